@@ -0,0 +1,150 @@
+/*
+***********************************************************************
+* epollclient.h:
+* non-blocking TCP client with length-prefixed frames, the counterpart
+* of epollserver. The client runs in the thread calling poll(), where
+* the frames from server are handed to the message handler, and the
+* queued frames are written without blocking.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _EPOLLCLIENT_H_
+#define _EPOLLCLIENT_H_
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+
+#include <functional>
+#include <string>
+
+#include "framedconnection.h"
+
+namespace ASV::common {
+
+class epollclient {
+ public:
+  epollclient(const std::string &_ip, const std::string &_port,
+              const socketconfig &_config = default_socketconfig)
+      : ip_server(_ip),
+        port(_port),
+        config(_config),
+        epollfd(-1),
+        results(0) {
+    connect2server();
+  }
+  epollclient(const epollclient &) = delete;
+  epollclient &operator=(const epollclient &) = delete;
+  ~epollclient() {
+    connection.reset();
+    if (epollfd >= 0) close(epollfd);
+  }
+
+  // _handler(const char *data, std::size_t size) is called for each frame
+  // from server, and the data is valid only during the call
+  epollclient &setmessagehandler(
+      std::function<void(const char *, std::size_t)> _handler) {
+    message_handler = std::move(_handler);
+    return *this;
+  }  // setmessagehandler
+
+  // wait for events up to _timeout_ms (-1: forever), and handle them.
+  // Return # of events.
+  int poll(const int _timeout_ms) {
+    if (!connection) return 0;
+    epoll_event event;
+    int num_events = epoll_wait(epollfd, &event, 1, _timeout_ms);
+    if (num_events <= 0) return 0;
+
+    // the frames received before a hangup or error are drained first
+    bool is_hangup = event.events & (EPOLLERR | EPOLLHUP);
+    bool is_alive = true;
+    if (is_hangup || (event.events & (EPOLLIN | EPOLLRDHUP)))
+      is_alive = connection->receive([this](const char *_data,
+                                            std::size_t _size) {
+        if (message_handler) message_handler(_data, _size);
+      });
+    is_alive = is_alive && !is_hangup;
+    if (is_alive && (event.events & EPOLLOUT)) is_alive = connection->flush();
+    if (!is_alive) disconnect();
+    return num_events;
+  }  // poll
+
+  // send one frame to server. Return false if it is dropped.
+  bool send(const char *_data, const std::size_t _size) {
+    return send(makeframe(_data, _size));
+  }
+  bool send(const sharedframe &_frame) {
+    if (!connection) return false;
+    bool is_queued = connection->enqueue(_frame);
+    if (!connection->flush()) disconnect();
+    return is_queued;
+  }  // send
+
+  bool isconnected() const noexcept { return static_cast<bool>(connection); }
+  int getsocketresults() const noexcept { return results; }
+  std::size_t getqueuedbytes() const noexcept {
+    return connection ? connection->getqueuedbytes() : 0;
+  }
+  // file descriptor of socket, -1 if disconnected
+  int getfd() const noexcept { return connection ? connection->getfd() : -1; }
+
+ private:
+  const std::string ip_server;
+  const std::string port;  // the port client will be connecting to
+  const socketconfig config;
+  int epollfd;
+  int results;
+  std::unique_ptr<framedconnection> connection;
+  std::function<void(const char *, std::size_t)> message_handler;
+
+  void disconnect() {
+    connection.reset();
+    results = 3;
+  }  // disconnect
+
+  void connect2server() {
+    addrinfo hints, *servinfo, *p;
+    std::memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int rv = getaddrinfo(ip_server.c_str(), port.c_str(), &hints, &servinfo);
+    if (rv != 0) {
+      results = 1;
+      return;
+    }
+    // loop through all the results and connect to the first we can
+    int sockfd = -1;
+    for (p = servinfo; p != NULL; p = p->ai_next) {
+      sockfd = socket(p->ai_family, p->ai_socktype | SOCK_CLOEXEC,
+                      p->ai_protocol);
+      if (sockfd == -1) continue;
+      if (connect(sockfd, p->ai_addr, p->ai_addrlen) == -1) {
+        close(sockfd);
+        continue;
+      }
+      break;
+    }
+    freeaddrinfo(servinfo);
+    if (p == NULL) {
+      results = 2;
+      return;
+    }
+
+    fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) | O_NONBLOCK);
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = sockfd;
+    epoll_ctl(epollfd, EPOLL_CTL_ADD, sockfd, &event);
+    connection = std::make_unique<framedconnection>(sockfd, config);
+  }  // connect2server
+
+};  // end class epollclient
+
+}  // namespace ASV::common
+
+#endif /* _EPOLLCLIENT_H_ */
@@ -0,0 +1,248 @@
+/*
+***********************************************************************
+* epollserver.h:
+* edge-triggered epoll TCP server with length-prefixed frames, for GUI
+* and telemetry. The server runs in the thread calling poll(), where
+* new connections are accepted, the frames from clients are handed to
+* the message handler, and the queued frames are written without
+* blocking. publish() serializes a snapshot once and fans it out to all
+* the clients; a slow client gets its frames dropped, instead of
+* blocking the publisher.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _EPOLLSERVER_H_
+#define _EPOLLSERVER_H_
+
+#include <netdb.h>
+#include <sys/epoll.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/logging/include/easylogging++.h"
+#include "framedconnection.h"
+
+namespace ASV::common {
+
+class epollserver {
+ public:
+  explicit epollserver(const std::string &_port,
+                       const socketconfig &_config = default_socketconfig)
+      : port(_port), config(_config), listener(-1), epollfd(-1), results(0) {
+    initializesocket();
+  }
+  epollserver(const epollserver &) = delete;
+  epollserver &operator=(const epollserver &) = delete;
+  ~epollserver() {
+    connections.clear();
+    if (listener >= 0) close(listener);
+    if (epollfd >= 0) close(epollfd);
+  }
+
+  // _handler(int fd, const char *data, std::size_t size) is called for each
+  // frame from a client, and the data is valid only during the call
+  epollserver &setmessagehandler(
+      std::function<void(int, const char *, std::size_t)> _handler) {
+    message_handler = std::move(_handler);
+    return *this;
+  }  // setmessagehandler
+
+  // wait for events up to _timeout_ms (-1: forever), and handle them.
+  // Return # of events.
+  int poll(const int _timeout_ms) {
+    int num_events = epoll_wait(epollfd, events, max_events, _timeout_ms);
+    if (num_events < 0) {
+      if (errno != EINTR) {
+        CLOG(ERROR, "tcp-server") << "epoll_wait: " << strerror(errno);
+        results = 4;
+      }
+      return 0;
+    }
+
+    for (int i = 0; i != num_events; ++i) {
+      int fd = events[i].data.fd;
+      if (fd == listener) {
+        acceptclients();
+        continue;
+      }
+      auto it = connections.find(fd);
+      if ((it == connections.end()) || (broken_fds.count(fd) != 0)) continue;
+      framedconnection &connection = *(it->second);
+      // the frames received before a hangup or error are drained first
+      bool is_hangup = events[i].events & (EPOLLERR | EPOLLHUP);
+      bool is_alive = true;
+      if (is_hangup || (events[i].events & (EPOLLIN | EPOLLRDHUP)))
+        is_alive = connection.receive(
+            [this, fd](const char *_data, std::size_t _size) {
+              if (message_handler) message_handler(fd, _data, _size);
+            });
+      is_alive = is_alive && !is_hangup;
+      if (is_alive && (events[i].events & EPOLLOUT))
+        is_alive = connection.flush();
+      if (!is_alive) broken_fds.insert(fd);
+    }
+    removebroken();
+    return num_events;
+  }  // poll
+
+  // send one frame to a client. Return false if it is dropped.
+  bool send(const int _fd, const char *_data, const std::size_t _size) {
+    return send(_fd, makeframe(_data, _size));
+  }
+  bool send(const int _fd, const sharedframe &_frame) {
+    auto it = connections.find(_fd);
+    if ((it == connections.end()) || (broken_fds.count(_fd) != 0))
+      return false;
+    bool is_queued = it->second->enqueue(_frame);
+    if (!it->second->flush()) broken_fds.insert(_fd);
+    return is_queued;
+  }  // send
+
+  // send one frame to all the clients, which share the serialized frame.
+  // Return # of clients which have queued it.
+  std::size_t publish(const char *_data, const std::size_t _size) {
+    return publish(makeframe(_data, _size));
+  }
+  std::size_t publish(const sharedframe &_frame) {
+    std::size_t num_queued = 0;
+    for (auto &[fd, connection] : connections) {
+      if (broken_fds.count(fd) != 0) continue;
+      if (connection->enqueue(_frame)) ++num_queued;
+      if (!connection->flush()) broken_fds.insert(fd);
+    }
+    return num_queued;
+  }  // publish
+
+  int getsocketresults() const noexcept { return results; }
+  int getconnectioncount() const noexcept {
+    return static_cast<int>(connections.size());
+  }
+  // max # of bytes waiting to be sent to a client
+  std::size_t getqueuedbytes() const noexcept {
+    std::size_t queued_bytes = 0;
+    for (auto const &[fd, connection] : connections)
+      queued_bytes = std::max(queued_bytes, connection->getqueuedbytes());
+    return queued_bytes;
+  }  // getqueuedbytes
+  // # of frames dropped by backpressure, for the connected clients
+  std::size_t getnumdropped() const noexcept {
+    std::size_t num_dropped = 0;
+    for (auto const &[fd, connection] : connections)
+      num_dropped += connection->getnumdropped();
+    return num_dropped;
+  }  // getnumdropped
+
+ private:
+  static constexpr int max_events = 64;
+
+  const std::string port;  // port we're listening on
+  const socketconfig config;
+  int listener;
+  int epollfd;
+  int results;
+  epoll_event events[max_events];
+
+  std::unordered_map<int, std::unique_ptr<framedconnection>> connections;
+  // the broken connections are removed at the end of poll(), since send()
+  // may be called from the message handler during a receive
+  std::unordered_set<int> broken_fds;
+  std::function<void(int, const char *, std::size_t)> message_handler;
+
+  void acceptclients() {
+    while (true) {
+      sockaddr_storage remoteaddr;
+      socklen_t addrlen = sizeof remoteaddr;
+      int newfd = accept4(listener, reinterpret_cast<sockaddr *>(&remoteaddr),
+                          &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (newfd == -1) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+          CLOG(ERROR, "tcp-server") << "accept: " << strerror(errno);
+        if (errno == EINTR) continue;
+        return;
+      }
+      epoll_event event{};
+      event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+      event.data.fd = newfd;
+      if (epoll_ctl(epollfd, EPOLL_CTL_ADD, newfd, &event) == -1) {
+        CLOG(ERROR, "tcp-server") << "epoll_ctl: " << strerror(errno);
+        close(newfd);
+        continue;
+      }
+      connections.emplace(newfd,
+                          std::make_unique<framedconnection>(newfd, config));
+      CLOG(INFO, "tcp-server") << "epollserver: new connection on socket "
+                               << newfd;
+    }
+  }  // acceptclients
+
+  void removebroken() {
+    for (auto fd : broken_fds) {
+      if (connections.erase(fd) != 0)
+        CLOG(INFO, "tcp-server") << "epollserver: socket " << fd
+                                 << " hung up";
+    }
+    broken_fds.clear();
+  }  // removebroken
+
+  void initializesocket() {
+    addrinfo hints, *ai, *p;
+    std::memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int rv = getaddrinfo(NULL, port.c_str(), &hints, &ai);
+    if (rv != 0) {
+      CLOG(ERROR, "tcp-server") << "epollserver: " << gai_strerror(rv);
+      results = 1;
+      return;
+    }
+
+    for (p = ai; p != NULL; p = p->ai_next) {
+      listener = socket(p->ai_family,
+                        p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        p->ai_protocol);
+      if (listener < 0) continue;
+      int yes = 1;
+      setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+      if (bind(listener, p->ai_addr, p->ai_addrlen) < 0) {
+        close(listener);
+        listener = -1;
+        continue;
+      }
+      break;
+    }
+    freeaddrinfo(ai);
+    if (p == NULL) {
+      CLOG(ERROR, "tcp-server") << "epollserver: failed to bind";
+      results = 2;
+      return;
+    }
+
+    if (listen(listener, SOMAXCONN) == -1) {
+      CLOG(ERROR, "tcp-server") << "listen: " << strerror(errno);
+      results = 3;
+      return;
+    }
+
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = listener;
+    if ((epollfd == -1) ||
+        (epoll_ctl(epollfd, EPOLL_CTL_ADD, listener, &event) == -1)) {
+      CLOG(ERROR, "tcp-server") << "epoll: " << strerror(errno);
+      results = 4;
+    }
+  }  // initializesocket
+
+};  // end class epollserver
+
+}  // namespace ASV::common
+
+#endif /* _EPOLLSERVER_H_ */
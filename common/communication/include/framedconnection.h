@@ -0,0 +1,265 @@
+/*
+***********************************************************************
+* framedconnection.h:
+* non-blocking TCP connection with length-prefixed framing, used by the
+* epoll server and client. Each frame is a 4-byte length (network byte
+* order) and the payload. The received bytes go into a ring buffer, so
+* that partial reads are assembled into frames; the frames to send are
+* queued by shared pointer, so that one serialized snapshot can be sent
+* to many connections without copying.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _FRAMEDCONNECTION_H_
+#define _FRAMEDCONNECTION_H_
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace ASV::common {
+
+// length of payload in each frame, in network byte order
+using frameheader = uint32_t;
+constexpr std::size_t frameheader_size = sizeof(frameheader);
+
+// a frame (header + payload) serialized once, and shared by all the
+// connections which send it
+using sharedframe = std::shared_ptr<const std::vector<char>>;
+
+inline sharedframe makeframe(const char *_data, const std::size_t _size) {
+  auto frame = std::make_shared<std::vector<char>>(frameheader_size + _size);
+  frameheader header = htonl(static_cast<frameheader>(_size));
+  std::memcpy(frame->data(), &header, frameheader_size);
+  if (_size > 0) std::memcpy(frame->data() + frameheader_size, _data, _size);
+  return frame;
+}  // makeframe
+
+struct socketconfig {
+  std::size_t recv_capacity;     // initial size of receive buffer (bytes)
+  std::size_t max_frame_size;    // a larger frame closes the connection
+  std::size_t max_queued_bytes;  // frames beyond it are dropped
+};
+
+constexpr socketconfig default_socketconfig{
+    1 << 16,  // recv_capacity
+    1 << 24,  // max_frame_size
+    1 << 22   // max_queued_bytes
+};
+
+// ring buffer of bytes, whose capacity is a power of 2
+class bytering {
+ public:
+  explicit bytering(const std::size_t _capacity)
+      : buffer(roundup(_capacity)), head(0), tail(0) {}
+
+  std::size_t size() const noexcept { return tail - head; }
+  std::size_t capacity() const noexcept { return buffer.size(); }
+  std::size_t available() const noexcept { return capacity() - size(); }
+
+  // free space, as up to two segments. Return # of segments
+  int writable(iovec _iov[2]) noexcept {
+    std::size_t begin = tail & mask();
+    std::size_t length = available();
+    std::size_t first = std::min(length, capacity() - begin);
+    _iov[0] = {buffer.data() + begin, first};
+    _iov[1] = {buffer.data(), length - first};
+    return (length == first) ? 1 : 2;
+  }  // writable
+
+  void commit(const std::size_t _n) noexcept { tail += _n; }
+  void consume(const std::size_t _n) noexcept { head += _n; }
+
+  // pointer to _n contiguous bytes from _offset, or nullptr if they wrap
+  // around the end of buffer
+  const char *contiguous(const std::size_t _offset,
+                         const std::size_t _n) const noexcept {
+    std::size_t begin = (head + _offset) & mask();
+    return (begin + _n <= capacity()) ? buffer.data() + begin : nullptr;
+  }  // contiguous
+
+  void peek(char *_dst, const std::size_t _offset,
+            const std::size_t _n) const noexcept {
+    std::size_t begin = (head + _offset) & mask();
+    std::size_t first = std::min(_n, capacity() - begin);
+    std::memcpy(_dst, buffer.data() + begin, first);
+    std::memcpy(_dst + first, buffer.data(), _n - first);
+  }  // peek
+
+  // enlarge the capacity to hold at least _n bytes
+  void reserve(const std::size_t _n) {
+    if (_n <= capacity()) return;
+    std::vector<char> larger(roundup(_n));
+    peek(larger.data(), 0, size());
+    tail = size();
+    head = 0;
+    buffer.swap(larger);
+  }  // reserve
+
+ private:
+  std::vector<char> buffer;
+  std::size_t head;  // # of bytes consumed
+  std::size_t tail;  // # of bytes committed
+
+  std::size_t mask() const noexcept { return capacity() - 1; }
+
+  static std::size_t roundup(const std::size_t _n) {
+    std::size_t capacity = 64;
+    while (capacity < _n) capacity <<= 1;
+    return capacity;
+  }  // roundup
+
+};  // end class bytering
+
+class framedconnection {
+ public:
+  framedconnection(const int _fd, const socketconfig &_config)
+      : fd(_fd),
+        config(_config),
+        recv_ring(_config.recv_capacity),
+        head_offset(0),
+        queued_bytes(0),
+        num_dropped(0),
+        num_received(0),
+        bytes_sent(0) {
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+  }
+  framedconnection(const framedconnection &) = delete;
+  framedconnection &operator=(const framedconnection &) = delete;
+  ~framedconnection() { close(fd); }
+
+  // read until the socket is drained (for edge-triggered epoll), and call
+  // _handler(const char *, std::size_t) for each complete frame. The data
+  // is valid only during the call. Return false if the connection is
+  // closed by peer, broken or gets a frame larger than max_frame_size.
+  template <typename Handler>
+  bool receive(Handler &&_handler) {
+    iovec iov[2];
+    while (true) {
+      if (recv_ring.available() == 0) recv_ring.reserve(recv_ring.size() + 1);
+      int num_iov = recv_ring.writable(iov);
+      ssize_t n = readv(fd, iov, num_iov);
+      if (n > 0) {
+        recv_ring.commit(static_cast<std::size_t>(n));
+        if (!parseframes(_handler)) return false;
+      } else if (n == 0) {
+        return false;
+      } else if (errno == EINTR) {
+        continue;
+      } else {
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+      }
+    }
+  }  // receive
+
+  // queue a frame to send. If more than max_queued_bytes are waiting, the
+  // frame is dropped and false is returned. An empty queue always accepts.
+  bool enqueue(sharedframe _frame) {
+    if (!send_queue.empty() &&
+        (queued_bytes + _frame->size() > config.max_queued_bytes)) {
+      ++num_dropped;
+      return false;
+    }
+    queued_bytes += _frame->size();
+    send_queue.push_back(std::move(_frame));
+    return true;
+  }  // enqueue
+
+  // send the queued frames until the socket buffer is full. Return false
+  // if the connection is broken.
+  bool flush() {
+    constexpr std::size_t max_iov = 64;
+    iovec iov[max_iov];
+    while (!send_queue.empty()) {
+      std::size_t num_iov = 0;
+      for (auto it = send_queue.begin();
+           (it != send_queue.end()) && (num_iov != max_iov); ++it) {
+        std::size_t offset = (num_iov == 0) ? head_offset : 0;
+        iov[num_iov++] = {const_cast<char *>((*it)->data()) + offset,
+                          (*it)->size() - offset};
+      }
+      msghdr message{};
+      message.msg_iov = iov;
+      message.msg_iovlen = num_iov;
+      ssize_t n = sendmsg(fd, &message, MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+      }
+      bytes_sent += static_cast<std::size_t>(n);
+      queued_bytes -= static_cast<std::size_t>(n);
+      // pop the frames which have been sent completely
+      std::size_t sent = static_cast<std::size_t>(n) + head_offset;
+      while (!send_queue.empty() && sent >= send_queue.front()->size()) {
+        sent -= send_queue.front()->size();
+        send_queue.pop_front();
+      }
+      head_offset = sent;
+    }
+    return true;
+  }  // flush
+
+  int getfd() const noexcept { return fd; }
+  std::size_t getqueuedbytes() const noexcept { return queued_bytes; }
+  std::size_t getnumdropped() const noexcept { return num_dropped; }
+  std::size_t getnumreceived() const noexcept { return num_received; }
+  std::size_t getbytessent() const noexcept { return bytes_sent; }
+
+ private:
+  const int fd;
+  const socketconfig config;
+  bytering recv_ring;
+  std::vector<char> scratch;  // for the frames wrapping around recv_ring
+
+  std::deque<sharedframe> send_queue;
+  std::size_t head_offset;  // bytes of the first frame already sent
+  std::size_t queued_bytes;
+
+  std::size_t num_dropped;   // frames dropped by backpressure
+  std::size_t num_received;  // frames received
+  std::size_t bytes_sent;
+
+  template <typename Handler>
+  bool parseframes(Handler &&_handler) {
+    while (recv_ring.size() >= frameheader_size) {
+      frameheader header;
+      recv_ring.peek(reinterpret_cast<char *>(&header), 0, frameheader_size);
+      std::size_t length = ntohl(header);
+      if (length > config.max_frame_size) return false;
+      if (recv_ring.size() < frameheader_size + length) {
+        recv_ring.reserve(frameheader_size + length);
+        break;
+      }
+      const char *data = recv_ring.contiguous(frameheader_size, length);
+      if (data == nullptr) {
+        scratch.resize(length);
+        recv_ring.peek(scratch.data(), frameheader_size, length);
+        data = scratch.data();
+      }
+      ++num_received;
+      _handler(data, length);
+      recv_ring.consume(frameheader_size + length);
+    }
+    return true;
+  }  // parseframes
+
+};  // end class framedconnection
+
+}  // namespace ASV::common
+
+#endif /* _FRAMEDCONNECTION_H_ */
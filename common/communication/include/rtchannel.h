@@ -0,0 +1,157 @@
+/*
+***********************************************************************
+* rtchannel.h:
+* lock-free "latest value" channel of real time data between threads,
+* with one writer and any number of readers. The writer copies each
+* new value into a free slot and publishes it with a version number;
+* a reader pins the latest slot and copies it out, so that it always
+* gets a consistent snapshot and never blocks the writer or the other
+* readers. It generalizes the triple buffer to many readers, and works
+* for any copyable type (Eigen, std::string, std::vector, etc), since a
+* slot is never written while it is pinned by a reader.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _RTCHANNEL_H_
+#define _RTCHANNEL_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace ASV::common {
+
+template <typename T>
+struct rtsnapshot {
+  uint64_t version;  // # of writes before this value, 0 for the initial one
+  T data;
+};
+
+// num_slots: # of buffers. Up to (num_slots - 2) readers can copy out at
+//            the same time without delaying the writer.
+template <typename T, std::size_t num_slots = 8>
+class rtchannel {
+  static_assert((num_slots >= 3) && (num_slots <= 256),
+                "# of slots should be in [3, 256]");
+
+ public:
+  static constexpr std::size_t max_readers = num_slots - 2;
+
+  explicit rtchannel(const T &_initial = T{}) : latest_(0), next_slot_(0) {
+    for (auto &_slot : slots_) {
+      _slot.readers.store(0, std::memory_order_relaxed);
+      _slot.data = _initial;
+    }
+  }
+  rtchannel(const rtchannel &) = delete;
+  rtchannel &operator=(const rtchannel &) = delete;
+  ~rtchannel() = default;
+
+  /********************* writer (one thread only)  *********************/
+  // publish a new value, and return its version
+  uint64_t write(const T &_data) {
+    std::size_t index = acquire_slot();
+    slots_[index].data = _data;
+    return publish(index);
+  }  // write
+
+  // publish the latest value modified by _modifier(T &), which is useful
+  // to update a few members only
+  template <typename Modifier>
+  uint64_t update(Modifier &&_modifier) {
+    const T &latest =
+        slots_[latest_.load(std::memory_order_relaxed) & slot_mask].data;
+    std::size_t index = acquire_slot();
+    slots_[index].data = latest;
+    _modifier(slots_[index].data);
+    return publish(index);
+  }  // update
+
+  /********************* readers (any thread)  *********************/
+  // copy out the latest value and its version
+  rtsnapshot<T> read() const {
+    rtsnapshot<T> snapshot{0, T{}};
+    snapshot.version = read(snapshot.data);
+    return snapshot;
+  }  // read
+
+  // copy the latest value into _data, and return its version
+  uint64_t read(T &_data) const {
+    while (true) {
+      uint64_t state = latest_.load(std::memory_order_seq_cst);
+      slot &_slot = slots_[state & slot_mask];
+      _slot.readers.fetch_add(1, std::memory_order_seq_cst);
+      // the slot is pinned only if it is still the latest one; otherwise
+      // the writer may be filling it, and we try again
+      if (latest_.load(std::memory_order_seq_cst) == state) {
+        _data = _slot.data;
+        _slot.readers.fetch_sub(1, std::memory_order_release);
+        return state >> version_shift;
+      }
+      _slot.readers.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }  // read
+
+  // copy out the latest value only if it is newer than _version, which is
+  // then updated. Return false if there is nothing new.
+  bool read_if_newer(T &_data, uint64_t &_version) const {
+    if (version() == _version) return false;
+    _version = read(_data);
+    return true;
+  }  // read_if_newer
+
+  // version of the latest value, without copying it
+  uint64_t version() const noexcept {
+    return latest_.load(std::memory_order_acquire) >> version_shift;
+  }
+
+ private:
+  static constexpr unsigned version_shift = 8;
+  static constexpr uint64_t slot_mask = (uint64_t(1) << version_shift) - 1;
+
+  struct alignas(64) slot {
+    std::atomic<uint32_t> readers;  // # of readers copying out this slot
+    T data;
+  };
+
+  // version << 8 | index of the latest slot
+  alignas(64) std::atomic<uint64_t> latest_;
+  std::size_t next_slot_;  // used by writer only
+  mutable std::array<slot, num_slots> slots_;
+
+  // find a slot which is neither the latest one nor pinned by a reader.
+  // If there are more readers than max_readers, the writer may wait for
+  // one of them to finish copying.
+  std::size_t acquire_slot() {
+    std::size_t latest_index =
+        latest_.load(std::memory_order_relaxed) & slot_mask;
+    while (true) {
+      for (std::size_t i = 1; i <= num_slots; ++i) {
+        std::size_t index = (next_slot_ + i) % num_slots;
+        if ((index != latest_index) &&
+            (slots_[index].readers.load(std::memory_order_seq_cst) == 0)) {
+          next_slot_ = index;
+          return index;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }  // acquire_slot
+
+  uint64_t publish(const std::size_t _index) {
+    uint64_t version =
+        (latest_.load(std::memory_order_relaxed) >> version_shift) + 1;
+    latest_.store((version << version_shift) | _index,
+                  std::memory_order_seq_cst);
+    return version;
+  }  // publish
+
+};  // end class rtchannel
+
+}  // namespace ASV::common
+
+#endif /* _RTCHANNEL_H_ */
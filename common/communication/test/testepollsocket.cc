@@ -0,0 +1,373 @@
+/*
+***********************************************************************
+* testepollsocket.cc:
+* unit test and loopback benchmark for the epoll server/client with
+* length-prefixed frames: partial reads, round trip latency compared
+* with selectserver, fan-out throughput to many subscribers, and the
+* backpressure of a client which does not read.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../include/epollclient.h"
+#include "../include/epollserver.h"
+#include "../include/tcpclient.h"
+#include "../include/tcpserver.h"
+
+using namespace ASV::common;
+using steady = std::chrono::steady_clock;
+
+double elapsed_ms(const steady::time_point &_t0) {
+  return std::chrono::duration<double, std::milli>(steady::now() - _t0)
+      .count();
+}  // elapsed_ms
+
+double percentile(std::vector<double> _values, const double _p) {
+  std::sort(_values.begin(), _values.end());
+  return _values[static_cast<std::size_t>(_p * (_values.size() - 1))];
+}  // percentile
+
+// the payload of frame i in the framing test
+std::size_t frame_size(const std::size_t i) { return (i * 7919) % 70000; }
+char frame_byte(const std::size_t i, const std::size_t j) {
+  return static_cast<char>((i + j) & 0xff);
+}
+
+// a blocking client writes frames in small pieces, which are assembled
+// by the server
+bool test_framing() {
+  constexpr std::size_t num_frames = 200;
+  epollserver server("9360");
+  std::size_t num_received = 0, num_wrong = 0;
+  server.setmessagehandler(
+      [&](int, const char *_data, std::size_t _size) {
+        bool is_same = (_size == frame_size(num_received));
+        for (std::size_t j = 0; is_same && (j != _size); ++j)
+          is_same = (_data[j] == frame_byte(num_received, j));
+        if (!is_same) ++num_wrong;
+        ++num_received;
+      });
+
+  std::thread writer([]() {
+    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(9360);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    connect(sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof addr);
+    std::vector<char> stream;
+    for (std::size_t i = 0; i != num_frames; ++i) {
+      auto frame = makeframe(std::vector<char>(frame_size(i)).data(),
+                             frame_size(i));
+      std::vector<char> bytes(*frame);
+      for (std::size_t j = 0; j != frame_size(i); ++j)
+        bytes[frameheader_size + j] = frame_byte(i, j);
+      stream.insert(stream.end(), bytes.begin(), bytes.end());
+    }
+    // pieces of 1 byte to 64 kB
+    std::size_t offset = 0, piece = 1;
+    while (offset != stream.size()) {
+      std::size_t n = std::min(piece, stream.size() - offset);
+      ssize_t sent = send(sockfd, stream.data() + offset, n, 0);
+      if (sent <= 0) break;
+      offset += static_cast<std::size_t>(sent);
+      piece = (piece * 3) % 65521 + 1;
+    }
+    close(sockfd);
+  });
+
+  auto t0 = steady::now();
+  while ((num_received != num_frames) && (elapsed_ms(t0) < 10000))
+    server.poll(100);
+  writer.join();
+
+  bool passed = (num_received == num_frames) && (num_wrong == 0);
+  std::cout << "framing: " << num_received << " frames, " << num_wrong
+            << " wrong" << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_framing
+
+// a client sends frames and resets the connection (EPOLLHUP | EPOLLERR),
+// and the frames before the reset are still handled by the server
+bool test_hangup() {
+  constexpr std::size_t num_frames = 10;
+  epollserver server("9366");
+  std::size_t num_received = 0;
+  server.setmessagehandler(
+      [&num_received](int, const char *, std::size_t) { ++num_received; });
+
+  int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(9366);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  connect(sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof addr);
+  while (server.getconnectioncount() == 0) server.poll(100);
+
+  for (std::size_t i = 0; i != num_frames; ++i) {
+    auto frame = makeframe("hangup", 6);
+    send(sockfd, frame->data(), frame->size(), 0);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  linger reset{1, 0};
+  setsockopt(sockfd, SOL_SOCKET, SO_LINGER, &reset, sizeof reset);
+  close(sockfd);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  auto t0 = steady::now();
+  while ((server.getconnectioncount() != 0) && (elapsed_ms(t0) < 2000))
+    server.poll(100);
+
+  bool passed =
+      (num_received == num_frames) && (server.getconnectioncount() == 0);
+  std::cout << "hangup: " << num_received << " frames before reset"
+            << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_hangup
+
+// a client resets the connection before the server polls again, and
+// publish/send skip the broken connection until poll removes it
+bool test_publish_broken() {
+  constexpr std::size_t num_snapshots = 100;
+  epollserver server("9367");
+  int server_fd = -1;
+  server.setmessagehandler(
+      [&server_fd](int _fd, const char *, std::size_t) { server_fd = _fd; });
+
+  int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(9367);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  connect(sockfd, reinterpret_cast<sockaddr *>(&addr), sizeof addr);
+  auto frame = makeframe("hello", 5);
+  send(sockfd, frame->data(), frame->size(), 0);
+  while (server_fd < 0) server.poll(100);
+  linger reset{1, 0};
+  setsockopt(sockfd, SOL_SOCKET, SO_LINGER, &reset, sizeof reset);
+  close(sockfd);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // the first frame finds the reset, and the others are not queued
+  std::size_t num_queued = 0;
+  for (std::size_t i = 0; i != num_snapshots; ++i)
+    num_queued += server.publish("broken", 6);
+  std::size_t num_sent = 0;
+  for (std::size_t i = 0; i != num_snapshots; ++i)
+    num_sent += server.send(server_fd, "broken", 6);
+  std::size_t queued_bytes = server.getqueuedbytes();
+  server.poll(0);
+
+  bool passed = (num_queued <= 1) && (num_sent == 0) &&
+                (queued_bytes <= frameheader_size + 6) &&
+                (server.getconnectioncount() == 0);
+  std::cout << "publish to broken: " << num_queued << " queued, "
+            << num_sent << " sent, " << queued_bytes << " bytes"
+            << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_publish_broken
+
+// round trip of 160 bytes (the message of GUI), epoll vs select
+bool test_latency() {
+  constexpr int num_trips = 2000;
+  constexpr std::size_t msg_size = 160;
+
+  // selectserver replies to each recv with the send buffer
+  std::vector<double> select_us;
+  {
+    ASV::tcpserver server("9361");
+    std::atomic<bool> is_done(false);
+    std::thread server_thread([&]() {
+      char recv_buffer[10];
+      char send_buffer[msg_size] = {1};
+      while (!is_done.load())
+        server.selectserver(recv_buffer, send_buffer, 10, msg_size);
+    });
+    {
+      tcpclient client("127.0.0.1", "9361");
+      char send_buffer[10] = "socket";
+      char recv_buffer[msg_size];
+      for (int i = 0; i != num_trips; ++i) {
+        auto t0 = steady::now();
+        client.senddata(recv_buffer, send_buffer, msg_size, 10);
+        select_us.push_back(1e3 * elapsed_ms(t0));
+      }
+      is_done.store(true);
+    }
+    server_thread.join();
+  }
+
+  // epollserver echoes each frame
+  std::vector<double> epoll_us;
+  {
+    epollserver server("9362");
+    server.setmessagehandler(
+        [&server](int _fd, const char *_data, std::size_t _size) {
+          server.send(_fd, _data, _size);
+        });
+    std::atomic<bool> is_done(false);
+    std::thread server_thread([&]() {
+      while (!is_done.load()) server.poll(100);
+    });
+    epollclient client("127.0.0.1", "9362");
+    bool is_replied = false;
+    client.setmessagehandler(
+        [&is_replied](const char *, std::size_t _size) {
+          is_replied = (_size == msg_size);
+        });
+    char msg[msg_size] = {1};
+    for (int i = 0; i != num_trips; ++i) {
+      auto t0 = steady::now();
+      is_replied = false;
+      client.send(msg, msg_size);
+      while (!is_replied && client.isconnected()) client.poll(100);
+      epoll_us.push_back(1e3 * elapsed_ms(t0));
+    }
+    is_done.store(true);
+    server_thread.join();
+  }
+
+  std::cout << "round trip(us) of " << msg_size << " bytes: select p50 "
+            << percentile(select_us, 0.5) << " p99 "
+            << percentile(select_us, 0.99) << " | epoll p50 "
+            << percentile(epoll_us, 0.5) << " p99 "
+            << percentile(epoll_us, 0.99) << std::endl;
+  return epoll_us.size() == num_trips;
+}  // test_latency
+
+// one snapshot to many subscribers. The publisher waits for the slowest
+// subscriber, so that no frame is dropped.
+bool test_fanout(const std::size_t num_subscribers,
+                 const std::size_t snapshot_size,
+                 const std::size_t num_snapshots, const bool is_shared) {
+  epollserver server("9363");
+  std::atomic<std::size_t> num_ready(0);
+  std::vector<std::size_t> num_received(num_subscribers, 0);
+  std::vector<std::size_t> num_disordered(num_subscribers, 0);
+  std::vector<std::thread> subscribers;
+  for (std::size_t k = 0; k != num_subscribers; ++k)
+    subscribers.emplace_back([&, k]() {
+      epollclient client("127.0.0.1", "9363");
+      client.setmessagehandler([&, k](const char *_data, std::size_t _size) {
+        uint64_t sequence;
+        std::memcpy(&sequence, _data, sizeof sequence);
+        if ((sequence != num_received[k]) || (_size != snapshot_size))
+          ++num_disordered[k];
+        ++num_received[k];
+      });
+      ++num_ready;
+      while ((num_received[k] != num_snapshots) && client.isconnected())
+        client.poll(100);
+    });
+
+  while (server.getconnectioncount() != static_cast<int>(num_subscribers))
+    server.poll(100);
+  while (num_ready.load() != num_subscribers) server.poll(1);
+
+  std::vector<char> snapshot(snapshot_size, 'x');
+  auto t0 = steady::now();
+  for (uint64_t i = 0; i != num_snapshots; ++i) {
+    while (server.getqueuedbytes() > default_socketconfig.max_queued_bytes / 2)
+      server.poll(10);
+    std::memcpy(snapshot.data(), &i, sizeof i);
+    if (is_shared) {
+      server.publish(snapshot.data(), snapshot_size);
+    } else {
+      // a copy for each subscriber, whose fd is less than 32 on server
+      for (int fd = 0; fd != 32; ++fd)
+        server.send(fd, snapshot.data(), snapshot_size);
+    }
+  }
+  while (server.getqueuedbytes() != 0) server.poll(10);
+  for (auto &_subscriber : subscribers) _subscriber.join();
+  double publish_ms = elapsed_ms(t0);
+
+  std::size_t total_received = 0, total_disordered = 0;
+  for (std::size_t k = 0; k != num_subscribers; ++k) {
+    total_received += num_received[k];
+    total_disordered += num_disordered[k];
+  }
+  bool passed = (total_received == num_subscribers * num_snapshots) &&
+                (total_disordered == 0) && (server.getnumdropped() == 0);
+  std::cout << (is_shared ? "publish" : "send copies") << " to "
+            << num_subscribers << " subscribers, " << num_snapshots << " x "
+            << snapshot_size << " bytes: " << publish_ms << " ms, "
+            << 1e-3 * total_received * snapshot_size / publish_ms
+            << " MB/s delivered" << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_fanout
+
+// a subscriber which never reads does not block the publisher, and its
+// queue is bounded
+bool test_backpressure() {
+  constexpr std::size_t snapshot_size = 16384;
+  constexpr std::size_t num_snapshots = 2000;
+  socketconfig config = default_socketconfig;
+  config.max_queued_bytes = 1 << 20;
+  epollserver server("9364", config);
+
+  epollclient stalled("127.0.0.1", "9364");
+  std::size_t num_received = 0, num_disordered = 0;
+  uint64_t last_sequence = 0;
+  epollclient reader("127.0.0.1", "9364");
+  reader.setmessagehandler([&](const char *_data, std::size_t) {
+    uint64_t sequence;
+    std::memcpy(&sequence, _data, sizeof sequence);
+    if ((num_received != 0) && (sequence <= last_sequence)) ++num_disordered;
+    last_sequence = sequence;
+    ++num_received;
+  });
+  while (server.getconnectioncount() != 2) server.poll(100);
+
+  std::vector<char> snapshot(snapshot_size, 'y');
+  std::size_t max_queued_bytes = 0;
+  auto t0 = steady::now();
+  for (uint64_t i = 0; i != num_snapshots; ++i) {
+    std::memcpy(snapshot.data(), &i, sizeof i);
+    server.publish(snapshot.data(), snapshot_size);
+    server.poll(0);
+    reader.poll(0);
+    max_queued_bytes = std::max(max_queued_bytes, server.getqueuedbytes());
+  }
+  double publish_ms = elapsed_ms(t0);
+  std::size_t num_dropped = server.getnumdropped();
+  while (reader.poll(50) != 0) server.poll(0);
+
+  bool passed = (num_dropped > 0) && (num_disordered == 0) &&
+                (num_received > 0) &&
+                (max_queued_bytes <= config.max_queued_bytes) &&
+                stalled.isconnected();
+  std::cout << "backpressure: " << num_snapshots << " x " << snapshot_size
+            << " bytes published in " << publish_ms << " ms, "
+            << num_dropped << " dropped, max queued " << max_queued_bytes
+            << " bytes, " << num_received << " read"
+            << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_backpressure
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  el::Configurations conf;
+  conf.setGlobally(el::ConfigurationType::Enabled, "false");
+  el::Loggers::setDefaultConfigurations(conf, true);
+
+  bool passed = true;
+  passed &= test_framing();
+  passed &= test_hangup();
+  passed &= test_publish_broken();
+  passed &= test_latency();
+  passed &= test_fanout(8, 1024, 20000, true);
+  passed &= test_fanout(8, 1024, 20000, false);
+  passed &= test_fanout(8, 65536, 1000, true);
+  passed &= test_backpressure();
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
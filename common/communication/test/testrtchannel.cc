@@ -0,0 +1,124 @@
+/*
+***********************************************************************
+* testrtchannel.cc:
+* stress test for the latest value channel, where one thread writes as
+* fast as possible and several threads read it. Each value is derived
+* from its sequence number, so that a torn read can be found.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/rtchannel.h"
+
+using namespace ASV::common;
+
+constexpr std::size_t num_values = 64;
+
+struct test_data {
+  uint64_t sequence;
+  double values[num_values];  // sequence + i
+  std::string name;           // heap string, to_string(sequence)
+  std::vector<double> history;
+};
+
+test_data generate_data(const uint64_t _sequence) {
+  test_data data{_sequence, {}, std::to_string(_sequence),
+                 std::vector<double>(8 + _sequence % 8, _sequence)};
+  for (std::size_t i = 0; i != num_values; ++i)
+    data.values[i] = static_cast<double>(_sequence + i);
+  return data;
+}  // generate_data
+
+bool is_consistent(const test_data &_data) {
+  for (std::size_t i = 0; i != num_values; ++i)
+    if (_data.values[i] != static_cast<double>(_data.sequence + i))
+      return false;
+  if (_data.name != std::to_string(_data.sequence)) return false;
+  if (_data.history.size() != 8 + _data.sequence % 8) return false;
+  for (auto const &_value : _data.history)
+    if (_value != _data.sequence) return false;
+  return true;
+}  // is_consistent
+
+template <std::size_t num_slots>
+bool test_channel(const uint64_t num_writes, const std::size_t num_readers) {
+  rtchannel<test_data, num_slots> channel(generate_data(0));
+
+  std::vector<std::size_t> num_reads(num_readers, 0);
+  std::vector<std::size_t> num_torn(num_readers, 0);
+  std::vector<std::size_t> num_disordered(num_readers, 0);
+  std::vector<std::thread> readers;
+  for (std::size_t j = 0; j != num_readers; ++j)
+    readers.emplace_back([&, j]() {
+      uint64_t previous_version = 0;
+      test_data data;
+      while (true) {
+        uint64_t version = channel.read(data);
+        ++num_reads[j];
+        if (!is_consistent(data) || (data.sequence != version)) ++num_torn[j];
+        if (version < previous_version) ++num_disordered[j];
+        previous_version = version;
+        if (version == num_writes) break;
+      }
+    });
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint64_t i = 1; i <= num_writes; ++i) {
+    if (i % 2)
+      channel.write(generate_data(i));
+    else
+      channel.update([i](test_data &_data) { _data = generate_data(i); });
+  }
+  double write_us = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - t0)
+                        .count() /
+                    num_writes;
+  for (auto &_reader : readers) _reader.join();
+
+  std::size_t total_reads = 0, total_torn = 0, total_disordered = 0;
+  for (std::size_t j = 0; j != num_readers; ++j) {
+    total_reads += num_reads[j];
+    total_torn += num_torn[j];
+    total_disordered += num_disordered[j];
+  }
+  bool passed = (total_torn == 0) && (total_disordered == 0) &&
+                (channel.version() == num_writes);
+  std::cout << "slots: " << num_slots << ", readers: " << num_readers
+            << ", writes: " << num_writes << ", reads: " << total_reads
+            << ", torn: " << total_torn
+            << ", disordered: " << total_disordered
+            << ", write(us): " << write_us
+            << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_channel
+
+int main() {
+  bool passed = true;
+  passed &= test_channel<8>(200000, 2);
+  // more readers than max_readers, the writer may wait for a free slot
+  passed &= test_channel<3>(200000, 4);
+  passed &= test_channel<4>(100000, 8);
+
+  // versioned read
+  rtchannel<test_data> channel(generate_data(0));
+  test_data data;
+  uint64_t version = 0;
+  passed &= !channel.read_if_newer(data, version);
+  channel.write(generate_data(1));
+  passed &= channel.read_if_newer(data, version) && (version == 1) &&
+            is_consistent(data) && (data.sequence == 1);
+  passed &= !channel.read_if_newer(data, version);
+  channel.update([](test_data &_data) { _data.name = "modified"; });
+  auto snapshot = channel.read();
+  passed &= (snapshot.version == 2) && (snapshot.data.sequence == 1) &&
+            (snapshot.data.name == "modified");
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,386 @@
+/*
+***********************************************************************
+* columnconverter.h:
+* convert the logs between the sqlite3 databases (datarecorder.h) and
+* the binary columnar format (columnrecorder.h). The channels without
+* column_schema (route planner, spoke processing, detected targets) are
+* not converted.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _COLUMNCONVERTER_H_
+#define _COLUMNCONVERTER_H_
+
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include "columnrecorder.h"
+#include "dataparser.h"
+#include "datarecorder.h"
+
+namespace ASV::common {
+
+namespace column_conversion {
+
+// # of rows read/written at once
+inline constexpr std::size_t chunk_size = 4096;
+
+// copy the rows given by the chunked parse into one channel, and return
+// the # of rows copied (the ones earlier than the channel are rejected)
+template <typename T_data, typename Parse>
+std::size_t db_to_column(Parse &&_parse, const std::string &_column_folder,
+                         const double _timestamp0) {
+  column_recorder<T_data> recorder(_column_folder, 0, _timestamp0);
+  try {
+    std::size_t num_rows = _parse([&](std::vector<T_data> &_chunk) {
+      for (auto const &row : _chunk) recorder.update_table(row, row.local_time);
+    });
+    return num_rows - recorder.num_rejected();
+  } catch (sqlite::sqlite_exception &) {
+    // the table does not exist
+    return 0;
+  }
+}  // db_to_column
+
+// copy all the records of one channel into the table, where _update is
+// called by each record and its DATETIME
+template <typename T_data, typename Update, typename Flush>
+std::size_t column_to_db(const std::string &_column_folder, Update &&_update,
+                         Flush &&_flush) {
+  if (!std::filesystem::exists(_column_folder + column_schema<T_data>::channel))
+    return 0;
+  column_parser<T_data> parser(_column_folder);
+  const double timestamp0 = parser.gettimestamp0();
+  char datetime[32];
+  return parser.parse_table(
+      -std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::infinity(),
+      [&](std::vector<T_data> &_chunk) {
+        for (auto const &row : _chunk) {
+          std::snprintf(datetime, sizeof(datetime), "%.10f",
+                        timestamp0 + row.local_time / 86400.0);
+          _update(row, datetime);
+        }
+        // the queue of the writer is never full
+        _flush();
+      },
+      chunk_size);
+}  // column_to_db
+
+}  // namespace column_conversion
+
+// copy the sqlite3 databases in _DB_folder_path into the columnar format,
+// and return the # of rows of each channel. The local_time is kept, as
+// the timestamp0 of master.db is used by the columns.
+inline std::map<std::string, std::size_t> convert_db_to_column(
+    const std::string &_DB_folder_path, const std::string &_config_name,
+    const std::string &_column_folder_path) {
+  using namespace column_conversion;
+  namespace fs = std::filesystem;
+  std::map<std::string, std::size_t> num_rows;
+  if (!fs::exists(_DB_folder_path + "master.db")) return num_rows;
+
+  double timestamp0 = 0;
+  sqlite::database master(_DB_folder_path + "master.db");
+  master << "select DATETIME from info where ID = 1;" >>
+      [&](std::string _datetime) { timestamp0 = atof(_datetime.c_str()); };
+
+  // the whole log
+  const double start_time = -std::numeric_limits<double>::infinity();
+  const double end_time = std::numeric_limits<double>::infinity();
+  auto add = [&](const char *_channel, std::size_t _num) {
+    num_rows[_channel] = _num;
+  };
+
+  if (fs::exists(_DB_folder_path + "gps.db")) {
+    GPS_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<gps_db_data>::channel,
+        db_to_column<gps_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_gps_table(start_time, end_time, _visitor,
+                                            chunk_size);
+            },
+            _column_folder_path, timestamp0));
+    add(column_schema<imu_db_data>::channel,
+        db_to_column<imu_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_imu_table(start_time, end_time, _visitor,
+                                            chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "wind.db")) {
+    wind_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<wind_db_data>::channel,
+        db_to_column<wind_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_table(start_time, end_time, _visitor,
+                                        chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "stm32.db")) {
+    stm32_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<stm32_db_data>::channel,
+        db_to_column<stm32_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_table(start_time, end_time, _visitor,
+                                        chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "marineradar.db")) {
+    marineradar_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<marineradar_db_data>::channel,
+        db_to_column<marineradar_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_table(start_time, end_time, _visitor,
+                                        chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "estimator.db")) {
+    estimator_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<est_measurement_db_data>::channel,
+        db_to_column<est_measurement_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_measurement_table(start_time, end_time,
+                                                    _visitor, chunk_size);
+            },
+            _column_folder_path, timestamp0));
+    add(column_schema<est_state_db_data>::channel,
+        db_to_column<est_state_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_state_table(start_time, end_time, _visitor,
+                                              chunk_size);
+            },
+            _column_folder_path, timestamp0));
+    add(column_schema<est_error_db_data>::channel,
+        db_to_column<est_error_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_error_table(start_time, end_time, _visitor,
+                                              chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "planner.db")) {
+    planner_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<plan_lattice_db_data>::channel,
+        db_to_column<plan_lattice_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_lattice_table(start_time, end_time,
+                                                _visitor, chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "controller.db")) {
+    control_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<control_setpoint_db_data>::channel,
+        db_to_column<control_setpoint_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_setpoint_table(start_time, end_time,
+                                                 _visitor, chunk_size);
+            },
+            _column_folder_path, timestamp0));
+    add(column_schema<control_TA_db_data>::channel,
+        db_to_column<control_TA_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_TA_table(start_time, end_time, _visitor,
+                                           chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  if (fs::exists(_DB_folder_path + "perception.db")) {
+    perception_parser parser(_DB_folder_path, _config_name);
+    add(column_schema<perception_trackingtarget_db_data>::channel,
+        db_to_column<perception_trackingtarget_db_data>(
+            [&](auto &&_visitor) {
+              return parser.parse_TT_table(start_time, end_time, _visitor,
+                                           chunk_size);
+            },
+            _column_folder_path, timestamp0));
+  }
+  return num_rows;
+}  // convert_db_to_column
+
+// copy the columnar format in _column_folder_path into the sqlite3
+// databases, and return the # of rows of each channel. The DATETIME of
+// each row is given by the timestamp0 and local_time of the columns.
+inline std::map<std::string, std::size_t> convert_column_to_db(
+    const std::string &_column_folder_path, const std::string &_DB_folder_path,
+    const std::string &_config_name) {
+  using namespace column_conversion;
+  namespace fs = std::filesystem;
+  std::map<std::string, std::size_t> num_rows;
+
+  // master.db is given by the timestamp0 of the first channel
+  double timestamp0 = -1;
+  auto find_timestamp0 = [&](auto _data) {
+    using T_data = decltype(_data);
+    if ((timestamp0 < 0) &&
+        fs::exists(_column_folder_path + column_schema<T_data>::channel))
+      timestamp0 = column_parser<T_data>(_column_folder_path).gettimestamp0();
+  };
+  find_timestamp0(gps_db_data{});
+  find_timestamp0(imu_db_data{});
+  find_timestamp0(wind_db_data{});
+  find_timestamp0(stm32_db_data{});
+  find_timestamp0(marineradar_db_data{});
+  find_timestamp0(est_measurement_db_data{});
+  find_timestamp0(est_state_db_data{});
+  find_timestamp0(est_error_db_data{});
+  find_timestamp0(plan_lattice_db_data{});
+  find_timestamp0(control_setpoint_db_data{});
+  find_timestamp0(control_TA_db_data{});
+  find_timestamp0(perception_trackingtarget_db_data{});
+  if (timestamp0 < 0) return num_rows;
+  char datetime0[32];
+  std::snprintf(datetime0, sizeof(datetime0), "%.10f", timestamp0);
+
+  const db_writer_config writer_config{
+      chunk_size,  // max_queue_size
+      512,         // batch_size
+      200,         // commit_interval_ms
+      true         // WAL_mode
+  };
+  auto exists = [&](auto _data) {
+    return fs::exists(_column_folder_path +
+                      column_schema<decltype(_data)>::channel);
+  };
+
+  if (exists(gps_db_data{}) || exists(imu_db_data{})) {
+    gps_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    auto flush = [&]() { db.flush(); };
+    num_rows[column_schema<gps_db_data>::channel] =
+        column_to_db<gps_db_data>(
+            _column_folder_path,
+            [&](const gps_db_data &_row, const std::string &_datetime) {
+              db.update_gps_table(_row, _datetime);
+            },
+            flush);
+    num_rows[column_schema<imu_db_data>::channel] =
+        column_to_db<imu_db_data>(
+            _column_folder_path,
+            [&](const imu_db_data &_row, const std::string &_datetime) {
+              db.update_imu_table(_row, _datetime);
+            },
+            flush);
+  }
+  if (exists(wind_db_data{})) {
+    wind_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    num_rows[column_schema<wind_db_data>::channel] =
+        column_to_db<wind_db_data>(
+            _column_folder_path,
+            [&](const wind_db_data &_row, const std::string &_datetime) {
+              db.update_table(_row, _datetime);
+            },
+            [&]() { db.flush(); });
+  }
+  if (exists(stm32_db_data{})) {
+    stm32_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    num_rows[column_schema<stm32_db_data>::channel] =
+        column_to_db<stm32_db_data>(
+            _column_folder_path,
+            [&](const stm32_db_data &_row, const std::string &_datetime) {
+              db.update_table(_row, _datetime);
+            },
+            [&]() { db.flush(); });
+  }
+  if (exists(marineradar_db_data{})) {
+    marineradar_db db(_DB_folder_path, _config_name, datetime0,
+                      writer_config);
+    db.create_table();
+    num_rows[column_schema<marineradar_db_data>::channel] =
+        column_to_db<marineradar_db_data>(
+            _column_folder_path,
+            [&](const marineradar_db_data &_row,
+                const std::string &_datetime) {
+              db.update_table(_row, _datetime);
+            },
+            [&]() { db.flush(); });
+  }
+  if (exists(est_measurement_db_data{}) || exists(est_state_db_data{}) ||
+      exists(est_error_db_data{})) {
+    estimator_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    auto flush = [&]() { db.flush(); };
+    num_rows[column_schema<est_measurement_db_data>::channel] =
+        column_to_db<est_measurement_db_data>(
+            _column_folder_path,
+            [&](const est_measurement_db_data &_row,
+                const std::string &_datetime) {
+              db.update_measurement_table(_row, _datetime);
+            },
+            flush);
+    num_rows[column_schema<est_state_db_data>::channel] =
+        column_to_db<est_state_db_data>(
+            _column_folder_path,
+            [&](const est_state_db_data &_row, const std::string &_datetime) {
+              db.update_state_table(_row, _datetime);
+            },
+            flush);
+    num_rows[column_schema<est_error_db_data>::channel] =
+        column_to_db<est_error_db_data>(
+            _column_folder_path,
+            [&](const est_error_db_data &_row, const std::string &_datetime) {
+              db.update_error_table(_row, _datetime);
+            },
+            flush);
+  }
+  if (exists(plan_lattice_db_data{})) {
+    planner_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    num_rows[column_schema<plan_lattice_db_data>::channel] =
+        column_to_db<plan_lattice_db_data>(
+            _column_folder_path,
+            [&](const plan_lattice_db_data &_row,
+                const std::string &_datetime) {
+              db.update_latticeplanner_table(_row, _datetime);
+            },
+            [&]() { db.flush(); });
+  }
+  if (exists(control_setpoint_db_data{}) || exists(control_TA_db_data{})) {
+    controller_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    auto flush = [&]() { db.flush(); };
+    num_rows[column_schema<control_setpoint_db_data>::channel] =
+        column_to_db<control_setpoint_db_data>(
+            _column_folder_path,
+            [&](const control_setpoint_db_data &_row,
+                const std::string &_datetime) {
+              db.update_setpoint_table(_row, _datetime);
+            },
+            flush);
+    num_rows[column_schema<control_TA_db_data>::channel] =
+        column_to_db<control_TA_db_data>(
+            _column_folder_path,
+            [&](const control_TA_db_data &_row, const std::string &_datetime) {
+              db.update_TA_table(_row, _datetime);
+            },
+            flush);
+  }
+  if (exists(perception_trackingtarget_db_data{})) {
+    perception_db db(_DB_folder_path, _config_name, datetime0, writer_config);
+    db.create_table();
+    num_rows[column_schema<perception_trackingtarget_db_data>::channel] =
+        column_to_db<perception_trackingtarget_db_data>(
+            _column_folder_path,
+            [&](const perception_trackingtarget_db_data &_row,
+                const std::string &_datetime) {
+              db.update_trackingtarget_table(_row, _datetime);
+            },
+            [&]() { db.flush(); });
+  }
+  return num_rows;
+}  // convert_column_to_db
+
+}  // namespace ASV::common
+
+#endif /* _COLUMNCONVERTER_H_ */
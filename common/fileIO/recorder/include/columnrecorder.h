@@ -0,0 +1,309 @@
+/*
+***********************************************************************
+* columnrecorder.h:
+* recorder of one channel in the binary columnar format (datacolumn.h),
+* as an alternative backend to datarecorder.h. Each record is copied
+* into the buffer of each column, and the buffers are appended to the
+* files when they are full, without any text conversion or SQL.
+* If the files exist, the new records are appended after the complete
+* records, and the incomplete ones (e.g. power failure) are discarded.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _COLUMNRECORDER_H_
+#define _COLUMNRECORDER_H_
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <filesystem>
+#include "common/logging/include/easylogging++.h"
+#include "datacolumn.h"
+
+namespace ASV::common {
+
+template <typename T_data>
+class column_recorder {
+  using Schema = column_schema<T_data>;
+  using Columns = decltype(Schema::columns(0));
+  static constexpr std::size_t num_columns = std::tuple_size_v<Columns>;
+
+ public:
+  // _array_size: # of elements of the vector columns, given by the first
+  //              record if 0
+  // _timestamp0: julian day where local_time = 0, used by the new files
+  // _buffer_size: # of bytes buffered per column before writing
+  explicit column_recorder(const std::string &_folder_path,
+                           const std::size_t _array_size = 0,
+                           const double _timestamp0 = julianday_now(),
+                           const std::size_t _buffer_size = 1 << 16)
+      : channel_path(_folder_path + Schema::channel + "/"),
+        logger(std::string("column-") + Schema::channel),
+        array_size(_array_size),
+        timestamp0(_timestamp0),
+        buffer_size(_buffer_size),
+        is_opened(false),
+        is_good(false),
+        num_records(0),
+        num_rejected_(0),
+        last_time(0) {
+    time_file.fd = -1;
+    for (auto &file : column_files) file.fd = -1;
+  }
+  column_recorder(const column_recorder &) = delete;
+  column_recorder &operator=(const column_recorder &) = delete;
+  ~column_recorder() { close(); }
+
+  // append one record at the current time
+  bool update_table(const T_data &update_data) {
+    return update_table(update_data,
+                        86400.0 * (julianday_now() - timestamp0));
+  }  // update_table
+
+  // append one record at local_time (s, since timestamp0). The time column
+  // is non-decreasing, so that a record earlier than the last one is
+  // rejected (false is returned, and it is counted by num_rejected).
+  bool update_table(const T_data &update_data, const double _local_time_s) {
+    if (!is_opened) open(update_data);
+    if (!is_good) return false;
+    if (!(_local_time_s >= last_time)) {
+      if (num_rejected_++ == 0)
+        CLOG(WARNING, logger.c_str())
+            << "record at " << _local_time_s
+            << " s is earlier than the last one at " << last_time
+            << " s, rejected";
+      return false;
+    }
+
+    last_time = _local_time_s;
+    append(time_file, reinterpret_cast<const char *>(&last_time));
+    std::apply(
+        [&](const auto &... _column) {
+          std::size_t i = 0;
+          (encode(_column, update_data, column_files[i++]), ...);
+        },
+        columns);
+    ++num_records;
+    return is_good;
+  }  // update_table
+
+  // write all the buffered records into the files
+  void flush() {
+    if (!is_good) return;
+    write_buffer(time_file);
+    for (auto &file : column_files) write_buffer(file);
+  }  // flush
+
+  void close() {
+    flush();
+    if (time_file.fd >= 0) ::close(time_file.fd);
+    for (auto &file : column_files)
+      if (file.fd >= 0) ::close(file.fd);
+    time_file.fd = -1;
+    for (auto &file : column_files) file.fd = -1;
+    is_good = false;
+  }  // close
+
+  // # of records in the channel, including the existing ones
+  std::size_t size() const noexcept { return num_records; }
+  // # of records rejected, as they are earlier than the last one
+  std::size_t num_rejected() const noexcept { return num_rejected_; }
+  bool good() const noexcept { return is_good; }
+  double gettimestamp0() const noexcept { return timestamp0; }
+  const std::string &getchannelpath() const noexcept { return channel_path; }
+
+ private:
+  struct column_file {
+    int fd;
+    std::size_t record_size;
+    std::vector<char> buffer;
+  };
+
+  const std::string channel_path;
+  const std::string logger;
+  std::size_t array_size;
+  double timestamp0;
+  const std::size_t buffer_size;
+  bool is_opened;
+  bool is_good;
+  std::size_t num_records;
+  std::size_t num_rejected_;
+  double last_time;
+
+  Columns columns;
+  column_file time_file;
+  std::array<column_file, num_columns> column_files;
+
+  // open (or create) the files of all columns, where the # of elements of
+  // the vector columns is given by the first record
+  void open(const T_data &_first_data) {
+    is_opened = true;
+    if (array_size == 0) array_size = Schema::array_size(_first_data);
+    columns = Schema::columns(array_size);
+
+    std::error_code ec;
+    std::filesystem::create_directories(channel_path, ec);
+    if (ec) {
+      CLOG(ERROR, logger.c_str()) << channel_path << ": " << ec.message();
+      return;
+    }
+
+    is_good = true;
+    std::size_t num_existing =
+        open_file(column_time_name, column_type::DOUBLE, 1, sizeof(double),
+                  time_file);
+    std::apply(
+        [&](const auto &... _column) {
+          std::size_t i = 0;
+          ((num_existing = std::min(
+                num_existing,
+                open_file(
+                    _column.name,
+                    column_type_of<typename std::decay_t<
+                        decltype(_column)>::element>(),
+                    _column.count, _column.record_size(),
+                    column_files[i++]))),
+           ...);
+        },
+        columns);
+    if (!is_good) return;
+
+    // discard the incomplete records, and start after the last time
+    truncate(time_file, num_existing);
+    for (auto &file : column_files) truncate(file, num_existing);
+    num_records = num_existing;
+    if ((num_existing > 0) &&
+        !read_exact(time_file, &last_time, sizeof(double),
+                    sizeof(column_header) +
+                        (num_existing - 1) * sizeof(double)))
+      is_good = false;
+  }  // open
+
+  // open one column file, and return the # of complete records in it
+  std::size_t open_file(const std::string &_name, const column_type _type,
+                        const std::size_t _count,
+                        const std::size_t _record_size, column_file &_file) {
+    _file.record_size = _record_size;
+    _file.buffer.reserve(std::max(buffer_size, _record_size) + _record_size);
+    std::string path = channel_path + _name + column_extension;
+    _file.fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_file.fd < 0) {
+      CLOG(ERROR, logger.c_str()) << path << ": " << std::strerror(errno);
+      is_good = false;
+      return 0;
+    }
+
+    column_header header{};
+    std::memcpy(header.magic, column_magic, sizeof(header.magic));
+    header.version = column_version;
+    header.type = static_cast<uint32_t>(_type);
+    header.count = static_cast<uint32_t>(_count);
+    header.record_size = static_cast<uint32_t>(_record_size);
+    header.timestamp0 = timestamp0;
+    std::strncpy(header.name, _name.c_str(), sizeof(header.name) - 1);
+
+    struct stat file_stat;
+    ::fstat(_file.fd, &file_stat);
+    std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+    if (file_size < sizeof(column_header)) {
+      // new file
+      if (::pwrite(_file.fd, &header, sizeof(header), 0) !=
+          static_cast<ssize_t>(sizeof(header))) {
+        CLOG(ERROR, logger.c_str()) << path << ": " << std::strerror(errno);
+        is_good = false;
+      }
+      return 0;
+    }
+
+    // existing file: the same column, and its timestamp0 is used
+    column_header existing;
+    if (!read_exact(_file, &existing, sizeof(existing), 0)) {
+      is_good = false;
+      return 0;
+    }
+    if (std::memcmp(existing.magic, column_magic, sizeof(column_magic)) ||
+        (existing.version != header.version) ||
+        (existing.type != header.type) || (existing.count != header.count) ||
+        (existing.record_size != header.record_size)) {
+      CLOG(ERROR, logger.c_str()) << path << ": different column format";
+      is_good = false;
+      return 0;
+    }
+    timestamp0 = existing.timestamp0;
+    return (file_size - sizeof(column_header)) / _record_size;
+  }  // open_file
+
+  // read _size bytes at _offset, where a short read is an error
+  bool read_exact(const column_file &_file, void *_data,
+                  const std::size_t _size, const std::size_t _offset) {
+    char *data = static_cast<char *>(_data);
+    std::size_t done = 0;
+    while (done < _size) {
+      ssize_t n = ::pread(_file.fd, data + done, _size - done,
+                          static_cast<off_t>(_offset + done));
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        CLOG(ERROR, logger.c_str()) << std::strerror(errno);
+        return false;
+      }
+      if (n == 0) {
+        CLOG(ERROR, logger.c_str())
+            << "short read: " << done << " of " << _size << " bytes";
+        return false;
+      }
+      done += static_cast<std::size_t>(n);
+    }
+    return true;
+  }  // read_exact
+
+  void truncate(column_file &_file, const std::size_t _num_records) {
+    if (::ftruncate(_file.fd, sizeof(column_header) +
+                                  _num_records * _file.record_size) != 0 ||
+        ::lseek(_file.fd, 0, SEEK_END) < 0) {
+      CLOG(ERROR, logger.c_str()) << std::strerror(errno);
+      is_good = false;
+    }
+  }  // truncate
+
+  template <typename T_column>
+  void encode(const T_column &_column, const T_data &_data,
+              column_file &_file) {
+    std::size_t offset = _file.buffer.size();
+    _file.buffer.resize(offset + _file.record_size);
+    _column.encode(_data, _file.buffer.data() + offset);
+    if (_file.buffer.size() >= buffer_size) write_buffer(_file);
+  }  // encode
+
+  void append(column_file &_file, const char *_record) {
+    _file.buffer.insert(_file.buffer.end(), _record,
+                        _record + _file.record_size);
+    if (_file.buffer.size() >= buffer_size) write_buffer(_file);
+  }  // append
+
+  void write_buffer(column_file &_file) {
+    const char *data = _file.buffer.data();
+    std::size_t remaining = _file.buffer.size();
+    while (remaining > 0) {
+      ssize_t n = ::write(_file.fd, data, remaining);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        CLOG(ERROR, logger.c_str()) << std::strerror(errno);
+        is_good = false;
+        break;
+      }
+      data += n;
+      remaining -= static_cast<std::size_t>(n);
+    }
+    _file.buffer.clear();
+  }  // write_buffer
+
+};  // end class column_recorder
+
+}  // namespace ASV::common
+
+#endif /* _COLUMNRECORDER_H_ */
@@ -12,11 +12,18 @@
 #define _DATABASEDATA_H_
 
 #include <common/math/eigen/Eigen/Core>
+#include <chrono>
 #include <string>
 #include <vector>
 
 namespace ASV::common {
 
+// current time in julian day, as julianday('now') of sqlite
+inline double julianday_now() {
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  return 2440587.5 + std::chrono::duration<double>(now).count() / 86400.0;
+}  // julianday_now
+
 struct gps_db_data {
   double local_time;
   double UTC;
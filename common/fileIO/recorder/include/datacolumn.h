@@ -0,0 +1,356 @@
+/*
+***********************************************************************
+* datacolumn.h:
+* binary columnar format of the logs, as an alternative to sqlite3.
+* Each channel (i.e. one table of the database) is a folder, where each
+* column is an append-only file of fixed-width records after a header
+* of 64 bytes. The time column (local_time.col) is non-decreasing (the
+* earlier records are rejected by the recorder), so that it is the time
+* index of the channel.
+* column_schema gives the columns of each struct in databasedata.h
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _DATACOLUMN_H_
+#define _DATACOLUMN_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "databasedata.h"
+
+namespace ASV::common {
+
+/********************************* format ************************************/
+enum class column_type : uint32_t { INT = 0, DOUBLE = 1, UINT8 = 2, CHAR = 3 };
+
+// header of each column file, followed by the records
+struct column_header {
+  char magic[8];         // "ASVCOL1"
+  uint32_t version;      // 1
+  uint32_t type;         // column_type of the elements
+  uint32_t count;        // # of elements per record
+  uint32_t record_size;  // # of bytes per record
+  double timestamp0;     // julian day, where local_time = 0
+  char name[32];         // name of the column
+};  // column_header
+
+static_assert(sizeof(column_header) == 64, "column header is 64 bytes");
+static_assert(sizeof(int) == 4, "INT column is 32 bits");
+
+inline constexpr char column_magic[8] = "ASVCOL1";
+inline constexpr uint32_t column_version = 1;
+inline const std::string column_time_name = "local_time";
+inline const std::string column_extension = ".col";
+
+template <typename T>
+constexpr column_type column_type_of() {
+  if constexpr (std::is_same_v<T, int>) {
+    return column_type::INT;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return column_type::DOUBLE;
+  } else if constexpr (std::is_same_v<T, uint8_t>) {
+    return column_type::UINT8;
+  } else {
+    static_assert(std::is_same_v<T, char>, "unsupported column type");
+    return column_type::CHAR;
+  }
+}  // column_type_of
+
+// the element of each member: scalar, std::vector or std::string, where
+// the vector and string are stored with a fixed # of elements
+template <typename T>
+struct column_member {
+  using element = T;
+  static constexpr bool is_array = false;
+};
+template <typename T>
+struct column_member<std::vector<T>> {
+  using element = T;
+  static constexpr bool is_array = true;
+};
+template <>
+struct column_member<std::string> {
+  using element = char;
+  static constexpr bool is_array = true;
+};
+
+// one column: the member of the struct, and the # of elements per record
+template <typename T_data, typename T_member>
+struct column_field {
+  using element = typename column_member<T_member>::element;
+  static constexpr bool is_array = column_member<T_member>::is_array;
+
+  const char *name;
+  T_member T_data::*member;
+  std::size_t count;
+
+  std::size_t record_size() const noexcept {
+    return count * sizeof(element);
+  }
+
+  // write the member into one record. The vector/string is truncated, or
+  // padded with zeros, to the # of elements
+  void encode(const T_data &_data, char *_record) const {
+    const T_member &value = _data.*member;
+    if constexpr (is_array) {
+      std::size_t n = std::min(value.size(), count);
+      std::memcpy(_record, value.data(), n * sizeof(element));
+      std::memset(_record + n * sizeof(element), 0,
+                  (count - n) * sizeof(element));
+    } else {
+      std::memcpy(_record, &value, sizeof(element));
+    }
+  }  // encode
+
+  // read the member from one record
+  void decode(const char *_record, T_data &_data) const {
+    T_member &value = _data.*member;
+    if constexpr (std::is_same_v<T_member, std::string>) {
+      value.assign(_record, strnlen(_record, count));
+    } else if constexpr (is_array) {
+      value.resize(count);
+      std::memcpy(value.data(), _record, count * sizeof(element));
+    } else {
+      std::memcpy(&value, _record, sizeof(element));
+    }
+  }  // decode
+};  // column_field
+
+template <typename T_data, typename T_member>
+constexpr column_field<T_data, T_member> make_column(
+    const char *_name, T_member T_data::*_member,
+    const std::size_t _count = 1) {
+  return column_field<T_data, T_member>{_name, _member, _count};
+}  // make_column
+
+/********************************* schema ************************************/
+// channel: the folder of the channel, relative to the log folder
+// columns(n): the columns except local_time, n is the # of elements of the
+//             vector columns
+// array_size(data): n given by one record (0 if no vector column)
+template <typename T_data>
+struct column_schema;
+
+template <>
+struct column_schema<gps_db_data> {
+  static constexpr const char *channel = "gps/GPS";
+  static auto columns(const std::size_t) {
+    using T = gps_db_data;
+    return std::make_tuple(
+        make_column("UTC", &T::UTC), make_column("latitude", &T::latitude),
+        make_column("longitude", &T::longitude),
+        make_column("heading", &T::heading), make_column("pitch", &T::pitch),
+        make_column("roll", &T::roll), make_column("altitude", &T::altitude),
+        make_column("Ve", &T::Ve), make_column("Vn", &T::Vn),
+        make_column("roti", &T::roti), make_column("status", &T::status),
+        make_column("UTM_x", &T::UTM_x), make_column("UTM_y", &T::UTM_y),
+        make_column("UTM_zone", &T::UTM_zone, 4));
+  }
+  static std::size_t array_size(const gps_db_data &) { return 0; }
+};  // column_schema<gps_db_data>
+
+template <>
+struct column_schema<imu_db_data> {
+  static constexpr const char *channel = "gps/IMU";
+  static auto columns(const std::size_t) {
+    using T = imu_db_data;
+    return std::make_tuple(
+        make_column("Acc_X", &T::Acc_X), make_column("Acc_Y", &T::Acc_Y),
+        make_column("Acc_Z", &T::Acc_Z),
+        make_column("Ang_vel_X", &T::Ang_vel_X),
+        make_column("Ang_vel_Y", &T::Ang_vel_Y),
+        make_column("Ang_vel_Z", &T::Ang_vel_Z), make_column("roll", &T::roll),
+        make_column("pitch", &T::pitch), make_column("yaw", &T::yaw));
+  }
+  static std::size_t array_size(const imu_db_data &) { return 0; }
+};  // column_schema<imu_db_data>
+
+template <>
+struct column_schema<wind_db_data> {
+  static constexpr const char *channel = "wind/wind";
+  static auto columns(const std::size_t) {
+    using T = wind_db_data;
+    return std::make_tuple(make_column("speed", &T::speed),
+                           make_column("orientation", &T::orientation));
+  }
+  static std::size_t array_size(const wind_db_data &) { return 0; }
+};  // column_schema<wind_db_data>
+
+template <>
+struct column_schema<stm32_db_data> {
+  static constexpr const char *channel = "stm32/stm32";
+  static auto columns(const std::size_t) {
+    using T = stm32_db_data;
+    return std::make_tuple(
+        make_column("stm32_link", &T::stm32_link),
+        make_column("stm32_status", &T::stm32_status),
+        make_column("command_u1", &T::command_u1),
+        make_column("command_u2", &T::command_u2),
+        make_column("feedback_u1", &T::feedback_u1),
+        make_column("feedback_u2", &T::feedback_u2),
+        make_column("feedback_pwm1", &T::feedback_pwm1),
+        make_column("feedback_pwm2", &T::feedback_pwm2),
+        make_column("RC_X", &T::RC_X), make_column("RC_Y", &T::RC_Y),
+        make_column("RC_Mz", &T::RC_Mz),
+        make_column("voltage_b1", &T::voltage_b1),
+        make_column("voltage_b2", &T::voltage_b2),
+        make_column("voltage_b3", &T::voltage_b3));
+  }
+  static std::size_t array_size(const stm32_db_data &) { return 0; }
+};  // column_schema<stm32_db_data>
+
+// n: # of bytes per spoke (SAMPLES_PER_SPOKE / 2)
+template <>
+struct column_schema<marineradar_db_data> {
+  static constexpr const char *channel = "marineradar/radar";
+  static auto columns(const std::size_t _array_size) {
+    using T = marineradar_db_data;
+    return std::make_tuple(
+        make_column("azimuth_deg", &T::azimuth_deg),
+        make_column("sample_range", &T::sample_range),
+        make_column("SpokeData", &T::spokedata, _array_size));
+  }
+  static std::size_t array_size(const marineradar_db_data &_data) {
+    return _data.spokedata.size();
+  }
+};  // column_schema<marineradar_db_data>
+
+template <>
+struct column_schema<est_measurement_db_data> {
+  static constexpr const char *channel = "estimator/measurement";
+  static auto columns(const std::size_t) {
+    using T = est_measurement_db_data;
+    return std::make_tuple(
+        make_column("meas_x", &T::meas_x), make_column("meas_y", &T::meas_y),
+        make_column("meas_theta", &T::meas_theta),
+        make_column("meas_u", &T::meas_u), make_column("meas_v", &T::meas_v),
+        make_column("meas_r", &T::meas_r));
+  }
+  static std::size_t array_size(const est_measurement_db_data &) {
+    return 0;
+  }
+};  // column_schema<est_measurement_db_data>
+
+template <>
+struct column_schema<est_state_db_data> {
+  static constexpr const char *channel = "estimator/state";
+  static auto columns(const std::size_t) {
+    using T = est_state_db_data;
+    return std::make_tuple(
+        make_column("state_x", &T::state_x),
+        make_column("state_y", &T::state_y),
+        make_column("state_theta", &T::state_theta),
+        make_column("state_u", &T::state_u),
+        make_column("state_v", &T::state_v),
+        make_column("state_r", &T::state_r),
+        make_column("curvature", &T::curvature),
+        make_column("speed", &T::speed), make_column("dspeed", &T::dspeed));
+  }
+  static std::size_t array_size(const est_state_db_data &) { return 0; }
+};  // column_schema<est_state_db_data>
+
+template <>
+struct column_schema<est_error_db_data> {
+  static constexpr const char *channel = "estimator/error";
+  static auto columns(const std::size_t) {
+    using T = est_error_db_data;
+    return std::make_tuple(
+        make_column("perror_x", &T::perror_x),
+        make_column("perror_y", &T::perror_y),
+        make_column("perror_mz", &T::perror_mz),
+        make_column("verror_x", &T::verror_x),
+        make_column("verror_y", &T::verror_y),
+        make_column("verror_mz", &T::verror_mz));
+  }
+  static std::size_t array_size(const est_error_db_data &) { return 0; }
+};  // column_schema<est_error_db_data>
+
+template <>
+struct column_schema<plan_lattice_db_data> {
+  static constexpr const char *channel = "planner/latticeplanner";
+  static auto columns(const std::size_t) {
+    using T = plan_lattice_db_data;
+    return std::make_tuple(
+        make_column("lattice_x", &T::lattice_x),
+        make_column("lattice_y", &T::lattice_y),
+        make_column("lattice_theta", &T::lattice_theta),
+        make_column("lattice_kappa", &T::lattice_kappa),
+        make_column("lattice_speed", &T::lattice_speed),
+        make_column("lattice_dspeed", &T::lattice_dspeed));
+  }
+  static std::size_t array_size(const plan_lattice_db_data &) { return 0; }
+};  // column_schema<plan_lattice_db_data>
+
+template <>
+struct column_schema<control_setpoint_db_data> {
+  static constexpr const char *channel = "controller/setpoint";
+  static auto columns(const std::size_t) {
+    using T = control_setpoint_db_data;
+    return std::make_tuple(
+        make_column("set_x", &T::set_x), make_column("set_y", &T::set_y),
+        make_column("set_theta", &T::set_theta),
+        make_column("set_u", &T::set_u), make_column("set_v", &T::set_v),
+        make_column("set_r", &T::set_r));
+  }
+  static std::size_t array_size(const control_setpoint_db_data &) {
+    return 0;
+  }
+};  // column_schema<control_setpoint_db_data>
+
+// n: # of thrusters
+template <>
+struct column_schema<control_TA_db_data> {
+  static constexpr const char *channel = "controller/TA";
+  static auto columns(const std::size_t _array_size) {
+    using T = control_TA_db_data;
+    return std::make_tuple(
+        make_column("desired_Fx", &T::desired_Fx),
+        make_column("desired_Fy", &T::desired_Fy),
+        make_column("desired_Mz", &T::desired_Mz),
+        make_column("est_Fx", &T::est_Fx), make_column("est_Fy", &T::est_Fy),
+        make_column("est_Mz", &T::est_Mz),
+        make_column("Azimuth", &T::alpha, _array_size),
+        make_column("Rotation", &T::rpm, _array_size));
+  }
+  static std::size_t array_size(const control_TA_db_data &_data) {
+    return _data.alpha.size();
+  }
+};  // column_schema<control_TA_db_data>
+
+// n: max # of tracked targets
+template <>
+struct column_schema<perception_trackingtarget_db_data> {
+  static constexpr const char *channel = "perception/TrackingTarget";
+  static auto columns(const std::size_t _array_size) {
+    using T = perception_trackingtarget_db_data;
+    return std::make_tuple(
+        make_column("spoke_state", &T::spoke_state),
+        make_column("targets_state", &T::targets_state, _array_size),
+        make_column("targets_intention", &T::targets_intention, _array_size),
+        make_column("targets_x", &T::targets_x, _array_size),
+        make_column("targets_y", &T::targets_y, _array_size),
+        make_column("targets_square_radius", &T::targets_square_radius,
+                    _array_size),
+        make_column("targets_vx", &T::targets_vx, _array_size),
+        make_column("targets_vy", &T::targets_vy, _array_size),
+        make_column("targets_CPA_x", &T::targets_CPA_x, _array_size),
+        make_column("targets_CPA_y", &T::targets_CPA_y, _array_size),
+        make_column("targets_TCPA", &T::targets_TCPA, _array_size));
+  }
+  static std::size_t array_size(
+      const perception_trackingtarget_db_data &_data) {
+    return _data.targets_state.size();
+  }
+};  // column_schema<perception_trackingtarget_db_data>
+
+}  // namespace ASV::common
+
+#endif /* _DATACOLUMN_H_ */
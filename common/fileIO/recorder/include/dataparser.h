@@ -2,6 +2,12 @@
 ***********************************************************************
 * dataparser.h:
 * parse data from sqlite3
+* Each table is read by one query over the time range, using the index of
+* DATETIME, and the rows are passed to a visitor in chunks (or returned
+* in a vector)
+* column_parser reads the binary columnar format (datacolumn.h) by mmap:
+* the columns are read in place, and the time range is found by binary
+* search of the time column
 * This header file can be read by C++ compilers
 *
 * by Hu.ZH(CrossOcean.ai)
@@ -11,16 +17,73 @@
 #ifndef _DATAPARSER_H_
 #define _DATAPARSER_H_
 
+#include <fcntl.h>
 #include <sqlite_modern_cpp.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/fileIO/include/json.hpp"
 #include "databasedata.h"
+#include "datacolumn.h"
 
 namespace ASV::common {
 
+// the rows of one table, passed to the visitor in chunks
+template <typename T_data, typename Visitor>
+class chunk_visitor {
+ public:
+  chunk_visitor(Visitor &_visitor, const std::size_t _chunk_size)
+      : visitor(_visitor),
+        chunk_size(std::max<std::size_t>(_chunk_size, 1)),
+        num_rows(0) {
+    chunk.reserve(chunk_size);
+  }
+
+  void push_back(T_data &&_data) {
+    chunk.push_back(std::move(_data));
+    if (chunk.size() == chunk_size) pass_chunk();
+  }  // push_back
+
+  // pass the remaining rows, and return the # of rows
+  std::size_t finish() {
+    pass_chunk();
+    return num_rows;
+  }  // finish
+
+ private:
+  Visitor &visitor;
+  const std::size_t chunk_size;
+  std::size_t num_rows;
+  std::vector<T_data> chunk;
+
+  void pass_chunk() {
+    if (chunk.empty()) return;
+    num_rows += chunk.size();
+    visitor(chunk);
+    chunk.clear();
+  }  // pass_chunk
+};  // end class chunk_visitor
+
+// visitor which moves the rows of each chunk into the vector
+template <typename T_data>
+auto append_to(std::vector<T_data> &_rows) {
+  return [&_rows](std::vector<T_data> &_chunk) {
+    std::move(_chunk.begin(), _chunk.end(), std::back_inserter(_rows));
+  };
+}  // append_to
+
 class master_parser {
  public:
   explicit master_parser(const std::string &_DB_folder_path) : timestamp0(0) {
@@ -38,6 +101,66 @@ class master_parser {
     return 86400.0 * Julianday;
   }  // convertJulianday2Second
 
+  // select DATETIME and the columns (given by the config file) of the rows
+  // between start_time and end_time (s), in the order of DATETIME. The
+  // query of each table is built once, and the index of DATETIME is created
+  // if it does not exist.
+  sqlite::database_binder select_range(sqlite::database &_db,
+                                       const std::string &_config_name,
+                                       const std::string &_config_pointer,
+                                       const std::string &_table,
+                                       const double start_time,
+                                       const double end_time) {
+    auto query = range_queries.find(_table);
+    if (query == range_queries.end())
+      query = range_queries
+                  .emplace(_table, prepare_range_query(_db, _config_name,
+                                                       _config_pointer, _table))
+                  .first;
+    // DATETIME is TEXT with 15 significant digits, so that the range is
+    // a little wider, and the rows are checked in seconds by the caller.
+    // The bounds are clamped to keep the fixed notation of julian day.
+    double start_s = std::clamp(start_time, -max_range_s, max_range_s);
+    double end_s = std::clamp(end_time, -max_range_s, max_range_s);
+    return _db << query->second
+               << timestamp0 + start_s / 86400.0 - range_margin_day
+               << timestamp0 + end_s / 86400.0 + range_margin_day;
+  }  // select_range
+
+ private:
+  static constexpr double range_margin_day = 1e-7;
+  static constexpr double max_range_s = 1e9;
+
+  nlohmann::json config_file;
+  std::unordered_map<std::string, std::string> range_queries;
+
+  std::string prepare_range_query(sqlite::database &_db,
+                                  const std::string &_config_name,
+                                  const std::string &_config_pointer,
+                                  const std::string &_table) {
+    // the config file is parsed only once
+    if (config_file.is_null()) {
+      std::ifstream in(_config_name);
+      in >> config_file;
+    }
+    auto db_config =
+        config_file[nlohmann::json::json_pointer(_config_pointer)]
+            .get<std::vector<std::pair<std::string, std::string>>>();
+
+    try {
+      _db << "CREATE INDEX IF NOT EXISTS " + _table + "_DATETIME ON " +
+                 _table + "(DATETIME);";
+    } catch (sqlite::sqlite_exception &) {
+      // read-only database: the table is scanned
+    }
+
+    std::string parse_string = "select DATETIME";
+    for (auto const &value : db_config) parse_string += ", " + value.first;
+    parse_string += " from " + _table +
+                    " where DATETIME between ? and ? order by DATETIME, ID;";
+    return parse_string;
+  }  // prepare_range_query
+
 };  // end class master_parser
 
 class GPS_parser : public master_parser {
@@ -52,100 +175,88 @@ class GPS_parser : public master_parser {
 
   std::vector<gps_db_data> parse_gps_table(const double start_time,
                                            const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["navigation_sensor"]["GPS"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from GPS where ID= ?;";
-
-    //
     std::vector<gps_db_data> v_gps_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from GPS;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double UTC, double latitude,
-              double longitude, double heading, double pitch, double roll,
-              double altitude, double Ve, double Vn, double roti, int status,
-              double UTM_x, double UTM_y, std::string UTM_zone) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_gps_db_data.push_back(gps_db_data{
-                  _local_time_s,  // local_time
-                  UTC,            // UTC
-                  latitude,       // latitude
-                  longitude,      // longitude
-                  heading,        // heading
-                  pitch,          // pitch
-                  roll,           // roll
-                  altitude,       // altitude
-                  Ve,             // Ve
-                  Vn,             // Vn
-                  roti,           // roti
-                  status,         // status
-                  UTM_x,          // UTM_x
-                  UTM_y,          // UTM_y
-                  UTM_zone        // UTM_zone
-              });
-            }
-          };
-    }
+    parse_gps_table(start_time, end_time, append_to(v_gps_db_data));
     return v_gps_db_data;
   }  // parse_gps_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_gps_table(const double start_time, const double end_time,
+                              Visitor &&_visitor,
+                              const std::size_t _chunk_size = 1024) {
+    chunk_visitor<gps_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/navigation_sensor/GPS", "GPS", start_time,
+                 end_time) >>
+        [&](std::string local_time, double UTC, double latitude,
+            double longitude, double heading, double pitch, double roll,
+            double altitude, double Ve, double Vn, double roti, int status,
+            double UTM_x, double UTM_y, std::string UTM_zone) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(gps_db_data{
+                _local_time_s,  // local_time
+                UTC,            // UTC
+                latitude,       // latitude
+                longitude,      // longitude
+                heading,        // heading
+                pitch,          // pitch
+                roll,           // roll
+                altitude,       // altitude
+                Ve,             // Ve
+                Vn,             // Vn
+                roti,           // roti
+                status,         // status
+                UTM_x,          // UTM_x
+                UTM_y,          // UTM_y
+                UTM_zone        // UTM_zone
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_gps_table
+
   std::vector<imu_db_data> parse_imu_table(const double start_time,
                                            const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["navigation_sensor"]["IMU"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from IMU where ID= ?;";
-
-    //
     std::vector<imu_db_data> v_imu_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from IMU;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double Acc_X, double Acc_Y, double Acc_Z,
-              double Ang_vel_X, double Ang_vel_Y, double Ang_vel_Z, double roll,
-              double pitch, double yaw) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_imu_db_data.push_back(imu_db_data{
-                  _local_time_s,  // local_time
-                  Acc_X,          // Acc_X
-                  Acc_Y,          // Acc_Y
-                  Acc_Z,          // Acc_Z
-                  Ang_vel_X,      // Ang_vel_X
-                  Ang_vel_Y,      // Ang_vel_Y
-                  Ang_vel_Z,      // Ang_vel_Z
-                  roll,           // roll
-                  pitch,          // pitch
-                  yaw             // yaw
-              });
-            }
-          };
-    }
+    parse_imu_table(start_time, end_time, append_to(v_imu_db_data));
     return v_imu_db_data;
   }  // parse_imu_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_imu_table(const double start_time, const double end_time,
+                              Visitor &&_visitor,
+                              const std::size_t _chunk_size = 1024) {
+    chunk_visitor<imu_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/navigation_sensor/IMU", "IMU", start_time,
+                 end_time) >>
+        [&](std::string local_time, double Acc_X, double Acc_Y, double Acc_Z,
+            double Ang_vel_X, double Ang_vel_Y, double Ang_vel_Z, double roll,
+            double pitch, double yaw) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(imu_db_data{
+                _local_time_s,  // local_time
+                Acc_X,          // Acc_X
+                Acc_Y,          // Acc_Y
+                Acc_Z,          // Acc_Z
+                Ang_vel_X,      // Ang_vel_X
+                Ang_vel_Y,      // Ang_vel_Y
+                Ang_vel_Z,      // Ang_vel_Z
+                roll,           // roll
+                pitch,          // pitch
+                yaw             // yaw
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_imu_table
+
  private:
   std::string config_name;
 
@@ -165,39 +276,33 @@ class wind_parser : public master_parser {
 
   std::vector<wind_db_data> parse_table(const double start_time,
                                         const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["wind"].get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from wind where ID= ?;";
-
-    //
     std::vector<wind_db_data> v_wind_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from wind;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double speed, double orientation) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_wind_db_data.push_back(wind_db_data{
-                  _local_time_s,  // local_time
-                  speed,          // speed
-                  orientation     // orientation
-              });
-            }
-          };
-    }
+    parse_table(start_time, end_time, append_to(v_wind_db_data));
     return v_wind_db_data;
   }  // parse_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_table(const double start_time, const double end_time,
+                          Visitor &&_visitor,
+                          const std::size_t _chunk_size = 1024) {
+    chunk_visitor<wind_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/wind", "wind", start_time, end_time) >>
+        [&](std::string local_time, double speed, double orientation) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(wind_db_data{
+                _local_time_s,  // local_time
+                speed,          // speed
+                orientation     // orientation
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_table
+
  private:
   std::string config_name;
   sqlite::database db;
@@ -216,55 +321,49 @@ class stm32_parser : public master_parser {
 
   std::vector<stm32_db_data> parse_table(const double start_time,
                                          const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["stm32"].get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from stm32 where ID= ?;";
-
-    //
     std::vector<stm32_db_data> v_stm32_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from stm32;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, int stm32_link, int stm32_status,
-              double command_u1, double command_u2, double feedback_u1,
-              double feedback_u2, int feedback_pwm1, int feedback_pwm2,
-              double RC_X, double RC_Y, double RC_Mz, double voltage_b1,
-              double voltage_b2, double voltage_b3) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_stm32_db_data.push_back(stm32_db_data{
-                  _local_time_s,  // local_time
-                  stm32_link,     // stm32_link
-                  stm32_status,   // stm32_status
-                  command_u1,     // command_u1
-                  command_u2,     // command_u2
-                  feedback_u1,    // feedback_u1
-                  feedback_u2,    // feedback_u2
-                  feedback_pwm1,  // feedback_pwm1
-                  feedback_pwm2,  // feedback_pwm2
-                  RC_X,           // RC_X
-                  RC_Y,           // RC_Y
-                  RC_Mz,          // RC_Mz
-                  voltage_b1,     // voltage_b1
-                  voltage_b2,     // voltage_b2
-                  voltage_b3      // voltage_b3
-              });
-            }
-          };
-    }
+    parse_table(start_time, end_time, append_to(v_stm32_db_data));
     return v_stm32_db_data;
   }  // parse_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_table(const double start_time, const double end_time,
+                          Visitor &&_visitor,
+                          const std::size_t _chunk_size = 1024) {
+    chunk_visitor<stm32_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/stm32", "stm32", start_time, end_time) >>
+        [&](std::string local_time, int stm32_link, int stm32_status,
+            double command_u1, double command_u2, double feedback_u1,
+            double feedback_u2, int feedback_pwm1, int feedback_pwm2,
+            double RC_X, double RC_Y, double RC_Mz, double voltage_b1,
+            double voltage_b2, double voltage_b3) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(stm32_db_data{
+                _local_time_s,  // local_time
+                stm32_link,     // stm32_link
+                stm32_status,   // stm32_status
+                command_u1,     // command_u1
+                command_u2,     // command_u2
+                feedback_u1,    // feedback_u1
+                feedback_u2,    // feedback_u2
+                feedback_pwm1,  // feedback_pwm1
+                feedback_pwm2,  // feedback_pwm2
+                RC_X,           // RC_X
+                RC_Y,           // RC_Y
+                RC_Mz,          // RC_Mz
+                voltage_b1,     // voltage_b1
+                voltage_b2,     // voltage_b2
+                voltage_b3      // voltage_b3
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_table
+
  private:
   std::string config_name;
   sqlite::database db;
@@ -283,42 +382,36 @@ class marineradar_parser : public master_parser {
 
   std::vector<marineradar_db_data> parse_table(const double start_time,
                                                const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["marineradar"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from radar where ID= ?;";
-
-    //
     std::vector<marineradar_db_data> v_marineradar_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from radar;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double azimuth_deg, double sample_range,
-              std::vector<uint8_t> spokedata) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_marineradar_db_data.push_back(marineradar_db_data{
-                  _local_time_s,  // local_time
-                  azimuth_deg,    // azimuth_deg
-                  sample_range,   // sample_range
-                  spokedata       // spokedata
-              });
-            }
-          };
-    }
+    parse_table(start_time, end_time, append_to(v_marineradar_db_data));
     return v_marineradar_db_data;
   }  // parse_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_table(const double start_time, const double end_time,
+                          Visitor &&_visitor,
+                          const std::size_t _chunk_size = 1024) {
+    chunk_visitor<marineradar_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/marineradar", "radar", start_time,
+                 end_time) >>
+        [&](std::string local_time, double azimuth_deg, double sample_range,
+            std::vector<uint8_t> spokedata) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(marineradar_db_data{
+                _local_time_s,  // local_time
+                azimuth_deg,    // azimuth_deg
+                sample_range,   // sample_range
+                spokedata       // spokedata
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_table
+
  private:
   std::string config_name;
   sqlite::database db;
@@ -337,132 +430,116 @@ class estimator_parser : public master_parser {
 
   std::vector<est_measurement_db_data> parse_measurement_table(
       const double start_time, const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["estimator"]["measurement"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from measurement where ID= ?;";
-
-    //
     std::vector<est_measurement_db_data> v_est_measurement_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from measurement;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double meas_x, double meas_y,
-              double meas_theta, double meas_u, double meas_v, double meas_r) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_est_measurement_db_data.push_back(est_measurement_db_data{
-                  _local_time_s,  // local_time
-                  meas_x,         // meas_x
-                  meas_y,         // meas_y
-                  meas_theta,     // meas_theta
-                  meas_u,         // meas_u
-                  meas_v,         // meas_v
-                  meas_r          // meas_r
-              });
-            }
-          };
-    }
+    parse_measurement_table(start_time, end_time,
+                            append_to(v_est_measurement_db_data));
     return v_est_measurement_db_data;
   }  // parse_measurement_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_measurement_table(const double start_time,
+                                      const double end_time, Visitor &&_visitor,
+                                      const std::size_t _chunk_size = 1024) {
+    chunk_visitor<est_measurement_db_data, Visitor> chunk(_visitor,
+                                                          _chunk_size);
+    select_range(db, config_name, "/estimator/measurement", "measurement",
+                 start_time, end_time) >>
+        [&](std::string local_time, double meas_x, double meas_y,
+            double meas_theta, double meas_u, double meas_v, double meas_r) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(est_measurement_db_data{
+                _local_time_s,  // local_time
+                meas_x,         // meas_x
+                meas_y,         // meas_y
+                meas_theta,     // meas_theta
+                meas_u,         // meas_u
+                meas_v,         // meas_v
+                meas_r          // meas_r
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_measurement_table
+
   std::vector<est_state_db_data> parse_state_table(const double start_time,
                                                    const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["estimator"]["state"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from state where ID= ?;";
-
-    //
     std::vector<est_state_db_data> v_est_state_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from state;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double state_x, double state_y,
-              double state_theta, double state_u, double state_v,
-              double state_r, double curvature, double speed, double dspeed) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_est_state_db_data.push_back(est_state_db_data{
-                  _local_time_s,  // local_time
-                  state_x,        // state_x
-                  state_y,        // state_y
-                  state_theta,    // state_theta
-                  state_u,        // state_u
-                  state_v,        // state_v
-                  state_r,        // state_r
-                  curvature,      // curvature
-                  speed,          // speed
-                  dspeed          // dspeed
-              });
-            }
-          };
-    }
+    parse_state_table(start_time, end_time, append_to(v_est_state_db_data));
     return v_est_state_db_data;
   }  // parse_state_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_state_table(const double start_time, const double end_time,
+                                Visitor &&_visitor,
+                                const std::size_t _chunk_size = 1024) {
+    chunk_visitor<est_state_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/estimator/state", "state", start_time,
+                 end_time) >>
+        [&](std::string local_time, double state_x, double state_y,
+            double state_theta, double state_u, double state_v,
+            double state_r, double curvature, double speed, double dspeed) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(est_state_db_data{
+                _local_time_s,  // local_time
+                state_x,        // state_x
+                state_y,        // state_y
+                state_theta,    // state_theta
+                state_u,        // state_u
+                state_v,        // state_v
+                state_r,        // state_r
+                curvature,      // curvature
+                speed,          // speed
+                dspeed          // dspeed
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_state_table
+
   std::vector<est_error_db_data> parse_error_table(const double start_time,
                                                    const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["estimator"]["error"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from error where ID= ?;";
-
-    //
     std::vector<est_error_db_data> v_est_error_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from error;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >> [&](std::string local_time,
-                                         double perror_x, double perror_y,
-                                         double perror_mz, double verror_x,
-                                         double verror_y, double verror_mz) {
-        double _local_time_s = master_parser::convertJulianday2Second(
-            atof(local_time.c_str()) - master_parser::timestamp0);
-        if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-          v_est_error_db_data.push_back(est_error_db_data{
-              _local_time_s,  // local_time
-              perror_x,       // perror_x
-              perror_y,       // perror_y
-              perror_mz,      // perror_mz
-              verror_x,       // verror_x
-              verror_y,       // verror_y
-              verror_mz       // verror_mz
-          });
-        }
-      };
-    }
+    parse_error_table(start_time, end_time, append_to(v_est_error_db_data));
     return v_est_error_db_data;
   }  // parse_error_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_error_table(const double start_time, const double end_time,
+                                Visitor &&_visitor,
+                                const std::size_t _chunk_size = 1024) {
+    chunk_visitor<est_error_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/estimator/error", "error", start_time,
+                 end_time) >>
+        [&](std::string local_time, double perror_x, double perror_y,
+            double perror_mz, double verror_x, double verror_y,
+            double verror_mz) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(est_error_db_data{
+                _local_time_s,  // local_time
+                perror_x,       // perror_x
+                perror_y,       // perror_y
+                perror_mz,      // perror_mz
+                verror_x,       // verror_x
+                verror_y,       // verror_y
+                verror_mz       // verror_mz
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_error_table
+
  private:
   std::string config_name;
   sqlite::database db;
@@ -481,97 +558,86 @@ class planner_parser : public master_parser {
 
   std::vector<plan_route_db_data> parse_route_table(const double start_time,
                                                     const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["planner"]["routeplanner"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from routeplanner where ID= ?;";
-
-    //
     std::vector<plan_route_db_data> v_plan_route_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from routeplanner;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double setpoints_X, double setpoints_Y,
-              double setpoints_heading, double setpoints_longitude,
-              double setpoints_latitude, double speed, double captureradius,
-              std::string utm_zone, std::vector<double> WPX,
-              std::vector<double> WPY, std::vector<double> WPLONG,
-              std::vector<double> WPLAT) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_plan_route_db_data.push_back(plan_route_db_data{
-                  _local_time_s,        // local_time
-                  setpoints_X,          // setpoints_X
-                  setpoints_Y,          // setpoints_Y
-                  setpoints_heading,    // setpoints_heading
-                  setpoints_longitude,  // setpoints_longitude
-                  setpoints_latitude,   // setpoints_latitude
-                  speed,                // speed
-                  captureradius,        // captureradius
-                  utm_zone,             // utm_zone
-                  WPX,                  // WPX
-                  WPY,                  // WPY
-                  WPLONG,               // WPLONG
-                  WPLAT                 // WPLAT
-              });
-            }
-          };
-    }
+    parse_route_table(start_time, end_time, append_to(v_plan_route_db_data));
     return v_plan_route_db_data;
   }  // parse_route_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_route_table(const double start_time, const double end_time,
+                                Visitor &&_visitor,
+                                const std::size_t _chunk_size = 1024) {
+    chunk_visitor<plan_route_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/planner/routeplanner", "routeplanner",
+                 start_time, end_time) >>
+        [&](std::string local_time, double setpoints_X, double setpoints_Y,
+            double setpoints_heading, double setpoints_longitude,
+            double setpoints_latitude, double speed, double captureradius,
+            std::string utm_zone, std::vector<double> WPX,
+            std::vector<double> WPY, std::vector<double> WPLONG,
+            std::vector<double> WPLAT) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(plan_route_db_data{
+                _local_time_s,        // local_time
+                setpoints_X,          // setpoints_X
+                setpoints_Y,          // setpoints_Y
+                setpoints_heading,    // setpoints_heading
+                setpoints_longitude,  // setpoints_longitude
+                setpoints_latitude,   // setpoints_latitude
+                speed,                // speed
+                captureradius,        // captureradius
+                utm_zone,             // utm_zone
+                WPX,                  // WPX
+                WPY,                  // WPY
+                WPLONG,               // WPLONG
+                WPLAT                 // WPLAT
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_route_table
+
   std::vector<plan_lattice_db_data> parse_lattice_table(const double start_time,
                                                         const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["planner"]["latticeplanner"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from latticeplanner where ID= ?;";
-
-    //
     std::vector<plan_lattice_db_data> v_plan_lattice_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from latticeplanner;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double lattice_x, double lattice_y,
-              double lattice_theta, double lattice_kappa, double lattice_speed,
-              double lattice_dspeed) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_plan_lattice_db_data.push_back(plan_lattice_db_data{
-                  _local_time_s,  // local_time
-                  lattice_x,      // lattice_x
-                  lattice_y,      // lattice_y
-                  lattice_theta,  // lattice_theta
-                  lattice_kappa,  // lattice_kappa
-                  lattice_speed,  // lattice_speed
-                  lattice_dspeed  // lattice_dspeed
-              });
-            }
-          };
-    }
+    parse_lattice_table(start_time, end_time,
+                        append_to(v_plan_lattice_db_data));
     return v_plan_lattice_db_data;
   }  // parse_lattice_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_lattice_table(const double start_time,
+                                  const double end_time, Visitor &&_visitor,
+                                  const std::size_t _chunk_size = 1024) {
+    chunk_visitor<plan_lattice_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/planner/latticeplanner", "latticeplanner",
+                 start_time, end_time) >>
+        [&](std::string local_time, double lattice_x, double lattice_y,
+            double lattice_theta, double lattice_kappa, double lattice_speed,
+            double lattice_dspeed) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(plan_lattice_db_data{
+                _local_time_s,  // local_time
+                lattice_x,      // lattice_x
+                lattice_y,      // lattice_y
+                lattice_theta,  // lattice_theta
+                lattice_kappa,  // lattice_kappa
+                lattice_speed,  // lattice_speed
+                lattice_dspeed  // lattice_dspeed
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_lattice_table
+
  private:
   std::string config_name;
   sqlite::database db;
@@ -590,89 +656,79 @@ class control_parser : public master_parser {
 
   std::vector<control_setpoint_db_data> parse_setpoint_table(
       const double start_time, const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["controller"]["setpoint"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from setpoint where ID= ?;";
-
-    //
     std::vector<control_setpoint_db_data> v_control_setpoint_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from setpoint;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double set_x, double set_y,
-              double set_theta, double set_u, double set_v, double set_r) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_control_setpoint_db_data.push_back(control_setpoint_db_data{
-                  _local_time_s,  // local_time
-                  set_x,          // set_x
-                  set_y,          // set_y
-                  set_theta,      // set_theta
-                  set_u,          // set_u
-                  set_v,          // set_v
-                  set_r           // set_r
-              });
-            }
-          };
-    }
+    parse_setpoint_table(start_time, end_time,
+                         append_to(v_control_setpoint_db_data));
     return v_control_setpoint_db_data;
   }  // parse_setpoint_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_setpoint_table(const double start_time,
+                                   const double end_time, Visitor &&_visitor,
+                                   const std::size_t _chunk_size = 1024) {
+    chunk_visitor<control_setpoint_db_data, Visitor> chunk(_visitor,
+                                                           _chunk_size);
+    select_range(db, config_name, "/controller/setpoint", "setpoint",
+                 start_time, end_time) >>
+        [&](std::string local_time, double set_x, double set_y,
+            double set_theta, double set_u, double set_v, double set_r) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(control_setpoint_db_data{
+                _local_time_s,  // local_time
+                set_x,          // set_x
+                set_y,          // set_y
+                set_theta,      // set_theta
+                set_u,          // set_u
+                set_v,          // set_v
+                set_r           // set_r
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_setpoint_table
+
   std::vector<control_TA_db_data> parse_TA_table(const double start_time,
                                                  const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["controller"]["TA"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from TA where ID= ?;";
-
-    //
     std::vector<control_TA_db_data> v_control_TA_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from TA;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, double desired_Fx, double desired_Fy,
-              double desired_Mz, double est_Fx, double est_Fy, double est_Mz,
-              std::vector<int> alpha, std::vector<int> rpm) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_control_TA_db_data.push_back(control_TA_db_data{
-                  _local_time_s,  // local_time
-                  desired_Fx,     // desired_Fx
-                  desired_Fy,     // desired_Fy
-                  desired_Mz,     // desired_Mz
-                  est_Fx,         // est_Fx
-                  est_Fy,         // est_Fy
-                  est_Mz,         // est_Mz
-                  alpha,          // alpha
-                  rpm             // rpm
-              });
-            }
-          };
-    }
+    parse_TA_table(start_time, end_time, append_to(v_control_TA_db_data));
     return v_control_TA_db_data;
   }  // parse_TA_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_TA_table(const double start_time, const double end_time,
+                             Visitor &&_visitor,
+                             const std::size_t _chunk_size = 1024) {
+    chunk_visitor<control_TA_db_data, Visitor> chunk(_visitor, _chunk_size);
+    select_range(db, config_name, "/controller/TA", "TA", start_time,
+                 end_time) >>
+        [&](std::string local_time, double desired_Fx, double desired_Fy,
+            double desired_Mz, double est_Fx, double est_Fy, double est_Mz,
+            std::vector<int> alpha, std::vector<int> rpm) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(control_TA_db_data{
+                _local_time_s,  // local_time
+                desired_Fx,     // desired_Fx
+                desired_Fy,     // desired_Fy
+                desired_Mz,     // desired_Mz
+                est_Fx,         // est_Fx
+                est_Fy,         // est_Fy
+                est_Mz,         // est_Mz
+                alpha,          // alpha
+                rpm             // rpm
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_TA_table
+
  private:
   std::string config_name;
   sqlite::database db;
@@ -691,146 +747,332 @@ class perception_parser : public master_parser {
 
   std::vector<perception_spoke_db_data> parse_spoke_table(
       const double start_time, const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["perception"]["SpokeProcess"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from SpokeProcess where ID= ?;";
-
-    //
     std::vector<perception_spoke_db_data> v_perception_spoke_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from SpokeProcess;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time,
-              std::vector<double> surroundings_bearing_rad,
-              std::vector<double> surroundings_range_m,
-              std::vector<double> surroundings_x_m,
-              std::vector<double> surroundings_y_m) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_perception_spoke_db_data.push_back(perception_spoke_db_data{
-                  _local_time_s,             // local_time
-                  surroundings_bearing_rad,  // surroundings_bearing_rad
-                  surroundings_range_m,      // surroundings_range_m
-                  surroundings_x_m,          // surroundings_x_m
-                  surroundings_y_m           // surroundings_y_m
-              });
-            }
-          };
-    }
+    parse_spoke_table(start_time, end_time,
+                      append_to(v_perception_spoke_db_data));
     return v_perception_spoke_db_data;
   }  // parse_spoke_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_spoke_table(const double start_time, const double end_time,
+                                Visitor &&_visitor,
+                                const std::size_t _chunk_size = 1024) {
+    chunk_visitor<perception_spoke_db_data, Visitor> chunk(_visitor,
+                                                           _chunk_size);
+    select_range(db, config_name, "/perception/SpokeProcess", "SpokeProcess",
+                 start_time, end_time) >>
+        [&](std::string local_time,
+            std::vector<double> surroundings_bearing_rad,
+            std::vector<double> surroundings_range_m,
+            std::vector<double> surroundings_x_m,
+            std::vector<double> surroundings_y_m) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(perception_spoke_db_data{
+                _local_time_s,             // local_time
+                surroundings_bearing_rad,  // surroundings_bearing_rad
+                surroundings_range_m,      // surroundings_range_m
+                surroundings_x_m,          // surroundings_x_m
+                surroundings_y_m           // surroundings_y_m
+            });
+          }
+        };
+    return chunk.finish();
+  }  // parse_spoke_table
+
   std::vector<perception_detection_db_data> parse_detection_table(
       const double start_time, const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["perception"]["DetectedTarget"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from DetectedTarget where ID= ?;";
-
-    //
     std::vector<perception_detection_db_data> v_perception_detection_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from DetectedTarget;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, std::vector<double> detected_target_x,
-              std::vector<double> detected_target_y,
-              std::vector<double> detected_target_radius) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_perception_detection_db_data.push_back(
-                  perception_detection_db_data{
-                      _local_time_s,          // local_time
-                      detected_target_x,      // detected_target_x
-                      detected_target_y,      // detected_target_y
-                      detected_target_radius  // detected_target_radius
-                  });
-            }
-          };
-    }
+    parse_detection_table(start_time, end_time,
+                          append_to(v_perception_detection_db_data));
     return v_perception_detection_db_data;
   }  // parse_detection_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_detection_table(const double start_time,
+                                    const double end_time, Visitor &&_visitor,
+                                    const std::size_t _chunk_size = 1024) {
+    chunk_visitor<perception_detection_db_data, Visitor> chunk(_visitor,
+                                                               _chunk_size);
+    select_range(db, config_name, "/perception/DetectedTarget",
+                 "DetectedTarget", start_time, end_time) >>
+        [&](std::string local_time, std::vector<double> detected_target_x,
+            std::vector<double> detected_target_y,
+            std::vector<double> detected_target_radius) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(
+                perception_detection_db_data{
+                    _local_time_s,          // local_time
+                    detected_target_x,      // detected_target_x
+                    detected_target_y,      // detected_target_y
+                    detected_target_radius  // detected_target_radius
+                });
+          }
+        };
+    return chunk.finish();
+  }  // parse_detection_table
+
   std::vector<perception_trackingtarget_db_data> parse_TT_table(
       const double start_time, const double end_time) {
-    // parse config file
-    std::string parse_string = "select DATETIME";
-    std::ifstream in(config_name);
-    nlohmann::json file;
-    in >> file;
-    auto db_config =
-        file["perception"]["TrackingTarget"]
-            .get<std::vector<std::pair<std::string, std::string>>>();
-    for (auto const &value : db_config) parse_string += ", " + value.first;
-    parse_string += " from TrackingTarget where ID= ?;";
-
-    //
     std::vector<perception_trackingtarget_db_data> v_perception_TT_db_data;
-
-    // loop through the database
-    int max_id = 0;
-    db << "select MAX(ID) from TrackingTarget;" >> max_id;
-    for (int i = 0; i != max_id; i++) {
-      db << parse_string << i + 1 >>
-          [&](std::string local_time, int spoke_state,
-              std::vector<int> targets_state,
-              std::vector<int> targets_intention, std::vector<double> targets_x,
-              std::vector<double> targets_y,
-              std::vector<double> targets_square_radius,
-              std::vector<double> targets_vx, std::vector<double> targets_vy,
-              std::vector<double> targets_CPA_x,
-              std::vector<double> targets_CPA_y,
-              std::vector<double> targets_TCPA) {
-            double _local_time_s = master_parser::convertJulianday2Second(
-                atof(local_time.c_str()) - master_parser::timestamp0);
-            if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
-              v_perception_TT_db_data.push_back(
-                  perception_trackingtarget_db_data{
-                      _local_time_s,          // local_time
-                      spoke_state,            // spoke_state
-                      targets_state,          // targets_state
-                      targets_intention,      // targets_intention
-                      targets_x,              // targets_x
-                      targets_y,              // targets_y
-                      targets_square_radius,  // targets_square_radius
-                      targets_vx,             // targets_vx
-                      targets_vy,             // targets_vy
-                      targets_CPA_x,          // targets_CPA_x
-                      targets_CPA_y,          // targets_CPA_y
-                      targets_TCPA            // targets_TCPA
-                  });
-            }
-          };
-    }
+    parse_TT_table(start_time, end_time, append_to(v_perception_TT_db_data));
     return v_perception_TT_db_data;
   }  // parse_TT_table
 
+  // pass the rows between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size rows, and return the # of rows
+  template <typename Visitor>
+  std::size_t parse_TT_table(const double start_time, const double end_time,
+                             Visitor &&_visitor,
+                             const std::size_t _chunk_size = 1024) {
+    chunk_visitor<perception_trackingtarget_db_data, Visitor> chunk(
+        _visitor, _chunk_size);
+    select_range(db, config_name, "/perception/TrackingTarget",
+                 "TrackingTarget", start_time, end_time) >>
+        [&](std::string local_time, int spoke_state,
+            std::vector<int> targets_state,
+            std::vector<int> targets_intention, std::vector<double> targets_x,
+            std::vector<double> targets_y,
+            std::vector<double> targets_square_radius,
+            std::vector<double> targets_vx, std::vector<double> targets_vy,
+            std::vector<double> targets_CPA_x,
+            std::vector<double> targets_CPA_y,
+            std::vector<double> targets_TCPA) {
+          double _local_time_s = master_parser::convertJulianday2Second(
+              atof(local_time.c_str()) - master_parser::timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            chunk.push_back(
+                perception_trackingtarget_db_data{
+                    _local_time_s,          // local_time
+                    spoke_state,            // spoke_state
+                    targets_state,          // targets_state
+                    targets_intention,      // targets_intention
+                    targets_x,              // targets_x
+                    targets_y,              // targets_y
+                    targets_square_radius,  // targets_square_radius
+                    targets_vx,             // targets_vx
+                    targets_vy,             // targets_vy
+                    targets_CPA_x,          // targets_CPA_x
+                    targets_CPA_y,          // targets_CPA_y
+                    targets_TCPA            // targets_TCPA
+                });
+          }
+        };
+    return chunk.finish();
+  }  // parse_TT_table
+
  private:
   std::string config_name;
   sqlite::database db;
 
 };  // end class perception_parser
 
+/************************** binary columnar format ***************************/
+template <typename T_data>
+class column_parser {
+  using Schema = column_schema<T_data>;
+  using Columns = decltype(Schema::columns(0));
+  static constexpr std::size_t num_columns = std::tuple_size_v<Columns>;
+
+ public:
+  // map all the column files of the channel. std::runtime_error is thrown
+  // if any file can not be mapped, or is not of the schema
+  explicit column_parser(const std::string &_folder_path)
+      : channel_path(_folder_path + Schema::channel + "/"),
+        columns(Schema::columns(0)),
+        num_records(0) {
+    try {
+      map_file(column_time_name, time_file);
+      num_records = time_file.num_records;
+
+      // the # of elements of the vector columns is given by the files
+      std::size_t i = 0;
+      std::size_t array_size = 0;
+      std::apply(
+          [&](const auto &... _column) {
+            ((map_file(_column.name, column_files[i]),
+              array_size = (_column.count == 0 && array_size == 0)
+                               ? column_files[i].header->count
+                               : array_size,
+              ++i),
+             ...);
+          },
+          columns);
+      columns = Schema::columns(array_size);
+
+      i = 0;
+      std::apply(
+          [&](const auto &... _column) {
+            (check_file(_column, column_files[i++]), ...);
+          },
+          columns);
+    } catch (...) {
+      unmap_files();
+      throw;
+    }
+    for (auto const &file : column_files)
+      num_records = std::min(num_records, file.num_records);
+  }
+  column_parser(const column_parser &) = delete;
+  column_parser &operator=(const column_parser &) = delete;
+  ~column_parser() { unmap_files(); }
+
+  // # of records
+  std::size_t size() const noexcept { return num_records; }
+  // julian day where local_time = 0
+  double gettimestamp0() const noexcept {
+    return time_file.header->timestamp0;
+  }
+
+  // local_time (s) of all the records, in the non-decreasing order
+  const double *local_time() const noexcept {
+    return reinterpret_cast<const double *>(time_file.data);
+  }
+
+  // elements of one column in place, count(_name) per record. nullptr if
+  // the column does not exist or is not of type T
+  template <typename T>
+  const T *column(const std::string &_name) const noexcept {
+    const mapped_file *file = find_file(_name);
+    if ((file == nullptr) ||
+        (file->header->type != static_cast<uint32_t>(column_type_of<T>())))
+      return nullptr;
+    return reinterpret_cast<const T *>(file->data);
+  }  // column
+
+  // # of elements per record of one column
+  std::size_t count(const std::string &_name) const noexcept {
+    const mapped_file *file = find_file(_name);
+    return (file == nullptr) ? 0 : file->header->count;
+  }  // count
+
+  // the records [first, last) in [start_time, end_time] (s)
+  std::pair<std::size_t, std::size_t> find_range(const double start_time,
+                                                 const double end_time) const {
+    const double *first = local_time();
+    const double *last = first + num_records;
+    return {std::lower_bound(first, last, start_time) - first,
+            std::upper_bound(first, last, end_time) - first};
+  }  // find_range
+
+  // the i-th record
+  T_data at(const std::size_t i) const {
+    T_data data{};
+    data.local_time = local_time()[i];
+    std::size_t j = 0;
+    std::apply(
+        [&](const auto &... _column) {
+          ((_column.decode(column_files[j].data +
+                               i * column_files[j].header->record_size,
+                           data),
+            ++j),
+           ...);
+        },
+        columns);
+    return data;
+  }  // at
+
+  // the records between start_time and end_time (s)
+  std::vector<T_data> parse_table(const double start_time,
+                                  const double end_time) const {
+    std::vector<T_data> v_data;
+    parse_table(start_time, end_time, append_to(v_data));
+    return v_data;
+  }  // parse_table
+
+  // pass the records between start_time and end_time (s) to the visitor, in
+  // chunks of at most _chunk_size records, and return the # of records
+  template <typename Visitor>
+  std::size_t parse_table(const double start_time, const double end_time,
+                          Visitor &&_visitor,
+                          const std::size_t _chunk_size = 1024) const {
+    chunk_visitor<T_data, Visitor> chunk(_visitor, _chunk_size);
+    auto [first, last] = find_range(start_time, end_time);
+    for (std::size_t i = first; i != last; ++i) chunk.push_back(at(i));
+    return chunk.finish();
+  }  // parse_table
+
+ private:
+  struct mapped_file {
+    std::string name;
+    void *address = MAP_FAILED;
+    std::size_t length = 0;
+    const column_header *header = nullptr;
+    const char *data = nullptr;
+    std::size_t num_records = 0;
+  };
+
+  const std::string channel_path;
+  Columns columns;
+  std::size_t num_records;
+  mapped_file time_file;
+  std::array<mapped_file, num_columns> column_files;
+
+  void map_file(const std::string &_name, mapped_file &_file) {
+    std::string path = channel_path + _name + column_extension;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error(path + ": " + std::strerror(errno));
+    struct stat file_stat;
+    ::fstat(fd, &file_stat);
+    _file.name = _name;
+    _file.length = static_cast<std::size_t>(file_stat.st_size);
+    if (_file.length >= sizeof(column_header))
+      _file.address =
+          ::mmap(nullptr, _file.length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (_file.address == MAP_FAILED)
+      throw std::runtime_error(path + ": can not be mapped");
+    ::madvise(_file.address, _file.length, MADV_SEQUENTIAL);
+
+    _file.header = static_cast<const column_header *>(_file.address);
+    _file.data = static_cast<const char *>(_file.address) +
+                 sizeof(column_header);
+    if (std::memcmp(_file.header->magic, column_magic, sizeof(column_magic)) ||
+        (_file.header->version != column_version) ||
+        (_file.header->record_size == 0))
+      throw std::runtime_error(path + ": not a column file");
+    _file.num_records = (_file.length - sizeof(column_header)) /
+                        _file.header->record_size;
+  }  // map_file
+
+  template <typename T_column>
+  void check_file(const T_column &_column, const mapped_file &_file) const {
+    using element = typename T_column::element;
+    uint32_t type = static_cast<uint32_t>(column_type_of<element>());
+    if ((_file.header->type != type) ||
+        (_file.header->count != _column.count) ||
+        (_file.header->record_size != _column.record_size()))
+      throw std::runtime_error(channel_path + _file.name +
+                               column_extension + ": different column format");
+  }  // check_file
+
+  void unmap_files() {
+    unmap_file(time_file);
+    for (auto &file : column_files) unmap_file(file);
+  }  // unmap_files
+
+  static void unmap_file(mapped_file &_file) {
+    if (_file.address != MAP_FAILED) ::munmap(_file.address, _file.length);
+    _file.address = MAP_FAILED;
+  }  // unmap_file
+
+  const mapped_file *find_file(const std::string &_name) const noexcept {
+    if (_name == column_time_name) return &time_file;
+    for (auto const &file : column_files)
+      if (file.name == _name) return &file;
+    return nullptr;
+  }  // find_file
+
+};  // end class column_parser
+
 }  // namespace ASV::common
 
 #endif /* _DATAPARSER_H_ */
\ No newline at end of file
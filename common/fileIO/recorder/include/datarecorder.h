@@ -6,6 +6,8 @@
 *
 * db_config.json is used to construct the tables in database
 * databasedata.h is used to update the data in database
+* The rows are inserted by a background writer (datawriter.h) with the
+* prepared statements, so that update_*_table never waits for the disk
 * by Hu.ZH(CrossOcean.ai)
 ***********************************************************************
 */
@@ -14,13 +16,14 @@
 #define _DATARECORDER_H_
 
 #include <sqlite_modern_cpp.h>
-#include <sstream>
+#include <memory>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
 #include "common/fileIO/include/json.hpp"
 #include "common/logging/include/easylogging++.h"
 #include "databasedata.h"
+#include "datawriter.h"
 
 namespace ASV::common {
 
@@ -39,13 +42,22 @@ class master_db {
   virtual ~master_db() = default;
 
  protected:
-  template <typename T>
-  std::string to_string_with_precision(const T a_value, const int n = 6) {
-    std::ostringstream out;
-    out.precision(n);
-    out << std::fixed << a_value;
-    return out.str();
-  }
+  using Statement = std::unique_ptr<sqlite::database_binder>;
+
+  // prepared statement to insert one row into the table, where the values
+  // of DATETIME and all the columns are bound
+  static Statement prepare_insert(sqlite::database &_db,
+                                  const std::string &_table,
+                                  const std::string &_insert_string,
+                                  const std::size_t _num_columns) {
+    std::string str = "INSERT INTO " + _table + _insert_string + "VALUES(?";
+    for (std::size_t i = 0; i != _num_columns; ++i) str += ", ?";
+    str += ");";
+    auto statement = std::make_unique<sqlite::database_binder>(_db << str);
+    // not to be executed when destroyed
+    statement->used(true);
+    return statement;
+  }  // prepare_insert
 
  private:
   std::string dbpath;
@@ -58,13 +70,16 @@ class gps_db : public master_db {
  public:
   explicit gps_db(const std::string &_DB_folder_path,
                   const std::string &_config_name,
-                  const std::string &_datetime = "julianday('now')")
+                  const std::string &_datetime = "julianday('now')",
+                  const db_writer_config &_writer_config =
+                      default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "gps.db"),
         config_name(_config_name),
         insert_gps_string(""),
         insert_imu_string(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-GPS", _writer_config) {}
   ~gps_db() {}
 
   void create_table() {
@@ -111,92 +126,69 @@ class gps_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-GPS") << e.what();
     }
-  }  // create_table
 
-  void update_gps_table(const gps_db_data &update_data,
-                        const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO GPS";
-      str += insert_gps_string;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.UTC);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.latitude, 7);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.longitude, 7);
-      str += ", ";
-      str += std::to_string(update_data.heading);
-      str += ", ";
-      str += std::to_string(update_data.pitch);
-      str += ", ";
-      str += std::to_string(update_data.roll);
-      str += ", ";
-      str += std::to_string(update_data.altitude);
-      str += ", ";
-      str += std::to_string(update_data.Ve);
-      str += ", ";
-      str += std::to_string(update_data.Vn);
-      str += ", ";
-      str += std::to_string(update_data.roti);
-      str += ", ";
-      str += std::to_string(update_data.status);
-      str += ", ";
-      str += master_db::to_string_with_precision<double>(update_data.UTM_x, 3);
-      str += ", ";
-      str += master_db::to_string_with_precision<double>(update_data.UTM_y, 3);
-      str += ", '";
-      str += update_data.UTM_zone;
-      str += "');";
-
-      db << str;
+      insert_gps_statement = master_db::prepare_insert(
+          db, "GPS", insert_gps_string, db_gps_config.size());
+      insert_imu_statement = master_db::prepare_insert(
+          db, "IMU", insert_imu_string, db_imu_config.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-GPS") << e.what();
     }
+  }  // create_table
+
+  void update_gps_table(const gps_db_data &update_data,
+                        const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_gps_table
 
   void update_imu_table(const imu_db_data &update_data,
                         const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO IMU";
-      str += insert_imu_string;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.Acc_X);
-      str += ", ";
-      str += std::to_string(update_data.Acc_Y);
-      str += ", ";
-      str += std::to_string(update_data.Acc_Z);
-      str += ", ";
-      str += std::to_string(update_data.Ang_vel_X);
-      str += ", ";
-      str += std::to_string(update_data.Ang_vel_Y);
-      str += ", ";
-      str += std::to_string(update_data.Ang_vel_Z);
-      str += ", ";
-      str += std::to_string(update_data.roll);
-      str += ", ";
-      str += std::to_string(update_data.pitch);
-      str += ", ";
-      str += std::to_string(update_data.yaw);
-      str += ");";
-
-      db << str;
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-GPS") << e.what();
-    }
+    writer.push(update_data, _datetime);
   }  // update_imu_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
   std::string insert_gps_string;
   std::string insert_imu_string;
   sqlite::database db;
+  Statement insert_gps_statement;
+  Statement insert_imu_statement;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<gps_db_data, imu_db_data> writer;
+
+  void insert_row(const double _julianday, const gps_db_data &update_data) {
+    *insert_gps_statement << _julianday << update_data.UTC
+                          << update_data.latitude << update_data.longitude
+                          << update_data.heading << update_data.pitch
+                          << update_data.roll << update_data.altitude
+                          << update_data.Ve << update_data.Vn
+                          << update_data.roti << update_data.status
+                          << update_data.UTM_x << update_data.UTM_y
+                          << update_data.UTM_zone;
+    insert_gps_statement->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday, const imu_db_data &update_data) {
+    *insert_imu_statement << _julianday << update_data.Acc_X
+                          << update_data.Acc_Y << update_data.Acc_Z
+                          << update_data.Ang_vel_X << update_data.Ang_vel_Y
+                          << update_data.Ang_vel_Z << update_data.roll
+                          << update_data.pitch << update_data.yaw;
+    insert_imu_statement->execute();
+  }  // insert_row
 
 };  // end class gps_db
 
@@ -204,12 +196,15 @@ class wind_db : public master_db {
  public:
   explicit wind_db(const std::string &_DB_folder_path,
                    const std::string &_config_name,
-                   const std::string &_datetime = "julianday('now')")
+                   const std::string &_datetime = "julianday('now')",
+                   const db_writer_config &_writer_config =
+                       default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "wind.db"),
         config_name(_config_name),
         insert_string(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-wind", _writer_config) {}
   ~wind_db() {}
 
   void create_table() {
@@ -236,32 +231,45 @@ class wind_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-wind") << e.what();
     }
-  }  // create_table
 
-  void update_table(const wind_db_data &update_data,
-                    const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO wind";
-      str += insert_string;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.speed);
-      str += ", ";
-      str += std::to_string(update_data.orientation);
-      str += ");";
-
-      db << str;
+      insert_statement = master_db::prepare_insert(db, "wind", insert_string,
+                                                   db_config.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-wind") << e.what();
     }
+  }  // create_table
+
+  void update_table(const wind_db_data &update_data,
+                    const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
   std::string insert_string;
   sqlite::database db;
+  Statement insert_statement;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<wind_db_data> writer;
+
+  void insert_row(const double _julianday, const wind_db_data &update_data) {
+    *insert_statement << _julianday << update_data.speed
+                      << update_data.orientation;
+    insert_statement->execute();
+  }  // insert_row
 
 };  // end class wind_db
 
@@ -269,12 +277,15 @@ class stm32_db : public master_db {
  public:
   explicit stm32_db(const std::string &_DB_folder_path,
                     const std::string &_config_name,
-                    const std::string &_datetime = "julianday('now')")
+                    const std::string &_datetime = "julianday('now')",
+                    const db_writer_config &_writer_config =
+                        default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "stm32.db"),
         config_name(_config_name),
         insert_string(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-stm32", _writer_config) {}
   ~stm32_db() {}
 
   void create_table() {
@@ -301,56 +312,51 @@ class stm32_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-stm32") << e.what();
     }
-  }  // create_table
 
-  void update_table(const stm32_db_data &update_data,
-                    const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO stm32";
-      str += insert_string;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.stm32_link);
-      str += ", ";
-      str += std::to_string(update_data.stm32_status);
-      str += ", ";
-      str += std::to_string(update_data.command_u1);
-      str += ", ";
-      str += std::to_string(update_data.command_u2);
-      str += ", ";
-      str += std::to_string(update_data.feedback_u1);
-      str += ", ";
-      str += std::to_string(update_data.feedback_u2);
-      str += ", ";
-      str += std::to_string(update_data.feedback_pwm1);
-      str += ", ";
-      str += std::to_string(update_data.feedback_pwm2);
-      str += ", ";
-      str += std::to_string(update_data.RC_X);
-      str += ", ";
-      str += std::to_string(update_data.RC_Y);
-      str += ", ";
-      str += std::to_string(update_data.RC_Mz);
-      str += ", ";
-      str += std::to_string(update_data.voltage_b1);
-      str += ", ";
-      str += std::to_string(update_data.voltage_b2);
-      str += ", ";
-      str += std::to_string(update_data.voltage_b3);
-      str += ");";
-
-      db << str;
+      insert_statement = master_db::prepare_insert(db, "stm32", insert_string,
+                                                   db_config.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-stm32") << e.what();
     }
+  }  // create_table
+
+  void update_table(const stm32_db_data &update_data,
+                    const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
   std::string insert_string;
   sqlite::database db;
+  Statement insert_statement;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<stm32_db_data> writer;
+
+  void insert_row(const double _julianday, const stm32_db_data &update_data) {
+    *insert_statement << _julianday << update_data.stm32_link
+                      << update_data.stm32_status << update_data.command_u1
+                      << update_data.command_u2 << update_data.feedback_u1
+                      << update_data.feedback_u2 << update_data.feedback_pwm1
+                      << update_data.feedback_pwm2 << update_data.RC_X
+                      << update_data.RC_Y << update_data.RC_Mz
+                      << update_data.voltage_b1 << update_data.voltage_b2
+                      << update_data.voltage_b3;
+    insert_statement->execute();
+  }  // insert_row
 
 };  // end class stm32_db
 
@@ -358,12 +364,15 @@ class marineradar_db : public master_db {
  public:
   explicit marineradar_db(const std::string &_DB_folder_path,
                           const std::string &_config_name,
-                          const std::string &_datetime = "julianday('now')")
+                          const std::string &_datetime = "julianday('now')",
+                          const db_writer_config &_writer_config =
+                              default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "marineradar.db"),
         config_name(_config_name),
         insert_string(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-marineradar", _writer_config) {}
   ~marineradar_db() {}
 
   void create_table() {
@@ -391,30 +400,46 @@ class marineradar_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-marineradar") << e.what();
     }
-  }  // create_table
 
-  void update_table(const marineradar_db_data &update_data,
-                    const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO radar";
-      str += insert_string;
-      str += "VALUES(";
-      str += _datetime;
-      str += ",? ,? ,? )";
-
-      db << str << update_data.azimuth_deg << update_data.sample_range
-         << update_data.spokedata;
-
+      insert_statement = master_db::prepare_insert(db, "radar", insert_string,
+                                                   db_config.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-marineradar") << e.what();
     }
+  }  // create_table
+
+  void update_table(const marineradar_db_data &update_data,
+                    const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
   std::string insert_string;
   sqlite::database db;
+  Statement insert_statement;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<marineradar_db_data> writer;
+
+  void insert_row(const double _julianday,
+                  const marineradar_db_data &update_data) {
+    *insert_statement << _julianday << update_data.azimuth_deg
+                      << update_data.sample_range << update_data.spokedata;
+    insert_statement->execute();
+  }  // insert_row
 
 };  // end class marineradar_db
 
@@ -424,14 +449,17 @@ class estimator_db : public master_db {
  public:
   explicit estimator_db(const std::string &_DB_folder_path,
                         const std::string &_config_name,
-                        const std::string &_datetime = "julianday('now')")
+                        const std::string &_datetime = "julianday('now')",
+                        const db_writer_config &_writer_config =
+                            default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "estimator.db"),
         config_name(_config_name),
         insert_string_measurement(""),
         insert_string_state(""),
         insert_string_error(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-estimator", _writer_config) {}
   ~estimator_db() {}
 
   void create_table() {
@@ -497,104 +525,47 @@ class estimator_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-estimator") << e.what();
     }
-  }  // create_table
 
-  void update_measurement_table(
-      const est_measurement_db_data &update_data,
-      const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO measurement";
-      str += insert_string_measurement;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += master_db::to_string_with_precision<double>(update_data.meas_x, 3);
-      str += ", ";
-      str += master_db::to_string_with_precision<double>(update_data.meas_y, 3);
-      str += ", ";
-      str += std::to_string(update_data.meas_theta);
-      str += ", ";
-      str += master_db::to_string_with_precision<double>(update_data.meas_u, 3);
-      str += ", ";
-      str += master_db::to_string_with_precision<double>(update_data.meas_v, 3);
-      str += ", ";
-      str += std::to_string(update_data.meas_r);
-      str += ");";
-
-      db << str;
+      insert_statement_measurement = master_db::prepare_insert(
+          db, "measurement", insert_string_measurement,
+          db_config_measurement.size());
+      insert_statement_state = master_db::prepare_insert(
+          db, "state", insert_string_state, db_config_state.size());
+      insert_statement_error = master_db::prepare_insert(
+          db, "error", insert_string_error, db_config_error.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-estimator") << e.what();
     }
+  }  // create_table
+
+  void update_measurement_table(
+      const est_measurement_db_data &update_data,
+      const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_measurement_table
 
   void update_state_table(const est_state_db_data &update_data,
                           const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO state";
-      str += insert_string_state;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.state_x, 3);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.state_y, 3);
-      str += ", ";
-      str += std::to_string(update_data.state_theta);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.state_u, 3);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.state_v, 3);
-      str += ", ";
-      str += std::to_string(update_data.state_r);
-      str += ", ";
-      str += std::to_string(update_data.curvature);
-      str += ", ";
-      str += std::to_string(update_data.speed);
-      str += ", ";
-      str += std::to_string(update_data.dspeed);
-      str += ");";
-
-      db << str;
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-estimator") << e.what();
-    }
+    writer.push(update_data, _datetime);
   }  // update_state_table
 
   void update_error_table(const est_error_db_data &update_data,
                           const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO error";
-      str += insert_string_error;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.perror_x, 3);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.perror_y, 3);
-      str += ", ";
-      str += std::to_string(update_data.perror_mz);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.verror_x, 3);
-      str += ", ";
-      str +=
-          master_db::to_string_with_precision<double>(update_data.verror_y, 3);
-      str += ", ";
-      str += std::to_string(update_data.verror_mz);
-      str += ");";
-
-      db << str;
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-estimator") << e.what();
-    }
+    writer.push(update_data, _datetime);
   }  // update_error_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
@@ -602,6 +573,41 @@ class estimator_db : public master_db {
   std::string insert_string_state;
   std::string insert_string_error;
   sqlite::database db;
+  Statement insert_statement_measurement;
+  Statement insert_statement_state;
+  Statement insert_statement_error;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<est_measurement_db_data, est_state_db_data, est_error_db_data>
+      writer;
+
+  void insert_row(const double _julianday,
+                  const est_measurement_db_data &update_data) {
+    *insert_statement_measurement << _julianday << update_data.meas_x
+                                  << update_data.meas_y
+                                  << update_data.meas_theta
+                                  << update_data.meas_u << update_data.meas_v
+                                  << update_data.meas_r;
+    insert_statement_measurement->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday,
+                  const est_state_db_data &update_data) {
+    *insert_statement_state << _julianday << update_data.state_x
+                            << update_data.state_y << update_data.state_theta
+                            << update_data.state_u << update_data.state_v
+                            << update_data.state_r << update_data.curvature
+                            << update_data.speed << update_data.dspeed;
+    insert_statement_state->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday,
+                  const est_error_db_data &update_data) {
+    *insert_statement_error << _julianday << update_data.perror_x
+                            << update_data.perror_y << update_data.perror_mz
+                            << update_data.verror_x << update_data.verror_y
+                            << update_data.verror_mz;
+    insert_statement_error->execute();
+  }  // insert_row
 
 };  // end class estimator_db
 
@@ -609,13 +615,16 @@ class planner_db : public master_db {
  public:
   explicit planner_db(const std::string &_DB_folder_path,
                       const std::string &_config_name,
-                      const std::string &_datetime = "julianday('now')")
+                      const std::string &_datetime = "julianday('now')",
+                      const db_writer_config &_writer_config =
+                          default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "planner.db"),
         config_name(_config_name),
         insert_string_routeplanner(""),
         insert_string_latticeplanner(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-planner", _writer_config) {}
   ~planner_db() {}
 
   void create_table() {
@@ -663,67 +672,42 @@ class planner_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-planner") << e.what();
     }
-  }  // create_table
 
-  void update_routeplanner_table(
-      const plan_route_db_data &update_data,
-      const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO routeplanner";
-      str += insert_string_routeplanner;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.setpoints_X);
-      str += ", ";
-      str += std::to_string(update_data.setpoints_Y);
-      str += ", ";
-      str += std::to_string(update_data.setpoints_heading);
-      str += ", ";
-      str += std::to_string(update_data.setpoints_longitude);
-      str += ", ";
-      str += std::to_string(update_data.setpoints_latitude);
-      str += ", ";
-      str += std::to_string(update_data.speed);
-      str += ", ";
-      str += std::to_string(update_data.captureradius);
-      str += ", ?, ?, ?, ?, ?); ";
-
-      db << str << update_data.utm_zone << update_data.WPX << update_data.WPY
-         << update_data.WPLONG << update_data.WPLAT;
+      insert_statement_routeplanner = master_db::prepare_insert(
+          db, "routeplanner", insert_string_routeplanner,
+          db_config_routeplanner.size());
+      insert_statement_latticeplanner = master_db::prepare_insert(
+          db, "latticeplanner", insert_string_latticeplanner,
+          db_config_latticeplanner.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-planner") << e.what();
     }
+  }  // create_table
+
+  void update_routeplanner_table(
+      const plan_route_db_data &update_data,
+      const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_routeplanner_table
 
   void update_latticeplanner_table(
       const plan_lattice_db_data &update_data,
       const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO latticeplanner";
-      str += insert_string_latticeplanner;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.lattice_x);
-      str += ", ";
-      str += std::to_string(update_data.lattice_y);
-      str += ", ";
-      str += std::to_string(update_data.lattice_theta);
-      str += ", ";
-      str += std::to_string(update_data.lattice_kappa);
-      str += ", ";
-      str += std::to_string(update_data.lattice_speed);
-      str += ", ";
-      str += std::to_string(update_data.lattice_dspeed);
-      str += ");";
-
-      db << str;
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-planner") << e.what();
-    }
+    writer.push(update_data, _datetime);
   }  // update_latticeplanner_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
@@ -731,6 +715,36 @@ class planner_db : public master_db {
   std::string insert_string_latticeplanner;
 
   sqlite::database db;
+  Statement insert_statement_routeplanner;
+  Statement insert_statement_latticeplanner;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<plan_route_db_data, plan_lattice_db_data> writer;
+
+  void insert_row(const double _julianday,
+                  const plan_route_db_data &update_data) {
+    *insert_statement_routeplanner << _julianday << update_data.setpoints_X
+                                   << update_data.setpoints_Y
+                                   << update_data.setpoints_heading
+                                   << update_data.setpoints_longitude
+                                   << update_data.setpoints_latitude
+                                   << update_data.speed
+                                   << update_data.captureradius
+                                   << update_data.utm_zone << update_data.WPX
+                                   << update_data.WPY << update_data.WPLONG
+                                   << update_data.WPLAT;
+    insert_statement_routeplanner->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday,
+                  const plan_lattice_db_data &update_data) {
+    *insert_statement_latticeplanner << _julianday << update_data.lattice_x
+                                     << update_data.lattice_y
+                                     << update_data.lattice_theta
+                                     << update_data.lattice_kappa
+                                     << update_data.lattice_speed
+                                     << update_data.lattice_dspeed;
+    insert_statement_latticeplanner->execute();
+  }  // insert_row
 
 };  // end class planner_db
 
@@ -738,13 +752,16 @@ class controller_db : public master_db {
  public:
   explicit controller_db(const std::string &_DB_folder_path,
                          const std::string &_config_name,
-                         const std::string &_datetime = "julianday('now')")
+                         const std::string &_datetime = "julianday('now')",
+                         const db_writer_config &_writer_config =
+                             default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "controller.db"),
         config_name(_config_name),
         insert_string_setpoint(""),
         insert_string_TA(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-controller", _writer_config) {}
   ~controller_db() {}
 
   void create_table() {
@@ -792,59 +809,68 @@ class controller_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-controller") << e.what();
     }
-  }  // create_table
 
-  void update_setpoint_table(
-      const control_setpoint_db_data &update_data,
-      const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO setpoint";
-      str += insert_string_setpoint;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ";
-      str += std::to_string(update_data.set_x);
-      str += ", ";
-      str += std::to_string(update_data.set_y);
-      str += ", ";
-      str += std::to_string(update_data.set_theta);
-      str += ", ";
-      str += std::to_string(update_data.set_u);
-      str += ", ";
-      str += std::to_string(update_data.set_v);
-      str += ", ";
-      str += std::to_string(update_data.set_r);
-      str += ");";
-
-      db << str;
+      insert_statement_setpoint = master_db::prepare_insert(
+          db, "setpoint", insert_string_setpoint, db_config_setpoint.size());
+      insert_statement_TA = master_db::prepare_insert(
+          db, "TA", insert_string_TA, db_config_TA.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-controller") << e.what();
     }
+  }  // create_table
+
+  void update_setpoint_table(
+      const control_setpoint_db_data &update_data,
+      const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_setpoint_table
 
   void update_TA_table(const control_TA_db_data &update_data,
                        const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO TA";
-      str += insert_string_TA;
-      str += "VALUES(";
-      str += _datetime;
-      str += ",? ,? ,? ,? ,? ,? ,? ,?);";
-      db << str << update_data.desired_Fx << update_data.desired_Fy
-         << update_data.desired_Mz << update_data.est_Fx << update_data.est_Fy
-         << update_data.est_Mz << update_data.alpha << update_data.rpm;
-
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-controller") << e.what();
-    }
+    writer.push(update_data, _datetime);
   }  // update_TA_table
 
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
+
  private:
   std::string dbpath;
   std::string config_name;
   std::string insert_string_setpoint;
   std::string insert_string_TA;
   sqlite::database db;
+  Statement insert_statement_setpoint;
+  Statement insert_statement_TA;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<control_setpoint_db_data, control_TA_db_data> writer;
+
+  void insert_row(const double _julianday,
+                  const control_setpoint_db_data &update_data) {
+    *insert_statement_setpoint << _julianday << update_data.set_x
+                               << update_data.set_y << update_data.set_theta
+                               << update_data.set_u << update_data.set_v
+                               << update_data.set_r;
+    insert_statement_setpoint->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday,
+                  const control_TA_db_data &update_data) {
+    *insert_statement_TA << _julianday << update_data.desired_Fx
+                         << update_data.desired_Fy << update_data.desired_Mz
+                         << update_data.est_Fx << update_data.est_Fy
+                         << update_data.est_Mz << update_data.alpha
+                         << update_data.rpm;
+    insert_statement_TA->execute();
+  }  // insert_row
 
 };  // end class controller_db
 
@@ -852,14 +878,17 @@ class perception_db : public master_db {
  public:
   explicit perception_db(const std::string &_DB_folder_path,
                          const std::string &_config_name,
-                         const std::string &_datetime = "julianday('now')")
+                         const std::string &_datetime = "julianday('now')",
+                         const db_writer_config &_writer_config =
+                             default_db_writer_config)
       : master_db(_DB_folder_path, _datetime),
         dbpath(_DB_folder_path + "perception.db"),
         config_name(_config_name),
         insert_string_spoke(""),
         insert_string_detectedtarget(""),
         insert_string_trackingtarget(""),
-        db(dbpath) {}
+        db(dbpath),
+        writer(db, "sql-perception", _writer_config) {}
   ~perception_db() {}
 
   void create_table() {
@@ -924,63 +953,49 @@ class perception_db : public master_db {
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-perception") << e.what();
     }
-  }  // create_table
 
-  void update_spoke_table(const perception_spoke_db_data &update_data,
-                          const std::string &_datetime = "julianday('now')") {
     try {
-      std::string str = "INSERT INTO SpokeProcess";
-      str += insert_string_spoke;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ?, ?, ?, ?);";
-
-      db << str << update_data.surroundings_bearing_rad
-         << update_data.surroundings_range_m << update_data.surroundings_x_m
-         << update_data.surroundings_y_m;
+      insert_statement_spoke = master_db::prepare_insert(
+          db, "SpokeProcess", insert_string_spoke,
+          db_config_SpokeProcess.size());
+      insert_statement_detectedtarget = master_db::prepare_insert(
+          db, "DetectedTarget", insert_string_detectedtarget,
+          db_config_DetectedTarget.size());
+      insert_statement_trackingtarget = master_db::prepare_insert(
+          db, "TrackingTarget", insert_string_trackingtarget,
+          db_config_TrackingTarget.size());
+      writer.start([this](const double _julianday, const auto &_row) {
+        std::visit([this, _julianday](
+                       const auto &_data) { insert_row(_julianday, _data); },
+                   _row);
+      });
     } catch (sqlite::sqlite_exception &e) {
       CLOG(ERROR, "sql-perception") << e.what();
     }
+  }  // create_table
+
+  void update_spoke_table(const perception_spoke_db_data &update_data,
+                          const std::string &_datetime = "julianday('now')") {
+    writer.push(update_data, _datetime);
   }  // update_spoke_table
 
   void update_detection_table(
       const perception_detection_db_data &update_data,
       const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO DetectedTarget";
-      str += insert_string_detectedtarget;
-      str += "VALUES(";
-      str += _datetime;
-      str += ", ?, ?, ?);";
-
-      db << str << update_data.detected_target_x
-         << update_data.detected_target_y << update_data.detected_target_radius;
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-perception") << e.what();
-    }
+    writer.push(update_data, _datetime);
   }  // update_detection_table
 
   void update_trackingtarget_table(
       const perception_trackingtarget_db_data &update_data,
       const std::string &_datetime = "julianday('now')") {
-    try {
-      std::string str = "INSERT INTO TrackingTarget";
-      str += insert_string_trackingtarget;
-      str += "VALUES(";
-      str += _datetime;
-      str += ",? ,? ,? ,? ,? ,? ,? ,?, ?, ?, ?);";
-
-      db << str << update_data.spoke_state << update_data.targets_state
-         << update_data.targets_intention << update_data.targets_x
-         << update_data.targets_y << update_data.targets_square_radius
-         << update_data.targets_vx << update_data.targets_vy
-         << update_data.targets_CPA_x << update_data.targets_CPA_y
-         << update_data.targets_TCPA;
+    writer.push(update_data, _datetime);
+  }  // update_trackingtarget_table
 
-    } catch (sqlite::sqlite_exception &e) {
-      CLOG(ERROR, "sql-perception") << e.what();
-    }
-  }  // update_TA_table
+  // wait until all the updated rows are committed
+  void flush() { writer.flush(); }
+
+  // queue depth and drop counters of the background writer
+  const auto &getwriter() const noexcept { return writer; }
 
  private:
   std::string dbpath;
@@ -990,6 +1005,48 @@ class perception_db : public master_db {
   std::string insert_string_trackingtarget;
 
   sqlite::database db;
+  Statement insert_statement_spoke;
+  Statement insert_statement_detectedtarget;
+  Statement insert_statement_trackingtarget;
+  // declared last, to be stopped before the statements are finalized
+  db_writer<perception_spoke_db_data, perception_detection_db_data,
+            perception_trackingtarget_db_data>
+      writer;
+
+  void insert_row(const double _julianday,
+                  const perception_spoke_db_data &update_data) {
+    *insert_statement_spoke << _julianday
+                            << update_data.surroundings_bearing_rad
+                            << update_data.surroundings_range_m
+                            << update_data.surroundings_x_m
+                            << update_data.surroundings_y_m;
+    insert_statement_spoke->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday,
+                  const perception_detection_db_data &update_data) {
+    *insert_statement_detectedtarget << _julianday
+                                     << update_data.detected_target_x
+                                     << update_data.detected_target_y
+                                     << update_data.detected_target_radius;
+    insert_statement_detectedtarget->execute();
+  }  // insert_row
+
+  void insert_row(const double _julianday,
+                  const perception_trackingtarget_db_data &update_data) {
+    *insert_statement_trackingtarget << _julianday << update_data.spoke_state
+                                     << update_data.targets_state
+                                     << update_data.targets_intention
+                                     << update_data.targets_x
+                                     << update_data.targets_y
+                                     << update_data.targets_square_radius
+                                     << update_data.targets_vx
+                                     << update_data.targets_vy
+                                     << update_data.targets_CPA_x
+                                     << update_data.targets_CPA_y
+                                     << update_data.targets_TCPA;
+    insert_statement_trackingtarget->execute();
+  }  // insert_row
 
 };  // end class perception_db
 
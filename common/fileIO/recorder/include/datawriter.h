@@ -0,0 +1,273 @@
+/*
+***********************************************************************
+* datawriter.h:
+* background writer of one sqlite3 database. The rows are pushed into
+* a bounded queue without waiting for the disk, and a writer thread
+* inserts them with the prepared statements, committing one
+* transaction per batch or per time window.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _DATAWRITER_H_
+#define _DATAWRITER_H_
+
+#include <sqlite_modern_cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "common/logging/include/easylogging++.h"
+#include "databasedata.h"
+
+namespace ASV::common {
+
+struct db_writer_config {
+  std::size_t max_queue_size;  // rows waiting, the new ones are dropped
+  std::size_t batch_size;      // max # of rows in one transaction
+  int commit_interval_ms;      // max time before the rows are committed
+  bool WAL_mode;               // journal_mode=WAL and synchronous=NORMAL
+};
+
+// default: ~4 s of radar spokes, and 5 commits per second at most
+inline constexpr db_writer_config default_db_writer_config{
+    8192,  // max_queue_size
+    512,   // batch_size
+    200,   // commit_interval_ms
+    true   // WAL_mode
+};
+
+// the SQL expression of DATETIME, evaluated when the row is pushed
+inline const std::string db_datetime_now = "julianday('now')";
+
+template <typename... T_data>
+class db_writer {
+ public:
+  using Row = std::variant<T_data...>;
+  // insert one row (DATETIME in julian day) with the prepared statements,
+  // in the writer thread
+  using Inserter = std::function<void(const double, const Row &)>;
+
+  db_writer(sqlite::database &_db, const std::string &_logger,
+            const db_writer_config &_config = default_db_writer_config)
+      : db(_db),
+        logger(_logger),
+        config(_config),
+        is_started(false),
+        is_stopped(false),
+        is_flushing(false),
+        num_pushed(0),
+        num_written_(0),
+        num_dropped_(0),
+        num_failed_(0),
+        max_queue_depth_(0) {
+    pending_rows.reserve(config.batch_size);
+    writing_rows.reserve(config.batch_size);
+  }
+  db_writer(const db_writer &) = delete;
+  db_writer &operator=(const db_writer &) = delete;
+  ~db_writer() { stop(); }
+
+  // set the pragmas and start the writer thread
+  void start(const Inserter &_inserter) {
+    if (is_started) return;
+    inserter = _inserter;
+    if (config.WAL_mode) {
+      try {
+        db << "PRAGMA journal_mode=WAL;";
+        db << "PRAGMA synchronous=NORMAL;";
+      } catch (sqlite::sqlite_exception &e) {
+        CLOG(ERROR, logger.c_str()) << e.what();
+      }
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    writer_thread = std::thread(&db_writer::write_loop, this);
+    is_started = true;
+  }  // start
+
+  // push one row into the queue, without waiting for the disk. The row is
+  // dropped if the queue is full, or if the writer is not started.
+  // _datetime is a SQL expression: julianday('now') is evaluated here, and
+  // the others are evaluated by the writer thread.
+  template <typename T>
+  bool push(T &&_data, const std::string &_datetime = db_datetime_now) {
+    double julianday = (_datetime == db_datetime_now) ? julianday_now() : 0.0;
+    std::string datetime = (_datetime == db_datetime_now) ? "" : _datetime;
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if (!is_started || is_stopped ||
+        (pending_rows.size() >= config.max_queue_size)) {
+      ++num_dropped_;
+      return false;
+    }
+    pending_rows.push_back(
+        {julianday, std::move(datetime), Row(std::forward<T>(_data))});
+    ++num_pushed;
+    std::size_t queue_depth = pending_rows.size();
+    if (queue_depth > max_queue_depth_) max_queue_depth_ = queue_depth;
+    lock.unlock();
+
+    if (queue_depth >= config.batch_size) queue_cv.notify_one();
+    return true;
+  }  // push
+
+  // wait until all the rows pushed before are committed
+  void flush() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if (!is_started) return;
+    std::size_t target = num_pushed;
+    is_flushing = true;
+    queue_cv.notify_one();
+    flushed_cv.wait(lock, [this, target]() {
+      return num_written_ + num_failed_ >= target;
+    });
+  }  // flush
+
+  // commit all the rows in the queue, and stop the writer thread
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      is_stopped = true;
+    }
+    queue_cv.notify_one();
+    if (writer_thread.joinable()) writer_thread.join();
+  }  // stop
+
+  // # of rows waiting in the queue
+  std::size_t queue_depth() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return pending_rows.size();
+  }
+  std::size_t max_queue_depth() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return max_queue_depth_;
+  }
+  // # of rows committed, dropped (queue is full) and failed (sql error, or
+  // the transaction of the batch is not committed)
+  std::size_t num_written() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return num_written_;
+  }
+  std::size_t num_dropped() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return num_dropped_;
+  }
+  std::size_t num_failed() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return num_failed_;
+  }
+
+ private:
+  struct Entry {
+    double julianday;
+    std::string datetime;  // empty if julianday is given
+    Row data;
+  };
+
+  sqlite::database &db;
+  const std::string logger;
+  const db_writer_config config;
+  Inserter inserter;
+
+  mutable std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::condition_variable flushed_cv;
+  std::thread writer_thread;
+  bool is_started;
+  bool is_stopped;
+  bool is_flushing;
+
+  // rows pushed by the producers, swapped with the ones being written
+  std::vector<Entry> pending_rows;
+  std::vector<Entry> writing_rows;
+
+  std::size_t num_pushed;
+  std::size_t num_written_;
+  std::size_t num_dropped_;
+  std::size_t num_failed_;
+  std::size_t max_queue_depth_;
+
+  void write_loop() {
+    auto interval = std::chrono::milliseconds(config.commit_interval_ms);
+    while (true) {
+      bool stopped = false;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait_for(lock, interval, [this]() {
+          return is_stopped || is_flushing ||
+                 (pending_rows.size() >= config.batch_size);
+        });
+        writing_rows.swap(pending_rows);
+        is_flushing = false;
+        stopped = is_stopped;
+      }
+
+      for (std::size_t begin = 0; begin < writing_rows.size();
+           begin += config.batch_size)
+        write_batch(begin,
+                    std::min(begin + config.batch_size, writing_rows.size()));
+      writing_rows.clear();
+
+      if (stopped) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (pending_rows.empty()) break;
+      }
+    }
+  }  // write_loop
+
+  // insert the rows [begin, end) in one transaction. The rows are written
+  // only if the transaction is committed; otherwise, all of them are failed.
+  void write_batch(const std::size_t begin, const std::size_t end) {
+    std::size_t num_failed_batch = end - begin;
+    try {
+      db << "BEGIN;";
+      std::size_t num_failed_insert = 0;
+      for (std::size_t i = begin; i != end; ++i) {
+        try {
+          double julianday = writing_rows[i].julianday;
+          if (!writing_rows[i].datetime.empty())
+            db << "SELECT " + writing_rows[i].datetime + ";" >> julianday;
+          inserter(julianday, writing_rows[i].data);
+        } catch (sqlite::sqlite_exception &e) {
+          // some errors (e.g. SQLITE_FULL) roll back the whole transaction
+          if (sqlite3_get_autocommit(db.connection().get())) throw;
+          ++num_failed_insert;
+          CLOG(ERROR, logger.c_str()) << e.what();
+        }
+      }
+      db << "COMMIT;";
+      num_failed_batch = num_failed_insert;
+    } catch (sqlite::sqlite_exception &e) {
+      CLOG(ERROR, logger.c_str()) << e.what();
+      rollback();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      num_written_ += end - begin - num_failed_batch;
+      num_failed_ += num_failed_batch;
+    }
+    flushed_cv.notify_all();
+  }  // write_batch
+
+  // roll back the transaction, if it is left open by the failed statement
+  void rollback() {
+    if (sqlite3_get_autocommit(db.connection().get())) return;
+    try {
+      db << "ROLLBACK;";
+    } catch (sqlite::sqlite_exception &e) {
+      CLOG(ERROR, logger.c_str()) << e.what();
+    }
+  }  // rollback
+
+};  // end class db_writer
+
+}  // namespace ASV::common
+
+#endif /* _DATAWRITER_H_ */
@@ -0,0 +1,270 @@
+/*
+***********************************************************************
+* testcolumn.cc:
+* unit test for the binary columnar format: recording, crash recovery,
+* zero-copy reading and the conversion from/to sqlite3. The cost of
+* recording and reading radar spokes is compared with sqlite3.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include <ctime>
+#include <numeric>
+#include "../include/columnconverter.h"
+
+namespace fs = std::filesystem;
+
+const std::string testfolder = "../../data/columntest/";
+const std::string config_path = "../../config/dbconfig.json";
+
+// a new folder for each test case
+std::string new_folder(const std::string &_name) {
+  std::string folder = testfolder + _name + "/";
+  fs::remove_all(folder);
+  fs::create_directories(folder);
+  return folder;
+}  // new_folder
+
+ASV::common::marineradar_db_data generate_spoke(const int i) {
+  ASV::common::marineradar_db_data spoke{
+      0.0,                                  // local_time
+      360.0 * (i % 4096) / 4096,            // azimuth_deg
+      0.5 + 0.001 * (i % 7),                // sample_range
+      std::vector<uint8_t>(1024, i & 0xff)  // spokedata
+  };
+  spoke.spokedata[i % 1024] = 0xff;
+  return spoke;
+}  // generate_spoke
+
+std::size_t folder_size(const std::string &_folder) {
+  std::size_t size = 0;
+  for (auto const &entry : fs::recursive_directory_iterator(_folder))
+    if (entry.is_regular_file()) size += entry.file_size();
+  return size;
+}  // folder_size
+
+BOOST_AUTO_TEST_CASE(record_and_parse) {
+  std::string folder = new_folder("record");
+  constexpr int num_spokes = 1000;
+  {
+    ASV::common::column_recorder<ASV::common::marineradar_db_data> recorder(
+        folder, 0, 2459000.5, 4096);
+    for (int i = 0; i != num_spokes; ++i)
+      recorder.update_table(generate_spoke(i), 0.001 * i);
+    // the record earlier than the last one is rejected
+    BOOST_TEST(!recorder.update_table(generate_spoke(num_spokes), 0.0));
+    BOOST_TEST(recorder.size() == num_spokes);
+    BOOST_TEST(recorder.num_rejected() == 1);
+    BOOST_TEST(recorder.good());
+  }
+
+  ASV::common::column_parser<ASV::common::marineradar_db_data> parser(folder);
+  BOOST_TEST(parser.size() == num_spokes);
+  BOOST_TEST(parser.gettimestamp0() == 2459000.5);
+  BOOST_TEST(parser.count("SpokeData") == 1024);
+  BOOST_TEST(parser.local_time()[num_spokes - 1] == 0.001 * (num_spokes - 1));
+
+  // zero-copy columns
+  const uint8_t *spokedata = parser.column<uint8_t>("SpokeData");
+  const double *azimuth = parser.column<double>("azimuth_deg");
+  BOOST_TEST((parser.column<int>("azimuth_deg") == nullptr));
+  BOOST_TEST((parser.column<double>("unknown") == nullptr));
+  bool is_same = true;
+  for (int i = 0; i != num_spokes; ++i) {
+    auto spoke = generate_spoke(i);
+    is_same &= (azimuth[i] == spoke.azimuth_deg);
+    is_same &= std::equal(spoke.spokedata.begin(), spoke.spokedata.end(),
+                          spokedata + 1024 * i);
+  }
+  BOOST_TEST(is_same);
+
+  // time range, by the time index
+  auto [first, last] = parser.find_range(0.1, 0.2);
+  BOOST_TEST(first == 100);
+  BOOST_TEST(last == 201);
+  auto read_spokes = parser.parse_table(0.1, 0.2);
+  BOOST_TEST(read_spokes.size() == 101);
+  BOOST_TEST(read_spokes[0].sample_range == generate_spoke(100).sample_range);
+  BOOST_TEST(read_spokes[0].spokedata == generate_spoke(100).spokedata);
+}
+
+BOOST_AUTO_TEST_CASE(append_and_recover) {
+  std::string folder = new_folder("append");
+  ASV::common::gps_db_data gps{0,    1.0, 31.0, 121.0, 4, 5, 6, 7,
+                               8,    9,   10,   2,     11, 12, "51N"};
+  {
+    ASV::common::column_recorder<ASV::common::gps_db_data> recorder(
+        folder, 0, 2459000.5);
+    for (int i = 0; i != 10; ++i) recorder.update_table(gps, i);
+  }
+  // an incomplete record of latitude, as if power failed
+  std::string latitude_path = folder + "gps/GPS/latitude.col";
+  fs::resize_file(latitude_path, fs::file_size(latitude_path) - 3);
+  {
+    // the existing timestamp0 is used
+    ASV::common::column_recorder<ASV::common::gps_db_data> recorder(
+        folder, 0, 2459999.5);
+    gps.UTM_zone = "51R";
+    recorder.update_table(gps, 100);
+    BOOST_TEST(recorder.size() == 10);
+    BOOST_TEST(recorder.gettimestamp0() == 2459000.5);
+  }
+
+  ASV::common::column_parser<ASV::common::gps_db_data> parser(folder);
+  BOOST_TEST(parser.size() == 10);
+  auto read_gps = parser.parse_table(0, 1000);
+  BOOST_TEST(read_gps.size() == 10);
+  BOOST_TEST(read_gps[8].UTM_zone == "51N");
+  BOOST_TEST(read_gps[8].local_time == 8);
+  BOOST_TEST(read_gps[9].UTM_zone == "51R");
+  BOOST_TEST(read_gps[9].local_time == 100);
+  BOOST_TEST(read_gps[9].status == 2);
+
+  // chunks
+  std::size_t num_chunks = 0;
+  BOOST_TEST(parser.parse_table(
+                 0, 1000,
+                 [&](std::vector<ASV::common::gps_db_data> &) { ++num_chunks; },
+                 3) == 10);
+  BOOST_TEST(num_chunks == 4);
+  BOOST_CHECK_THROW(
+      ASV::common::column_parser<ASV::common::wind_db_data>{folder},
+      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(conversion) {
+  std::string sqlite_folder = new_folder("sqlite");
+  std::string column_folder = new_folder("column");
+  std::string sqlite_folder2 = new_folder("sqlite2");
+  constexpr int num_rows = 100;
+  {
+    ASV::common::wind_db wind_db(sqlite_folder, config_path);
+    ASV::common::controller_db controller_db(sqlite_folder, config_path);
+    wind_db.create_table();
+    controller_db.create_table();
+    for (int i = 0; i != num_rows; ++i) {
+      wind_db.update_table(ASV::common::wind_db_data{0, 0.1 * i, -1.0 * i});
+      controller_db.update_TA_table(ASV::common::control_TA_db_data{
+          0,              // local_time
+          1.0 * i,        // desired_Fx
+          2,              // desired_Fy
+          3,              // desired_Mz
+          4,              // est_Fx
+          5,              // est_Fy
+          6,              // est_Mz
+          {i, -i, 2 * i}, // alpha
+          {7, 8, i}       // rpm
+      });
+    }
+  }
+
+  auto num_columns = ASV::common::convert_db_to_column(
+      sqlite_folder, config_path, column_folder);
+  BOOST_TEST(num_columns["wind/wind"] == num_rows);
+  BOOST_TEST(num_columns["controller/TA"] == num_rows);
+  BOOST_TEST(num_columns["controller/setpoint"] == 0);
+  BOOST_TEST(!fs::exists(column_folder + "controller/setpoint"));
+
+  auto num_db = ASV::common::convert_column_to_db(column_folder, sqlite_folder2,
+                                                  config_path);
+  BOOST_TEST(num_db["wind/wind"] == num_rows);
+  BOOST_TEST(num_db["controller/TA"] == num_rows);
+
+  // sqlite -> column -> sqlite
+  ASV::common::control_parser parser(sqlite_folder, config_path);
+  ASV::common::control_parser parser2(sqlite_folder2, config_path);
+  ASV::common::column_parser<ASV::common::control_TA_db_data> column_parser(
+      column_folder);
+  auto TA = parser.parse_TA_table(-100, 100);
+  auto TA2 = parser2.parse_TA_table(-100, 100);
+  auto TA_column = column_parser.parse_table(-100, 100);
+  BOOST_TEST(TA.size() == num_rows);
+  BOOST_TEST(TA2.size() == num_rows);
+  BOOST_TEST(TA_column.size() == num_rows);
+  for (std::size_t i = 0; i != TA.size(); ++i) {
+    BOOST_TEST(TA[i].local_time == TA_column[i].local_time);
+    BOOST_TEST(std::abs(TA[i].local_time - TA2[i].local_time) < 1e-3);
+    BOOST_TEST(TA[i].desired_Fx == TA_column[i].desired_Fx);
+    BOOST_TEST(TA[i].desired_Fx == TA2[i].desired_Fx);
+    BOOST_TEST(TA[i].alpha == TA_column[i].alpha);
+    BOOST_TEST(TA[i].alpha == TA2[i].alpha);
+    BOOST_TEST(TA[i].rpm == TA2[i].rpm);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(radar_benchmark) {
+  // one minute of radar spokes (4096 spokes per 2.5s)
+  constexpr int num_spokes = 4096 * 24;
+  std::string sqlite_folder = new_folder("radar_sqlite");
+  std::string column_folder = new_folder("radar_column");
+  std::vector<ASV::common::marineradar_db_data> spokes;
+  for (int i = 0; i != num_spokes; ++i) spokes.push_back(generate_spoke(i));
+
+  using clock = std::chrono::steady_clock;
+  auto cpu_ms = []() { return 1e3 * std::clock() / CLOCKS_PER_SEC; };
+
+  auto t0 = clock::now();
+  double c0 = cpu_ms();
+  {
+    ASV::common::marineradar_db marineradar_db(
+        sqlite_folder, config_path, "julianday('now')",
+        ASV::common::db_writer_config{num_spokes, 512, 200, true});
+    marineradar_db.create_table();
+    for (auto const &spoke : spokes) marineradar_db.update_table(spoke);
+    marineradar_db.flush();
+  }
+  double sqlite_write_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+  double sqlite_write_cpu_ms = cpu_ms() - c0;
+
+  t0 = clock::now();
+  c0 = cpu_ms();
+  {
+    ASV::common::column_recorder<ASV::common::marineradar_db_data> recorder(
+        column_folder);
+    for (auto const &spoke : spokes) recorder.update_table(spoke);
+  }
+  double column_write_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+  double column_write_cpu_ms = cpu_ms() - c0;
+
+  // read all the spokes
+  t0 = clock::now();
+  ASV::common::marineradar_parser sqlite_parser(sqlite_folder, config_path);
+  std::size_t num_sqlite = sqlite_parser.parse_table(
+      -1e6, 1e6, [](std::vector<ASV::common::marineradar_db_data> &) {});
+  double sqlite_read_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+  t0 = clock::now();
+  ASV::common::column_parser<ASV::common::marineradar_db_data> column_parser(
+      column_folder);
+  std::size_t num_column = column_parser.parse_table(
+      -1e6, 1e6, [](std::vector<ASV::common::marineradar_db_data> &) {});
+  double column_read_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+  // zero-copy: sum of one column
+  t0 = clock::now();
+  const double *azimuth = column_parser.column<double>("azimuth_deg");
+  double sum = std::accumulate(azimuth, azimuth + column_parser.size(), 0.0);
+  double column_scan_ms =
+      std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+  std::cout << "spokes: " << num_spokes
+            << "\nwrite(ms, cpu ms): sqlite " << sqlite_write_ms << ", "
+            << sqlite_write_cpu_ms << " | column " << column_write_ms << ", "
+            << column_write_cpu_ms
+            << "\ndisk(MB): sqlite " << folder_size(sqlite_folder) / 1e6
+            << " | column " << folder_size(column_folder) / 1e6
+            << "\nread(ms): sqlite " << sqlite_read_ms << " | column "
+            << column_read_ms << " | one column in place " << column_scan_ms
+            << std::endl;
+  BOOST_TEST(num_sqlite == static_cast<std::size_t>(num_spokes));
+  BOOST_TEST(num_column == static_cast<std::size_t>(num_spokes));
+  BOOST_TEST(sum > 0);
+  BOOST_TEST(column_write_cpu_ms < sqlite_write_cpu_ms);
+}
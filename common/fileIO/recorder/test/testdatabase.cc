@@ -57,6 +57,7 @@ BOOST_AUTO_TEST_CASE(GPS) {
     gps_db.update_imu_table(imu_db_data);
   }
 
+  gps_db.flush();
   // parse
   ASV::common::GPS_parser GPS_parser(folderp, config_path);
   auto read_gps = GPS_parser.parse_gps_table(starting_time, end_time);
@@ -104,6 +105,7 @@ BOOST_AUTO_TEST_CASE(wind) {
   wind_db.create_table();
   wind_db.update_table(wind_db_data);
 
+  wind_db.flush();
   // parse
   ASV::common::wind_parser wind_parser(folderp, config_path);
   auto read_wind = wind_parser.parse_table(starting_time, end_time);
@@ -136,6 +138,7 @@ BOOST_AUTO_TEST_CASE(stm32) {
   ASV::common::stm32_db stm32_db(folderp, config_path);
   stm32_db.create_table();
   stm32_db.update_table(stm32_db_data);
+  stm32_db.flush();
   // parse
   ASV::common::stm32_parser stm32_parser(folderp, config_path);
   auto read_stm32 = stm32_parser.parse_table(starting_time, end_time);
@@ -160,6 +163,7 @@ BOOST_AUTO_TEST_CASE(marineradar) {
   marineradar_db.create_table();
   marineradar_db.update_table(marineradar_db_data);
 
+  marineradar_db.flush();
   // parse
   ASV::common::marineradar_parser marineradar_parser(folderp, config_path);
   auto read_marineradar =
@@ -213,6 +217,7 @@ BOOST_AUTO_TEST_CASE(estimator) {
   estimator_db.update_state_table(est_state_db_data);
   estimator_db.update_error_table(est_error_db_data);
 
+  estimator_db.flush();
   // parse
   ASV::common::estimator_parser estimator_parser(folderp, config_path);
   auto read_measurement =
@@ -284,6 +289,7 @@ BOOST_AUTO_TEST_CASE(planner) {
   planner_db.update_routeplanner_table(plan_route_db_data);
   planner_db.update_latticeplanner_table(plan_lattice_db_data);
 
+  planner_db.flush();
   // parse
   ASV::common::planner_parser planner_parser(folderp, config_path);
   auto read_route = planner_parser.parse_route_table(starting_time, end_time);
@@ -325,6 +331,7 @@ BOOST_AUTO_TEST_CASE(control) {
   controller_db.update_setpoint_table(control_setpoint_db_data);
   controller_db.update_TA_table(control_TA_db_data);
 
+  controller_db.flush();
   // parse
   ASV::common::control_parser control_parser(folderp, config_path);
   auto read_setpoint =
@@ -401,6 +408,7 @@ BOOST_AUTO_TEST_CASE(perception) {
           std::vector<double>(targets_TCPA.data(),
                               targets_TCPA.data() + num_target)  // targets_TCPA
       });
+  perception_db.flush();
   // parse
   ASV::common::perception_parser perception_parser(folderp, config_path);
   auto read_spoke =
@@ -412,3 +420,195 @@ BOOST_AUTO_TEST_CASE(perception) {
     std::cout << value.local_time << std::endl;
   }
 }
+
+BOOST_AUTO_TEST_CASE(writer) {
+  // radar spokes, ~60 times faster than the radar (4096 spokes per 2.5s):
+  // the rows are queued without waiting for the disk, and committed in
+  // batches by the writer thread
+  constexpr int num_spokes = 4096 * 5;
+  ASV::common::marineradar_db_data spoke{
+      -1,                              // local_time
+      0,                               // azimuth_deg
+      0.9999,                          // sample_range
+      std::vector<uint8_t>(512, 0x5a)  // spokedata
+  };
+  ASV::common::marineradar_db marineradar_db(folderp, config_path);
+  marineradar_db.create_table();
+  int num_rows_before = 0;
+  sqlite::database db(folderp + "marineradar.db");
+  db << "select count(*) from radar;" >> num_rows_before;
+
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  double sum_push_us = 0;
+  double max_push_us = 0;
+  for (int i = 0; i != num_spokes; ++i) {
+    spoke.azimuth_deg = 360.0 * (i % 4096) / 4096;
+    auto t0 = clock::now();
+    marineradar_db.update_table(spoke);
+    double push_us =
+        std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+    sum_push_us += push_us;
+    max_push_us = std::max(max_push_us, push_us);
+    if (i % 256 == 255)
+      std::this_thread::sleep_for(std::chrono::microseconds(2500));
+  }
+  marineradar_db.flush();
+  double write_s = std::chrono::duration<double>(clock::now() - start).count();
+
+  int num_rows_after = 0;
+  db << "select count(*) from radar;" >> num_rows_after;
+  const auto &writer = marineradar_db.getwriter();
+  std::cout << "spokes: " << num_spokes
+            << ", push(us): " << sum_push_us / num_spokes << " mean, "
+            << max_push_us << " max, total(ms): " << 1e3 * write_s
+            << ", max queue depth: " << writer.max_queue_depth()
+            << ", dropped: " << writer.num_dropped() << std::endl;
+  BOOST_TEST(num_rows_after - num_rows_before ==
+             static_cast<int>(writer.num_written()));
+  BOOST_TEST(writer.num_written() == static_cast<std::size_t>(num_spokes));
+  BOOST_TEST(writer.num_dropped() == 0);
+  BOOST_TEST(writer.num_failed() == 0);
+  BOOST_TEST(writer.queue_depth() == 0);
+
+  // the new rows are dropped, instead of blocking, if the queue is full
+  ASV::common::wind_db wind_db(folderp, config_path, "julianday('now')",
+                               ASV::common::db_writer_config{
+                                   4,     // max_queue_size
+                                   1000,  // batch_size
+                                   1000,  // commit_interval_ms
+                                   true   // WAL_mode
+                               });
+  wind_db.create_table();
+  for (int i = 0; i != 100; ++i)
+    wind_db.update_table(ASV::common::wind_db_data{-1, 1.0 * i, 0});
+  wind_db.flush();
+  BOOST_TEST(wind_db.getwriter().num_written() == 4);
+  BOOST_TEST(wind_db.getwriter().num_dropped() == 96);
+}
+
+BOOST_AUTO_TEST_CASE(writer_commit) {
+  // a deferred foreign key is checked at COMMIT: a batch which fails to
+  // commit is counted as failed, and is not written
+  sqlite::database db(folderp + "deferred.db");
+  db << "PRAGMA foreign_keys=ON;";
+  db << "DROP TABLE IF EXISTS child;";
+  db << "DROP TABLE IF EXISTS parent;";
+  db << "CREATE TABLE parent (ID INTEGER PRIMARY KEY);";
+  db << "CREATE TABLE child (parent_ID INTEGER REFERENCES parent(ID) "
+        "DEFERRABLE INITIALLY DEFERRED);";
+  db << "INSERT INTO parent VALUES (1);";
+
+  ASV::common::db_writer<int> writer(db, "deferred",
+                                     ASV::common::db_writer_config{
+                                         100,   // max_queue_size
+                                         10,    // batch_size
+                                         1000,  // commit_interval_ms
+                                         false  // WAL_mode
+                                     });
+  writer.start([&db](const double, const std::variant<int> &row) {
+    db << "INSERT INTO child VALUES (?);" << std::get<int>(row);
+  });
+  for (int i = 0; i != 10; ++i) writer.push(1);
+  writer.flush();
+  for (int i = 0; i != 10; ++i) writer.push((i == 5) ? 2 : 1);
+  writer.flush();
+  for (int i = 0; i != 10; ++i) writer.push(1);
+  writer.flush();
+  writer.stop();
+
+  int num_rows = 0;
+  db << "select count(*) from child;" >> num_rows;
+  BOOST_TEST(writer.num_written() == 20);
+  BOOST_TEST(writer.num_failed() == 10);
+  BOOST_TEST(num_rows == 20);
+}
+
+// the rows of wind table, read by one query per ID
+std::vector<ASV::common::wind_db_data> parse_wind_by_id(
+    sqlite::database &_db, const double _timestamp0, const double start_time,
+    const double end_time) {
+  std::vector<ASV::common::wind_db_data> v_wind_db_data;
+  int max_id = 0;
+  _db << "select MAX(ID) from wind;" >> max_id;
+  for (int i = 0; i != max_id; i++) {
+    _db << "select DATETIME, speed, orientation from wind where ID= ?;"
+        << i + 1 >>
+        [&](std::string local_time, double speed, double orientation) {
+          double _local_time_s =
+              86400.0 * (atof(local_time.c_str()) - _timestamp0);
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time))
+            v_wind_db_data.push_back(
+                ASV::common::wind_db_data{_local_time_s, speed, orientation});
+        };
+  }
+  return v_wind_db_data;
+}  // parse_wind_by_id
+
+BOOST_AUTO_TEST_CASE(parser) {
+  // a trial of 6 hours at 1 Hz, 1000 s after the master time
+  constexpr int num_rows = 6 * 3600;
+  ASV::common::wind_db wind_db(folderp, config_path);
+  wind_db.create_table();
+  double timestamp0 = 0;
+  sqlite::database master(folderp + "master.db");
+  master << "select DATETIME from info where ID = 1;" >>
+      [&](std::string _datetime) { timestamp0 = atof(_datetime.c_str()); };
+  sqlite::database db(folderp + "wind.db");
+  db << "BEGIN;";
+  for (int i = 0; i != num_rows; ++i)
+    db << "INSERT INTO wind (DATETIME, speed, orientation) VALUES(?, ?, ?);"
+       << timestamp0 + (1000.5 + i) / 86400.0 << 0.01 * i << 0.5;
+  db << "COMMIT;";
+
+  // 10 s in the middle of the trial
+  const double window_start = 1000 + 3 * 3600;
+  const double window_end = window_start + 10;
+  using clock = std::chrono::steady_clock;
+  auto t0 = clock::now();
+  auto read_by_id = parse_wind_by_id(db, timestamp0, window_start, window_end);
+  auto t1 = clock::now();
+  ASV::common::wind_parser wind_parser(folderp, config_path);
+  auto read_wind = wind_parser.parse_table(window_start, window_end);
+  auto t2 = clock::now();
+  std::cout << "rows: " << read_wind.size() << ", by ID(ms): "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << ", range(ms): "
+            << std::chrono::duration<double, std::milli>(t2 - t1).count()
+            << std::endl;
+
+  BOOST_TEST(read_wind.size() == 10);
+  BOOST_TEST(read_wind.size() == read_by_id.size());
+  for (std::size_t i = 0; i != read_wind.size(); ++i) {
+    BOOST_TEST(read_wind[i].local_time == read_by_id[i].local_time);
+    BOOST_TEST(read_wind[i].speed == read_by_id[i].speed);
+  }
+
+  // the index of DATETIME is created by the parser
+  int num_index = 0;
+  db << "select count(*) from sqlite_master where type = 'index' and "
+        "name = 'wind_DATETIME';" >>
+      num_index;
+  BOOST_TEST(num_index == 1);
+
+  // the whole trial in chunks
+  std::size_t num_chunks = 0;
+  std::size_t max_chunk_size = 0;
+  double last_time = -1;
+  bool is_ordered = true;
+  std::size_t num_parsed = wind_parser.parse_table(
+      1000, 1000 + num_rows,
+      [&](std::vector<ASV::common::wind_db_data> &_chunk) {
+        ++num_chunks;
+        max_chunk_size = std::max(max_chunk_size, _chunk.size());
+        for (auto const &value : _chunk) {
+          is_ordered &= (last_time < value.local_time);
+          last_time = value.local_time;
+        }
+      },
+      500);
+  BOOST_TEST(num_parsed == static_cast<std::size_t>(num_rows));
+  BOOST_TEST(num_chunks == (num_rows + 499) / 500);
+  BOOST_TEST(max_chunk_size == 500);
+  BOOST_TEST(is_ordered);
+}
@@ -0,0 +1,231 @@
+/*
+***********************************************************************
+* ReedsSheppTable.h:
+* Lookup table of the Reeds Shepp distance, over the relative pose
+* (dx, dy, dtheta) in the frame of the starting state, normalized by
+* the turning radius. Between the grid points, a lower bound of the
+* distance is given by the triangle inequality, so that it is admissible
+* as a heuristic. The table can be cached to disk.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _REEDS_SHEPP_TABLE_H_
+#define _REEDS_SHEPP_TABLE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Reeds_Shepp.h"
+
+namespace ASV::common::math {
+
+class ReedsSheppLookupTable {
+ public:
+  // max_xy and resolution_xy are in units of the turning radius
+  explicit ReedsSheppLookupTable(double turningRadius = 1.0,
+                                 double max_xy = 10.0,
+                                 double resolution_xy = 0.2,
+                                 int num_theta = 72)
+      : rho_(turningRadius),
+        max_xy_(max_xy),
+        resolution_xy_(resolution_xy),
+        resolution_theta_(2 * M_PI / num_theta),
+        num_x_(2 * static_cast<int>(std::round(max_xy / resolution_xy)) + 1),
+        num_y_(static_cast<int>(std::round(max_xy / resolution_xy)) + 1),
+        num_theta_(num_theta),
+        error_bound_(0.0),
+        rscurve_(turningRadius) {}
+  virtual ~ReedsSheppLookupTable() = default;
+
+  // load the cached table, or generate (and cache) it if the file does not
+  // exist or was generated with different parameters
+  ReedsSheppLookupTable &load_or_generate(const std::string &filename) {
+    if (!load(filename)) {
+      generate();
+      save(filename);
+    }
+    return *this;
+  }  // load_or_generate
+
+  // evaluate the normalized RS distance at each grid point
+  ReedsSheppLookupTable &generate() {
+    ReedsSheppStateSpace unit_rscurve(1.0);
+    table_.resize(static_cast<std::size_t>(num_x_) * num_y_ * num_theta_);
+    for (int ix = 0; ix != num_x_; ++ix)
+      for (int iy = 0; iy != num_y_; ++iy)
+        for (int it = 0; it != num_theta_; ++it)
+          table_[index(ix, iy, it)] = static_cast<float>(
+              unit_rscurve.rs_distance({0, 0, 0}, {grid_x(ix), grid_y(iy),
+                                                   grid_theta(it)}));
+    error_bound_ = compute_error_bound();
+    return *this;
+  }  // generate
+
+  // return true if the table is loaded with the same parameters
+  bool load(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return false;
+
+    Header header;
+    file.read(reinterpret_cast<char *>(&header), sizeof(Header));
+    if (!file || std::memcmp(header.magic, magic_, sizeof(magic_)) != 0 ||
+        !(header == generate_header()))
+      return false;
+
+    std::vector<float> table(static_cast<std::size_t>(num_x_) * num_y_ *
+                             num_theta_);
+    file.read(reinterpret_cast<char *>(table.data()),
+              table.size() * sizeof(float));
+    if (!file) return false;
+
+    table_ = std::move(table);
+    error_bound_ = compute_error_bound();
+    return true;
+  }  // load
+
+  // return true if the table is written
+  bool save(const std::string &filename) const {
+    if (table_.empty()) return false;
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    Header header = generate_header();
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char *>(table_.data()),
+               table_.size() * sizeof(float));
+    return static_cast<bool>(file);
+  }  // save
+
+  // lower bound of the RS distance from q0 to q1, within 2 * error_bound()
+  // of the exact one; the exact one is computed if the relative pose is out
+  // of the table
+  double rs_distance(const std::array<double, 3> &q0,
+                     const std::array<double, 3> &q1) const {
+    double dx = q1[0] - q0[0];
+    double dy = q1[1] - q0[1];
+    double c = std::cos(q0[2]);
+    double s = std::sin(q0[2]);
+    double x = (c * dx + s * dy) / rho_;
+    double y = (-s * dx + c * dy) / rho_;
+    double phi = q1[2] - q0[2];
+
+    if (table_.empty() || std::fabs(x) > max_xy_ || std::fabs(y) > max_xy_)
+      return rscurve_.rs_distance(q0, q1);
+
+    // RS distance is symmetric about the x axis: (x, y, phi) -> (x, -y, -phi)
+    if (y < 0) {
+      y = -y;
+      phi = -phi;
+    }
+    // the path is not shorter than the segment, or the arc of the heading
+    double phi_pi = std::fabs(std::remainder(phi, 2 * M_PI));
+    return rho_ *
+           std::max({lowerbound(x, y, phi), std::hypot(x, y), phi_pi});
+  }  // rs_distance
+
+  // upper bound of the RS distance from a pose to its nearest grid point
+  double error_bound() const noexcept { return rho_ * error_bound_; }
+  bool empty() const noexcept { return table_.empty(); }
+  std::size_t size() const noexcept { return table_.size(); }
+
+ private:
+  struct Header {
+    char magic[4];
+    std::int32_t num_x;
+    std::int32_t num_y;
+    std::int32_t num_theta;
+    double max_xy;
+    double resolution_xy;
+
+    bool operator==(const Header &rhs) const {
+      return num_x == rhs.num_x && num_y == rhs.num_y &&
+             num_theta == rhs.num_theta && max_xy == rhs.max_xy &&
+             resolution_xy == rhs.resolution_xy;
+    }
+  };
+
+  static constexpr char magic_[4] = {'R', 'S', 'L', 'T'};
+
+  const double rho_;  // TURNNING RADIUS
+  const double max_xy_;
+  const double resolution_xy_;
+  const double resolution_theta_;
+  const int num_x_;  // x in [-max_xy, max_xy]
+  const int num_y_;  // y in [0, max_xy], using the symmetry
+  const int num_theta_;  // theta in [-pi, pi)
+  double error_bound_;   // normalized, see compute_error_bound()
+
+  ReedsSheppStateSpace rscurve_;
+  std::vector<float> table_;
+
+  Header generate_header() const {
+    Header header;
+    std::memcpy(header.magic, magic_, sizeof(magic_));
+    header.num_x = num_x_;
+    header.num_y = num_y_;
+    header.num_theta = num_theta_;
+    header.max_xy = max_xy_;
+    header.resolution_xy = resolution_xy_;
+    return header;
+  }  // generate_header
+
+  std::size_t index(int ix, int iy, int it) const {
+    return (static_cast<std::size_t>(ix) * num_y_ + iy) * num_theta_ + it;
+  }
+  double grid_x(int ix) const { return -max_xy_ + ix * resolution_xy_; }
+  double grid_y(int iy) const { return iy * resolution_xy_; }
+  double grid_theta(int it) const { return -M_PI + it * resolution_theta_; }
+
+  // the lower bound given by the nearest grid point c, as
+  // d(0, q) >= d(0, c) - d(c, q) >= d(0, c) - error_bound; theta is periodic
+  double lowerbound(double x, double y, double phi) const {
+    double fx = (x + max_xy_) / resolution_xy_;
+    double fy = y / resolution_xy_;
+    double ft = (phi + M_PI) / resolution_theta_;
+    ft -= num_theta_ * std::floor(ft / num_theta_);
+
+    int ix = std::min(static_cast<int>(std::lround(fx)), num_x_ - 1);
+    int iy = std::min(static_cast<int>(std::lround(fy)), num_y_ - 1);
+    int it = static_cast<int>(std::lround(ft)) % num_theta_;
+    return table_[index(ix, iy, it)] - error_bound_;
+  }  // lowerbound
+
+  // max normalized RS distance between a pose and its nearest grid point,
+  // i.e. over the offsets |(dx, dy)| <= sqrt(2)/2 * resolution_xy and
+  // |dtheta| <= resolution_theta/2 in any frame. The max is sampled on a
+  // polar grid, which is widened by 10% and padded with the rounding error
+  // of the float table.
+  double compute_error_bound() const {
+    ReedsSheppStateSpace unit_rscurve(1.0);
+    const int num_sample = 10;
+    const double max_r = 1.1 * std::sqrt(0.5) * resolution_xy_;
+    const double max_theta = 1.1 * 0.5 * resolution_theta_;
+    double max_distance = 0.0;
+    for (int i = 0; i <= num_sample; ++i)
+      for (int j = 0; j != 4 * num_sample; ++j)
+        for (int k = -num_sample; k <= num_sample; ++k) {
+          double r = max_r * i / num_sample;
+          double angle = 2 * M_PI * j / (4 * num_sample);
+          max_distance = std::max(
+              max_distance,
+              unit_rscurve.rs_distance(
+                  {0, 0, 0}, {r * std::cos(angle), r * std::sin(angle),
+                              max_theta * k / num_sample}));
+        }
+    float max_table = *std::max_element(table_.begin(), table_.end());
+    return max_distance +
+           4 * std::numeric_limits<float>::epsilon() * max_table;
+  }  // compute_error_bound
+
+};  // end class ReedsSheppLookupTable
+
+}  // namespace ASV::common::math
+
+#endif /* _REEDS_SHEPP_TABLE_H_ */
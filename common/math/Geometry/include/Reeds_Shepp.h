@@ -14,6 +14,7 @@
 #define _REEDS_SHEPP_H_
 
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <limits>
 #include <tuple>
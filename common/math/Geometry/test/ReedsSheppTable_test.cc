@@ -0,0 +1,120 @@
+/*
+***********************************************************************
+* ReedsSheppTable_test.cc:
+* test for the lookup table of Reeds Shepp distance, which must be a
+* lower bound of the exact distance (admissible heuristic)
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include "../include/ReedsSheppTable.h"
+#include <boost/test/included/unit_test.hpp>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+using namespace ASV::common::math;
+
+BOOST_AUTO_TEST_CASE(GridPoint) {
+  const double rho = 3.0;
+  ReedsSheppStateSpace rscurve(rho);
+  ReedsSheppLookupTable rstable(rho, 4.0, 0.5, 36);
+  rstable.generate();
+  BOOST_CHECK_EQUAL(rstable.size(), 17 * 9 * 36);
+
+  // at the grid points, at any starting state, the table is a lower bound
+  // within the error bound
+  std::array<double, 3> q0 = {1.0, -2.0, 0.3};
+  for (double x : {-4.0, -1.5, 0.0, 2.5}) {
+    for (double y : {-3.0, 0.0, 1.0, 4.0}) {
+      for (double theta : {-M_PI, -0.5 * M_PI, 0.0, 5 * M_PI / 18}) {
+        std::array<double, 3> q1 = {
+            q0[0] + rho * (std::cos(q0[2]) * x - std::sin(q0[2]) * y),
+            q0[1] + rho * (std::sin(q0[2]) * x + std::cos(q0[2]) * y),
+            q0[2] + theta};
+        double exact = rscurve.rs_distance(q0, q1);
+        double lowerbound = rstable.rs_distance(q0, q1);
+        BOOST_CHECK_LE(lowerbound, exact + 1e-6);
+        BOOST_CHECK_GE(lowerbound, exact - rstable.error_bound() - 1e-6);
+      }
+    }
+  }
+
+  // out of the table, the exact distance is given
+  std::array<double, 3> q1 = {30.0, 40.0, 1.0};
+  BOOST_CHECK_CLOSE(rstable.rs_distance(q0, q1), rscurve.rs_distance(q0, q1),
+                    1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(Cache) {
+  const std::string filename = "rstable_test.bin";
+  ReedsSheppLookupTable rstable(2.0, 3.0, 0.5, 24);
+  rstable.load_or_generate(filename);
+  BOOST_CHECK(!rstable.empty());
+
+  ReedsSheppLookupTable rstable_cached(2.0, 3.0, 0.5, 24);
+  BOOST_CHECK(rstable_cached.load(filename));
+  std::array<double, 3> q0 = {0.0, 0.0, 0.0};
+  std::array<double, 3> q1 = {1.3, -2.1, 2.0};
+  BOOST_CHECK_CLOSE(rstable.rs_distance(q0, q1),
+                    rstable_cached.rs_distance(q0, q1), 1e-9);
+
+  // the table with different parameters is not loaded
+  ReedsSheppLookupTable rstable_other(2.0, 3.0, 0.25, 24);
+  BOOST_CHECK(!rstable_other.load(filename));
+
+  std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(Admissibility) {
+  const double rho = 1.0 / 0.3;
+  ReedsSheppStateSpace rscurve(rho);
+  ReedsSheppLookupTable rstable(rho);
+  rstable.generate();
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> distribution_xy(-10 * rho, 10 * rho);
+  // close to the start, where the RS distance is steep
+  std::uniform_real_distribution<double> distribution_near(-rho, rho);
+  std::uniform_real_distribution<double> distribution_theta(-M_PI, M_PI);
+
+  const int num_sample = 100000;
+  double max_overestimate = 0.0;
+  double max_relative_overestimate = 0.0;
+  double max_underestimate = 0.0;
+  double mean_abs_error = 0.0;
+  int num_overestimate = 0;
+  for (int i = 0; i != num_sample; ++i) {
+    std::array<double, 3> q0 = {0.0, 0.0, distribution_theta(generator)};
+    auto &distribution = (i % 2 == 0) ? distribution_xy : distribution_near;
+    std::array<double, 3> q1 = {distribution(generator),
+                                distribution(generator),
+                                distribution_theta(generator)};
+    double exact = rscurve.rs_distance(q0, q1);
+    double error = rstable.rs_distance(q0, q1) - exact;
+    mean_abs_error += std::fabs(error) / num_sample;
+    max_underestimate = std::fmax(max_underestimate, -error);
+    if (error > 1e-6) {
+      ++num_overestimate;
+      max_overestimate = std::fmax(max_overestimate, error);
+      max_relative_overestimate =
+          std::fmax(max_relative_overestimate, error / exact);
+    }
+  }
+
+  std::cout << "RS lookup table (" << rstable.size() << " entries)\n"
+            << "mean absolute error: " << mean_abs_error << " m\n"
+            << "overestimate: " << num_overestimate << " of " << num_sample
+            << " samples\n"
+            << "max overestimate: " << max_overestimate << " m ("
+            << 100 * max_relative_overestimate << "%)\n"
+            << "max underestimate: " << max_underestimate
+            << " m, error bound: " << rstable.error_bound() << " m\n";
+
+  // admissible, and the error is bounded by the grid
+  BOOST_CHECK_EQUAL(num_overestimate, 0);
+  BOOST_CHECK_LE(max_overestimate, 1e-6);
+  BOOST_CHECK_LE(max_underestimate, 2 * rstable.error_bound());
+}
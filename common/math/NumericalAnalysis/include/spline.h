@@ -103,7 +103,7 @@ class spline {
     if (cubic_spline == true) {  // cubic spline interpolation
       // setting up the matrix and right hand side of the equation system
       // for the parameters b[]
-      Eigen::MatrixXd A(n, n);
+      Eigen::MatrixXd A = Eigen::MatrixXd::Zero(n, n);
       Eigen::VectorXd rhs(n);
       for (std::size_t i = 1; i < n - 1; i++) {
         A(i, i - 1) = 1.0 / 3.0 * (m_x(i) - m_x(i - 1));
@@ -304,14 +304,39 @@ class Spline2D {
     // dkappa = ((dddy * dx - dddx * dy) * squareterm -
     //           3 * (ddy * dx - ddx * dy) * (dx * ddx + dy * ddy)) /
     //          std::pow(squareterm, 2.5);
-    // avoid using sqrt to speed up
+    // avoid using sqrt to speed up, which is the exact derivative of the
+    // kappa given by compute_curvature
     double dkappa = ((dddy * dx - dddx * dy) * squareterm -
-                     3 * (ddy * dx - ddx * dy) * (dx * ddx + dy * ddy)) /
+                     2 * (ddy * dx - ddx * dy) * (dx * ddx + dy * ddy)) /
                     (squareterm * squareterm);
 
     return dkappa;
   }  // compute_dcurvature
 
+  // calculate the second derivative of curvature to arclength, where the
+  // fourth derivative of the cubic spline is zero
+  double compute_ddcurvature(double _arclength) const {
+    double dx = SX_.deriv(1, _arclength);
+    double ddx = SX_.deriv(2, _arclength);
+    double dddx = SX_.deriv(3, _arclength);
+    double dy = SY_.deriv(1, _arclength);
+    double ddy = SY_.deriv(2, _arclength);
+    double dddy = SY_.deriv(3, _arclength);
+
+    double squareterm = dx * dx + dy * dy;
+    double dsquareterm = 2 * (dx * ddx + dy * ddy);
+    double cross = ddy * dx - ddx * dy;
+    double dcross = dddy * dx - dddx * dy;
+    // dkappa = numerator / squareterm^2
+    double numerator = dcross * squareterm - cross * dsquareterm;
+    double dnumerator =
+        (dddy * ddx - dddx * ddy) * squareterm -
+        2 * cross * (ddx * ddx + dx * dddx + ddy * ddy + dy * dddy);
+
+    return (dnumerator * squareterm - 2 * numerator * dsquareterm) /
+           (squareterm * squareterm * squareterm);
+  }  // compute_ddcurvature
+
   // calculate the orientation based on the arclength
   double compute_yaw(double _arclength) const {
     double dx = SX_.deriv(1, _arclength);
@@ -375,6 +400,22 @@ class polynomialvalue {
     return results;
   }  // compute_order_derivative
 
+  // calculate the derivtive of polynomial at each element of _x, using the
+  // same Horner scheme as the scalar one; _results is resized only if the
+  // size of _x is changed
+  template <std::size_t _order = 0>
+  void compute_order_derivative(const Eigen::VectorXd& _x,
+                                Eigen::VectorXd& _results) const {
+    _results.setZero(_x.size());
+    if constexpr (_order <= order) {
+      for (std::size_t i = 0; i != (order + 1 - _order); i++) {
+        std::size_t t_order = 1;
+        for (std::size_t j = 0; j != _order; j++) t_order *= (order - i - j);
+        _results.array() = _results.array() * _x.array() + t_order * a(i);
+      }
+    }
+  }  // compute_order_derivative
+
   void setcofficient(const polyvector& _a) { a = _a; }
   polyvector getcofficient() const { return a; }
 
@@ -63,5 +63,14 @@ int main() {
   std::cout << _quintic_polynomial.compute_order_derivative<2>(3) << std::endl;
   std::cout << _quintic_polynomial.compute_order_derivative<3>(4) << std::endl;
 
+  // evaluation over a vector, which should be the same as the scalar one
+  Eigen::VectorXd t = Eigen::VectorXd::LinSpaced(5, 1, 5);
+  Eigen::VectorXd t_results;
+  _quintic_polynomial.compute_order_derivative<2>(t, t_results);
+  for (int i = 0; i != t.size(); ++i)
+    std::cout << t_results(i) - _quintic_polynomial.compute_order_derivative<2>(
+                                    t(i))
+              << std::endl;
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,190 @@
+/*
+***********************************************************************
+* streamingfilter.h: constant-time filters on a stream of samples,
+* including moving average, windowed integral, first-order exponential
+* filter and second-order Butterworth low pass. The sample type is a
+* double or a fixed-size Eigen vector.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _STREAMINGFILTER_H_
+#define _STREAMINGFILTER_H_
+
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+#include <common/math/eigen/Eigen/Core>
+#include <common/math/eigen/Eigen/Dense>
+
+namespace ASV::common::math {
+
+// zero of a double or a fixed-size Eigen vector
+template <typename T>
+T zerosample() {
+  if constexpr (std::is_arithmetic_v<T>)
+    return T(0);
+  else
+    return T::Zero();
+}  // zerosample
+
+// circular buffer of the last L samples, with a running sum. The running
+// sum drifts by rounding errors of the subtraction; every L samples it is
+// replaced by the sum of the samples pushed since last wrap, which are
+// exactly the samples in the window. So both update and correction are
+// O(1).
+template <typename T, int L>
+class slidingwindow {
+  static_assert(L > 0, "the window holds at least one sample");
+
+ public:
+  slidingwindow() { reset(zerosample<T>()); }
+
+  // fill the window with the same value
+  void reset(const T &_value) {
+    window.fill(_value);
+    index = 0;
+    running_sum = _value * static_cast<double>(L);
+    fresh_sum = zerosample<T>();
+  }  // reset
+
+  // push a new sample and drop the oldest one
+  void push(const T &_newstep) {
+    running_sum += _newstep - window[index];
+    fresh_sum += _newstep;
+    window[index] = _newstep;
+    if (++index == L) {
+      index = 0;
+      running_sum = fresh_sum;
+      fresh_sum = zerosample<T>();
+    }
+  }  // push
+
+  const T &sum() const noexcept { return running_sum; }
+  T mean() const { return running_sum / static_cast<double>(L); }
+  // the oldest sample in the window
+  const T &oldest() const noexcept { return window[index]; }
+
+ private:
+  std::array<T, L> window;
+  int index;  // position of the oldest sample
+  T running_sum;
+  T fresh_sum;  // sum of the samples pushed since index wraps
+};  // end class slidingwindow
+
+// mean value of the last L samples
+template <typename T, int L>
+class movingaverage {
+ public:
+  movingaverage() {}
+
+  void reset(const T &_value) { window.reset(_value); }
+
+  // push a new sample and return the mean value
+  T update(const T &_newstep) {
+    window.push(_newstep);
+    return window.mean();
+  }  // update
+
+  T value() const { return window.mean(); }
+
+ private:
+  slidingwindow<T, L> window;
+};  // end class movingaverage
+
+// integral of the last L samples (rectangle rule)
+template <typename T, int L>
+class windowedintegral {
+ public:
+  explicit windowedintegral(const double _sample_time)
+      : sample_time(_sample_time) {}
+
+  void reset(const T &_value) { window.reset(_value); }
+
+  // push a new sample and return the integral over the window
+  T update(const T &_newstep) {
+    window.push(_newstep);
+    return value();
+  }  // update
+
+  T value() const { return sample_time * window.sum(); }
+
+ private:
+  const double sample_time;
+  slidingwindow<T, L> window;
+};  // end class windowedintegral
+
+// first-order low pass: y += a * (x - y), where a = dt / (tau + dt)
+template <typename T>
+class exponentialfilter {
+ public:
+  explicit exponentialfilter(const double _alpha)
+      : alpha(_alpha), state(zerosample<T>()) {}
+  exponentialfilter(const double _time_constant, const double _sample_time)
+      : exponentialfilter(_sample_time / (_time_constant + _sample_time)) {}
+
+  void reset(const T &_value) { state = _value; }
+
+  T update(const T &_newstep) {
+    state += alpha * (_newstep - state);
+    return state;
+  }  // update
+
+  const T &value() const noexcept { return state; }
+
+ private:
+  const double alpha;
+  T state;
+};  // end class exponentialfilter
+
+// second-order Butterworth low pass, given by the bilinear transform with
+// pre-warping, in the transposed direct form II
+template <typename T>
+class butterworth {
+ public:
+  butterworth(const double _cutoff_frequency, const double _sample_time)
+      : b({0, 0, 0}),
+        a({0, 0}),
+        z1(zerosample<T>()),
+        z2(zerosample<T>()),
+        output(zerosample<T>()) {
+    double k = std::tan(M_PI * _cutoff_frequency * _sample_time);
+    double k2 = k * k;
+    double norm = 1.0 / (1.0 + M_SQRT2 * k + k2);
+    b[0] = k2 * norm;
+    b[1] = 2 * b[0];
+    b[2] = b[0];
+    a[0] = 2 * (k2 - 1) * norm;
+    a[1] = (1 - M_SQRT2 * k + k2) * norm;
+  }
+
+  // steady state with the output equal to _value
+  void reset(const T &_value) {
+    output = _value;
+    z1 = _value * (1.0 - b[0]);
+    z2 = _value * (b[2] - a[1]);
+  }  // reset
+
+  T update(const T &_newstep) {
+    output = b[0] * _newstep + z1;
+    z1 = b[1] * _newstep - a[0] * output + z2;
+    z2 = b[2] * _newstep - a[1] * output;
+    return output;
+  }  // update
+
+  const T &value() const noexcept { return output; }
+
+ private:
+  std::array<double, 3> b;  // numerator
+  std::array<double, 2> a;  // denominator, a0 = 1
+  T z1;
+  T z2;
+  T output;
+};  // end class butterworth
+
+}  // namespace ASV::common::math
+
+#endif /* _STREAMINGFILTER_H_ */
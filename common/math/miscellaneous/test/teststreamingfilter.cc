@@ -0,0 +1,152 @@
+/*
+***********************************************************************
+* teststreamingfilter.cc: Test the constant-time streaming filters, and
+* compare the moving average with the recomputed one
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include <chrono>
+#include <iostream>
+#include "../include/streamingfilter.h"
+
+using namespace ASV::common::math;
+
+// the moving average recomputed from the whole window at each sample
+template <int L>
+class naiveaverage {
+  using vectorld = Eigen::Matrix<double, L, 1>;
+
+ public:
+  naiveaverage() : window(vectorld::Zero()) {}
+  double update(double _newstep) {
+    vectorld t_window = vectorld::Zero();
+    t_window.head(L - 1) = window.tail(L - 1);
+    t_window(L - 1) = _newstep;
+    window = t_window;
+    return window.mean();
+  }
+
+ private:
+  vectorld window;
+};
+
+BOOST_AUTO_TEST_CASE(MovingAverage) {
+  movingaverage<double, 7> average;
+  naiveaverage<7> naive;
+  for (int i = 0; i != 100; ++i) {
+    double x = std::sin(0.3 * i) + 0.01 * i;
+    BOOST_CHECK_SMALL(average.update(x) - naive.update(x), 1e-12);
+  }
+
+  average.reset(2.5);
+  BOOST_CHECK_CLOSE(average.value(), 2.5, 1e-10);
+  BOOST_CHECK_CLOSE(average.update(9.5), 3.5, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(MovingAverageVector) {
+  movingaverage<Eigen::Vector3d, 3> average;
+  average.update(Eigen::Vector3d(3, 6, 9));
+  average.update(Eigen::Vector3d(3, 0, 0));
+  Eigen::Vector3d mean = average.update(Eigen::Vector3d(3, 0, -9));
+  BOOST_CHECK_CLOSE(mean(0), 3, 1e-10);
+  BOOST_CHECK_CLOSE(mean(1), 2, 1e-10);
+  BOOST_CHECK_SMALL(mean(2), 1e-12);
+  // the first sample is dropped
+  mean = average.update(Eigen::Vector3d::Zero());
+  BOOST_CHECK_CLOSE(mean(0), 2, 1e-10);
+  BOOST_CHECK_SMALL(mean(1), 1e-12);
+}
+
+// running sum with large offset and small signal does not drift
+BOOST_AUTO_TEST_CASE(MovingAverageDrift) {
+  constexpr int L = 100;
+  movingaverage<double, L> average;
+  average.reset(3433875.0);
+  double x = 0;
+  for (int i = 0; i != 2000000; ++i) {
+    x = 3433875.0 + 1e-3 * std::sin(0.01 * i) + ((i % 3) - 1) * 1e4;
+    average.update(x);
+  }
+  double exact = 0;
+  for (int i = 2000000 - L; i != 2000000; ++i)
+    exact += 3433875.0 + 1e-3 * std::sin(0.01 * i) + ((i % 3) - 1) * 1e4;
+  exact /= L;
+  BOOST_CHECK_SMALL(average.value() - exact, 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(WindowedIntegral) {
+  windowedintegral<double, 10> integral(0.1);
+  double value = 0;
+  for (int i = 0; i != 25; ++i) value = integral.update(2.0);
+  BOOST_CHECK_CLOSE(value, 2.0, 1e-10);
+  for (int i = 0; i != 5; ++i) value = integral.update(0.0);
+  BOOST_CHECK_CLOSE(value, 1.0, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE(ExponentialFilter) {
+  exponentialfilter<double> filter(0.9, 0.1);
+  filter.reset(1.0);
+  for (int i = 0; i != 9; ++i) filter.update(0.0);
+  // e^{-1} of a continuous first order system
+  BOOST_CHECK_CLOSE(filter.value(), std::pow(0.9, 9), 1e-10);
+  BOOST_CHECK_CLOSE(filter.value(), std::exp(-1), 10);
+}
+
+BOOST_AUTO_TEST_CASE(Butterworth) {
+  constexpr double sample_time = 0.01;
+  // unit gain for a constant
+  butterworth<double> filter(2, sample_time);
+  double y = 0;
+  for (int i = 0; i != 1000; ++i) y = filter.update(1.0);
+  BOOST_CHECK_CLOSE(y, 1.0, 1e-6);
+  filter.reset(-4.0);
+  BOOST_CHECK_CLOSE(filter.update(-4.0), -4.0, 1e-10);
+
+  // -3 dB at cut-off frequency, -40 dB/decade above it
+  auto amplitude = [&](double _frequency) {
+    butterworth<double> t_filter(2, sample_time);
+    double max_y = 0;
+    for (int i = 0; i != 4000; ++i) {
+      double t_y = t_filter.update(std::sin(2 * M_PI * _frequency * i *
+                                            sample_time));
+      if (i > 2000) max_y = std::max(max_y, std::abs(t_y));
+    }
+    return max_y;
+  };
+  BOOST_CHECK_CLOSE(amplitude(2), M_SQRT1_2, 1);
+  BOOST_CHECK_SMALL(amplitude(20), 0.015);
+
+  butterworth<Eigen::Vector2d> vfilter(2, sample_time);
+  vfilter.reset(Eigen::Vector2d(1, -1));
+  Eigen::Vector2d vy = vfilter.update(Eigen::Vector2d(1, -1));
+  BOOST_CHECK_CLOSE(vy(0), 1, 1e-10);
+  BOOST_CHECK_CLOSE(vy(1), -1, 1e-10);
+}
+
+// cost per sample of the window of PID controller
+BOOST_AUTO_TEST_CASE(MovingAverageTime) {
+  constexpr int L = 500;
+  constexpr int num_samples = 200000;
+  movingaverage<double, L> average;
+  naiveaverage<L> naive;
+  double checksum = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i != num_samples; ++i) checksum += average.update(i % 17);
+  auto t1 = std::chrono::steady_clock::now();
+  for (int i = 0; i != num_samples; ++i) checksum -= naive.update(i % 17);
+  auto t2 = std::chrono::steady_clock::now();
+
+  std::cout << "moving average of " << L << " samples: streaming "
+            << std::chrono::duration<double, std::nano>(t1 - t0).count() /
+                   num_samples
+            << " ns, recomputed "
+            << std::chrono::duration<double, std::nano>(t2 - t1).count() /
+                   num_samples
+            << " ns per sample\n";
+  BOOST_CHECK_SMALL(checksum, 1e-3);
+}
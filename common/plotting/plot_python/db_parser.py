@@ -7,9 +7,11 @@
 # ****************************************************************************
 # */
 
+import os
 import struct
 import sqlite3
 import json
+import numpy as np
 import pandas as pd
 
 
@@ -142,3 +144,33 @@ def parse_marineradar(db_path, db_config_path, num_spokedata):
     radar_data['SpokeData'] = spokedata
 
     return radar_data
+
+
+def parse_column(channel_path):
+    # parse one channel of the binary columnar format (datacolumn.h), where
+    # each column is memory-mapped into a numpy array without any copy
+    header_format = '=8sIIIId32s'  # magic, version, type, count, size, ...
+    header_size = struct.calcsize(header_format)
+    column_dtypes = {0: np.int32, 1: np.float64, 2: np.uint8, 3: 'S1'}
+
+    columns = {}
+    timestamp0 = 0
+    for file_name in sorted(os.listdir(channel_path)):
+        if not file_name.endswith('.col'):
+            continue
+        file_path = os.path.join(channel_path, file_name)
+        with open(file_path, 'rb') as f:
+            magic, version, column_type, count, record_size, timestamp0, \
+                name = struct.unpack(header_format, f.read(header_size))
+        num_records = (os.path.getsize(file_path) - header_size) // \
+            record_size
+        data = np.memmap(file_path, dtype=column_dtypes[column_type],
+                         mode='r', offset=header_size,
+                         shape=(num_records, count))
+        columns[file_name[:-4]] = data if count > 1 else data[:, 0]
+
+    # incomplete records are discarded
+    num_records = min(len(data) for data in columns.values())
+    for name in columns:
+        columns[name] = columns[name][:num_records]
+    return timestamp0, columns
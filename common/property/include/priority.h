@@ -1,7 +1,7 @@
 /*
 ***********************************************************************
 * priority.h: indicator for controller, estimator, planner, joystick
-* and GUI
+* and GUI, and the real time scheduling of threads
 * This header file can be read by C++ compilers
 *
 *  by Hu.ZH(CrossOcean.ai)
@@ -11,6 +11,9 @@
 #ifndef _PRIORITY_H_
 #define _PRIORITY_H_
 
+#include <pthread.h>
+#include <sched.h>
+
 // #include "controllerdata.h"
 // #include "estimatordata.h"
 // #include "gpsdata.h"
@@ -24,6 +27,32 @@ enum class STATETOGGLE {
   READY
 };
 
+// real time scheduling of a thread
+struct threadproperty {
+  int priority;  // SCHED_FIFO priority in [1, 99], 0 for the default policy
+  int cpu;       // CPU affinity, -1 for any CPU
+};
+
+// apply _property to the calling thread. Return false if it is not
+// permitted (e.g. SCHED_FIFO without root) or the CPU does not exist.
+inline bool setthreadproperty(const threadproperty &_property) {
+  bool is_applied = true;
+  if (_property.priority > 0) {
+    sched_param _param;
+    _param.sched_priority = _property.priority;
+    is_applied &=
+        (pthread_setschedparam(pthread_self(), SCHED_FIFO, &_param) == 0);
+  }
+  if (_property.cpu >= 0) {
+    cpu_set_t _cpuset;
+    CPU_ZERO(&_cpuset);
+    CPU_SET(_property.cpu, &_cpuset);
+    is_applied &= (pthread_setaffinity_np(pthread_self(), sizeof(_cpuset),
+                                          &_cpuset) == 0);
+  }
+  return is_applied;
+}  // setthreadproperty
+
 }  // namespace ASV::common
 
 #endif /* _PRIORITY_H_ */
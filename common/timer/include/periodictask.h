@@ -0,0 +1,235 @@
+/*
+***********************************************************************
+* periodictask.h: periodic executor of a real time loop. The task is
+* woken up at absolute deadlines (clock_nanosleep on CLOCK_MONOTONIC),
+* so that the period does not drift with the execution time. If a cycle
+* overruns, the missed deadlines are skipped and counted. The jitter
+* of wakeup and the execution time are recorded in histograms, which
+* can be read by other threads.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _PERIODICTASK_H_
+#define _PERIODICTASK_H_
+
+#include <time.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "common/communication/include/rtchannel.h"
+#include "common/property/include/priority.h"
+
+namespace ASV::common {
+
+// histogram of durations in microseconds. The bin 0 is [0, 1) us, the bin
+// i is [2^(i-1), 2^i) us, and the last bin has all the longer durations.
+class durationhistogram {
+ public:
+  static constexpr std::size_t num_bins = 21;  // up to 0.5 s
+
+  durationhistogram() : bins{}, count(0), sum(0), max(0) {}
+
+  void add(const double _us) {
+    std::size_t bin = 0;
+    if (_us >= 1)
+      bin = std::min(num_bins - 1, static_cast<std::size_t>(std::ilogb(_us)) +
+                                       1);
+    ++bins[bin];
+    ++count;
+    sum += _us;
+    max = std::max(max, _us);
+  }  // add
+
+  std::size_t size() const noexcept { return count; }
+  double mean() const noexcept { return count == 0 ? 0 : sum / count; }
+  double maximum() const noexcept { return max; }
+  const auto &getbins() const noexcept { return bins; }
+  // upper bound (us) of the _p quantile, _p in (0, 1], given by the upper
+  // edge of its bin
+  double quantile(const double _p) const {
+    std::size_t rank = static_cast<std::size_t>(std::ceil(_p * count));
+    std::size_t cumulative = 0;
+    for (std::size_t i = 0; i != num_bins; ++i) {
+      cumulative += bins[i];
+      if (cumulative >= rank)
+        return std::min(max, std::ldexp(1.0, static_cast<int>(i)));
+    }
+    return max;
+  }  // quantile
+
+ private:
+  std::array<std::size_t, num_bins> bins;
+  std::size_t count;
+  double sum;
+  double max;
+
+};  // end class durationhistogram
+
+struct periodictaskstats {
+  std::size_t num_cycles;
+  std::size_t num_overruns;  // cycles ending after the next deadline
+  std::size_t num_skipped;   // deadlines skipped by overruns
+  bool is_realtime;          // whether SCHED_FIFO is applied
+  durationhistogram jitter;     // wakeup - deadline (us)
+  durationhistogram execution;  // execution time of task (us)
+};
+
+class periodictask {
+ public:
+  explicit periodictask(const std::string &_name, const double _period_s,
+                        const threadproperty &_property = {0, -1})
+      : name(_name),
+        period_ns(static_cast<long long>(std::llround(_period_s * 1e9))),
+        property(_property),
+        is_stopped(false),
+        report_cycles(1),
+        stats{0, 0, 0, false, durationhistogram(), durationhistogram()},
+        stats_channel(stats) {}
+  periodictask(const periodictask &) = delete;
+  periodictask &operator=(const periodictask &) = delete;
+  ~periodictask() = default;
+
+  // called in the loop thread after an overrun, e.g. to log it
+  periodictask &setoverrunhandler(
+      std::function<void(const periodictaskstats &)> _handler) {
+    overrun_handler = std::move(_handler);
+    return *this;
+  }  // setoverrunhandler
+
+  // called in the loop thread every _num_cycles (at least 1) cycles
+  periodictask &setreporthandler(
+      std::function<void(const periodictaskstats &)> _handler,
+      const std::size_t _num_cycles) {
+    report_handler = std::move(_handler);
+    report_cycles = std::max<std::size_t>(_num_cycles, 1);
+    return *this;
+  }  // setreporthandler
+
+  // default handlers of the thread loops: _log(message) is called with the
+  // number of overruns after each overrun, and with report() every
+  // _report_cycles cycles (no report if _report_cycles is 0)
+  template <typename Log>
+  periodictask &setloghandler(Log _log, const std::size_t _report_cycles) {
+    setoverrunhandler([_log](const periodictaskstats &_stats) {
+      _log("Too much time! " + std::to_string(_stats.num_overruns) +
+           " overruns");
+    });
+    if (_report_cycles > 0)
+      setreporthandler(
+          [this, _log](const periodictaskstats &_stats) {
+            _log(report(_stats));
+          },
+          _report_cycles);
+    return *this;
+  }  // setloghandler
+
+  // run _task() at every deadline in the calling thread, until stop() is
+  // called or _task returns false. The first cycle starts immediately.
+  // A stop() before run() is kept, and run() returns at once.
+  template <typename Task>
+  void run(Task &&_task) {
+    stats.is_realtime = setthreadproperty(property) && (property.priority > 0);
+
+    timespec deadline = now();
+    while (!is_stopped.load(std::memory_order_relaxed)) {
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+                             nullptr) == EINTR) {
+      }
+      timespec wakeup = now();
+
+      if constexpr (std::is_same_v<std::invoke_result_t<Task>, bool>) {
+        if (!_task()) is_stopped.store(true, std::memory_order_relaxed);
+      } else {
+        _task();
+      }
+      timespec finish = now();
+
+      ++stats.num_cycles;
+      stats.jitter.add(1e-3 * difference_ns(wakeup, deadline));
+      stats.execution.add(1e-3 * difference_ns(finish, wakeup));
+
+      // next deadline, on the grid of the first one
+      deadline = advance(deadline, period_ns);
+      if (difference_ns(finish, deadline) > 0) {
+        ++stats.num_overruns;
+        long long num_missed = difference_ns(finish, deadline) / period_ns + 1;
+        stats.num_skipped += static_cast<std::size_t>(num_missed);
+        deadline = advance(deadline, num_missed * period_ns);
+        if (overrun_handler) overrun_handler(stats);
+      }
+      if (report_handler && (stats.num_cycles % report_cycles == 0))
+        report_handler(stats);
+      stats_channel.write(stats);
+    }
+  }  // run
+
+  // stop the loop after the current cycle, from any thread
+  void stop() noexcept { is_stopped.store(true, std::memory_order_relaxed); }
+
+  // statistics till the last cycle, from any thread
+  periodictaskstats getstats() const { return stats_channel.read().data; }
+  double getperiod() const noexcept { return 1e-9 * period_ns; }
+  const std::string &getname() const noexcept { return name; }
+
+  // one line summary of the statistics
+  std::string report() const { return report(getstats()); }
+  std::string report(const periodictaskstats &_stats) const {
+    std::ostringstream oss;
+    oss << name << ": " << _stats.num_cycles << " cycles, "
+        << _stats.num_overruns << " overruns, " << _stats.num_skipped
+        << " skipped" << (_stats.is_realtime ? "" : ", not realtime")
+        << "; jitter(us) mean " << _stats.jitter.mean() << " p99 <"
+        << _stats.jitter.quantile(0.99) << " max " << _stats.jitter.maximum()
+        << "; execution(us) mean " << _stats.execution.mean() << " p99 <"
+        << _stats.execution.quantile(0.99) << " max "
+        << _stats.execution.maximum();
+    return oss.str();
+  }  // report
+
+ private:
+  const std::string name;
+  const long long period_ns;
+  const threadproperty property;
+  std::atomic<bool> is_stopped;
+  std::function<void(const periodictaskstats &)> overrun_handler;
+  std::function<void(const periodictaskstats &)> report_handler;
+  std::size_t report_cycles;
+
+  periodictaskstats stats;  // used by the loop thread only
+  rtchannel<periodictaskstats, 4> stats_channel;
+
+  static timespec now() {
+    timespec _now;
+    clock_gettime(CLOCK_MONOTONIC, &_now);
+    return _now;
+  }  // now
+
+  static timespec advance(const timespec &_t, const long long _ns) {
+    long long total_ns = _t.tv_nsec + _ns;
+    timespec _next;
+    _next.tv_sec = _t.tv_sec + static_cast<time_t>(total_ns / 1000000000);
+    _next.tv_nsec = static_cast<long>(total_ns % 1000000000);
+    return _next;
+  }  // advance
+
+  // _t1 - _t0 in nanoseconds
+  static long long difference_ns(const timespec &_t1, const timespec &_t0) {
+    return (static_cast<long long>(_t1.tv_sec) - _t0.tv_sec) * 1000000000LL +
+           (_t1.tv_nsec - _t0.tv_nsec);
+  }  // difference_ns
+
+};  // end class periodictask
+
+}  // namespace ASV::common
+
+#endif /* _PERIODICTASK_H_ */
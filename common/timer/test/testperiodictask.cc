@@ -0,0 +1,148 @@
+/*
+*****************************************************************************
+* testperiodictask.cc:
+* unit test for the periodic task with absolute deadlines, compared with
+* the loop of sleep_for(sample_time - elapsed_time). The counting of cycles
+* and the stop are checked; the timing (drift, phase) depends on the load
+* of the machine and is only printed.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*****************************************************************************
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../include/periodictask.h"
+#include "../include/timecounter.h"
+
+using namespace ASV::common;
+using steady = std::chrono::steady_clock;
+
+// busy work of about _us microseconds
+void work(const long _us) {
+  auto t_end = steady::now() + std::chrono::microseconds(_us);
+  while (steady::now() < t_end) {
+  }
+}  // work
+
+double elapsed_ms(const steady::time_point &_t0) {
+  return std::chrono::duration<double, std::milli>(steady::now() - _t0)
+      .count();
+}  // elapsed_ms
+
+// the loop in threadloop: the elapsed time is truncated to milliseconds
+double sleep_for_loop(const int num_cycles, const long sample_time,
+                      const long work_us) {
+  timecounter timer;
+  long int innerloop_elapsed_time = 0;
+  auto t0 = steady::now();
+  for (int i = 0; i != num_cycles; ++i) {
+    timer.timeelapsed();
+    work(work_us);
+    innerloop_elapsed_time = timer.timeelapsed();
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
+  }
+  return elapsed_ms(t0);
+}  // sleep_for_loop
+
+int main() {
+  bool passed = true;
+  constexpr int num_cycles = 100;
+  constexpr long sample_time = 10;  // ms
+  constexpr long work_us = 2500;
+
+  // drift of the two loops over 100 cycles
+  double sleep_for_ms = sleep_for_loop(num_cycles, sample_time, work_us);
+
+  periodictask task("test", 1e-3 * sample_time);
+  std::vector<double> wakeup_ms;
+  auto t0 = steady::now();
+  task.run([&]() {
+    wakeup_ms.push_back(elapsed_ms(t0));
+    work(work_us);
+    return wakeup_ms.size() != num_cycles + 1;
+  });
+  double deadline_ms = wakeup_ms.back();
+  auto stats = task.getstats();
+  std::cout << "elapsed time of " << num_cycles << " cycles (expected "
+            << num_cycles * sample_time << " ms): sleep_for " << sleep_for_ms
+            << " ms, deadline " << deadline_ms << " ms\n"
+            << task.report() << std::endl;
+  // no SCHED_FIFO with the default property
+  passed &= (stats.num_cycles == num_cycles + 1) && !stats.is_realtime;
+  passed &= (stats.execution.mean() > 0.9 * work_us);
+
+  // overruns: every 5th cycle takes 2.5 periods, and the following
+  // deadlines stay on the grid of the first one
+  periodictask overrun_task("overrun", 1e-3 * sample_time);
+  std::size_t num_handled = 0, num_reports = 0;
+  overrun_task
+      .setoverrunhandler(
+          [&num_handled](const periodictaskstats &) { ++num_handled; })
+      .setreporthandler(
+          [&num_reports](const periodictaskstats &) { ++num_reports; }, 10);
+  wakeup_ms.clear();
+  t0 = steady::now();
+  std::size_t cycle = 0;
+  overrun_task.run([&]() {
+    wakeup_ms.push_back(elapsed_ms(t0));
+    work(++cycle % 5 == 0 ? 25000 : 1000);
+    if (cycle == 20) overrun_task.stop();
+  });
+  stats = overrun_task.getstats();
+  std::cout << overrun_task.report() << std::endl;
+  // at least 2 deadlines are skipped by each long cycle
+  passed &= (stats.num_cycles == 20) && (stats.num_overruns >= 4) &&
+            (num_handled == stats.num_overruns) &&
+            (stats.num_skipped >= 2 * stats.num_overruns) &&
+            (num_reports == 2);
+  double max_phase_error = 0;
+  for (auto const &_t : wakeup_ms) {
+    double phase = std::fmod(_t, sample_time);
+    max_phase_error =
+        std::max(max_phase_error, std::min(phase, sample_time - phase));
+  }
+  std::cout << "max phase error(ms): " << max_phase_error << std::endl;
+
+  // stop from another thread
+  periodictask stopped_task("stopped", 1e-3);
+  std::thread stopper([&stopped_task]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stopped_task.stop();
+  });
+  stopped_task.run([]() {});
+  stopper.join();
+  passed &= (stopped_task.getstats().num_cycles > 0);
+
+  // stop before the loop thread enters run()
+  periodictask early_task("early", 1e-3);
+  early_task.stop();
+  std::thread early_thread([&early_task]() { early_task.run([]() {}); });
+  early_thread.join();
+  passed &= (early_task.getstats().num_cycles == 0);
+
+  // report every cycle if 0 is given, and the default log handlers
+  periodictask logged_task("logged", 1e-3);
+  std::size_t num_logs = 0;
+  cycle = 0;
+  logged_task.setreporthandler([](const periodictaskstats &) {}, 0)
+      .setloghandler([&num_logs](const std::string &) { ++num_logs; }, 5);
+  logged_task.run([&cycle]() { return ++cycle != 10; });
+  passed &= (logged_task.getstats().num_cycles == 10) &&
+            (num_logs == 2 + logged_task.getstats().num_overruns);
+
+  // quantile of the histogram
+  durationhistogram histogram;
+  for (int i = 0; i != 99; ++i) histogram.add(30);
+  histogram.add(3000);
+  passed &= (histogram.quantile(0.5) == 32) &&
+            (histogram.quantile(0.99) == 32) &&
+            (histogram.quantile(1.0) == 3000) && (histogram.maximum() == 3000);
+
+  std::cout << (passed ? "passed" : "failed") << std::endl;
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -23,9 +23,11 @@
 #include "guiserver.h"
 #include "jsonparse.h"
 #include "motorclient.h"
+#include "periodictask.h"
 #include "planner.h"
 #include "priority.h"
 #include "remotecontrol.h"
+#include "rtchannel.h"
 #include "tcpclient.h"
 #include "tcpserver.h"
 #include "timecounter.h"
@@ -36,6 +38,8 @@ constexpr int num_thruster = 6;
 constexpr int dim_controlspace = 3;
 constexpr USEKALMAN indicator_kalman = KALMANOFF;
 constexpr ACTUATION indicator_actuation = FULLYACTUATED;
+// SCHED_FIFO priority and cpu of the planner, estimator and controller
+constexpr ASV::common::threadproperty rt_property{99, -1};
 
 class threadloop {
  public:
@@ -58,9 +62,6 @@ class threadloop {
   ~threadloop() {}
 
   void mainloop() {
-    sched_param sch;
-    sch.sched_priority = 99;
-
     std::thread gps_thread(&threadloop::gpsimuloop, this);
     std::thread wind_thread(&threadloop::windloop, this);
     std::thread planner_thread(&threadloop::plannerloop, this);
@@ -72,19 +73,6 @@ class threadloop {
     std::thread indicators_thread(&threadloop::indicatorsloop, this);
     std::thread lidar_thread(&threadloop::socketlidarloop, this);
 
-    if (pthread_setschedparam(planner_thread.native_handle(), SCHED_FIFO,
-                              &sch)) {
-      std::cout << "Failed to setschedparam: " << std::strerror(errno) << '\n';
-    }
-    if (pthread_setschedparam(estimator_thread.native_handle(), SCHED_FIFO,
-                              &sch)) {
-      std::cout << "Failed to setschedparam: " << std::strerror(errno) << '\n';
-    }
-    if (pthread_setschedparam(controller_thread.native_handle(), SCHED_FIFO,
-                              &sch)) {
-      std::cout << "Failed to setschedparam: " << std::strerror(errno) << '\n';
-    }
-
     gps_thread.detach();
     wind_thread.detach();
     planner_thread.detach();
@@ -109,18 +97,21 @@ class threadloop {
       Eigen::Vector3d::Zero()   // command
   };
 
-  controllerRTdata<num_thruster, dim_controlspace> _controllerRTdata{
+  // the data of GPS, wind, estimator and controller are written by one loop
+  // only, and the other loops read a consistent snapshot without any lock
+  ASV::common::rtchannel<controllerRTdata<num_thruster, dim_controlspace>>
+      _controller_channel{{
       Eigen::Matrix<double, dim_controlspace, 1>::Zero(),  // tau
       Eigen::Matrix<double, dim_controlspace, 1>::Zero(),  // BalphaU
       Eigen::Matrix<double, num_thruster, 1>::Zero(),      // u
       Eigen::Matrix<int, num_thruster, 1>::Zero(),         // rotation
       Eigen::Matrix<double, num_thruster, 1>::Zero(),      // alpha
       Eigen::Matrix<int, num_thruster, 1>::Zero()          // alpha_deg
-  };
+  }};
 
   motorRTdata<num_thruster> _motorRTdata;
   // realtime parameters of the estimators
-  estimatorRTdata _estimatorRTdata{
+  ASV::common::rtchannel<estimatorRTdata> _estimator_channel{{
       Eigen::Matrix3d::Identity(),          // CTB2G
       Eigen::Matrix3d::Identity(),          // CTG2B
       Eigen::Matrix<double, 6, 1>::Zero(),  // Measurement
@@ -130,10 +121,10 @@ class threadloop {
       Eigen::Vector3d::Zero(),              // BalphaU
       Eigen::Matrix<double, 6, 1>::Zero(),  // motiondata_6dof
       Eigen::Vector3d::Zero()               // windload
-  };
+  }};
 
   // real time GPS/IMU data
-  gpsRTdata gps_data{
+  ASV::common::rtchannel<gpsRTdata> gps_channel{{
       0,                // date
       0,                // time
       0,                // heading
@@ -153,12 +144,12 @@ class threadloop {
       0,                // UTM_x
       0,                // UTM_y
       "0n"              // UTM_zone
-  };
+  }};
   // real time wind data
-  windRTdata _windRTdata{
+  ASV::common::rtchannel<windRTdata> _wind_channel{{
       0,  // speed
       0   // orientation
-  };
+  }};
 
   // real time remote control data
   recontrolRTdata _recontrolRTdata{
@@ -207,8 +198,8 @@ class threadloop {
   database<num_thruster, dim_controlspace> _sqlite;
 
   void intializethreadloop() {
-    _controllerRTdata =
-        _controller.initializecontroller().getcontrollerRTdata();
+    _controller_channel.write(
+        _controller.initializecontroller().getcontrollerRTdata());
     _sqlite.initializetables();
   }
 
@@ -248,11 +239,10 @@ class threadloop {
     //       std::chrono::milliseconds(sample_time - elapsed_time));
     // }
 
-    timecounter timer_planner;
-    long int outerloop_elapsed_time = 0;
-    long int innerloop_elapsed_time = 0;
-    long int sample_time =
-        static_cast<long int>(1000 * _planner.getsampletime());
+    ASV::common::periodictask planner_task("planner", _planner.getsampletime(),
+                                           rt_property);
+    planner_task.setloghandler(
+        [](const std::string &_msg) { CLOG(INFO, "planner") << _msg; }, 0);
     // Eigen::MatrixXd waypoints = Eigen::MatrixXd::Zero(2, 4);
     // waypoints.col(0) << 3433875, 351046;
     // waypoints.col(1) << 3433895, 351058;
@@ -261,8 +251,9 @@ class threadloop {
     // _plannerRTdata.waypoint0 = waypoints.col(0);
     // _plannerRTdata.waypoint1 = waypoints.col(1);
     int index_wpt = 2;
-    while (1) {
-      outerloop_elapsed_time = timer_planner.timeelapsed();
+    auto _estimatorRTdata = _estimator_channel.read().data;
+    planner_task.run([&]() {
+      _estimator_channel.read(_estimatorRTdata);
 
       switch (_indicators.indicator_controlmode) {  // controller mode
         case 2:
@@ -293,14 +284,7 @@ class threadloop {
         default:
           break;
       }
-
-      innerloop_elapsed_time = timer_planner.timeelapsed();
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-      if (outerloop_elapsed_time > 1.1 * sample_time)
-        CLOG(INFO, "planner") << "Too much time!";
-    }
+    });
 
   }  // plannerloop
 
@@ -308,7 +292,7 @@ class threadloop {
   void gpsimuloop() {
     try {
       while (1) {
-        gps_data = _gpsimu.gpsonestep().getgpsRTdata();
+        gps_channel.write(_gpsimu.gpsonestep().getgpsRTdata());
       }
 
     } catch (std::exception& e) {
@@ -317,22 +301,26 @@ class threadloop {
   }  // gpsimuloop()
 
   void controllerloop() {
-    timecounter timer_controler;
-    long int outerloop_elapsed_time = 0;
-    long int innerloop_elapsed_time = 0;
-    long int sample_time =
-        static_cast<long int>(1000 * _controller.getsampletime());
+    ASV::common::periodictask controller_task(
+        "controller", _controller.getsampletime(), rt_property);
+    controller_task.setloghandler(
+        [](const std::string &_msg) { CLOG(INFO, "controller") << _msg; }, 0);
 
     _motorclient.startup_socket_client(_motorRTdata);
     CLOG(INFO, "PLC") << "Servo and PLC initialation successful!";
 
-    while (1) {
-      outerloop_elapsed_time = timer_controler.timeelapsed();
+    auto _controllerRTdata = _controller_channel.read().data;
+    auto _estimatorRTdata = _estimator_channel.read().data;
+    auto _windRTdata = _wind_channel.read().data;
+    controller_task.run([&]() {
+      _estimator_channel.read(_estimatorRTdata);
+      _wind_channel.read(_windRTdata);
       _controller.setcontrolmode(_indicators.indicator_controlmode);
       _controller.controlleronestep(
           _controllerRTdata, _estimatorRTdata.windload,
           _estimatorRTdata.p_error, _estimatorRTdata.v_error,
           _plannerRTdata.command, _plannerRTdata.v_setpoint);
+      _controller_channel.write(_controllerRTdata);
 
       _motorclient.commandfromcontroller(
           _motorRTdata.command_alpha, _motorRTdata.command_rotation,
@@ -350,31 +338,29 @@ class threadloop {
       std::cout << "wind speed: " << _windRTdata.speed << std::endl;
       std::cout << "wind orientation: " << _windRTdata.orientation << std::endl;
       std::cout << "windload " << _estimatorRTdata.windload << std::endl;
-
-      // std::cout << elapsed_time << std::endl;
-      innerloop_elapsed_time = timer_controler.timeelapsed();
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-      if (outerloop_elapsed_time > 1.1 * sample_time)
-        CLOG(INFO, "controller") << "Too much time!";
-    }
+    });
   }  // controllerloop
 
   // loop to give real time state estimation
   void estimatorloop() {
-    timecounter timer_estimator;
-    long int outerloop_elapsed_time = 0;
-    long int innerloop_elapsed_time = 0;
-    long int sample_time =
-        static_cast<long int>(1000 * _estimator.getsampletime());
-
+    ASV::common::periodictask estimator_task(
+        "estimator", _estimator.getsampletime(), rt_property);
+    estimator_task.setloghandler(
+        [](const std::string &_msg) { CLOG(INFO, "estimator") << _msg; }, 0);
+
+    auto _estimatorRTdata = _estimator_channel.read().data;
+    auto _controllerRTdata = _controller_channel.read().data;
+    auto gps_data = gps_channel.read().data;
+    auto _windRTdata = _wind_channel.read().data;
     while (1) {
+      gps_channel.read(gps_data);
+      _wind_channel.read(_windRTdata);
       if ((gps_data.status == 'B') || (gps_data.status == '4')) {
         _estimator.setvalue(_estimatorRTdata, gps_data.UTM_x, gps_data.UTM_y,
                             gps_data.altitude, gps_data.roll, gps_data.pitch,
                             gps_data.heading, gps_data.Ve, gps_data.Vn);
         _windcompensation.setvalue(_windRTdata.speed, _windRTdata.orientation);
+        _estimator_channel.write(_estimatorRTdata);
         CLOG(INFO, "GPS") << "initialation successful!";
         break;
       }
@@ -382,8 +368,10 @@ class threadloop {
       std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
 
-    while (1) {
-      outerloop_elapsed_time = timer_estimator.timeelapsed();
+    estimator_task.run([&]() {
+      _controller_channel.read(_controllerRTdata);
+      gps_channel.read(gps_data);
+      _wind_channel.read(_windRTdata);
 
       _windcompensation.setwindstatus(_indicators.indicator_windstatus);
       _estimatorRTdata.windload =
@@ -399,20 +387,22 @@ class threadloop {
                                _plannerRTdata.setpoint(2));
       _estimator.estimateerror(_estimatorRTdata, _plannerRTdata.setpoint,
                                _plannerRTdata.v_setpoint);
-
-      innerloop_elapsed_time = timer_estimator.timeelapsed();
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-      if (outerloop_elapsed_time > 1.1 * sample_time)
-        CLOG(INFO, "estimator") << "Too much time!";
-    }
+      _estimator_channel.write(_estimatorRTdata);
+    });
 
   }  // estimatorloop()
 
   // loop to save real time data using sqlite3
   void sqlloop() {
+    auto gps_data = gps_channel.read().data;
+    auto _estimatorRTdata = _estimator_channel.read().data;
+    auto _controllerRTdata = _controller_channel.read().data;
+    auto _windRTdata = _wind_channel.read().data;
     while (1) {
+      gps_channel.read(gps_data);
+      _estimator_channel.read(_estimatorRTdata);
+      _controller_channel.read(_controllerRTdata);
+      _wind_channel.read(_windRTdata);
       _sqlite.update_gps_table(gps_data);
       _sqlite.update_planner_table(_plannerRTdata);
       _sqlite.update_estimator_table(_estimatorRTdata);
@@ -423,7 +413,13 @@ class threadloop {
   }  // sqlloop()
 
   void guicommunicationloop() {
+    auto gps_data = gps_channel.read().data;
+    auto _estimatorRTdata = _estimator_channel.read().data;
+    auto _windRTdata = _wind_channel.read().data;
     while (1) {
+      gps_channel.read(gps_data);
+      _estimator_channel.read(_estimatorRTdata);
+      _wind_channel.read(_windRTdata);
       _guiserver.guicommunication(_guilinkRTdata, _indicators, _estimatorRTdata,
                                   _plannerRTdata, gps_data, _motorRTdata,
                                   _windRTdata);
@@ -473,7 +469,7 @@ class threadloop {
   void windloop() {
     wind _wind(_jsonparse.getwindbaudrate(), _jsonparse.getwindport());
     while (1) {
-      _windRTdata = _wind.readwind().getwindRTdata();
+      _wind_channel.write(_wind.readwind().getwindRTdata());
       // std::this_thread::sleep_for(std::chrono::milliseconds(500));
     }
   }  // windloop
@@ -489,7 +485,11 @@ class threadloop {
     const int send_size = 24;
     char recv_buffer[recv_size];
     lidarmsg _sendmsg = {0.0, 0.0, 0.0};
+    auto gps_data = gps_channel.read().data;
+    auto _estimatorRTdata = _estimator_channel.read().data;
     while (1) {
+      gps_channel.read(gps_data);
+      _estimator_channel.read(_estimatorRTdata);
       // State
       _sendmsg.double_msg[0] = gps_data.latitude;
       _sendmsg.double_msg[1] = gps_data.longitude;
@@ -12,10 +12,12 @@
 #include <pthread.h>
 
 #include "StateMonitor.h"
+#include "common/communication/include/rtchannel.h"
 #include "common/communication/include/tcpserver.h"
 #include "common/fileIO/include/jsonparse.h"
 #include "common/fileIO/recorder/include/datarecorder.h"
 #include "common/logging/include/easylogging++.h"
+#include "common/timer/include/periodictask.h"
 #include "common/timer/include/timecounter.h"
 #include "modules/controller/include/controller.h"
 #include "modules/controller/include/trajectorytracking.h"
@@ -40,6 +42,15 @@ constexpr control::ACTUATION indicator_actuation =
     control::ACTUATION::UNDERACTUATED;
 constexpr int max_num_targets = 20;
 
+// real time scheduling (SCHED_FIFO priority, cpu) of the periodic loops,
+// which falls back to the default scheduling without the privilege
+constexpr common::threadproperty estimator_property{90, -1};
+constexpr common::threadproperty controller_property{90, -1};
+constexpr common::threadproperty planner_property{80, -1};
+constexpr common::threadproperty targettracking_property{70, -1};
+// # of cycles between two reports of jitter and execution time
+constexpr std::size_t report_cycles = 6000;
+
 // constexpr common::TESTMODE testmode = common::TESTMODE::SIMULATION_DP;
 // constexpr common::TESTMODE testmode = common::TESTMODE::SIMULATION_LOS;
 // constexpr common::TESTMODE testmode = common::TESTMODE::SIMULATION_FRENET;
@@ -57,7 +57,9 @@ class threadloop : public StateMonitor {
 
  private:
   /********************* Real time Data  *********************/
-  planning::RoutePlannerRTdata RoutePlanner_RTdata{
+  // each channel is written by one loop only, and the other loops read a
+  // consistent snapshot of it without any lock
+  common::rtchannel<planning::RoutePlannerRTdata> RoutePlanner_channel{{
       common::STATETOGGLE::IDLE,  // state_toggle
       0,                          // setpoints_X
       0,                          // setpoints_Y;
@@ -71,17 +73,18 @@ class threadloop : public StateMonitor {
       Eigen::VectorXd::Zero(2),   // Waypoint_Y
       Eigen::VectorXd::Zero(2),   // Waypoint_longitude
       Eigen::VectorXd::Zero(2)    // Waypoint_latitude
-  };
+  }};
 
   // real time data of tracker
-  control::trackerRTdata tracker_RTdata{
+  common::rtchannel<control::trackerRTdata> tracker_channel{{
       control::TRACKERMODE::STARTED,  // trackermode
       Eigen::Vector3d::Zero(),        // setpoint
       Eigen::Vector3d::Zero()         // v_setpoint
-  };
+  }};
 
   // real time data of controller
-  control::controllerRTdata<num_thruster, dim_controlspace> controller_RTdata{
+  common::rtchannel<control::controllerRTdata<num_thruster, dim_controlspace>>
+      controller_channel{{
       common::STATETOGGLE::IDLE,                           // state_toggle
       Eigen::Matrix<double, dim_controlspace, 1>::Zero(),  // tau
       Eigen::Matrix<double, dim_controlspace, 1>::Zero(),  // BalphaU
@@ -93,10 +96,10 @@ class threadloop : public StateMonitor {
       Eigen::Matrix<int, num_thruster, 1>::Zero(),         // feedback_rotation
       Eigen::Matrix<double, num_thruster, 1>::Zero(),      // feedback_alpha
       Eigen::Matrix<int, num_thruster, 1>::Zero()          // feedback_alpha_deg
-  };
+  }};
 
   // realtime parameters of the estimators
-  localization::estimatorRTdata estimator_RTdata{
+  common::rtchannel<localization::estimatorRTdata> estimator_channel{{
       common::STATETOGGLE::IDLE,            // state_toggle
       Eigen::Matrix3d::Identity(),          // CTB2G
       Eigen::Matrix3d::Identity(),          // CTG2B
@@ -108,10 +111,10 @@ class threadloop : public StateMonitor {
       Eigen::Vector3d::Zero(),              // p_error
       Eigen::Vector3d::Zero(),              // v_error
       Eigen::Vector3d::Zero()               // BalphaU
-  };
+  }};
 
   // real time data
-  planning::CartesianState Planning_Marine_state{
+  common::rtchannel<planning::CartesianState> Planning_Marine_channel{{
       0,           // x
       0,           // y
       M_PI / 3.0,  // theta
@@ -120,10 +123,10 @@ class threadloop : public StateMonitor {
       0,           // dspeed
       0,           // yaw_rate
       0            // yaw_accel
-  };
+  }};
 
   // real time GPS/IMU data
-  messages::gpsRTdata gps_data{
+  common::rtchannel<messages::gpsRTdata> gps_channel{{
       0,  // UTC
       0,  // latitude
       0,  // longitude
@@ -138,10 +141,10 @@ class threadloop : public StateMonitor {
       0,  // UTM_x
       0,  // UTM_y
       ""  // UTM_zone
-  };
+  }};
 
   // real time stm32 data
-  messages::stm32data stm32_data{
+  common::rtchannel<messages::stm32data> stm32_channel{{
       "",                              // UTC_time
       0,                               // command_u1
       -10,                             // command_u2
@@ -158,10 +161,10 @@ class threadloop : public StateMonitor {
       messages::STM32STATUS::STANDBY,  // feedback_stm32status
       messages::STM32STATUS::STANDBY,  // command_stm32status
       common::LINKSTATUS::CONNECTED    // linkstatus;
-  };
+  }};
 
   // real time gui-link data
-  messages::guilinkRTdata<num_thruster, 3> guilink_RTdata{
+  common::rtchannel<messages::guilinkRTdata<num_thruster, 3>> guilink_channel{{
       "",                                           // UTC_time
       messages::GUISTATUS::STANDBY,                 // guistutus_PC2gui
       messages::GUISTATUS::STANDBY,                 // guistutus_gui2PC
@@ -183,10 +186,11 @@ class threadloop : public StateMonitor {
       Eigen::Matrix<double, 2, 8>::Zero(),          // waypoints
       Eigen::VectorXd::Zero(2),                     // WX
       Eigen::VectorXd::Zero(2)                      // WY
-  };
+  }};
 
   // real time data of target tracker
-  perception::TargetTrackerRTdata<max_num_targets> TargetTracker_RTdata{
+  common::rtchannel<perception::TargetTrackerRTdata<max_num_targets>>
+      TargetTracker_channel{{
       perception::SPOKESTATE::OUTSIDE_ALARM_ZONE,         // spoke_state
       Eigen::Matrix<int, max_num_targets, 1>::Zero(),     // targets_state
       Eigen::Matrix<int, max_num_targets, 1>::Zero(),     // targets_intention
@@ -198,25 +202,33 @@ class threadloop : public StateMonitor {
       Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_vy
       Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_CPA_x
       Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_CPA_y
-      Eigen::Matrix<double, max_num_targets, 1>::Zero()   // targets_TCPA
-  };
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_TCPA
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_DCPA
+      Eigen::Matrix<double, max_num_targets, 1>::Zero()   // targets_TTSD
+  }};
 
   // real time SpokeProcess data
-  perception::SpokeProcessRTdata SpokeProcess_RTdata;
+  common::rtchannel<perception::SpokeProcessRTdata> SpokeProcess_channel;
 
   // real time radar detected data
-  perception::TargetDetectionRTdata TargetDetection_RTdata;
+  common::rtchannel<perception::TargetDetectionRTdata> TargetDetection_channel;
 
   // real time data from marine radar
-  messages::MarineRadarRTdata MarineRadar_RTdata{
+  common::rtchannel<messages::MarineRadarRTdata> MarineRadar_channel{{
       common::STATETOGGLE::IDLE,  // state_toggle
       0,                          // spoke_azimuth_deg
       0,                          // spoke_samplerange_m
-      {0x00, 0x00, 0x00}          // spokedata
-  };
+      {0x00, 0x00, 0x00},         // spokedata
+      0,                          // num_spokes
+      0                           // num_spoke_overruns
+  }};
+
+  // all the spokes from marine radar to target tracking
+  std::shared_ptr<messages::MarineRadarSpokeRing> MarineRadar_spokering =
+      std::make_shared<messages::MarineRadarSpokeRing>();
 
   // real time utc
-  std::string pt_utc;
+  common::rtchannel<std::string> utc_channel;
 
   /********************* Modules  *********************/
   // json
@@ -228,19 +240,18 @@ class threadloop : public StateMonitor {
         _jsonparse.getalarmzonedata(), _jsonparse.getSpokeProcessdata(),
         _jsonparse.getTargetTrackingdata(), _jsonparse.getClusteringdata());
 
-    common::timecounter timer_targettracking;
-    long int outerloop_elapsed_time = 0;
-    long int innerloop_elapsed_time = 0;
-    long int sample_time_ms =
-        static_cast<long int>(1000 * Target_Tracking.getsampletime());
+    common::periodictask targettracking_task(
+        "TargetTracking", Target_Tracking.getsampletime(),
+        targettracking_property);
+    targettracking_task.setloghandler(
+        [](const std::string &_msg) { CLOG(INFO, "TargetTracking") << _msg; },
+        report_cycles);
 
     StateMonitor::check_target_tracking();
 
-    std::size_t size_spokedata = sizeof(MarineRadar_RTdata.spokedata) /
-                                 sizeof(MarineRadar_RTdata.spokedata[0]);
-    while (1) {
-      outerloop_elapsed_time = timer_targettracking.timeelapsed();
-
+    auto estimator_RTdata = estimator_channel.read().data;
+    std::size_t num_spoke_overruns = 0;
+    targettracking_task.run([&]() {
       switch (testmode) {
         case common::TESTMODE::SIMULATION_DP:
         case common::TESTMODE::SIMULATION_LOS:
@@ -253,37 +264,38 @@ class threadloop : public StateMonitor {
           break;
         }
         case common::TESTMODE::EXPERIMENT_AVOIDANCE: {
-          TargetTracker_RTdata =
+          estimator_channel.read(estimator_RTdata);
+          // drain all the spokes received since the last loop
+          TargetTracker_channel.write(
               Target_Tracking
-                  .AutoTracking(MarineRadar_RTdata.spokedata, size_spokedata,
-                                MarineRadar_RTdata.spoke_azimuth_deg,
-                                MarineRadar_RTdata.spoke_samplerange_m,
+                  .AutoTracking(*MarineRadar_spokering,
                                 estimator_RTdata.radar_state(0),
                                 estimator_RTdata.radar_state(1),
                                 estimator_RTdata.radar_state(3),
                                 estimator_RTdata.radar_state(4),
                                 estimator_RTdata.radar_state(5))
-                  .getTargetTrackerRTdata();
+                  .getTargetTrackerRTdata());
 
-          SpokeProcess_RTdata = Target_Tracking.getSpokeProcessRTdata();
-          TargetDetection_RTdata = Target_Tracking.getTargetDetectionRTdata();
+          SpokeProcess_channel.write(Target_Tracking.getSpokeProcessRTdata());
+          TargetDetection_channel.write(
+              Target_Tracking.getTargetDetectionRTdata());
           break;
         }
         default:
           break;
       }  // end switch
 
-      innerloop_elapsed_time = timer_targettracking.timeelapsed();
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(sample_time_ms - innerloop_elapsed_time));
-
-      if (outerloop_elapsed_time > 1.1 * sample_time_ms)
-        CLOG(INFO, "TargetTracking") << "Too much time!";
-    }
+      if (MarineRadar_spokering->num_overruns() != num_spoke_overruns) {
+        num_spoke_overruns = MarineRadar_spokering->num_overruns();
+        CLOG(INFO, "TargetTracking")
+            << num_spoke_overruns << " spokes are dropped by overrun!";
+      }
+    });
   }  // target_tracking_loop
 
   //##################### route planning ########################//
   void route_planner_loop() {
+    auto RoutePlanner_RTdata = RoutePlanner_channel.read().data;
     planning::RoutePlanning Route_Planner(RoutePlanner_RTdata,
                                           _jsonparse.getvessel());
 
@@ -306,6 +318,7 @@ class threadloop : public StateMonitor {
         RoutePlanner_RTdata = Route_Planner.setCruiseSpeed(1)
                                   .setWaypoints(W_long, W_lat)
                                   .getRoutePlannerRTdata();
+        RoutePlanner_channel.write(RoutePlanner_RTdata);
       }
 
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -318,19 +331,26 @@ class threadloop : public StateMonitor {
     planning::LatticePlanner _trajectorygenerator(
         _jsonparse.getlatticedata(), _jsonparse.getcollisiondata());
 
-    common::timecounter timer_planner;
-    long int outerloop_elapsed_time = 0;
-    long int innerloop_elapsed_time = 0;
-    long int sample_time_ms =
-        static_cast<long int>(1000 * _trajectorygenerator.getsampletime());
+    common::periodictask planner_task(
+        "planner", _trajectorygenerator.getsampletime(), planner_property);
+    planner_task.setloghandler(
+        [](const std::string &_msg) { CLOG(INFO, "planner") << _msg; },
+        report_cycles);
 
     StateMonitor::check_pathplanner();
 
+    auto RoutePlanner_RTdata = RoutePlanner_channel.read().data;
+    auto estimator_RTdata = estimator_channel.read().data;
+    auto TargetTracker_RTdata = TargetTracker_channel.read().data;
+    auto Planning_Marine_state = Planning_Marine_channel.read().data;
+
     _trajectorygenerator.regenerate_target_course(
         RoutePlanner_RTdata.Waypoint_X, RoutePlanner_RTdata.Waypoint_Y);
 
-    while (1) {
-      outerloop_elapsed_time = timer_planner.timeelapsed();
+    planner_task.run([&]() {
+      RoutePlanner_channel.read(RoutePlanner_RTdata);
+      estimator_channel.read(estimator_RTdata);
+      TargetTracker_channel.read(TargetTracker_RTdata);
 
       switch (testmode) {
         case common::TESTMODE::SIMULATION_DP:
@@ -451,47 +471,48 @@ class threadloop : public StateMonitor {
         default:
           break;
       }  // end switch
-
-      innerloop_elapsed_time = timer_planner.timeelapsed();
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(sample_time_ms - innerloop_elapsed_time));
-
-      if (outerloop_elapsed_time > 1.1 * sample_time_ms)
-        CLOG(INFO, "planner") << "Too much time!";
-    }
+      Planning_Marine_channel.write(Planning_Marine_state);
+    });
 
   }  // path_planner_loop
 
   //################### path following, controller, TA ####################//
   void controllerloop() {
     control::controller<10, num_thruster, indicator_actuation, dim_controlspace>
-        _controller(controller_RTdata, _jsonparse.getcontrollerdata(),
+        _controller(controller_channel.read().data,
+                    _jsonparse.getcontrollerdata(),
                     _jsonparse.getvessel(), _jsonparse.getpiddata(),
                     _jsonparse.getthrustallocationdata(),
                     _jsonparse.gettunneldata(), _jsonparse.getazimuthdata(),
                     _jsonparse.getmainrudderdata(),
                     _jsonparse.gettwinfixeddata());
 
+    auto tracker_RTdata = tracker_channel.read().data;
     control::trajectorytracking _trajectorytracking(
         _jsonparse.getcontrollerdata(), tracker_RTdata);
 
-    common::timecounter timer_controler;
-    long int outerloop_elapsed_time = 0;
-    long int innerloop_elapsed_time = 0;
-    long int sample_time =
-        static_cast<long int>(1000 * _controller.getsampletime());
+    common::periodictask controller_task(
+        "controller", _controller.getsampletime(), controller_property);
+    controller_task.setloghandler(
+        [](const std::string &_msg) { CLOG(INFO, "controller") << _msg; },
+        report_cycles);
 
     StateMonitor::check_controller();
 
-    controller_RTdata =
+    auto controller_RTdata =
         _controller.initializecontroller().getcontrollerRTdata();
+    controller_channel.write(controller_RTdata);
+    auto RoutePlanner_RTdata = RoutePlanner_channel.read().data;
+    auto estimator_RTdata = estimator_channel.read().data;
+    auto Planning_Marine_state = Planning_Marine_channel.read().data;
 
     _trajectorytracking.set_grid_points(
         RoutePlanner_RTdata.Waypoint_X, RoutePlanner_RTdata.Waypoint_Y,
         RoutePlanner_RTdata.speed, RoutePlanner_RTdata.los_capture_radius);
 
-    while (1) {
-      outerloop_elapsed_time = timer_controler.timeelapsed();
+    controller_task.run([&]() {
+      estimator_channel.read(estimator_RTdata);
+      Planning_Marine_channel.read(Planning_Marine_state);
 
       switch (testmode) {
         case common::TESTMODE::SIMULATION_DP: {
@@ -598,6 +619,7 @@ class threadloop : public StateMonitor {
         default:
           break;
       }  // end switch
+      tracker_channel.write(tracker_RTdata);
 
       // controller
       controller_RTdata = _controller
@@ -607,14 +629,8 @@ class threadloop : public StateMonitor {
                                                  Eigen::Vector3d::Zero(),
                                                  tracker_RTdata.v_setpoint)
                               .getcontrollerRTdata();
-      // std::cout << elapsed_time << std::endl;
-      innerloop_elapsed_time = timer_controler.timeelapsed();
-      std::this_thread::sleep_for(
-          std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-      if (outerloop_elapsed_time > 1.1 * sample_time)
-        CLOG(INFO, "controller") << "Too much time!";
-    }
+      controller_channel.write(controller_RTdata);
+    });
   }  // controllerloop
 
   //##################### state estimation and simulator ####################//
@@ -637,29 +653,33 @@ class threadloop : public StateMonitor {
                                 1,                 // nlp_v
                                 1                  // nlp_roti
                                 >
-            _estimator(estimator_RTdata, _jsonparse.getvessel(),
+            _estimator(estimator_channel.read().data, _jsonparse.getvessel(),
                        _jsonparse.getestimatordata());
 
         simulation::simulator _simulator(_jsonparse.getsimulatordata(),
                                          _jsonparse.getvessel());
 
-        common::timecounter timer_estimator;
-        long int outerloop_elapsed_time = 0;
-        long int innerloop_elapsed_time = 0;
-        long int sample_time =
-            static_cast<long int>(1000 * _estimator.getsampletime());
+        common::periodictask estimator_task(
+            "estimator", _estimator.getsampletime(), estimator_property);
+        estimator_task.setloghandler(
+            [](const std::string &_msg) { CLOG(INFO, "estimator") << _msg; },
+            report_cycles);
 
         // State monitor toggle
         StateMonitor::check_estimator();
 
-        estimator_RTdata =
+        auto estimator_RTdata =
             _estimator.setvalue(350938.7, 3433823.54, 0, 0, 0, 90, 0, 0, 0)
                 .getEstimatorRTData();
+        estimator_channel.write(estimator_RTdata);
         _simulator.setX(estimator_RTdata.State);
+        auto tracker_RTdata = tracker_channel.read().data;
+        auto controller_RTdata = controller_channel.read().data;
 
         // real time calculation in estimator
-        while (1) {
-          outerloop_elapsed_time = timer_estimator.timeelapsed();
+        estimator_task.run([&]() {
+          tracker_channel.read(tracker_RTdata);
+          controller_channel.read(controller_RTdata);
 
           auto x = _simulator
                        .simulator_onestep(tracker_RTdata.setpoint(2),
@@ -674,14 +694,8 @@ class threadloop : public StateMonitor {
                                  .estimateerror(tracker_RTdata.setpoint,
                                                 tracker_RTdata.v_setpoint)
                                  .getEstimatorRTData();
-
-          innerloop_elapsed_time = timer_estimator.timeelapsed();
-          std::this_thread::sleep_for(
-              std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-          if (outerloop_elapsed_time > 1.1 * sample_time)
-            CLOG(INFO, "estimator") << "Too much time!";
-        }
+          estimator_channel.write(estimator_RTdata);
+        });
 
         break;
       }
@@ -703,33 +717,40 @@ class threadloop : public StateMonitor {
                                 5,                 // nlp_v
                                 1                  // nlp_roti
                                 >
-            _estimator(estimator_RTdata, _jsonparse.getvessel(),
+            _estimator(estimator_channel.read().data, _jsonparse.getvessel(),
                        _jsonparse.getestimatordata());
 
-        common::timecounter timer_estimator;
-        long int outerloop_elapsed_time = 0;
-        long int innerloop_elapsed_time = 0;
-        long int sample_time =
-            static_cast<long int>(1000 * _estimator.getsampletime());
+        common::periodictask estimator_task(
+            "estimator", _estimator.getsampletime(), estimator_property);
+        estimator_task.setloghandler(
+            [](const std::string &_msg) { CLOG(INFO, "estimator") << _msg; },
+            report_cycles);
 
         // State monitor toggle
         StateMonitor::check_estimator();
-        estimator_RTdata = _estimator
-                               .setvalue(gps_data.UTM_x,     // gps_x
-                                         gps_data.UTM_y,     // gps_y
-                                         gps_data.altitude,  // gps_z
-                                         gps_data.roll,      // gps_roll
-                                         gps_data.pitch,     // gps_pitch
-                                         gps_data.heading,   // gps_heading
-                                         gps_data.Ve,        // gps_Ve
-                                         gps_data.Vn,        // gps_Vn
-                                         gps_data.roti       // gps_roti
-                                         )
-                               .getEstimatorRTData();
+        auto gps_data = gps_channel.read().data;
+        auto tracker_RTdata = tracker_channel.read().data;
+        auto controller_RTdata = controller_channel.read().data;
+        auto estimator_RTdata =
+            _estimator
+                .setvalue(gps_data.UTM_x,     // gps_x
+                          gps_data.UTM_y,     // gps_y
+                          gps_data.altitude,  // gps_z
+                          gps_data.roll,      // gps_roll
+                          gps_data.pitch,     // gps_pitch
+                          gps_data.heading,   // gps_heading
+                          gps_data.Ve,        // gps_Ve
+                          gps_data.Vn,        // gps_Vn
+                          gps_data.roti       // gps_roti
+                          )
+                .getEstimatorRTData();
+        estimator_channel.write(estimator_RTdata);
 
         // real time calculation in estimator
-        while (1) {
-          outerloop_elapsed_time = timer_estimator.timeelapsed();
+        estimator_task.run([&]() {
+          gps_channel.read(gps_data);
+          tracker_channel.read(tracker_RTdata);
+          controller_channel.read(controller_RTdata);
 
           _estimator
               .updateestimatedforce(controller_RTdata.BalphaU,
@@ -750,14 +771,8 @@ class threadloop : public StateMonitor {
                                  .estimateerror(tracker_RTdata.setpoint,
                                                 tracker_RTdata.v_setpoint)
                                  .getEstimatorRTData();
-
-          innerloop_elapsed_time = timer_estimator.timeelapsed();
-          std::this_thread::sleep_for(
-              std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-          if (outerloop_elapsed_time > 1.1 * sample_time)
-            CLOG(INFO, "estimator") << "Too much time!";
-        }
+          estimator_channel.write(estimator_RTdata);
+        });
 
         break;
       }
@@ -788,7 +803,28 @@ class threadloop : public StateMonitor {
     _controller_db.create_table();
     _perception_db.create_table();
 
+    auto gps_data = gps_channel.read().data;
+    auto stm32_data = stm32_channel.read().data;
+    auto estimator_RTdata = estimator_channel.read().data;
+    auto tracker_RTdata = tracker_channel.read().data;
+    auto controller_RTdata = controller_channel.read().data;
+    auto Planning_Marine_state = Planning_Marine_channel.read().data;
+    auto RoutePlanner_RTdata = RoutePlanner_channel.read().data;
+    auto MarineRadar_RTdata = MarineRadar_channel.read().data;
+    auto TargetTracker_RTdata = TargetTracker_channel.read().data;
+    auto SpokeProcess_RTdata = SpokeProcess_channel.read().data;
+    auto TargetDetection_RTdata = TargetDetection_channel.read().data;
+
     while (1) {
+      // snapshots of the real time data, and the vectors are reused
+      gps_channel.read(gps_data);
+      stm32_channel.read(stm32_data);
+      estimator_channel.read(estimator_RTdata);
+      tracker_channel.read(tracker_RTdata);
+      controller_channel.read(controller_RTdata);
+      Planning_Marine_channel.read(Planning_Marine_state);
+      RoutePlanner_channel.read(RoutePlanner_RTdata);
+
       switch (testmode) {
         case common::TESTMODE::SIMULATION_DP:
         case common::TESTMODE::SIMULATION_LOS:
@@ -1182,6 +1218,7 @@ class threadloop : public StateMonitor {
             });
           }
 
+          MarineRadar_channel.read(MarineRadar_RTdata);
           std::size_t size_spokedata = sizeof(MarineRadar_RTdata.spokedata) /
                                        sizeof(MarineRadar_RTdata.spokedata[0]);
           _marineradar_db.update_table(common::marineradar_db_data{
@@ -1193,8 +1230,11 @@ class threadloop : public StateMonitor {
                   &MarineRadar_RTdata.spokedata[size_spokedata])  // spokedata
           });
 
+          TargetTracker_channel.read(TargetTracker_RTdata);
           if (TargetTracker_RTdata.spoke_state ==
               ASV::perception::SPOKESTATE::LEAVE_ALARM_ZONE) {
+            SpokeProcess_channel.read(SpokeProcess_RTdata);
+            TargetDetection_channel.read(TargetDetection_RTdata);
             _perception_db.update_spoke_table(common::perception_spoke_db_data{
                 -1,  // local_time
                 SpokeProcess_RTdata
@@ -1278,10 +1318,16 @@ class threadloop : public StateMonitor {
       case common::TESTMODE::EXPERIMENT_FRENET:
       case common::TESTMODE::EXPERIMENT_AVOIDANCE: {
         // experiment
-        messages::stm32_link _stm32_link(stm32_data,
+        messages::stm32_link _stm32_link(stm32_channel.read().data,
                                          _jsonparse.getstm32baudrate(),
                                          _jsonparse.getstm32port());
+        auto guilink_RTdata = guilink_channel.read().data;
+        auto controller_RTdata = controller_channel.read().data;
+        std::string pt_utc = utc_channel.read().data;
         while (1) {
+          guilink_channel.read(guilink_RTdata);
+          controller_channel.read(controller_RTdata);
+          utc_channel.read(pt_utc);
           messages::STM32STATUS _command_stm32 =
               static_cast<messages::STM32STATUS>(
                   guilink_RTdata.guistutus_gui2PC);
@@ -1289,7 +1335,7 @@ class threadloop : public StateMonitor {
               .setstm32data(_command_stm32, pt_utc, controller_RTdata.command_u,
                             controller_RTdata.command_alpha)
               .stm32onestep();
-          stm32_data = _stm32_link.getstmdata();
+          stm32_channel.write(_stm32_link.getstmdata());
         }
 
         break;
@@ -1318,9 +1364,11 @@ class threadloop : public StateMonitor {
                               _jsonparse.getgpsport());
 
         // experiment
+        auto RoutePlanner_RTdata = RoutePlanner_channel.read().data;
         while (1) {
-          gps_data =
-              _gpsimu.parseGPS(RoutePlanner_RTdata.utm_zone).getgpsRTdata();
+          RoutePlanner_channel.read(RoutePlanner_RTdata);
+          gps_channel.write(
+              _gpsimu.parseGPS(RoutePlanner_RTdata.utm_zone).getgpsRTdata());
         }
 
         break;
@@ -1346,10 +1394,10 @@ class threadloop : public StateMonitor {
       }
       case common::TESTMODE::EXPERIMENT_AVOIDANCE: {
         messages::MarineRadar Marine_Radar;
-        Marine_Radar.StartMarineRadar();
+        Marine_Radar.setSpokeRing(MarineRadar_spokering).StartMarineRadar();
         // experiment
         while (1) {
-          MarineRadar_RTdata = Marine_Radar.getMarineRadarRTdata();
+          MarineRadar_channel.write(Marine_Radar.getMarineRadarRTdata());
           std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
         break;
@@ -1375,11 +1423,17 @@ class threadloop : public StateMonitor {
       case common::TESTMODE::EXPERIMENT_FRENET:
       case common::TESTMODE::EXPERIMENT_AVOIDANCE: {
         messages::guilink_serial<num_thruster, 3, dim_controlspace> _gui_link(
-            guilink_RTdata, _jsonparse.getguibaudrate(),
+            guilink_channel.read().data, _jsonparse.getguibaudrate(),
             _jsonparse.getguiport());
 
+        auto stm32_data = stm32_channel.read().data;
+        auto gps_data = gps_channel.read().data;
+        auto estimator_RTdata = estimator_channel.read().data;
         // experiment
         while (1) {
+          stm32_channel.read(stm32_data);
+          gps_channel.read(gps_data);
+          estimator_channel.read(estimator_RTdata);
           Eigen::Vector3d batteries =
               (Eigen::Vector3d() << stm32_data.voltage_b1,
                stm32_data.voltage_b2, stm32_data.voltage_b3)
@@ -1398,7 +1452,7 @@ class threadloop : public StateMonitor {
                                 estimator_RTdata.Measurement_6dof(4),
                                 estimator_RTdata.State, feedback_pwm, batteries)
               .guicommunication();
-          guilink_RTdata = _gui_link.getguilinkRTdata();
+          guilink_channel.write(_gui_link.getguilinkRTdata());
         }
 
         break;
@@ -1414,7 +1468,7 @@ class threadloop : public StateMonitor {
     common::timecounter utc_timer;
 
     while (1) {
-      pt_utc = utc_timer.getUTCtime();
+      utc_channel.write(utc_timer.getUTCtime());
       std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
   }  // utc_timer_loop
@@ -1429,7 +1483,7 @@ class threadloop : public StateMonitor {
         while (1) {
           if ((StateMonitor::indicator_routeplanner ==
                common::STATETOGGLE::IDLE) &&
-              (RoutePlanner_RTdata.state_toggle ==
+              (RoutePlanner_channel.read().data.state_toggle ==
                common::STATETOGGLE::READY)) {
             StateMonitor::indicator_routeplanner = common::STATETOGGLE::READY;
             CLOG(INFO, "route-planner") << "initialation successful!";
@@ -1462,13 +1516,13 @@ class threadloop : public StateMonitor {
         while (1) {
           if ((StateMonitor::indicator_routeplanner ==
                common::STATETOGGLE::IDLE) &&
-              (RoutePlanner_RTdata.state_toggle ==
+              (RoutePlanner_channel.read().data.state_toggle ==
                common::STATETOGGLE::READY)) {
             StateMonitor::indicator_routeplanner = common::STATETOGGLE::READY;
             CLOG(INFO, "route-planner") << "initialation successful!";
           }
 
-          if ((gps_data.status >= 1) &&
+          if ((gps_channel.read().data.status >= 1) &&
               (StateMonitor::indicator_gps == common::STATETOGGLE::IDLE) &&
               (StateMonitor::indicator_routeplanner ==
                common::STATETOGGLE::READY)) {
@@ -1503,12 +1557,12 @@ class threadloop : public StateMonitor {
         while (1) {
           if ((StateMonitor::indicator_routeplanner ==
                common::STATETOGGLE::IDLE) &&
-              (RoutePlanner_RTdata.state_toggle ==
+              (RoutePlanner_channel.read().data.state_toggle ==
                common::STATETOGGLE::READY)) {
             StateMonitor::indicator_routeplanner = common::STATETOGGLE::READY;
             CLOG(INFO, "route-planner") << "initialation successful!";
           }
-          if ((gps_data.status >= 1) &&
+          if ((gps_channel.read().data.status >= 1) &&
               (StateMonitor::indicator_gps == common::STATETOGGLE::IDLE) &&
               (StateMonitor::indicator_routeplanner ==
                common::STATETOGGLE::READY)) {
@@ -1525,7 +1579,8 @@ class threadloop : public StateMonitor {
 
           if ((StateMonitor::indicator_marine_radar ==
                common::STATETOGGLE::IDLE) &&
-              (MarineRadar_RTdata.state_toggle == common::STATETOGGLE::READY)) {
+              (MarineRadar_channel.read().data.state_toggle ==
+               common::STATETOGGLE::READY)) {
             StateMonitor::indicator_marine_radar = common::STATETOGGLE::READY;
             CLOG(INFO, "marine-radar") << "initialation successful!";
           }
@@ -1582,13 +1637,18 @@ class threadloop : public StateMonitor {
         char recv_buffer[recv_size];
         socketmsg _sendmsg = {0.0, 0.0, 0.0, 0.0, 0.0};
 
-        common::timecounter timer_socket;
-        long int outerloop_elapsed_time = 0;
-        long int innerloop_elapsed_time = 0;
-        long int sample_time = 100;
+        // the GUI link is not real time
+        common::periodictask socket_task("socket", 0.1);
+        socket_task.setloghandler(
+            [](const std::string &_msg) { CLOG(INFO, "socket") << _msg; }, 0);
 
-        while (1) {
-          outerloop_elapsed_time = timer_socket.timeelapsed();
+        auto estimator_RTdata = estimator_channel.read().data;
+        auto RoutePlanner_RTdata = RoutePlanner_channel.read().data;
+        auto controller_RTdata = controller_channel.read().data;
+        socket_task.run([&]() {
+          estimator_channel.read(estimator_RTdata);
+          RoutePlanner_channel.read(RoutePlanner_RTdata);
+          controller_channel.read(controller_RTdata);
 
           for (int i = 0; i != 6; ++i)
             _sendmsg.double_msg[i] = estimator_RTdata.State(i);  // State
@@ -1614,14 +1674,7 @@ class threadloop : public StateMonitor {
           }
           _tcpserver.selectserver(recv_buffer, _sendmsg.char_msg, recv_size,
                                   send_size);
-
-          innerloop_elapsed_time = timer_socket.timeelapsed();
-          std::this_thread::sleep_for(
-              std::chrono::milliseconds(sample_time - innerloop_elapsed_time));
-
-          if (outerloop_elapsed_time > 1.1 * sample_time)
-            CLOG(INFO, "socket") << "Too much time!";
-        }
+        });
 
         break;
       }
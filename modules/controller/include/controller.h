@@ -13,6 +13,7 @@
 #define _CONTROLLER_H_
 
 #include <vector>
+#include "common/math/miscellaneous/include/streamingfilter.h"
 #include "common/property/include/vesseldata.h"
 #include "controllerdata.h"
 #include "thrustallocation.h"
@@ -24,7 +25,6 @@ namespace ASV::control {
 template <int L, int m, ACTUATION index_actuation, int n = 3>
 class controller {
   using vectornd = Eigen::Matrix<double, n, 1>;
-  using matrixnld = Eigen::Matrix<double, n, L>;
   using matrixpid = Eigen::Matrix<double, 2, n>;
 
  public:
@@ -44,8 +44,6 @@ class controller {
         velocity_allowed_error(vectornd::Zero()),
         v_max_output(vectornd::Zero()),
         v_min_output(vectornd::Zero()),
-        positionerror_integralmatrix(matrixnld::Zero()),
-        velocityerror_integralmatrix(matrixnld::Zero()),
         lineardamping(_vessel.LinearDamping),
         quadraticdamping(_vessel.QuadraticDamping),
         sample_time(_controllerdata.sample_time),
@@ -153,8 +151,9 @@ class controller {
   vectornd v_max_output;  // max_output of thruster
   vectornd v_min_output;  // min_output of thruster
 
-  matrixnld positionerror_integralmatrix;  // I for position control
-  matrixnld velocityerror_integralmatrix;  // I for velocity control
+  // moving window of error, I for position and velocity control
+  common::math::movingaverage<vectornd, L> positionerror_average;
+  common::math::movingaverage<vectornd, L> velocityerror_average;
 
   Eigen::Matrix3d lineardamping;     // linear damping
   Eigen::Matrix3d quadraticdamping;  // quadratic damping
@@ -246,25 +245,12 @@ class controller {
 
   // calculate the Integral error with moving window
   vectornd updatepositionIntegralMatrix(const vectornd &_error) {
-    matrixnld t_integralmatrix = matrixnld::Zero();
-    int index = L - 1;
-    t_integralmatrix.leftCols(index) =
-        positionerror_integralmatrix.rightCols(index);
-    // t_integralmatrix.col(index) = sample_time * _error;
-    t_integralmatrix.col(index) = _error;
-    positionerror_integralmatrix = t_integralmatrix;
-    return positionerror_integralmatrix.rowwise().mean();
+    return positionerror_average.update(_error);
   }  // updatepositionIntegralMatrix
 
   // calculate the Integral error with moving window
   vectornd updatevelocityIntegralMatrix(const vectornd &_derror) {
-    matrixnld t_integralmatrix = matrixnld::Zero();
-    int index = L - 1;
-    t_integralmatrix.leftCols(index) =
-        velocityerror_integralmatrix.rightCols(index);
-    t_integralmatrix.col(index) = _derror;
-    velocityerror_integralmatrix = t_integralmatrix;
-    return velocityerror_integralmatrix.rowwise().mean();
+    return velocityerror_average.update(_derror);
   }  // updatevelocityIntegralMatrix
 
   // compare the real time position error with the allowed error
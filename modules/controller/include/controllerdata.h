@@ -130,6 +130,15 @@ struct pidcontrollerdata {
   double max_output;
 };
 
+// telemetry of the QP solver in thrust allocation, at each step
+struct QPsolverinfo {
+  int status;          // status of solver (OSQP: 1 solved, <0 failed)
+  int num_iterations;  // # of iterations
+  double solve_time;   // s, update and solution of the QP
+  double rho;          // step size of ADMM, adapted across steps
+  int num_updated;     // # of nonzeros in P and A updated at this step
+};
+
 // real-time data in the controller
 template <int m, int n = 3>
 struct controllerRTdata {
@@ -156,6 +165,9 @@ struct controllerRTdata {
   Eigen::Matrix<double, m, 1> feedback_alpha;
   // deg, angle of all propellers (sent to the actuators)
   Eigen::Matrix<int, m, 1> feedback_alpha_deg;
+
+  // QP solver in thrust allocation
+  QPsolverinfo QP_telemetry{0, 0, 0.0, 0.0, 0};
 };
 
 // real-time data in the trajecotry tracking
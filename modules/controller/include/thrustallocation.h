@@ -25,6 +25,7 @@
 #include "common/logging/include/easylogging++.h"
 #include "controllerdata.h"
 #include "mosek.h"
+#include "thrusterkernel.h"
 
 namespace ASV::control {
 // m: # of all thrusters on the vessel
@@ -37,6 +38,7 @@ class thrustallocation {
   using matrixnmd = Eigen::Matrix<double, n, m>;
   using matrixmmd = Eigen::Matrix<double, m, m>;
   using matrixnnd = Eigen::Matrix<double, n, n>;
+  using kernel = thrusterkernel<m, n>;
 
  public:
   explicit thrustallocation(
@@ -75,7 +77,6 @@ class thrustallocation {
         b(vectornd::Zero()),
         delta_alpha(vectormd::Zero()),
         delta_u(vectormd::Zero()),
-        derivative_dx(1e-6),
         results(Eigen::Matrix<double, 2 * m + n, 1>::Zero()) {
     initializethrusterallocation();
   }
@@ -263,8 +264,6 @@ class thrustallocation {
   // real time physical variable in thruster allocation
   vectormd delta_alpha;  // rad
   vectormd delta_u;      // N
-  // linearized parameters
-  double derivative_dx;  // step size of the derivative
 
   // parameters for Mosek API
   MSKint32t aptrb[2 * m + n], aptre[2 * m + n], asub[6 * m + n];
@@ -966,40 +965,19 @@ class thrustallocation {
 
   // calculate Balpha as function of alpha
   matrixnmd calculateBalpha(const vectormd &t_alpha) {
-    matrixnmd _B_alpha = matrixnmd::Zero();
-    double angle = 0;
-    double t_cos = 0;
-    double t_sin = 0;
-    for (int i = 0; i != m; ++i) {
-      angle = t_alpha(i);
-      t_cos = cos(angle);
-      t_sin = sin(angle);
-      _B_alpha(0, i) = t_cos;
-      _B_alpha(1, i) = t_sin;
-      _B_alpha(2, i) = -ly(i) * t_cos + lx(i) * t_sin;
-    }
-    return _B_alpha;
+    return kernel::Balpha(t_alpha, lx, ly);
   }  // calculateBalpha
 
   // calculate the rho term in thruster allocation
   double calculateRhoTerm(const vectormd &t_alpha, double epsilon = 0.1,
                           double rho = 10) {
-    auto _B_alpha = calculateBalpha(t_alpha);
-    matrixnnd BBT = _B_alpha * _B_alpha.transpose();
-    return rho / (epsilon + BBT.determinant());
+    return kernel::RhoTerm(calculateBalpha(t_alpha), epsilon, rho);
   }  // calculateRhoTerm
 
-  // calculate Jacobian using central difference
-  void calculateJocobianRhoTerm(const vectormd &t_alpha) {
-    for (int i = 0; i != m; ++i) {
-      auto alpha_plus = t_alpha;
-      auto alpha_minus = t_alpha;
-      alpha_plus(i) += derivative_dx;
-      alpha_minus(i) -= derivative_dx;
-      d_rho(i) =
-          (calculateRhoTerm(alpha_plus) - calculateRhoTerm(alpha_minus)) /
-          (2 * derivative_dx);
-    }
+  // calculate Jacobian of the rho term in closed form
+  void calculateJocobianRhoTerm(const matrixnmd &t_B_alpha,
+                                const matrixnmd &t_dB_alpha) {
+    d_rho = kernel::gradientRhoTerm(t_B_alpha, t_dB_alpha);
   }  // calculateJocobianRhoTerm
 
   // calculate the Balpha u term
@@ -1012,17 +990,10 @@ class thrustallocation {
 
   }  // calculateBalphau
 
-  // calculate derivative of Balpha times u
-  void calculateJocobianBalphaU(const vectormd &t_alpha, const vectormd &t_u) {
-    for (int i = 0; i != m; ++i) {
-      auto alpha_plus = t_alpha;
-      auto alpha_minus = t_alpha;
-      alpha_plus(i) += derivative_dx;
-      alpha_minus(i) -= derivative_dx;
-      d_Balpha_u.col(i) = (calculateBalphau(alpha_plus, t_u) -
-                           calculateBalphau(alpha_minus, t_u)) /
-                          (2 * derivative_dx);
-    }
+  // calculate derivative of Balpha times u in closed form
+  void calculateJocobianBalphaU(const matrixnmd &t_dB_alpha,
+                                const vectormd &t_u) {
+    d_Balpha_u = kernel::JacobianBalphaU(t_dB_alpha, t_u);
   }  // calculateJocobianBalphaU
 
   // calculate g_deltau and Q_deltau
@@ -1047,9 +1018,11 @@ class thrustallocation {
     // update BalphaU
     _RTdata.BalphaU = calculateBalphau(B_alpha, _RTdata.feedback_u);
 
+    // dB/dalpha shares the sin and cos in B_alpha
+    matrixnmd dB_alpha = kernel::dBalpha(B_alpha, lx, ly);
     if constexpr (index_actuation == ACTUATION::FULLYACTUATED)
-      calculateJocobianRhoTerm(_RTdata.feedback_alpha);
-    calculateJocobianBalphaU(_RTdata.feedback_alpha, _RTdata.feedback_u);
+      calculateJocobianRhoTerm(B_alpha, dB_alpha);
+    calculateJocobianBalphaU(dB_alpha, _RTdata.feedback_u);
     calculateDeltauQ(_RTdata.feedback_u);
     calculateb(_RTdata.tau, _RTdata.BalphaU);
     calculateconstraints_tunnel(_RTdata, _RTdata.tau(2));
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -25,6 +26,7 @@
 #include "common/logging/include/easylogging++.h"
 #include "controllerdata.h"
 #include "osqp.h"
+#include "thrusterkernel.h"
 
 namespace ASV::control {
 // m: # of all thrusters on the vessel
@@ -37,6 +39,7 @@ class thrustallocation {
   using matrixnmd = Eigen::Matrix<double, n, m>;
   using matrixmmd = Eigen::Matrix<double, m, m>;
   using matrixnnd = Eigen::Matrix<double, n, n>;
+  using kernel = thrusterkernel<m, n>;
 
  public:
   explicit thrustallocation(
@@ -76,7 +79,6 @@ class thrustallocation {
         b_(vectornd::Zero()),
         delta_alpha_(vectormd::Zero()),
         delta_u_(vectormd::Zero()),
-        derivative_dx(1e-6),
         results_(Eigen::Matrix<double, 2 * m + n, 1>::Zero()) {
     initializethrusterallocation();
   }
@@ -99,8 +101,14 @@ class thrustallocation {
   void onestepthrustallocation(controllerRTdata<m, n> &_RTdata) {
     update_formerstep_feedback(_RTdata);
     updateTAparameters(_RTdata);
+    auto t_start = std::chrono::steady_clock::now();
     updateOSQPparameters();
     onestepOSQP();
+    osqp_telemetry.solve_time =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      t_start)
+            .count();
+    _RTdata.QP_telemetry = osqp_telemetry;
     update_nextstep_command(_RTdata);
   }  // onestepthrustallocation
 
@@ -225,6 +233,7 @@ class thrustallocation {
   vectormd delta_alpha() const { return delta_alpha_; }
   vectormd delta_u() const { return delta_u_; }
   Eigen::Matrix<double, 2 * m + n, 1> results() const { return results_; }
+  QPsolverinfo QP_telemetry() const { return osqp_telemetry; }
 
  private:
   const double Q_surge;
@@ -274,8 +283,6 @@ class thrustallocation {
   // real time physical variable in thruster allocation
   vectormd delta_alpha_;  // rad
   vectormd delta_u_;      // N
-  // linearized parameters
-  double derivative_dx;  // step size of the derivative
 
   // array to store the optimization results
   Eigen::Matrix<double, 2 * m + n, 1> results_;
@@ -297,6 +304,26 @@ class thrustallocation {
   OSQPSettings *osqp_settings;
   OSQPData *osqp_data;
 
+  // values in the OSQP workspace, to find the nonzeros of P and A changed
+  // at each step, which are passed to OSQP by index
+  c_float workspace_P_x[2 * m + n];
+  c_float workspace_A_x[2 * (m * n + m + n)];
+  c_float workspace_q[2 * m + n];
+  c_float workspace_l[2 * (m + n)];
+  c_float workspace_u[2 * (m + n)];
+  c_float changed_P_x[2 * m + n];
+  c_int changed_P_idx[2 * m + n];
+  c_float changed_A_x[2 * (m * n + m + n)];
+  c_int changed_A_idx[2 * (m * n + m + n)];
+  // primal and dual solution at the last step for warm start, which are
+  // zero after a failure
+  c_float warm_x[2 * m + n];
+  c_float warm_y[2 * (m + n)];
+
+  QPsolverinfo osqp_telemetry;
+  // time limit of each solution (s), the iterate is used if reached
+  static constexpr double osqp_time_limit = 5e-4;
+
   void initializethrusterallocation() {
     assert(num_tunnel + num_azimuth + num_mainrudder + num_twinfixed == m);
     if (num_twinfixed > 0) assert(num_twinfixed == 2);
@@ -899,40 +926,19 @@ class thrustallocation {
 
   // calculate Balpha as function of alpha
   matrixnmd calculateBalpha(const vectormd &t_alpha) {
-    matrixnmd _B_alpha = matrixnmd::Zero();
-    double angle = 0;
-    double t_cos = 0;
-    double t_sin = 0;
-    for (int i = 0; i != m; ++i) {
-      angle = t_alpha(i);
-      t_cos = cos(angle);
-      t_sin = sin(angle);
-      _B_alpha(0, i) = t_cos;
-      _B_alpha(1, i) = t_sin;
-      _B_alpha(2, i) = -ly_(i) * t_cos + lx_(i) * t_sin;
-    }
-    return _B_alpha;
+    return kernel::Balpha(t_alpha, lx_, ly_);
   }  // calculateBalpha
 
   // calculate the rho term in thruster allocation
   double calculateRhoTerm(const vectormd &t_alpha, double epsilon = 0.1,
                           double rho = 10) {
-    auto _B_alpha = calculateBalpha(t_alpha);
-    matrixnnd BBT = _B_alpha * _B_alpha.transpose();
-    return rho / (epsilon + BBT.determinant());
+    return kernel::RhoTerm(calculateBalpha(t_alpha), epsilon, rho);
   }  // calculateRhoTerm
 
-  // calculate Jacobian using central difference
-  void calculateJocobianRhoTerm(const vectormd &t_alpha) {
-    for (int i = 0; i != m; ++i) {
-      auto alpha_plus = t_alpha;
-      auto alpha_minus = t_alpha;
-      alpha_plus(i) += derivative_dx;
-      alpha_minus(i) -= derivative_dx;
-      d_rho_(i) =
-          (calculateRhoTerm(alpha_plus) - calculateRhoTerm(alpha_minus)) /
-          (2 * derivative_dx);
-    }
+  // calculate Jacobian of the rho term in closed form
+  void calculateJocobianRhoTerm(const matrixnmd &t_B_alpha,
+                                const matrixnmd &t_dB_alpha) {
+    d_rho_ = kernel::gradientRhoTerm(t_B_alpha, t_dB_alpha);
   }  // calculateJocobianRhoTerm
 
   // calculate the Balpha u term
@@ -945,17 +951,10 @@ class thrustallocation {
 
   }  // calculateBalphau
 
-  // calculate derivative of Balpha times u
-  void calculateJocobianBalphaU(const vectormd &t_alpha, const vectormd &t_u) {
-    for (int i = 0; i != m; ++i) {
-      auto alpha_plus = t_alpha;
-      auto alpha_minus = t_alpha;
-      alpha_plus(i) += derivative_dx;
-      alpha_minus(i) -= derivative_dx;
-      d_Balpha_u_.col(i) = (calculateBalphau(alpha_plus, t_u) -
-                            calculateBalphau(alpha_minus, t_u)) /
-                           (2 * derivative_dx);
-    }
+  // calculate derivative of Balpha times u in closed form
+  void calculateJocobianBalphaU(const matrixnmd &t_dB_alpha,
+                                const vectormd &t_u) {
+    d_Balpha_u_ = kernel::JacobianBalphaU(t_dB_alpha, t_u);
   }  // calculateJocobianBalphaU
 
   // calculate g_deltau and Q_deltau
@@ -980,9 +979,11 @@ class thrustallocation {
     // update BalphaU
     _RTdata.BalphaU = calculateBalphau(B_alpha_, _RTdata.feedback_u);
 
+    // dB/dalpha shares the sin and cos in B_alpha
+    matrixnmd dB_alpha = kernel::dBalpha(B_alpha_, lx_, ly_);
     if constexpr (index_actuation == ACTUATION::FULLYACTUATED)
-      calculateJocobianRhoTerm(_RTdata.feedback_alpha);
-    calculateJocobianBalphaU(_RTdata.feedback_alpha, _RTdata.feedback_u);
+      calculateJocobianRhoTerm(B_alpha_, dB_alpha);
+    calculateJocobianBalphaU(dB_alpha, _RTdata.feedback_u);
     calculateDeltauQ(_RTdata.feedback_u);
     calculateb(_RTdata.tau, _RTdata.BalphaU);
     calculateconstraints_tunnel(_RTdata, _RTdata.tau(2));
@@ -1065,13 +1066,28 @@ class thrustallocation {
       osqp_data->u = osqp_u;
     }
 
-    // Define solver settings as default
+    // Define solver settings as default, with warm start and adaptive rho,
+    // which is kept in the workspace across steps
     if (osqp_settings) {
       osqp_set_default_settings(osqp_settings);
+      osqp_settings->warm_start = 1;
+      osqp_settings->adaptive_rho = 1;
+#ifdef PROFILING
+      osqp_settings->time_limit = osqp_time_limit;
+#endif
     }
     osqp_flag = osqp_setup(&osqp_work, osqp_data, osqp_settings);
     if (osqp_flag != 0) CLOG(ERROR, "osqp") << "setup error.";
 
+    std::copy(osqp_P_x, osqp_P_x + numvar, workspace_P_x);
+    std::copy(osqp_A_x, osqp_A_x + A_nnz, workspace_A_x);
+    std::copy(osqp_q, osqp_q + numvar, workspace_q);
+    std::copy(osqp_l, osqp_l + num_constraints, workspace_l);
+    std::copy(osqp_u, osqp_u + num_constraints, workspace_u);
+    std::fill(warm_x, warm_x + numvar, 0.0);
+    std::fill(warm_y, warm_y + num_constraints, 0.0);
+    osqp_telemetry = QPsolverinfo{0, 0, 0.0, osqp_settings->rho, 0};
+
   }  // initializeOSQPAPI
 
   // update parameters in QP for each time step
@@ -1103,13 +1119,55 @@ class thrustallocation {
       osqp_u[n + m + i] = upper_delta_alpha_(i);
     }
 
-    osqp_update_P(osqp_work, osqp_P_x, OSQP_NULL, numvar);
-    osqp_update_A(osqp_work, osqp_A_x, OSQP_NULL, A_nnz);
-    osqp_update_lin_cost(osqp_work, osqp_q);
-    osqp_update_bounds(osqp_work, osqp_l, osqp_u);
+    // only the changed nonzeros of P and A are passed to OSQP, and the KKT
+    // matrix is factorized once if any of them changes
+    c_int num_P = findchanges(osqp_P_x, workspace_P_x, numvar, changed_P_x,
+                              changed_P_idx);
+    c_int num_A = findchanges(osqp_A_x, workspace_A_x, A_nnz, changed_A_x,
+                              changed_A_idx);
+    if ((num_P > 0) && (num_A > 0))
+      osqp_update_P_A(osqp_work, changed_P_x, changed_P_idx, num_P,
+                      changed_A_x, changed_A_idx, num_A);
+    else if (num_P > 0)
+      osqp_update_P(osqp_work, changed_P_x, changed_P_idx, num_P);
+    else if (num_A > 0)
+      osqp_update_A(osqp_work, changed_A_x, changed_A_idx, num_A);
+    osqp_telemetry.num_updated = static_cast<int>(num_P + num_A);
+
+    if (!std::equal(osqp_q, osqp_q + numvar, workspace_q)) {
+      osqp_update_lin_cost(osqp_work, osqp_q);
+      std::copy(osqp_q, osqp_q + numvar, workspace_q);
+    }
+    if (!std::equal(osqp_l, osqp_l + num_constraints, workspace_l) ||
+        !std::equal(osqp_u, osqp_u + num_constraints, workspace_u)) {
+      osqp_update_bounds(osqp_work, osqp_l, osqp_u);
+      std::copy(osqp_l, osqp_l + num_constraints, workspace_l);
+      std::copy(osqp_u, osqp_u + num_constraints, workspace_u);
+    }
+
+    // the iterate in workspace is scaled by the former P and A, so that
+    // the warm start is given by the unscaled solution of the last step
+    osqp_warm_start(osqp_work, warm_x, warm_y);
 
   }  // updateOSQPparameters
 
+  // collect the elements of _new different from _old, and update _old.
+  // Return # of changed elements.
+  static c_int findchanges(const c_float *_new, c_float *_old,
+                           const int _size, c_float *_changed_x,
+                           c_int *_changed_idx) {
+    c_int num_changed = 0;
+    for (int i = 0; i != _size; ++i) {
+      if (_new[i] != _old[i]) {
+        _old[i] = _new[i];
+        _changed_x[num_changed] = _new[i];
+        _changed_idx[num_changed] = i;
+        ++num_changed;
+      }
+    }
+    return num_changed;
+  }  // findchanges
+
   // solve QP using OSQP solver
   void onestepOSQP() {
     // reset the delta value
@@ -1117,9 +1175,31 @@ class thrustallocation {
 
     // Solve Problem
     osqp_solve(osqp_work);
-    if (osqp_work->info->status_val > 0) {
+    c_int status = osqp_work->info->status_val;
+    osqp_telemetry.status = static_cast<int>(status);
+    osqp_telemetry.num_iterations = static_cast<int>(osqp_work->info->iter);
+    osqp_telemetry.rho = osqp_work->settings->rho;
+
+    // the last iterate is used if the solver stops early, which is still
+    // better than no allocation
+    bool is_stopped = (status == OSQP_MAX_ITER_REACHED);
+#ifdef OSQP_TIME_LIMIT_REACHED
+    is_stopped = is_stopped || (status == OSQP_TIME_LIMIT_REACHED);
+#endif
+    if ((status > 0) || is_stopped) {
       for (int i = 0; i != numvar; ++i) results_(i) = osqp_work->solution->x[i];
+      std::copy(osqp_work->solution->x, osqp_work->solution->x + numvar,
+                warm_x);
+      std::copy(osqp_work->solution->y,
+                osqp_work->solution->y + num_constraints, warm_y);
+      if (is_stopped)
+        CLOG(WARNING, "osqp")
+            << "solver stops at " << osqp_telemetry.num_iterations
+            << " iterations.";
     } else {
+      // cold start at the next step
+      std::fill(warm_x, warm_x + numvar, 0.0);
+      std::fill(warm_y, warm_y + num_constraints, 0.0);
       CLOG(ERROR, "osqp") << "solver error.";
     }
 
@@ -0,0 +1,109 @@
+/*
+*******************************************************************************
+* thrusterkernel.h:
+* closed form of the thrust configuration matrix B(alpha), the Jacobian of
+* B(alpha)u and the gradient of the rho term w.r.t. alpha, which are used
+* by the thrust allocation (Mosek and OSQP). The column i of B(alpha) is
+* (cos(a_i), sin(a_i), -ly_i * cos(a_i) + lx_i * sin(a_i)), whatever the
+* type of thruster, so that its derivative only depends on the column.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#ifndef _THRUSTERKERNEL_H_
+#define _THRUSTERKERNEL_H_
+
+#include <common/math/eigen/Eigen/Core>
+#include <common/math/eigen/Eigen/Dense>
+#include <cmath>
+
+namespace ASV::control {
+
+// m: # of all thrusters on the vessel
+// n: # of dimension of control space (surge, sway and yaw)
+template <int m, int n = 3>
+class thrusterkernel {
+  static_assert(n == 3, "B(alpha) is defined for surge, sway and yaw");
+
+  using vectormd = Eigen::Matrix<double, m, 1>;
+  using matrixnmd = Eigen::Matrix<double, n, m>;
+  using matrixnnd = Eigen::Matrix<double, n, n>;
+
+ public:
+  // B(alpha) of thrusters located at (lx, ly)
+  static matrixnmd Balpha(const vectormd &_alpha, const vectormd &_lx,
+                          const vectormd &_ly) {
+    matrixnmd _B_alpha;
+    for (int i = 0; i != m; ++i) {
+      double t_cos = std::cos(_alpha(i));
+      double t_sin = std::sin(_alpha(i));
+      _B_alpha(0, i) = t_cos;
+      _B_alpha(1, i) = t_sin;
+      _B_alpha(2, i) = -_ly(i) * t_cos + _lx(i) * t_sin;
+    }
+    return _B_alpha;
+  }  // Balpha
+
+  // column i is dB_i/dalpha_i, given by the cos and sin in column i of
+  // B(alpha)
+  static matrixnmd dBalpha(const matrixnmd &_B_alpha, const vectormd &_lx,
+                           const vectormd &_ly) {
+    matrixnmd _dB_alpha;
+    _dB_alpha.row(0) = -_B_alpha.row(1);
+    _dB_alpha.row(1) = _B_alpha.row(0);
+    _dB_alpha.row(2) = _ly.transpose().cwiseProduct(_B_alpha.row(1)) +
+                       _lx.transpose().cwiseProduct(_B_alpha.row(0));
+    return _dB_alpha;
+  }  // dBalpha
+
+  // Jacobian of B(alpha)u w.r.t. alpha
+  static matrixnmd JacobianBalphaU(const matrixnmd &_dB_alpha,
+                                   const vectormd &_u) {
+    return _dB_alpha * _u.asDiagonal();
+  }  // JacobianBalphaU
+
+  // rho / (epsilon + det(B * B^T)), to avoid the singular configuration
+  static double RhoTerm(const matrixnmd &_B_alpha, const double _epsilon = 0.1,
+                        const double _rho = 10) {
+    matrixnnd BBT = _B_alpha * _B_alpha.transpose();
+    return _rho / (_epsilon + BBT.determinant());
+  }  // RhoTerm
+
+  // gradient of the rho term w.r.t. alpha. The derivative of det(M) is
+  // trace(adj(M) * dM), where dM = dB_i * B_i^T + B_i * dB_i^T, so that
+  // d(det)/dalpha_i = 2 * B_i^T * adj(M) * dB_i. The adjugate is used,
+  // since M is singular for less than 3 thrusters.
+  static vectormd gradientRhoTerm(const matrixnmd &_B_alpha,
+                                  const matrixnmd &_dB_alpha,
+                                  const double _epsilon = 0.1,
+                                  const double _rho = 10) {
+    matrixnnd BBT = _B_alpha * _B_alpha.transpose();
+    double denominator = _epsilon + BBT.determinant();
+    matrixnmd adj_dB = adjugate(BBT) * _dB_alpha;
+    return (-2 * _rho / (denominator * denominator)) *
+           _B_alpha.cwiseProduct(adj_dB).colwise().sum().transpose();
+  }  // gradientRhoTerm
+
+ private:
+  // adjugate of a symmetric 3x3 matrix
+  static matrixnnd adjugate(const matrixnnd &_M) {
+    matrixnnd adj;
+    adj(0, 0) = _M(1, 1) * _M(2, 2) - _M(1, 2) * _M(2, 1);
+    adj(0, 1) = _M(0, 2) * _M(2, 1) - _M(0, 1) * _M(2, 2);
+    adj(0, 2) = _M(0, 1) * _M(1, 2) - _M(0, 2) * _M(1, 1);
+    adj(1, 1) = _M(0, 0) * _M(2, 2) - _M(0, 2) * _M(2, 0);
+    adj(1, 2) = _M(0, 2) * _M(1, 0) - _M(0, 0) * _M(1, 2);
+    adj(2, 2) = _M(0, 0) * _M(1, 1) - _M(0, 1) * _M(1, 0);
+    adj(1, 0) = adj(0, 1);
+    adj(2, 0) = adj(0, 2);
+    adj(2, 1) = adj(1, 2);
+    return adj;
+  }  // adjugate
+
+};  // end class thrusterkernel
+
+}  // namespace ASV::control
+
+#endif /* _THRUSTERKERNEL_H_ */
@@ -1,7 +1,8 @@
 /*
 *******************************************************************************
 * testthrust_osqp.cc:
-* unit test for thrust allocation
+* unit test for thrust allocation. The warm-started, incrementally updated
+* QP is compared with a cold solve set up from scratch at each step.
 * This header file can be read by C++ compilers
 *
 * by Hu.ZH(CrossOcean.ai)
@@ -14,6 +15,93 @@
 using namespace ASV::control;
 using namespace ASV::common;
 
+// cold solve of the QP at the last step of _TA, which is set up from
+// scratch with the same parameters (no warm start, no update), and solved
+// to a tight tolerance
+template <int m, ACTUATION index_actuation, int n>
+Eigen::Matrix<double, 2 * m + n, 1> coldsolve(
+    const thrustallocation<m, index_actuation, n> &_TA, int &_iterations) {
+  constexpr int numvar = 2 * m + n;
+  constexpr int num_constraints = numvar + n;
+  constexpr int A_nnz = 2 * (m * n + m + n);
+
+  // P = diag(Q_deltau, Omega, Q), q = (g_deltau, d_rho, 0)
+  c_float P_x[numvar], q[numvar];
+  c_int P_i[numvar], P_p[numvar + 1];
+  for (int i = 0; i != m; ++i) {
+    P_x[i] = _TA.Q_deltau()(i, i);
+    P_x[m + i] = _TA.Omega()(i, i);
+    q[i] = _TA.g_deltau()(i);
+    q[m + i] = _TA.d_rho()(i);
+  }
+  for (int i = 0; i != n; ++i) {
+    P_x[2 * m + i] = _TA.Q()(i, i);
+    q[2 * m + i] = 0;
+  }
+  for (int i = 0; i != numvar; ++i) P_i[i] = P_p[i] = i;
+  P_p[numvar] = numvar;
+
+  // B_alpha * delta_u + d_Balpha_u * delta_alpha + s = b, and the bounds
+  // of delta_u, delta_alpha
+  c_float A_x[A_nnz], l[num_constraints], u[num_constraints];
+  c_int A_i[A_nnz], A_p[numvar + 1];
+  int k = 0;
+  for (int i = 0; i != numvar; ++i) {
+    A_p[i] = k;
+    for (int j = 0; j != n; ++j) {
+      if (i >= 2 * m) {
+        if (j != i - 2 * m) continue;
+        A_x[k] = 1.0;
+      } else {
+        A_x[k] = (i < m) ? _TA.B_alpha()(j, i) : _TA.d_Balpha_u()(j, i - m);
+      }
+      A_i[k++] = j;
+    }
+    A_x[k] = 1.0;
+    A_i[k++] = n + i;
+  }
+  A_p[numvar] = k;
+  for (int i = 0; i != n; ++i) {
+    l[i] = u[i] = _TA.b()(i);
+    l[numvar + i] = -OSQP_INFTY;
+    u[numvar + i] = OSQP_INFTY;
+  }
+  for (int i = 0; i != m; ++i) {
+    l[n + i] = _TA.lower_delta_u()(i);
+    u[n + i] = _TA.upper_delta_u()(i);
+    l[n + m + i] = _TA.lower_delta_alpha()(i);
+    u[n + m + i] = _TA.upper_delta_alpha()(i);
+  }
+
+  OSQPData data{numvar,
+                num_constraints,
+                csc_matrix(numvar, numvar, numvar, P_x, P_i, P_p),
+                q,
+                csc_matrix(num_constraints, numvar, k, A_x, A_i, A_p),
+                l,
+                u};
+  OSQPSettings settings;
+  osqp_set_default_settings(&settings);
+  settings.warm_start = 0;
+  settings.eps_abs = 1e-9;
+  settings.eps_rel = 1e-9;
+  settings.max_iter = 100000;
+  OSQPWorkspace *work = nullptr;
+  Eigen::Matrix<double, 2 * m + n, 1> x =
+      Eigen::Matrix<double, 2 * m + n, 1>::Constant(NAN);
+  _iterations = -1;
+  if (osqp_setup(&work, &data, &settings) == 0) {
+    osqp_solve(work);
+    _iterations = static_cast<int>(work->info->iter);
+    if (work->info->status_val == OSQP_SOLVED)
+      for (int i = 0; i != numvar; ++i) x(i) = work->solution->x[i];
+  }
+  osqp_cleanup(work);
+  c_free(data.P);
+  c_free(data.A);
+  return x;
+}  // coldsolve
+
 // illustrate the results using gnuplot
 void plotTAresults(const Eigen::MatrixXd &plot_u,
                    const Eigen::MatrixXi &plot_rotation,
@@ -249,7 +337,7 @@ void testonestepthrustallocation() {
 }  // testonestepthrustallocation
 
 // test thrust allocation for 3 propellers (fully actuated)
-void test_multiplethrusterallocation() {
+bool test_multiplethrusterallocation(const bool _plot) {
   // set the parameters in the thrust allocation
   const int m = 3;
   const int n = 3;
@@ -360,6 +448,18 @@ void test_multiplethrusterallocation() {
                                    0.05 * Eigen::MatrixXd::Random(1, 100);
   save_tau.row(0) = 0 * Eigen::MatrixXd::Constant(1, totalstep, 1) +
                     0.00 * Eigen::MatrixXd::Random(1, totalstep);
+
+  // telemetry of QP solver
+  constexpr int numvar = 2 * m + n;
+  constexpr int num_nonzeros = numvar + 2 * (m * n + m + n);  // P and A
+  double max_solve_time = 0;
+  double total_solve_time = 0;
+  int total_iterations = 0;
+  int total_cold_iterations = 0;
+  int num_unsolved = 0;
+  int num_insane = 0;      // telemetry out of range
+  int num_mismatched = 0;  // warm and cold solutions differ
+  double max_difference = 0;
   for (int i = 0; i != totalstep; ++i) {
     // update tau
     _controllerRTdata.tau = save_tau.col(i);
@@ -375,23 +475,58 @@ void test_multiplethrusterallocation() {
     save_alpha_deg.col(i) = _controllerRTdata.command_alpha_deg;
     save_Balphau.col(i) = _controllerRTdata.BalphaU;
     save_rotation.col(i) = _controllerRTdata.command_rotation;
-  }
 
-  plotTAresults(save_u, save_rotation, save_alpha, save_alpha_deg, save_Balphau,
-                save_tau);
+    auto const &telemetry = _controllerRTdata.QP_telemetry;
+    max_solve_time = std::max(max_solve_time, telemetry.solve_time);
+    total_solve_time += telemetry.solve_time;
+    total_iterations += telemetry.num_iterations;
+    if (telemetry.status != 1) ++num_unsolved;
+    if ((telemetry.num_iterations <= 0) || (telemetry.num_iterations > 4000) ||
+        !(telemetry.solve_time > 0) || (telemetry.solve_time > 1) ||
+        !(telemetry.rho > 0) || (telemetry.num_updated < 0) ||
+        (telemetry.num_updated > num_nonzeros) ||
+        ((i == 0) && (telemetry.num_updated == 0)))
+      ++num_insane;
+
+    // the allocation is solved to eps_abs = eps_rel = 1e-3
+    int cold_iterations = 0;
+    auto cold_results = coldsolve(_thrustallocation, cold_iterations);
+    total_cold_iterations += cold_iterations;
+    double difference =
+        (_thrustallocation.results() - cold_results).cwiseAbs().maxCoeff();
+    double scale = 1 + cold_results.cwiseAbs().maxCoeff();
+    max_difference = std::max(max_difference, difference / scale);
+    if (!(difference <= 1e-2 * scale)) ++num_mismatched;
+  }
+  std::cout << "QP solve time(ms): mean " << 1e3 * total_solve_time / totalstep
+            << ", max " << 1e3 * max_solve_time << "; iterations: mean "
+            << static_cast<double>(total_iterations) / totalstep
+            << " (cold "
+            << static_cast<double>(total_cold_iterations) / totalstep
+            << "); unsolved: " << num_unsolved << "; rho: "
+            << _controllerRTdata.QP_telemetry.rho << std::endl;
+  std::cout << "warm vs cold: max relative difference " << max_difference
+            << ", mismatched " << num_mismatched << "; insane telemetry "
+            << num_insane << std::endl;
+
+  if (_plot)
+    plotTAresults(save_u, save_rotation, save_alpha, save_alpha_deg,
+                  save_Balphau, save_tau);
+  return (num_unsolved == 0) && (num_insane == 0) && (num_mismatched == 0);
 }
 
-int main() {
+// the results are plotted with any argument, e.g. "testthrust_osqp plot"
+int main(int argc, char *[]) {
   el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
   LOG(INFO) << "The program has started!";
 
   // testonestepthrustallocation();
-  test_multiplethrusterallocation();
+  bool passed = test_multiplethrusterallocation(argc > 1);
   // testrudder();
   // test_twinfixed();
   // testbiling();
   // testoutboard();
 
   LOG(INFO) << "Shutting down.";
-  return 0;
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+*******************************************************************************
+* testthrusterkernel.cc:
+* unit test for the closed form of B(alpha), the Jacobian of B(alpha)u and
+* the gradient of rho term, compared with the central difference used
+* before, and the time of both.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "../include/thrusterkernel.h"
+
+using namespace ASV::control;
+using steady = std::chrono::steady_clock;
+
+// central difference, the same as thrust allocation did before
+template <int m>
+struct centraldifference {
+  using vectormd = Eigen::Matrix<double, m, 1>;
+  using matrixnmd = Eigen::Matrix<double, 3, m>;
+  using kernel = thrusterkernel<m>;
+  static constexpr double dx = 1e-6;
+
+  static vectormd gradientRhoTerm(const vectormd &_alpha, const vectormd &_lx,
+                                  const vectormd &_ly) {
+    vectormd d_rho;
+    for (int i = 0; i != m; ++i) {
+      vectormd alpha_plus = _alpha;
+      vectormd alpha_minus = _alpha;
+      alpha_plus(i) += dx;
+      alpha_minus(i) -= dx;
+      d_rho(i) = (kernel::RhoTerm(kernel::Balpha(alpha_plus, _lx, _ly)) -
+                  kernel::RhoTerm(kernel::Balpha(alpha_minus, _lx, _ly))) /
+                 (2 * dx);
+    }
+    return d_rho;
+  }  // gradientRhoTerm
+
+  static matrixnmd JacobianBalphaU(const vectormd &_alpha,
+                                   const vectormd &_u, const vectormd &_lx,
+                                   const vectormd &_ly) {
+    matrixnmd d_Balpha_u;
+    for (int i = 0; i != m; ++i) {
+      vectormd alpha_plus = _alpha;
+      vectormd alpha_minus = _alpha;
+      alpha_plus(i) += dx;
+      alpha_minus(i) -= dx;
+      d_Balpha_u.col(i) = (kernel::Balpha(alpha_plus, _lx, _ly) * _u -
+                           kernel::Balpha(alpha_minus, _lx, _ly) * _u) /
+                          (2 * dx);
+    }
+    return d_Balpha_u;
+  }  // JacobianBalphaU
+};
+
+template <int m>
+bool testkernel(const int _num_samples) {
+  using vectormd = Eigen::Matrix<double, m, 1>;
+  using matrixnmd = Eigen::Matrix<double, 3, m>;
+  using kernel = thrusterkernel<m>;
+  using reference = centraldifference<m>;
+
+  std::srand(m);
+  vectormd lx = 2 * vectormd::Random();
+  vectormd ly = vectormd::Random();
+  double max_error_rho = 0, max_error_bu = 0;
+  for (int k = 0; k != 100; ++k) {
+    vectormd alpha = M_PI * vectormd::Random();
+    vectormd u = 10 * (vectormd::Random() + vectormd::Ones());
+
+    matrixnmd B_alpha = kernel::Balpha(alpha, lx, ly);
+    matrixnmd dB_alpha = kernel::dBalpha(B_alpha, lx, ly);
+    vectormd d_rho = kernel::gradientRhoTerm(B_alpha, dB_alpha);
+    matrixnmd d_Balpha_u = kernel::JacobianBalphaU(dB_alpha, u);
+
+    vectormd fd_rho = reference::gradientRhoTerm(alpha, lx, ly);
+    matrixnmd fd_Balpha_u = reference::JacobianBalphaU(alpha, u, lx, ly);
+    max_error_rho = std::max(max_error_rho,
+                             (d_rho - fd_rho).cwiseAbs().maxCoeff() /
+                                 (1 + fd_rho.cwiseAbs().maxCoeff()));
+    max_error_bu = std::max(max_error_bu,
+                            (d_Balpha_u - fd_Balpha_u).cwiseAbs().maxCoeff() /
+                                (1 + fd_Balpha_u.cwiseAbs().maxCoeff()));
+  }
+
+  // time of the linearization in each step of thrust allocation
+  vectormd alpha = vectormd::Random();
+  vectormd u = vectormd::Ones();
+  double checksum = 0;
+  auto t0 = steady::now();
+  for (int k = 0; k != _num_samples; ++k) {
+    alpha(k % m) += 1e-3;
+    matrixnmd B_alpha = kernel::Balpha(alpha, lx, ly);
+    matrixnmd dB_alpha = kernel::dBalpha(B_alpha, lx, ly);
+    checksum += kernel::gradientRhoTerm(B_alpha, dB_alpha).sum();
+    checksum += kernel::JacobianBalphaU(dB_alpha, u).sum();
+  }
+  auto t1 = steady::now();
+  for (int k = 0; k != _num_samples; ++k) {
+    alpha(k % m) += 1e-3;
+    checksum += kernel::Balpha(alpha, lx, ly).sum();
+    checksum += reference::gradientRhoTerm(alpha, lx, ly).sum();
+    checksum += reference::JacobianBalphaU(alpha, u, lx, ly).sum();
+  }
+  auto t2 = steady::now();
+  double closed_ns =
+      std::chrono::duration<double, std::nano>(t1 - t0).count() /
+      _num_samples;
+  double difference_ns =
+      std::chrono::duration<double, std::nano>(t2 - t1).count() /
+      _num_samples;
+
+  bool passed = (max_error_rho < 1e-6) && (max_error_bu < 1e-6);
+  std::cout << "m = " << m << ": error of d_rho " << max_error_rho
+            << ", error of d_Balpha_u " << max_error_bu << ", closed form "
+            << closed_ns << " ns, central difference " << difference_ns
+            << " ns" << (passed ? ", passed" : ", failed") << " (" << checksum
+            << ")\n";
+  return passed;
+}  // testkernel
+
+int main() {
+  constexpr int num_samples = 100000;
+  bool passed = true;
+  passed &= testkernel<1>(num_samples);
+  passed &= testkernel<2>(num_samples);
+  passed &= testkernel<3>(num_samples);
+  passed &= testkernel<4>(num_samples);
+  passed &= testkernel<6>(num_samples);
+  passed &= testkernel<8>(num_samples);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -11,37 +11,25 @@
 #ifndef _LOWPASS_H_
 #define _LOWPASS_H_
 
-#include <common/math/eigen/Eigen/Core>
-#include <common/math/eigen/Eigen/Dense>
+#include "common/math/miscellaneous/include/streamingfilter.h"
 
 namespace ASV::localization {
 
 template <int num_lowpass>
 class lowpass {
-  using vectorlp = Eigen::Matrix<double, num_lowpass, 1>;
-
  public:
-  lowpass() : averagevector(vectorlp::Zero()) {}
+  lowpass() {}
   ~lowpass() {}
 
-  // assign the same value to all elements of "averagevector"
+  // assign the same value to all elements of the moving window
   void setaveragevector(double _initialvalue) {
-    averagevector = vectorlp::Constant(_initialvalue);
-  }
-  // low pass filtering using moving average method
-  double movingaverage(double _newstep) {
-    // pop_front
-    vectorlp t_average = vectorlp::Zero();
-    t_average.head(num_lowpass - 1) = averagevector.tail(num_lowpass - 1);
-    // push back
-    t_average(num_lowpass - 1) = _newstep;
-    averagevector = t_average;
-    // calculate the mean value
-    return averagevector.mean();
+    average.reset(_initialvalue);
   }
+  // low pass filtering using moving average method, O(1) per sample
+  double movingaverage(double _newstep) { return average.update(_newstep); }
 
  private:
-  vectorlp averagevector;
+  common::math::movingaverage<double, num_lowpass> average;
 };  // end class lowpass
 
 }  // namespace ASV::localization
@@ -19,6 +19,7 @@
 #include <chrono>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <thread>
 
 #include "MarineRadarData.h"
@@ -52,8 +53,11 @@ class MarineRadar
             common::STATETOGGLE::IDLE,  // state_toggle
             0.0,                        // spoke_azimuth_deg
             0.0,                        // spoke_samplerange_m
-            {0x00, 0x00, 0x00}          // spokedata
-        }) {
+            {0x00, 0x00, 0x00},         // spokedata
+            0,                          // num_spokes
+            0                           // num_spoke_overruns
+        }),
+        spoke_ring(nullptr) {
     m_pImageClient = new Navico::Protocol::NRP::tImageClient();
     m_pTargetClient = new Navico::Protocol::NRP::tTargetTrackingClient();
     InitProtocolData();
@@ -101,6 +105,15 @@ class MarineRadar
     return MarineRadar_RTdata;
   }
 
+  // every spoke is pushed into the ring (if set) by the spoke callback.
+  // It should be set before StartMarineRadar(), and be drained by a single
+  // consumer (e.g. TargetTracking::AutoTracking)
+  MarineRadar &setSpokeRing(
+      const std::shared_ptr<MarineRadarSpokeRing> &_spoke_ring) {
+    spoke_ring = _spoke_ring;
+    return *this;
+  }  // setSpokeRing
+
  private:
   //-------------------------------------------------------------------------
   //  Observer Callbacks
@@ -120,6 +133,15 @@ class MarineRadar
         1000.0;
     memcpy(MarineRadar_RTdata.spokedata, pSpoke->data, SAMPLES_PER_SPOKE / 2);
 
+    // push the whole spoke into the ring, so that none of them is missed
+    ++MarineRadar_RTdata.num_spokes;
+    if (spoke_ring) {
+      spoke_ring->push(pSpoke->header.sequenceNumber,
+                       MarineRadar_RTdata.spoke_azimuth_deg,
+                       MarineRadar_RTdata.spoke_samplerange_m, pSpoke->data);
+      MarineRadar_RTdata.num_spoke_overruns = spoke_ring->num_overruns();
+    }
+
   }  // UpdateSpoke
 
   // iImageClientStateObserver callbacks
@@ -1155,6 +1177,7 @@ class MarineRadar
   MultiRadar* m_pMultiRadar;
   Navico::Protocol::NRP::Spoke::t9174Spoke m_pSpoke;
   MarineRadarRTdata MarineRadar_RTdata;
+  std::shared_ptr<MarineRadarSpokeRing> spoke_ring;
   bool m_AlarmTypes[Navico::Protocol::NRP::cMaxGuardZones];
 };
 
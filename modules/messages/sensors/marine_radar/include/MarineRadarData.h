@@ -23,6 +23,8 @@
 
 #include "common/property/include/priority.h"
 
+#include "SpokeRingBuffer.h"
+
 namespace ASV::messages {
 
 enum class GUARDZONE {
@@ -41,8 +43,16 @@ struct MarineRadarRTdata {
   double spoke_azimuth_deg;
   double spoke_samplerange_m;
   uint8_t spokedata[SAMPLES_PER_SPOKE / 2];
+
+  // # of spokes received, and dropped because the ring was full
+  std::size_t num_spokes;
+  std::size_t num_spoke_overruns;
 };
 
+// ring of spokes from the callback of radar to target tracking,
+// about two revolutions (2048 spokes per revolution)
+using MarineRadarSpokeRing = SpokeRingBuffer<SAMPLES_PER_SPOKE / 2, 4096>;
+
 }  // namespace ASV::messages
 
 #endif /* _MARINERADARDATA_H_ */
@@ -0,0 +1,132 @@
+/*
+****************************************************************************
+* SpokeRingBuffer.h:
+* single-producer/single-consumer lock-free ring of radar spokes. The
+* spoke callback of marine radar pushes each spoke (header + samples), and
+* target tracking drains them in batches, so that every spoke is processed
+* exactly once. A spoke is dropped and counted as overrun if the ring is
+* full.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _SPOKERINGBUFFER_H_
+#define _SPOKERINGBUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ASV::messages {
+
+template <std::size_t num_bytes>
+struct SpokeRecord {
+  uint32_t sequence_number;  // spoke sequence number given by radar
+  double spoke_azimuth_deg;
+  double spoke_samplerange_m;
+  uint8_t spokedata[num_bytes];
+};
+
+template <std::size_t num_bytes, std::size_t capacity = 4096>
+class SpokeRingBuffer {
+  static_assert((capacity > 1) && ((capacity & (capacity - 1)) == 0),
+                "capacity of ring should be a power of 2");
+
+ public:
+  using Record = SpokeRecord<num_bytes>;
+
+  // the records are on the heap, as one revolution is about 1 MB
+  SpokeRingBuffer()
+      : records_(capacity), head_(0), tail_(0), num_overruns_(0) {}
+
+  SpokeRingBuffer(const SpokeRingBuffer &) = delete;
+  SpokeRingBuffer &operator=(const SpokeRingBuffer &) = delete;
+
+  virtual ~SpokeRingBuffer() = default;
+
+  // producer: copy one spoke into the ring. Return false if the ring is
+  // full, where the spoke is dropped and the overrun counter increases.
+  bool push(const uint32_t _sequence_number, const double _spoke_azimuth_deg,
+            const double _spoke_samplerange_m, const uint8_t *_spokedata) {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == capacity) {
+      num_overruns_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    Record &_record = records_[head & (capacity - 1)];
+    _record.sequence_number = _sequence_number;
+    _record.spoke_azimuth_deg = _spoke_azimuth_deg;
+    _record.spoke_samplerange_m = _spoke_samplerange_m;
+    std::memcpy(_record.spokedata, _spokedata, num_bytes);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }  // push
+
+  // consumer: call _visitor(const Record &) on the pending spokes in order,
+  // at most _max_num_spokes of them. The records are read in place and
+  // released once visited. If _visitor returns false, the drain stops after
+  // the current spoke. Return the # of consumed spokes.
+  template <typename Visitor>
+  std::size_t consume(Visitor &&_visitor,
+                      const std::size_t _max_num_spokes = capacity) {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    std::size_t head = head_.load(std::memory_order_acquire);
+    std::size_t num_spokes = 0;
+    while ((tail != head) && (num_spokes != _max_num_spokes)) {
+      bool next = _visitor(
+          static_cast<const Record &>(records_[tail & (capacity - 1)]));
+      ++tail;
+      ++num_spokes;
+      tail_.store(tail, std::memory_order_release);
+      if (!next) break;
+    }
+    return num_spokes;
+  }  // consume
+
+  // consumer: copy out the oldest spoke, return false if empty
+  bool pop(Record &_record) {
+    return consume(
+               [&_record](const Record &_pending) {
+                 _record = _pending;
+                 return false;
+               },
+               1) == 1;
+  }  // pop
+
+  // # of spokes waiting to be consumed
+  std::size_t size() const noexcept {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const noexcept { return size() == 0; }
+  static constexpr std::size_t max_size() noexcept { return capacity; }
+
+  // # of spokes pushed into the ring since construction
+  std::size_t num_pushed() const noexcept {
+    return head_.load(std::memory_order_acquire);
+  }
+  // # of spokes consumed since construction
+  std::size_t num_consumed() const noexcept {
+    return tail_.load(std::memory_order_acquire);
+  }
+  // # of spokes dropped because the ring was full
+  std::size_t num_overruns() const noexcept {
+    return num_overruns_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::vector<Record> records_;
+  // head_ is written by producer, tail_ by consumer only. They are on
+  // separate cache lines to avoid false sharing.
+  alignas(64) std::atomic<std::size_t> head_;
+  alignas(64) std::atomic<std::size_t> tail_;
+  alignas(64) std::atomic<std::size_t> num_overruns_;
+
+};  // end class SpokeRingBuffer
+
+}  // namespace ASV::messages
+
+#endif /* _SPOKERINGBUFFER_H_ */
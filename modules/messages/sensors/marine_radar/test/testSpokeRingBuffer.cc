@@ -0,0 +1,93 @@
+/*
+****************************************************************************
+* testSpokeRingBuffer.cc:
+* unit test for the lock-free ring of spokes, where one thread pushes the
+* spokes and another one drains them in batches
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include "../include/SpokeRingBuffer.h"
+
+using namespace ASV::messages;
+
+constexpr std::size_t num_bytes = 512;
+
+// every sample of a spoke is filled with the same byte, so that a torn
+// spoke can be found
+template <std::size_t capacity>
+bool test_ring(const std::size_t num_spokes, const bool slow_consumer) {
+  SpokeRingBuffer<num_bytes, capacity> spoke_ring;
+
+  std::thread producer([&spoke_ring, num_spokes]() {
+    uint8_t spokedata[num_bytes];
+    for (std::size_t i = 0; i != num_spokes; ++i) {
+      std::memset(spokedata, static_cast<int>(i & 0xff), num_bytes);
+      spoke_ring.push(static_cast<uint32_t>(i), 360.0 * i / 2048, 0.1 * i,
+                      spokedata);
+    }
+  });
+
+  std::size_t num_consumed = 0;
+  std::size_t num_torn = 0;
+  std::size_t num_disordered = 0;
+  long long previous_sequence = -1;
+  auto check_spoke = [&](const SpokeRecord<num_bytes> &_spoke) {
+    uint8_t expected = static_cast<uint8_t>(_spoke.sequence_number & 0xff);
+    for (std::size_t j = 0; j != num_bytes; ++j)
+      if (_spoke.spokedata[j] != expected) {
+        ++num_torn;
+        break;
+      }
+    if (_spoke.spoke_samplerange_m != 0.1 * _spoke.sequence_number) ++num_torn;
+    if (static_cast<long long>(_spoke.sequence_number) <= previous_sequence)
+      ++num_disordered;
+    previous_sequence = _spoke.sequence_number;
+    return true;
+  };
+
+  while (true) {
+    bool finished = (spoke_ring.num_pushed() + spoke_ring.num_overruns() ==
+                     num_spokes);
+    num_consumed += spoke_ring.consume(check_spoke, 64);
+    if (finished && spoke_ring.empty()) break;
+    if (slow_consumer) std::this_thread::yield();
+  }
+  producer.join();
+
+  bool passed = (num_torn == 0) && (num_disordered == 0) &&
+                (num_consumed == spoke_ring.num_pushed()) &&
+                (num_consumed == spoke_ring.num_consumed()) &&
+                (num_consumed + spoke_ring.num_overruns() == num_spokes);
+  std::cout << "capacity: " << capacity << ", pushed: " << num_spokes
+            << ", consumed: " << num_consumed
+            << ", overruns: " << spoke_ring.num_overruns()
+            << ", torn: " << num_torn << ", disordered: " << num_disordered
+            << (passed ? ", passed\n" : ", failed\n");
+  return passed;
+}  // test_ring
+
+int main() {
+  bool passed = true;
+  // the ring is large enough for all the spokes
+  passed &= test_ring<1 << 16>(50000, false);
+  // the ring is too small, some spokes are dropped
+  passed &= test_ring<16>(200000, false);
+  passed &= test_ring<16>(200000, true);
+
+  // copy out one by one
+  SpokeRingBuffer<num_bytes, 4> spoke_ring;
+  uint8_t spokedata[num_bytes] = {0x00};
+  for (uint32_t i = 0; i != 6; ++i) spoke_ring.push(i, 0.0, 0.0, spokedata);
+  SpokeRecord<num_bytes> _spoke;
+  for (uint32_t i = 0; i != 4; ++i)
+    passed &= spoke_ring.pop(_spoke) && (_spoke.sequence_number == i);
+  passed &= !spoke_ring.pop(_spoke) && (spoke_ring.num_overruns() == 2);
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
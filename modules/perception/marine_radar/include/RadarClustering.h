@@ -0,0 +1,420 @@
+/*
+****************************************************************************
+* RadarClustering.h:
+* DBSCAN clustering of the radar echoes. The neighbors are found on a
+* uniform grid (cell size = radius) in the marine coordinate, or on a
+* polar grid of range rings and azimuth sectors; the core points are
+* merged by union-find. The clusters are the same as the ones of
+* pyclustering::clst::dbscan: a border point belongs to the first cluster
+* (ordered by the smallest index of core point) which reaches it.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _RADARCLUSTERING_H_
+#define _RADARCLUSTERING_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace ASV::perception {
+
+class RadarDBSCAN {
+ public:
+  // a point is core if it has at least "minimum_neighbors" other points
+  // within "radius" (squared distance <= radius^2)
+  explicit RadarDBSCAN(const double radius = 1.0,
+                       const std::size_t minimum_neighbors = 2,
+                       const std::size_t max_num_cells = 1 << 20)
+      : radius_(radius),
+        minimum_neighbors_(minimum_neighbors),
+        max_num_cells_(max_num_cells),
+        cell_size_(radius),
+        origin_x_(0.0),
+        origin_y_(0.0),
+        size_x_(0),
+        size_y_(0) {}
+  virtual ~RadarDBSCAN() = default;
+
+  RadarDBSCAN &setparameters(const double radius,
+                             const std::size_t minimum_neighbors) {
+    radius_ = radius;
+    minimum_neighbors_ = minimum_neighbors;
+    return *this;
+  }  // setparameters
+
+  // clustering of the echoes in the marine coordinate
+  RadarDBSCAN &cluster(const std::vector<double> &_x,
+                       const std::vector<double> &_y) {
+    std::size_t num_points = std::min(_x.size(), _y.size());
+    build_cartesian_grid(_x, _y, num_points);
+    const double squared_radius = radius_ * radius_;
+
+    run(num_points, [&](const std::size_t i, auto &&_visitor) {
+      const double px = _x[i];
+      const double py = _y[i];
+      int ix = cell_x_[i];
+      int iy = cell_y_[i];
+      int min_iy = std::max(iy - 1, 0);
+      int max_iy = std::min(iy + 1, size_y_ - 1);
+      for (int cx = std::max(ix - 1, 0); cx <= std::min(ix + 1, size_x_ - 1);
+           ++cx) {
+        // the cells in a column are contiguous
+        std::size_t begin = cell_start_[cx * size_y_ + min_iy];
+        std::size_t end = cell_start_[cx * size_y_ + max_iy + 1];
+        for (std::size_t k = begin; k != end; ++k) {
+          double dx = px - sorted_a_[k];
+          double dy = py - sorted_b_[k];
+          if ((dx * dx + dy * dy <= squared_radius) && (sorted_index_[k] != i))
+            if (!_visitor(sorted_index_[k])) return;
+        }
+      }
+    });
+    return *this;
+  }  // cluster
+
+  // clustering of the echoes given by range (m) and bearing (rad), which
+  // gives the same clusters as the ones in the cartesian coordinate. The
+  // squared distance is (dr)^2 + 4 * r1 * r2 * sin^2(dtheta / 2).
+  RadarDBSCAN &cluster_polar(const std::vector<double> &_range,
+                             const std::vector<double> &_bearing) {
+    std::size_t num_points = std::min(_range.size(), _bearing.size());
+    build_polar_grid(_range, _bearing, num_points);
+    const double squared_radius = radius_ * radius_;
+
+    run(num_points, [&](const std::size_t i, auto &&_visitor) {
+      const double range = _range[i];
+      const double sin_half = half_sin_[i];
+      const double cos_half = half_cos_[i];
+      // the angle between two points within radius is less than
+      // asin(radius / range)
+      double max_dtheta =
+          (range > radius_) ? std::asin(radius_ / range) : M_PI;
+      int ring = cell_x_[i];
+      for (int r = std::max(ring - 1, 0); r <= std::min(ring + 1, size_x_ - 1);
+           ++r) {
+        int num_sectors = ring_sectors_[r];
+        double sector_width = 2 * M_PI / num_sectors;
+        int span = static_cast<int>(max_dtheta / sector_width) + 1;
+        int center = static_cast<int>(bearing_[i] / sector_width);
+        if (2 * span + 1 >= num_sectors) {  // the whole ring
+          if (!scan_polar_cells(ring_start_[r], ring_start_[r] + num_sectors,
+                                i, range, sin_half, cos_half, squared_radius,
+                                _visitor))
+            return;
+          continue;
+        }
+        // the sectors [center - span, center + span], wrapped around
+        int first = center - span;
+        int last = center + span;
+        if (first < 0) {
+          if (!scan_polar_cells(ring_start_[r] + first + num_sectors,
+                                ring_start_[r] + num_sectors, i, range,
+                                sin_half, cos_half, squared_radius, _visitor))
+            return;
+          first = 0;
+        }
+        if (last >= num_sectors) {
+          if (!scan_polar_cells(ring_start_[r],
+                                ring_start_[r] + last - num_sectors + 1, i,
+                                range, sin_half, cos_half, squared_radius,
+                                _visitor))
+            return;
+          last = num_sectors - 1;
+        }
+        if (!scan_polar_cells(ring_start_[r] + first,
+                              ring_start_[r] + last + 1, i, range, sin_half,
+                              cos_half, squared_radius, _visitor))
+          return;
+      }
+    });
+    return *this;
+  }  // cluster_polar
+
+  std::size_t num_clusters() const noexcept {
+    return cluster_start_.empty() ? 0 : cluster_start_.size() - 1;
+  }
+  // the points of the i-th cluster are in [cluster_begin(i), cluster_end(i))
+  // in ascending order of index
+  const std::size_t *cluster_begin(const std::size_t i) const {
+    return cluster_points_.data() + cluster_start_[i];
+  }
+  const std::size_t *cluster_end(const std::size_t i) const {
+    return cluster_points_.data() + cluster_start_[i + 1];
+  }
+  std::size_t cluster_size(const std::size_t i) const {
+    return cluster_start_[i + 1] - cluster_start_[i];
+  }
+  // index of cluster of each point, -1 for noise
+  const std::vector<int> &labels() const noexcept { return labels_; }
+
+ private:
+  double radius_;
+  std::size_t minimum_neighbors_;
+  const std::size_t max_num_cells_;
+
+  // grid: cells sorted x-major (cartesian) or ring-major (polar)
+  double cell_size_;
+  double origin_x_;
+  double origin_y_;
+  int size_x_;  // # of columns (cartesian) or rings (polar)
+  int size_y_;  // # of rows (cartesian)
+  std::vector<int> cell_x_;  // column or ring of each point
+  std::vector<int> cell_y_;  // row or sector of each point
+  std::vector<std::size_t> cell_index_;
+  std::vector<std::size_t> cell_start_;
+  std::vector<std::size_t> cell_fill_;
+  // points sorted by cell: x/y (cartesian), or range/bearing (polar)
+  std::vector<double> sorted_a_;
+  std::vector<double> sorted_b_;
+  std::vector<std::size_t> sorted_index_;
+
+  // polar grid: the sectors of each ring are at least "radius" wide
+  std::vector<int> ring_sectors_;
+  std::vector<std::size_t> ring_start_;
+  std::vector<double> bearing_;  // in [0, 2pi)
+  std::vector<double> half_sin_;
+  std::vector<double> half_cos_;
+  std::vector<double> sorted_half_sin_;
+  std::vector<double> sorted_half_cos_;
+
+  // DBSCAN
+  std::vector<char> is_core_;
+  std::vector<std::size_t> parent_;
+  std::vector<int> labels_;
+  std::vector<int> root_label_;
+  std::vector<std::size_t> cluster_start_;
+  std::vector<std::size_t> cluster_points_;
+
+  std::size_t find_root(std::size_t i) {
+    while (parent_[i] != i) {
+      parent_[i] = parent_[parent_[i]];  // path halving
+      i = parent_[i];
+    }
+    return i;
+  }  // find_root
+
+  void merge(const std::size_t i, const std::size_t j) {
+    std::size_t root_i = find_root(i);
+    std::size_t root_j = find_root(j);
+    if (root_i == root_j) return;
+    // the smaller index is the root
+    if (root_i < root_j)
+      parent_[root_j] = root_i;
+    else
+      parent_[root_i] = root_j;
+  }  // merge
+
+  // for_each_neighbor(i, visitor) calls visitor(j) for each neighbor j of
+  // point i (j != i), and stops once visitor returns false
+  template <typename NeighborSearch>
+  void run(const std::size_t num_points, NeighborSearch &&for_each_neighbor) {
+    // core points
+    is_core_.assign(num_points, 0);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      std::size_t count = 0;
+      for_each_neighbor(i, [&count, this](std::size_t) {
+        return ++count < minimum_neighbors_;
+      });
+      is_core_[i] = (count >= minimum_neighbors_) ? 1 : 0;
+    }
+
+    // merge the core points within radius
+    parent_.resize(num_points);
+    std::iota(parent_.begin(), parent_.end(), 0);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      if (!is_core_[i]) continue;
+      for_each_neighbor(i, [i, this](std::size_t j) {
+        if ((j > i) && is_core_[j]) merge(i, j);
+        return true;
+      });
+    }
+
+    // the clusters are numbered by their smallest index of core point, as
+    // the root of each set is its smallest index
+    labels_.assign(num_points, -1);
+    root_label_.assign(num_points, -1);
+    int num_clusters = 0;
+    for (std::size_t i = 0; i != num_points; ++i) {
+      if (!is_core_[i]) continue;
+      std::size_t root = find_root(i);
+      if (root_label_[root] < 0) root_label_[root] = num_clusters++;
+      labels_[i] = root_label_[root];
+    }
+
+    // a border point belongs to the first cluster among its core neighbors
+    for (std::size_t i = 0; i != num_points; ++i) {
+      if (is_core_[i]) continue;
+      int label = std::numeric_limits<int>::max();
+      for_each_neighbor(i, [&label, this](std::size_t j) {
+        if (is_core_[j]) label = std::min(label, labels_[j]);
+        return true;
+      });
+      if (label != std::numeric_limits<int>::max()) labels_[i] = label;
+    }
+
+    // flat list of the points in each cluster
+    cluster_start_.assign(num_clusters + 1, 0);
+    for (std::size_t i = 0; i != num_points; ++i)
+      if (labels_[i] >= 0) ++cluster_start_[labels_[i] + 1];
+    for (int c = 0; c != num_clusters; ++c)
+      cluster_start_[c + 1] += cluster_start_[c];
+    cluster_points_.resize(cluster_start_.back());
+    cell_fill_.assign(cluster_start_.begin(), cluster_start_.end() - 1);
+    for (std::size_t i = 0; i != num_points; ++i)
+      if (labels_[i] >= 0) cluster_points_[cell_fill_[labels_[i]]++] = i;
+  }  // run
+
+  // counting sort of the points by cell
+  void sort_by_cell(const std::vector<double> &_a,
+                    const std::vector<double> &_b,
+                    const std::size_t num_points,
+                    const std::size_t num_cells) {
+    cell_start_.assign(num_cells + 1, 0);
+    for (std::size_t i = 0; i != num_points; ++i)
+      ++cell_start_[cell_index_[i] + 1];
+    for (std::size_t c = 0; c != num_cells; ++c)
+      cell_start_[c + 1] += cell_start_[c];
+
+    sorted_a_.resize(num_points);
+    sorted_b_.resize(num_points);
+    sorted_index_.resize(num_points);
+    cell_fill_.assign(cell_start_.begin(), cell_start_.end() - 1);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      std::size_t position = cell_fill_[cell_index_[i]]++;
+      sorted_a_[position] = _a[i];
+      sorted_b_[position] = _b[i];
+      sorted_index_[position] = i;
+    }
+  }  // sort_by_cell
+
+  void build_cartesian_grid(const std::vector<double> &_x,
+                            const std::vector<double> &_y,
+                            const std::size_t num_points) {
+    cell_x_.resize(num_points);
+    cell_y_.resize(num_points);
+    cell_index_.resize(num_points);
+    if (num_points == 0) {
+      size_x_ = 0;
+      size_y_ = 0;
+      cell_start_.assign(1, 0);
+      return;
+    }
+
+    auto [min_x, max_x] =
+        std::minmax_element(_x.begin(), _x.begin() + num_points);
+    auto [min_y, max_y] =
+        std::minmax_element(_y.begin(), _y.begin() + num_points);
+    origin_x_ = *min_x;
+    origin_y_ = *min_y;
+    double range_x = *max_x - *min_x;
+    double range_y = *max_y - *min_y;
+    // the cells are enlarged if there are too many of them
+    cell_size_ = std::fmax(
+        radius_, std::sqrt((range_x + radius_) * (range_y + radius_) /
+                           max_num_cells_));
+    size_x_ = static_cast<int>(range_x / cell_size_) + 1;
+    size_y_ = static_cast<int>(range_y / cell_size_) + 1;
+
+    for (std::size_t i = 0; i != num_points; ++i) {
+      cell_x_[i] = std::min(static_cast<int>((_x[i] - origin_x_) / cell_size_),
+                            size_x_ - 1);
+      cell_y_[i] = std::min(static_cast<int>((_y[i] - origin_y_) / cell_size_),
+                            size_y_ - 1);
+      cell_index_[i] = static_cast<std::size_t>(cell_x_[i]) * size_y_ +
+                       cell_y_[i];
+    }
+    sort_by_cell(_x, _y, num_points,
+                 static_cast<std::size_t>(size_x_) * size_y_);
+  }  // build_cartesian_grid
+
+  void build_polar_grid(const std::vector<double> &_range,
+                        const std::vector<double> &_bearing,
+                        const std::size_t num_points) {
+    cell_x_.resize(num_points);
+    cell_y_.resize(num_points);
+    cell_index_.resize(num_points);
+    bearing_.resize(num_points);
+    half_sin_.resize(num_points);
+    half_cos_.resize(num_points);
+    if (num_points == 0) {
+      size_x_ = 0;
+      ring_sectors_.clear();
+      ring_start_.assign(1, 0);
+      cell_start_.assign(1, 0);
+      return;
+    }
+
+    // ring width is radius, unless there are too many cells
+    double max_range =
+        *std::max_element(_range.begin(), _range.begin() + num_points);
+    cell_size_ =
+        std::fmax(radius_, max_range * std::sqrt(M_PI / max_num_cells_));
+    size_x_ = static_cast<int>(max_range / cell_size_) + 1;
+    ring_sectors_.resize(size_x_);
+    ring_start_.resize(size_x_ + 1);
+    ring_start_[0] = 0;
+    for (int r = 0; r != size_x_; ++r) {
+      // the arc of a sector at the inner side of the ring is >= cell size
+      ring_sectors_[r] = std::max(1, static_cast<int>(2 * M_PI * r));
+      ring_start_[r + 1] = ring_start_[r] + ring_sectors_[r];
+    }
+
+    for (std::size_t i = 0; i != num_points; ++i) {
+      double bearing =
+          _bearing[i] - 2 * M_PI * std::floor(_bearing[i] / (2 * M_PI));
+      if (bearing >= 2 * M_PI) bearing = 0;
+      bearing_[i] = bearing;
+      half_sin_[i] = std::sin(0.5 * _bearing[i]);
+      half_cos_[i] = std::cos(0.5 * _bearing[i]);
+      int ring =
+          std::min(static_cast<int>(_range[i] / cell_size_), size_x_ - 1);
+      int sector = std::min(
+          static_cast<int>(bearing / (2 * M_PI / ring_sectors_[ring])),
+          ring_sectors_[ring] - 1);
+      cell_x_[i] = ring;
+      cell_y_[i] = sector;
+      cell_index_[i] = ring_start_[ring] + sector;
+    }
+    sort_by_cell(_range, bearing_, num_points, ring_start_.back());
+
+    sorted_half_sin_.resize(num_points);
+    sorted_half_cos_.resize(num_points);
+    for (std::size_t k = 0; k != num_points; ++k) {
+      sorted_half_sin_[k] = half_sin_[sorted_index_[k]];
+      sorted_half_cos_[k] = half_cos_[sorted_index_[k]];
+    }
+  }  // build_polar_grid
+
+  // visit the points of the polar cells [first_cell, last_cell) within
+  // radius. Return false if the visitor stops
+  template <typename Visitor>
+  bool scan_polar_cells(const std::size_t first_cell,
+                        const std::size_t last_cell, const std::size_t i,
+                        const double range, const double sin_half,
+                        const double cos_half, const double squared_radius,
+                        Visitor &_visitor) const {
+    for (std::size_t k = cell_start_[first_cell]; k != cell_start_[last_cell];
+         ++k) {
+      double dr = range - sorted_a_[k];
+      // sin((theta_i - theta_k) / 2)
+      double sin_dhalf =
+          sin_half * sorted_half_cos_[k] - cos_half * sorted_half_sin_[k];
+      if ((dr * dr + 4 * range * sorted_a_[k] * sin_dhalf * sin_dhalf <=
+           squared_radius) &&
+          (sorted_index_[k] != i))
+        if (!_visitor(sorted_index_[k])) return false;
+    }
+    return true;
+  }  // scan_polar_cells
+
+};  // end class RadarDBSCAN
+
+}  // namespace ASV::perception
+
+#endif /* _RADARCLUSTERING_H_ */
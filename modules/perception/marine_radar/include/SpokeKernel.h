@@ -0,0 +1,261 @@
+/*
+****************************************************************************
+* SpokeKernel.h:
+* extract the echoes of one spoke of marine radar. The spoke is packed
+* with two 4-bit samples per byte (low nibble first); the nibbles are
+* unpacked, compared with the sensitivity threshold and gated by the
+* alarm range in one pass (SSE2/AVX2 if available). The range of each
+* sample and the sin/cos of each azimuth (4096 per revolution) are read
+* from lookup tables, and the echoes are written into preallocated
+* buffers.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _SPOKEKERNEL_H_
+#define _SPOKEKERNEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace ASV::perception {
+
+class SpokeKernel {
+ public:
+  // # of azimuth per revolution, see t9174SpokeHeader::spokeAzimuth
+  static constexpr std::size_t num_azimuth = 4096;
+
+  explicit SpokeKernel(const std::size_t _max_num_samples = 1024,
+                       const double _range_offset_m = 8.0)
+      : max_num_samples_(_max_num_samples),
+        range_offset_m_(_range_offset_m),
+        samplerange_m_(-1.0),
+        start_range_m_(0.0),
+        end_range_m_(0.0),
+        threshold_(0),
+        first_sample_(0),
+        last_sample_(0),
+        num_echoes_(0),
+        azimuth_cos_(num_azimuth),
+        azimuth_sin_(num_azimuth),
+        sample_range_m_(_max_num_samples),
+        echo_index_(_max_num_samples),
+        echo_range_m_(_max_num_samples) {
+    for (std::size_t i = 0; i != num_azimuth; ++i) {
+      double _azimuth_rad = 2 * M_PI * i / num_azimuth;
+      azimuth_cos_[i] = std::cos(_azimuth_rad);
+      azimuth_sin_[i] = std::sin(_azimuth_rad);
+    }
+  }
+  virtual ~SpokeKernel() = default;
+
+  // range gate [start, end] (m) and the min sensitivity (0~255)
+  SpokeKernel &setgate(const double _start_range_m, const double _end_range_m,
+                       const uint8_t _threshold) {
+    start_range_m_ = _start_range_m;
+    end_range_m_ = _end_range_m;
+    threshold_ = _threshold;
+    update_gate();
+    return *this;
+  }  // setgate
+
+  // find all the echoes in the range gate whose sensitivity is not smaller
+  // than the threshold. The sensitivity of a 4-bit sample is scaled to
+  // 0~255 (i.e. 0x0f -> 0xff), and the range of the k-th sample is
+  // range_offset + samplerange * (k + 1).
+  std::size_t extract(const uint8_t *_spoke_array, const std::size_t _num_bytes,
+                      const double _samplerange_m) {
+    if (_samplerange_m != samplerange_m_) update_range_table(_samplerange_m);
+
+    std::size_t _last_sample = std::min(last_sample_, 2 * _num_bytes);
+    num_echoes_ = threshold_nibbles(_spoke_array, first_sample_, _last_sample,
+                                    threshold_nibble(threshold_),
+                                    echo_index_.data());
+    for (std::size_t i = 0; i != num_echoes_; ++i)
+      echo_range_m_[i] = sample_range_m_[echo_index_[i]];
+    return num_echoes_;
+  }  // extract
+
+  // cos and sin of the azimuth (rad), read from the table if the azimuth is
+  // one of the 4096 steps of the radar
+  void azimuth_cos_sin(const double _azimuth_rad, double &_cos,
+                       double &_sin) const {
+    double _step = _azimuth_rad * num_azimuth / (2 * M_PI);
+    double _index = std::round(_step);
+    if (std::abs(_step - _index) < 1e-9) {
+      std::size_t i = static_cast<std::size_t>(static_cast<long long>(_index) &
+                                               (num_azimuth - 1));
+      _cos = azimuth_cos_[i];
+      _sin = azimuth_sin_[i];
+    } else {
+      _cos = std::cos(_azimuth_rad);
+      _sin = std::sin(_azimuth_rad);
+    }
+  }  // azimuth_cos_sin
+
+  std::size_t num_echoes() const noexcept { return num_echoes_; }
+  // sample index and range of each echo, in the ascending order
+  const uint32_t *echo_index() const noexcept { return echo_index_.data(); }
+  const double *echo_range_m() const noexcept { return echo_range_m_.data(); }
+
+  // write the index of each 4-bit sample in [first, last) which is not
+  // smaller than the threshold (0~15) into the buffer, and return the # of
+  // them. The samples are read from the bytes of the spoke, two per byte.
+  static std::size_t threshold_nibbles(const uint8_t *_spoke_array,
+                                       const std::size_t _first_sample,
+                                       const std::size_t _last_sample,
+                                       const uint8_t _threshold_nibble,
+                                       uint32_t *_index) {
+    if (_first_sample >= _last_sample) return 0;
+    std::size_t num = 0;
+    std::size_t byte = _first_sample / 2;
+    const std::size_t end_byte = (_last_sample + 1) / 2;
+
+#if defined(__AVX2__)
+    const __m256i low_mask_256 = _mm256_set1_epi8(0x0f);
+    const __m256i threshold_256 =
+        _mm256_set1_epi8(static_cast<char>(_threshold_nibble - 1));
+    for (; byte + 32 <= end_byte; byte += 32) {
+      __m256i v = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(_spoke_array + byte));
+      __m256i lo = _mm256_and_si256(v, low_mask_256);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask_256);
+      // nibbles are in 0~15, so the signed comparison with threshold-1
+      // gives nibble >= threshold
+      lo = _mm256_cmpgt_epi8(lo, threshold_256);
+      hi = _mm256_cmpgt_epi8(hi, threshold_256);
+      // the unpack is within each 128-bit lane: samples 0~15 and 32~47 in
+      // the first one, 16~31 and 48~63 in the second one
+      uint32_t m0 = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_unpacklo_epi8(lo, hi)));
+      uint32_t m1 = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_unpackhi_epi8(lo, hi)));
+      uint64_t mask = (m0 & 0xffffull) | ((m1 & 0xffffull) << 16) |
+                      (static_cast<uint64_t>(m0 >> 16) << 32) |
+                      (static_cast<uint64_t>(m1 >> 16) << 48);
+      num += write_mask(mask, 2 * byte, _first_sample, _last_sample,
+                        _index + num);
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i low_mask_128 = _mm_set1_epi8(0x0f);
+    const __m128i threshold_128 =
+        _mm_set1_epi8(static_cast<char>(_threshold_nibble - 1));
+    for (; byte + 16 <= end_byte; byte += 16) {
+      __m128i v = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(_spoke_array + byte));
+      __m128i lo =
+          _mm_cmpgt_epi8(_mm_and_si128(v, low_mask_128), threshold_128);
+      __m128i hi = _mm_cmpgt_epi8(
+          _mm_and_si128(_mm_srli_epi16(v, 4), low_mask_128), threshold_128);
+      uint64_t m0 = static_cast<uint32_t>(
+          _mm_movemask_epi8(_mm_unpacklo_epi8(lo, hi)));
+      uint64_t m1 = static_cast<uint32_t>(
+          _mm_movemask_epi8(_mm_unpackhi_epi8(lo, hi)));
+      num += write_mask(m0 | (m1 << 16), 2 * byte, _first_sample, _last_sample,
+                        _index + num);
+    }
+#endif
+
+    // the remaining bytes
+    for (; byte != end_byte; ++byte) {
+      uint64_t mask = ((_spoke_array[byte] & 0x0f) >= _threshold_nibble) |
+                      (((_spoke_array[byte] >> 4) >= _threshold_nibble) << 1);
+      num += write_mask(mask, 2 * byte, _first_sample, _last_sample,
+                        _index + num);
+    }
+    return num;
+  }  // threshold_nibbles
+
+  // the same as threshold_nibbles, one sample by one sample
+  static std::size_t threshold_nibbles_scalar(const uint8_t *_spoke_array,
+                                              const std::size_t _first_sample,
+                                              const std::size_t _last_sample,
+                                              const uint8_t _threshold_nibble,
+                                              uint32_t *_index) {
+    std::size_t num = 0;
+    for (std::size_t k = _first_sample; k < _last_sample; ++k) {
+      uint8_t nibble = (k % 2 == 0) ? (_spoke_array[k / 2] & 0x0f)
+                                    : (_spoke_array[k / 2] >> 4);
+      if (nibble >= _threshold_nibble) _index[num++] = static_cast<uint32_t>(k);
+    }
+    return num;
+  }  // threshold_nibbles_scalar
+
+  // the min 4-bit sample whose scaled sensitivity (x 0x11) is not smaller
+  // than the threshold
+  static uint8_t threshold_nibble(const uint8_t _threshold) noexcept {
+    return static_cast<uint8_t>((_threshold + 0x10) / 0x11);
+  }  // threshold_nibble
+
+ private:
+  const std::size_t max_num_samples_;
+  const double range_offset_m_;
+
+  double samplerange_m_;
+  double start_range_m_;
+  double end_range_m_;
+  uint8_t threshold_;
+  // samples in [first, last) are in the range gate
+  std::size_t first_sample_;
+  std::size_t last_sample_;
+  std::size_t num_echoes_;
+
+  // sin/cos of each azimuth step
+  std::vector<double> azimuth_cos_;
+  std::vector<double> azimuth_sin_;
+  // range of each sample
+  std::vector<double> sample_range_m_;
+  // echoes of the last spoke
+  std::vector<uint32_t> echo_index_;
+  std::vector<double> echo_range_m_;
+
+  void update_range_table(const double _samplerange_m) {
+    samplerange_m_ = _samplerange_m;
+    for (std::size_t k = 0; k != max_num_samples_; ++k)
+      sample_range_m_[k] = range_offset_m_ + _samplerange_m * (k + 1);
+    update_gate();
+  }  // update_range_table
+
+  // the range of samples increases with the index, so that the gate is
+  // given by the first and last sample inside it
+  void update_gate() {
+    first_sample_ = std::lower_bound(sample_range_m_.begin(),
+                                     sample_range_m_.end(), start_range_m_) -
+                    sample_range_m_.begin();
+    last_sample_ = std::upper_bound(sample_range_m_.begin(),
+                                    sample_range_m_.end(), end_range_m_) -
+                   sample_range_m_.begin();
+  }  // update_gate
+
+  // write the index of the set bits of the mask, whose first bit is the
+  // sample at _offset, within [first, last)
+  static std::size_t write_mask(uint64_t _mask, const std::size_t _offset,
+                                const std::size_t _first_sample,
+                                const std::size_t _last_sample,
+                                uint32_t *_index) {
+    if (_offset < _first_sample) _mask &= ~0ull << (_first_sample - _offset);
+    if (_last_sample - _offset < 64)
+      _mask &= (1ull << (_last_sample - _offset)) - 1;
+    std::size_t num = 0;
+    while (_mask != 0) {
+      _index[num++] = static_cast<uint32_t>(_offset + __builtin_ctzll(_mask));
+      _mask &= _mask - 1;
+    }
+    return num;
+  }  // write_mask
+
+};  // end class SpokeKernel
+
+}  // namespace ASV::perception
+
+#endif /* _SPOKEKERNEL_H_ */
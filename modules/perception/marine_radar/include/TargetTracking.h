@@ -16,14 +16,15 @@
 #ifndef _TARGETTRACKING_H_
 #define _TARGETTRACKING_H_
 
-#include <pyclustering/cluster/dbscan.hpp>
-#include <pyclustering/utils/metric.hpp>
+#include <limits>
 
 #include "common/math/Geometry/include/Miniball.hpp"
 #include "common/math/miscellaneous/include/math_utils.h"
 #include "common/timer/include/timecounter.h"
 
+#include "RadarClustering.h"
 #include "RadarFiltering.h"
+#include "SpokeKernel.h"
 #include "TargetTrackingData.h"
 
 namespace ASV::perception {
@@ -43,6 +44,8 @@ class TargetTracking : public RadarFiltering {
         SpokeProcess_data(_SpokeProcessdata),
         TrackingTarget_Data(_TrackingTargetData),
         Clustering_data(_ClusteringData),
+        radar_dbscan(_ClusteringData.p_radius,
+                     _ClusteringData.p_minumum_neighbors),
         TargetTracking_RTdata({
             SPOKESTATE::OUTSIDE_ALARM_ZONE,  // spoke_state
             T_Vectori::Zero(),               // targets_state
@@ -54,24 +57,29 @@ class TargetTracking : public RadarFiltering {
             T_Vectord::Zero(),               // targets_vy
             T_Vectord::Zero(),               // targets_CPA_x
             T_Vectord::Zero(),               // targets_CPA_y
-            T_Vectord::Zero()                // targets_TCPA
-        }) {}
+            T_Vectord::Zero(),               // targets_TCPA
+            T_Vectord::Zero(),               // targets_DCPA
+            T_Vectord::Zero()                // targets_TTSD
+        }),
+        previous_spoke_azimuth_rad(0.0),
+        previous_IsInAlarmAzimuth(false),
+        num_processed_spokes(0) {
+    spoke_kernel.setgate(Alarm_Zone.start_range_m, Alarm_Zone.end_range_m,
+                         Alarm_Zone.sensitivity_threhold);
+  }
   virtual ~TargetTracking() = default;
 
   // spoke data from marine radar
   // [_vessel_x_m, _vessel_y_m]: vessel position in the marine coordinate
   // _vessel_theta_rad: vessel orientation (rad)
   // [_vessel_speed_x, _vessel_speed_y]: vessel speed in the marine coordinate
+  // The spoke is ignored if its azimuth is close to the previous one.
   TargetTracking &AutoTracking(
       const uint8_t *_spoke_array, const std::size_t _array_size,
       const double _spoke_azimuth_deg, const double _samplerange_m,
       const double _vessel_x_m = 0.0, const double _vessel_y_m = 0.0,
       const double _vessel_theta_rad = 0.0, const double _vessel_speed_x = 0.0,
       const double _vessel_speed_y = 0.0) {
-    static double previous_spoke_azimuth_rad = 0;
-    static bool previous_IsInAlarmAzimuth = false;
-    static common::timecounter _timer;
-
     double _spoke_azimuth_rad = common::math::Normalizeheadingangle(
         common::math::Degree2Rad(_spoke_azimuth_deg));
 
@@ -80,83 +88,9 @@ class TargetTracking : public RadarFiltering {
 
     if (std::abs(common::math::Normalizeheadingangle(
             _spoke_azimuth_rad - previous_spoke_azimuth_rad)) > 0.008) {
-      bool current_IsInAlarmAzimuth = IsInAlarmAzimuth(_spoke_azimuth_rad);
-      if (current_IsInAlarmAzimuth) {  // in the alarm azimuth
-        std::vector<double> surroundings_onespoke_bearing_rad;
-        std::vector<double> surroundings_onespoke_range_m;
-        std::vector<double> surroundings_onespoke_x_m;
-        std::vector<double> surroundings_onespoke_y_m;
-
-        find_surroundings_spoke(
-            _spoke_array, _array_size, _spoke_azimuth_rad, _samplerange_m,
-            surroundings_onespoke_bearing_rad, surroundings_onespoke_range_m);
-        convert_surroundings_to_marine(
-            _vessel_x_m, _vessel_y_m, _vessel_theta_rad,
-            surroundings_onespoke_bearing_rad, surroundings_onespoke_range_m,
-            surroundings_onespoke_x_m, surroundings_onespoke_y_m);
-
-        // append the surroundings in the alarm zone
-        SpokeProcess_RTdata.surroundings_bearing_rad.insert(
-            SpokeProcess_RTdata.surroundings_bearing_rad.end(),
-            surroundings_onespoke_bearing_rad.begin(),
-            surroundings_onespoke_bearing_rad.end());
-        SpokeProcess_RTdata.surroundings_range_m.insert(
-            SpokeProcess_RTdata.surroundings_range_m.end(),
-            surroundings_onespoke_range_m.begin(),
-            surroundings_onespoke_range_m.end());
-        SpokeProcess_RTdata.surroundings_x_m.insert(
-            SpokeProcess_RTdata.surroundings_x_m.end(),
-            surroundings_onespoke_x_m.begin(), surroundings_onespoke_x_m.end());
-        SpokeProcess_RTdata.surroundings_y_m.insert(
-            SpokeProcess_RTdata.surroundings_y_m.end(),
-            surroundings_onespoke_y_m.begin(), surroundings_onespoke_y_m.end());
-
-        // check the spoke azimuth to determine spoke state
-        if (previous_IsInAlarmAzimuth)
-          TargetTracking_RTdata.spoke_state = SPOKESTATE::IN_ALARM_ZONE;
-        else {
-          TargetTracking_RTdata.spoke_state = SPOKESTATE::ENTER_ALARM_ZONE;
-          // _timer.timeelapsed();
-        }
-
-      } else {                            // outside the alarm azimuth
-        if (previous_IsInAlarmAzimuth) {  // leaving the alarm azimuth
-
-          long int et_ms = _timer.timeelapsed();
-          double sample_time = 0.001 * et_ms;
-
-          sample_time = 2.5;
-
-          // start to cluster and miniball
-          ClusteringAndMiniBall(SpokeProcess_RTdata.surroundings_x_m,
-                                SpokeProcess_RTdata.surroundings_y_m,
-                                TargetDetection_RTdata.target_x,
-                                TargetDetection_RTdata.target_y,
-                                TargetDetection_RTdata.target_square_radius);
-
-          RemoveImpossibleRadius(TargetDetection_RTdata);
-
-          TargetTracking_RTdata = PredictMotion(
-              TargetDetection_RTdata.target_x, TargetDetection_RTdata.target_y,
-              TargetDetection_RTdata.target_square_radius, sample_time,
-              TargetTracking_RTdata);
-
-          SituationAwareness(_vessel_speed_x, _vessel_speed_y, _vessel_speed_x,
-                             _vessel_speed_y, TargetTracking_RTdata);
-
-          RemoveDuplicateTargets(TargetTracking_RTdata);
-
-          TargetTracking_RTdata.spoke_state = SPOKESTATE::LEAVE_ALARM_ZONE;
-
-        } else {
-          SpokeProcess_RTdata.surroundings_bearing_rad.clear();
-          SpokeProcess_RTdata.surroundings_range_m.clear();
-          SpokeProcess_RTdata.surroundings_x_m.clear();
-          SpokeProcess_RTdata.surroundings_y_m.clear();
-
-          TargetTracking_RTdata.spoke_state = SPOKESTATE::OUTSIDE_ALARM_ZONE;
-        }
-      }
+      ProcessSpoke(_spoke_array, _array_size, _spoke_azimuth_rad,
+                   _samplerange_m, _vessel_x_m, _vessel_y_m, _vessel_theta_rad,
+                   _vessel_speed_x, _vessel_speed_y);
     }  // check if two azimuth is different
 
     previous_spoke_azimuth_rad = _spoke_azimuth_rad;
@@ -165,6 +99,97 @@ class TargetTracking : public RadarFiltering {
     return *this;
   }  // AutoTracking
 
+  // drain the spokes in the ring (e.g. messages::MarineRadarSpokeRing) in a
+  // batch, where each spoke is processed exactly once. The drain stops
+  // after the spoke leaving the alarm zone, so that the tracked targets of
+  // this revolution can be read before the next one starts; the remaining
+  // spokes are left for the next call.
+  template <typename T_SpokeRing, typename = typename T_SpokeRing::Record>
+  TargetTracking &AutoTracking(
+      T_SpokeRing &_spoke_ring, const double _vessel_x_m = 0.0,
+      const double _vessel_y_m = 0.0, const double _vessel_theta_rad = 0.0,
+      const double _vessel_speed_x = 0.0, const double _vessel_speed_y = 0.0,
+      const std::size_t _max_num_spokes =
+          std::numeric_limits<std::size_t>::max()) {
+    num_processed_spokes += _spoke_ring.consume(
+        [&](const typename T_SpokeRing::Record &_spoke) {
+          ProcessSpoke(
+              _spoke.spokedata, sizeof(_spoke.spokedata),
+              common::math::Normalizeheadingangle(
+                  common::math::Degree2Rad(_spoke.spoke_azimuth_deg)),
+              _spoke.spoke_samplerange_m, _vessel_x_m, _vessel_y_m,
+              _vessel_theta_rad, _vessel_speed_x, _vessel_speed_y);
+          return TargetTracking_RTdata.spoke_state !=
+                 SPOKESTATE::LEAVE_ALARM_ZONE;
+        },
+        _max_num_spokes);
+    return *this;
+  }  // AutoTracking
+
+  // calculate the CPA, TCPA and DCPA of all the targets in one pass, in
+  // closed form. With the relative position d and velocity w of the vessel
+  // to the target, TCPA = -d.w/|w|^2, and the vessel enters its safe domain
+  // at the smaller root of |d + w t| = safe_distance.
+  // TCPA, DCPA and TTSD use the relative motion for all the targets, so that
+  // a static target (e.g. buoy) ahead of the vessel is still dangerous; only
+  // the displayed CPA of a target slower than threhold is the target
+  // position. Targets whose TCPA<0 are leaving, and the ones in IDLE are
+  // ignored.
+  void SituationAwareness(
+      const double _vessel_x_m, const double _vessel_y_m,
+      const double _vessel_vx, const double _vessel_vy,
+      TargetTrackerRTdata<max_num_target> &_TargetTracking_RTdata) const {
+    using T_Arrayd = Eigen::Array<double, max_num_target, 1>;
+    auto &_RTdata = _TargetTracking_RTdata;
+    const double square_safe_distance =
+        std::pow(TrackingTarget_Data.safe_distance, 2);
+
+    auto is_active = (_RTdata.targets_state.array() > 0);
+    auto is_moving = (_RTdata.targets_vx.array().square() +
+                          _RTdata.targets_vy.array().square() >
+                      std::pow(TrackingTarget_Data.speed_threhold, 2));
+
+    T_Arrayd dx = _vessel_x_m - _RTdata.targets_x.array();
+    T_Arrayd dy = _vessel_y_m - _RTdata.targets_y.array();
+    T_Arrayd wx = _vessel_vx - _RTdata.targets_vx.array();
+    T_Arrayd wy = _vessel_vy - _RTdata.targets_vy.array();
+    T_Arrayd square_d = dx.square() + dy.square();
+    T_Arrayd square_w = wx.square() + wy.square();
+    T_Arrayd d_dot_w = dx * wx + dy * wy;
+
+    T_Arrayd TCPA =
+        (d_dot_w < 0.0).select(-d_dot_w / square_w.max(1e-12), -1.0);
+    T_Arrayd t_CPA = TCPA.max(0.0);
+    T_Arrayd DCPA =
+        ((dx + wx * t_CPA).square() + (dy + wy * t_CPA).square()).sqrt();
+    T_Arrayd discriminant =
+        (d_dot_w.square() - square_w * (square_d - square_safe_distance))
+            .max(0.0);
+    T_Arrayd TTSD =
+        (square_d <= square_safe_distance)
+            .select(0.0, ((TCPA > 0.0) && (DCPA.square() <=
+                                            square_safe_distance))
+                             .select((-d_dot_w - discriminant.sqrt()) /
+                                         square_w.max(1e-12),
+                                     -1.0));
+
+    _RTdata.targets_CPA_x = is_active.select(
+        is_moving.select(_vessel_x_m + _vessel_vx * t_CPA,
+                         _RTdata.targets_x.array()),
+        _RTdata.targets_CPA_x.array());
+    _RTdata.targets_CPA_y = is_active.select(
+        is_moving.select(_vessel_y_m + _vessel_vy * t_CPA,
+                         _RTdata.targets_y.array()),
+        _RTdata.targets_CPA_y.array());
+    _RTdata.targets_TCPA = is_active.select(TCPA, _RTdata.targets_TCPA.array());
+    _RTdata.targets_DCPA = is_active.select(DCPA, _RTdata.targets_DCPA.array());
+    _RTdata.targets_TTSD = is_active.select(TTSD, _RTdata.targets_TTSD.array());
+    // dangerous if the vessel is (or will be) in the safe domain
+    _RTdata.targets_intention =
+        is_active.select((TTSD >= 0.0).template cast<int>(),
+                         _RTdata.targets_intention.array());
+  }  // SituationAwareness
+
   TargetTracking &TestClustering(const std::vector<double> &_surroundings_x,
                                  const std::vector<double> &_surroundings_y) {
     ClusteringAndMiniBall(_surroundings_x, _surroundings_y,
@@ -193,7 +218,9 @@ class TargetTracking : public RadarFiltering {
         T_Vectord::Zero(),               // targets_vy
         T_Vectord::Zero(),               // targets_CPA_x
         T_Vectord::Zero(),               // targets_CPA_y
-        T_Vectord::Zero()                // targets_TCPA
+        T_Vectord::Zero(),               // targets_TCPA
+        T_Vectord::Zero(),               // targets_DCPA
+        T_Vectord::Zero()                // targets_TTSD
     };
 
     _previous_tracking_targets.targets_state(1) = 2;
@@ -243,6 +270,10 @@ class TargetTracking : public RadarFiltering {
               << std::endl;
     std::cout << "targets_TCPA:\n " << _new_tracking_targets.targets_TCPA
               << std::endl;
+    std::cout << "targets_DCPA:\n " << _new_tracking_targets.targets_DCPA
+              << std::endl;
+    std::cout << "targets_TTSD:\n " << _new_tracking_targets.targets_TTSD
+              << std::endl;
 
     return *this;
   }  // TestSituationAware
@@ -259,6 +290,10 @@ class TargetTracking : public RadarFiltering {
     return TargetTracking_RTdata;
   }  // getTargetTrackerRTdata
 
+  std::size_t getnumprocessedspokes() const noexcept {
+    return num_processed_spokes;
+  }  // getnumprocessedspokes
+
   double getsampletime() const noexcept {
     return SpokeProcess_data.sample_time;
   }  // getsampletime
@@ -274,111 +309,89 @@ class TargetTracking : public RadarFiltering {
   const SpokeProcessdata SpokeProcess_data;
   const TrackingTargetData TrackingTarget_Data;
   ClusteringData Clustering_data;
+  RadarDBSCAN radar_dbscan;
+  SpokeKernel spoke_kernel;
 
   TargetTrackerRTdata<max_num_target> TargetTracking_RTdata;
   SpokeProcessRTdata SpokeProcess_RTdata;
   TargetDetectionRTdata TargetDetection_RTdata;
 
-  // calculate the CPA and TCPA of the targets
-  // whose speed is larger than threhold.
-  // If the target speed is smaller than threhold, the target is assumed to be
-  // static, abd CPA is equal to target position
-  void SituationAwareness(
-      const double _vessel_x_m, const double _vessel_y_m,
-      const double _vessel_vx, const double _vessel_vy,
-      TargetTrackerRTdata<max_num_target> &_TargetTracking_RTdata) {
-    for (int i = 0; i != max_num_target; ++i) {
-      if (_TargetTracking_RTdata.targets_state(i) > 0) {  // IDLE is ignored
-        double _square_speed =
-            std::pow(_TargetTracking_RTdata.targets_vx(i), 2) +
-            std::pow(_TargetTracking_RTdata.targets_vy(i), 2);
-        if (_square_speed <=
-            std::pow(TrackingTarget_Data.speed_threhold, 2)) {  // static target
-          _TargetTracking_RTdata.targets_CPA_x(i) =
-              _TargetTracking_RTdata.targets_x(i);
-          _TargetTracking_RTdata.targets_CPA_y(i) =
-              _TargetTracking_RTdata.targets_y(i);
-
-          if (CheckSafeDistance(_vessel_x_m, _vessel_y_m,
-                                _TargetTracking_RTdata.targets_x(i),
-                                _TargetTracking_RTdata.targets_y(i)))
-            _TargetTracking_RTdata.targets_intention(i) = 1;  // dangerous
-          else
-            _TargetTracking_RTdata.targets_intention(i) = 0;  // safe
-
-        } else {  // moving target
-          auto [_CPA_x, _CPA_y, _TCPA] =
-              computeCPA(_vessel_x_m, _vessel_y_m, _vessel_vx, _vessel_vy,
-                         _TargetTracking_RTdata.targets_x(i),
-                         _TargetTracking_RTdata.targets_y(i),
-                         _TargetTracking_RTdata.targets_vx(i),
-                         _TargetTracking_RTdata.targets_vy(i));
-
-          std::cout << "CPA: " << _CPA_x << " " << _CPA_y << " " << _TCPA
-                    << std::endl;
-
-          _TargetTracking_RTdata.targets_CPA_x(i) = _CPA_x;
-          _TargetTracking_RTdata.targets_CPA_y(i) = _CPA_y;
-          _TargetTracking_RTdata.targets_TCPA(i) = _TCPA;
-
-          if (_TCPA > 0) {  // collision may occur
-            if (CheckSafeDistance(_vessel_x_m, _vessel_y_m, _CPA_x, _CPA_y))
-              _TargetTracking_RTdata.targets_intention(i) = 1;  // dangerous
-            else
-              _TargetTracking_RTdata.targets_intention(i) = 0;  // safe
-          }
-        }
+  // coordinates of the points in a cluster, used by miniball
+  std::vector<double> miniball_points;
+  std::vector<double *> miniball_pointers;
+
+  // azimuth and alarm state of the previous processed spoke
+  double previous_spoke_azimuth_rad;
+  bool previous_IsInAlarmAzimuth;
+  common::timecounter revolution_timer;
+  // # of spokes drained from the ring
+  std::size_t num_processed_spokes;
+
+  // find the surroundings in one spoke, and update the spoke state. Once
+  // the spoke leaves the alarm zone, the surroundings of this revolution
+  // are clustered and the targets are tracked.
+  void ProcessSpoke(const uint8_t *_spoke_array, const std::size_t _array_size,
+                    const double _spoke_azimuth_rad,
+                    const double _samplerange_m, const double _vessel_x_m,
+                    const double _vessel_y_m, const double _vessel_theta_rad,
+                    const double _vessel_speed_x,
+                    const double _vessel_speed_y) {
+    bool current_IsInAlarmAzimuth = IsInAlarmAzimuth(_spoke_azimuth_rad);
+    if (current_IsInAlarmAzimuth) {  // in the alarm azimuth
+      find_surroundings_spoke(_spoke_array, _array_size, _spoke_azimuth_rad,
+                              _samplerange_m, _vessel_x_m, _vessel_y_m,
+                              _vessel_theta_rad);
+
+      // check the spoke azimuth to determine spoke state
+      if (previous_IsInAlarmAzimuth)
+        TargetTracking_RTdata.spoke_state = SPOKESTATE::IN_ALARM_ZONE;
+      else {
+        TargetTracking_RTdata.spoke_state = SPOKESTATE::ENTER_ALARM_ZONE;
+        // revolution_timer.timeelapsed();
       }
-    }  // end for loop
 
-  }  // SituationAwareness
+    } else {                            // outside the alarm azimuth
+      if (previous_IsInAlarmAzimuth) {  // leaving the alarm azimuth
+
+        long int et_ms = revolution_timer.timeelapsed();
+        double sample_time = 0.001 * et_ms;
+
+        sample_time = 2.5;
+
+        // start to cluster and miniball
+        ClusteringAndMiniBall(SpokeProcess_RTdata.surroundings_x_m,
+                              SpokeProcess_RTdata.surroundings_y_m,
+                              TargetDetection_RTdata.target_x,
+                              TargetDetection_RTdata.target_y,
+                              TargetDetection_RTdata.target_square_radius);
 
-  // calculate the CPA and TCPA, regarding with boat A, in global coordinate
-  // TCPA < 0 means there is no CPA
-  std::tuple<double, double, double> computeCPA(
-      const double boatA_position_x, const double boatA_position_y,
-      const double boatA_speed_x, const double boatA_speed_y,
-      const double boatB_position_x, const double boatB_position_y,
-      const double boatB_speed_x, const double boatB_speed_y) {
-    double initial_delta_x = boatA_position_x - boatB_position_x;
-    double initial_delta_y = boatA_position_y - boatB_position_y;
-    double delta_speed_x = boatA_speed_x - boatB_speed_x;
-    double delta_speed_y = boatA_speed_y - boatB_speed_y;
-    double initial_square_distance =
-        initial_delta_x * initial_delta_x + initial_delta_y * initial_delta_y;
-    double initial_square_rela_speed =
-        delta_speed_x * delta_speed_x + delta_speed_y * delta_speed_y;
-
-    /** empiricial value **/
-    double max_search_time = std::sqrt(2 * initial_square_distance /
-                                       (initial_square_rela_speed + 1));
-    int max_search_index = 100;
-    double search_time_step = max_search_time / max_search_index;
-    // empiricial value
-
-    double min_distance = initial_square_distance;
-    double CPA_x = 0;
-    double CPA_y = 0;
-    double TCPA = 0;
-    for (int i = 0; i != max_search_index; ++i) {
-      double search_time = i * search_time_step;
-      double distance = (search_time * delta_speed_x + initial_delta_x) *
-                            (search_time * delta_speed_x + initial_delta_x) +
-                        (search_time * delta_speed_y + initial_delta_y) *
-                            (search_time * delta_speed_y + initial_delta_y);
-
-      if (distance < min_distance) {
-        min_distance = distance;
-        TCPA = search_time;
-        CPA_x = boatA_position_x + boatA_speed_x * search_time;
-        CPA_y = boatA_position_y + boatA_speed_y * search_time;
+        RemoveImpossibleRadius(TargetDetection_RTdata);
+
+        TargetTracking_RTdata = PredictMotion(
+            TargetDetection_RTdata.target_x, TargetDetection_RTdata.target_y,
+            TargetDetection_RTdata.target_square_radius, sample_time,
+            TargetTracking_RTdata);
+
+        SituationAwareness(_vessel_x_m, _vessel_y_m, _vessel_speed_x,
+                           _vessel_speed_y, TargetTracking_RTdata);
+
+        RemoveDuplicateTargets(TargetTracking_RTdata);
+
+        TargetTracking_RTdata.spoke_state = SPOKESTATE::LEAVE_ALARM_ZONE;
+
+      } else {
+        SpokeProcess_RTdata.surroundings_bearing_rad.clear();
+        SpokeProcess_RTdata.surroundings_range_m.clear();
+        SpokeProcess_RTdata.surroundings_x_m.clear();
+        SpokeProcess_RTdata.surroundings_y_m.clear();
+
+        TargetTracking_RTdata.spoke_state = SPOKESTATE::OUTSIDE_ALARM_ZONE;
       }
     }
 
-    if (TCPA < 0.01) TCPA = -1;
-
-    return {CPA_x, CPA_y, TCPA};
-  }  // computeCPA
+    previous_spoke_azimuth_rad = _spoke_azimuth_rad;
+    previous_IsInAlarmAzimuth = current_IsInAlarmAzimuth;
+  }  // ProcessSpoke
 
   // clustering for all points and find the miniball around each sets of points
   void ClusteringAndMiniBall(const std::vector<double> &_surroundings_x,
@@ -387,24 +400,12 @@ class TargetTracking : public RadarFiltering {
                              std::vector<double> &_target_y,
                              std::vector<double> &_target_radius) {
     // clustering for all points
-    std::shared_ptr<pyclustering::dataset> p_data =
-        std::make_shared<pyclustering::dataset>();
-    std::shared_ptr<pyclustering::clst::dbscan_data> ptr_output_result =
-        std::make_shared<pyclustering::clst::dbscan_data>();
+    radar_dbscan
+        .setparameters(Clustering_data.p_radius,
+                       Clustering_data.p_minumum_neighbors)
+        .cluster(_surroundings_x, _surroundings_y);
 
-    std::size_t num_surroundings = _surroundings_x.size();
-    p_data->resize(num_surroundings);
-    for (std::size_t i = 0; i != num_surroundings; ++i) {
-      p_data->at(i) = {_surroundings_x[i], _surroundings_y[i]};
-    }
-
-    pyclustering::clst::dbscan clustering_solver(
-        Clustering_data.p_radius, Clustering_data.p_minumum_neighbors);
-    clustering_solver.process(*p_data, *ptr_output_result);
-    const pyclustering::clst::cluster_sequence &actual_clusters =
-        ptr_output_result->clusters();
-
-    std::size_t num_actual_clusters = actual_clusters.size();
+    std::size_t num_actual_clusters = radar_dbscan.num_clusters();
 
     // miniball for each cluster
     _target_x.resize(num_actual_clusters);
@@ -412,32 +413,27 @@ class TargetTracking : public RadarFiltering {
     _target_radius.resize(num_actual_clusters);
 
     for (std::size_t index = 0; index != num_actual_clusters; ++index) {
-      auto cluster = actual_clusters.at(index);
-
-      int d = 2;                       // dimension
-      std::size_t n = cluster.size();  // number of points
+      int d = 2;                                         // dimension
+      std::size_t n = radar_dbscan.cluster_size(index);  // number of points
 
-      double **ap = new double *[n];
+      miniball_points.resize(d * n);
+      miniball_pointers.resize(n);
+      const std::size_t *cluster = radar_dbscan.cluster_begin(index);
       for (std::size_t j = 0; j < n; ++j) {
-        double *p = new double[d];
-        p[0] = _surroundings_x[cluster.at(j)];
-        p[1] = _surroundings_y[cluster.at(j)];
-        ap[j] = p;
+        miniball_points[d * j] = _surroundings_x[cluster[j]];
+        miniball_points[d * j + 1] = _surroundings_y[cluster[j]];
+        miniball_pointers[j] = &miniball_points[d * j];
       }
       // create an instance of Miniball
       Miniball::Miniball<
           Miniball::CoordAccessor<double *const *, const double *> >
-          mb(d, ap, ap + n);
+          mb(d, miniball_pointers.data(), miniball_pointers.data() + n);
 
       // output results
       const double *center = mb.center();
       _target_x[index] = center[0];
       _target_y[index] = center[1];
       _target_radius[index] = mb.squared_radius();
-
-      // clean up
-      for (std::size_t j = 0; j < n; ++j) delete[] ap[j];
-      delete[] ap;
     }
 
   }  // ClusteringAndMiniBall
@@ -756,15 +752,6 @@ class TargetTracking : public RadarFiltering {
     return {new_vx, new_vy};
   }
 
-  // check the safe distance, true: dangerous; false: safe
-  bool CheckSafeDistance(double boat_x, double boat_y, double o_x, double o_y) {
-    double _square_distance_V2T =
-        std::pow(boat_x - o_x, 2) + std::pow(boat_y - o_y, 2);
-    if (_square_distance_V2T <= std::pow(TrackingTarget_Data.safe_distance, 2))
-      return true;
-    return false;
-  }  // CheckSafeDistance
-
   // check if spoke azimuth is the alarm zone, depending on azimuth
   bool IsInAlarmAzimuth(const double _current_spoke_azimuth_rad) {
     if (std::abs(common::math::Normalizeheadingangle(
@@ -774,91 +761,56 @@ class TargetTracking : public RadarFiltering {
     return false;
   }  // IsInAlarmAzimuth
 
-  // convert the body-fixed coordinate to marine
-  void convert_surroundings_to_marine(
-      const double _vessel_x_m, const double _vessel_y_m,
-      const double _vessel_theta_rad,
-      const std::vector<double> &surroundings_bearing_rad,
-      const std::vector<double> &surroundings_range_m,
-      std::vector<double> &surroundings_x_m,
-      std::vector<double> &surroundings_y_m) {
-    double cvalue = std::cos(_vessel_theta_rad);
-    double svalue = std::sin(_vessel_theta_rad);
-
-    std::size_t num_surroundings = surroundings_bearing_rad.size();
-
-    surroundings_x_m.resize(num_surroundings);
-    surroundings_y_m.resize(num_surroundings);
-
-    for (std::size_t i = 0; i != num_surroundings; ++i) {
-      double bearing_rad = surroundings_bearing_rad[i];
-      double range_m = surroundings_range_m[i];
-      double cvalue_plus = std::cos(_vessel_theta_rad + bearing_rad);
-      double svalue_plus = std::sin(_vessel_theta_rad + bearing_rad);
-
-      double xs = cvalue * SpokeProcess_data.radar_x -
-                  svalue * SpokeProcess_data.radar_y + range_m * cvalue_plus +
-                  _vessel_x_m;
-
-      double ys = svalue * SpokeProcess_data.radar_x +
-                  cvalue * SpokeProcess_data.radar_y + range_m * svalue_plus +
-                  _vessel_y_m;
-
-      surroundings_x_m[i] = xs;
-      surroundings_y_m[i] = ys;
-    }
-  }  // convert_surroundings_to_marine
-
-  // find all surroundings on one spoke data, depending on the given threhold
+  // find the surroundings in one spoke, depending on the given threhold and
+  // the range of alarm zone, and append them (in both the body-fixed and
+  // marine coordinate) to the surroundings of this revolution
   void find_surroundings_spoke(
       const uint8_t *_spoke_array, const std::size_t _array_size,
       const double _spoke_azimuth_rad, const double _samplerange_m,
-      std::vector<double> &surroundings_InAlarm_bearing_rad,
-      std::vector<double> &surroundings_InAlarm_range_m) {
-    // find the index of all elements larger than threhold value
-    auto surroundings_index = find_above_allelements_index<uint8_t>(
-        _spoke_array, _array_size, Alarm_Zone.sensitivity_threhold);
-    std::size_t num_surroundings = surroundings_index.size();
-
-    // check if the surroundings are in the alarm zone
-    surroundings_InAlarm_bearing_rad.clear();
-    surroundings_InAlarm_range_m.clear();
-
+      const double _vessel_x_m, const double _vessel_y_m,
+      const double _vessel_theta_rad) {
+    std::size_t num_surroundings =
+        spoke_kernel.extract(_spoke_array, _array_size, _samplerange_m);
+    const double *surroundings_range_m = spoke_kernel.echo_range_m();
+
+    SpokeProcess_RTdata.surroundings_bearing_rad.insert(
+        SpokeProcess_RTdata.surroundings_bearing_rad.end(), num_surroundings,
+        _spoke_azimuth_rad);
+    SpokeProcess_RTdata.surroundings_range_m.insert(
+        SpokeProcess_RTdata.surroundings_range_m.end(), surroundings_range_m,
+        surroundings_range_m + num_surroundings);
+
+    // convert the body-fixed coordinate to marine. All the surroundings
+    // are on the same bearing, so the trigonometric functions are evaluated
+    // once per spoke.
+    double cvalue = std::cos(_vessel_theta_rad);
+    double svalue = std::sin(_vessel_theta_rad);
+    double cvalue_bearing = 1.0;
+    double svalue_bearing = 0.0;
+    spoke_kernel.azimuth_cos_sin(_spoke_azimuth_rad, cvalue_bearing,
+                                 svalue_bearing);
+    double cvalue_plus = cvalue * cvalue_bearing - svalue * svalue_bearing;
+    double svalue_plus = svalue * cvalue_bearing + cvalue * svalue_bearing;
+    double x0 = cvalue * SpokeProcess_data.radar_x -
+                svalue * SpokeProcess_data.radar_y + _vessel_x_m;
+    double y0 = svalue * SpokeProcess_data.radar_x +
+                cvalue * SpokeProcess_data.radar_y + _vessel_y_m;
+
+    std::size_t num_previous = SpokeProcess_RTdata.surroundings_x_m.size();
+    SpokeProcess_RTdata.surroundings_x_m.resize(num_previous +
+                                                num_surroundings);
+    SpokeProcess_RTdata.surroundings_y_m.resize(num_previous +
+                                                num_surroundings);
+    double *surroundings_x_m =
+        SpokeProcess_RTdata.surroundings_x_m.data() + num_previous;
+    double *surroundings_y_m =
+        SpokeProcess_RTdata.surroundings_y_m.data() + num_previous;
     for (std::size_t i = 0; i != num_surroundings; ++i) {
-      // TODO: test the empirical
-      static double interception_empirical = 8.0;
-      double s_range_m =
-          interception_empirical + _samplerange_m * (surroundings_index[i] + 1);
-      double s_bearing_rad = _spoke_azimuth_rad;
-
-      if ((s_range_m <= Alarm_Zone.end_range_m) &&
-          (Alarm_Zone.start_range_m <= s_range_m)) {
-        surroundings_InAlarm_bearing_rad.emplace_back(s_bearing_rad);
-        surroundings_InAlarm_range_m.emplace_back(s_range_m);
-      }
+      surroundings_x_m[i] = x0 + surroundings_range_m[i] * cvalue_plus;
+      surroundings_y_m[i] = y0 + surroundings_range_m[i] * svalue_plus;
     }
-
   }  // find_surroundings_spoke
 
-  template <class T>
-  std::vector<T> find_above_allelements(const T *arr, const int array_size,
-                                        const T _threhold) {
-    std::vector<T> target;
-    std::copy_if(arr, arr + array_size, std::back_inserter(target),
-                 [=](T element) { return element >= _threhold; });
-    return target;
-  }  // find_above_allelements
-
-  template <class T>
-  std::vector<std::size_t> find_above_allelements_index(
-      const T *arr, const std::size_t array_size, const T _threhold) {
-    std::vector<std::size_t> results;
-    for (std::size_t i = 0; i != array_size; ++i) {
-      if (arr[i] >= _threhold) results.emplace_back(i);
-    }
-    return results;
-  }  // find_above_allelements_index
-
 };  // namespace ASV::perception
 
 }  // namespace ASV::perception
@@ -105,6 +105,11 @@ struct TargetTrackerRTdata {
   Eigen::Matrix<double, max_num_target, 1> targets_CPA_y;
   // when TCPA<0, no collision
   Eigen::Matrix<double, max_num_target, 1> targets_TCPA;
+  // distance at CPA, between the vessel and target
+  Eigen::Matrix<double, max_num_target, 1> targets_DCPA;
+  // time to enter the safe domain (safe_distance) of the vessel;
+  // 0 if already inside, <0 if never
+  Eigen::Matrix<double, max_num_target, 1> targets_TTSD;
 };
 
 }  // namespace ASV::perception
@@ -0,0 +1,118 @@
+/*
+****************************************************************************
+* testRadarClustering.cc:
+* unit test for the grid DBSCAN of radar echoes. The clusters (in the
+* cartesian and polar coordinate) are compared with the ones given by
+* pyclustering, on the echoes of a simulated coastline and targets.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <pyclustering/cluster/dbscan.hpp>
+#include <iostream>
+#include <random>
+#include "../include/RadarClustering.h"
+#include "common/math/miscellaneous/include/math_utils.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+// echoes on the (range bin, azimuth) lattice of radar: a coastline, some
+// targets and random clutter
+void generate_echoes(const std::size_t num_coast_spokes,
+                     const std::size_t num_targets, const std::size_t seed,
+                     std::vector<double> &_range,
+                     std::vector<double> &_bearing, std::vector<double> &_x,
+                     std::vector<double> &_y) {
+  const double samplerange_m = 0.1;
+  const double azimuth_step = 2 * M_PI / 2048;
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  auto add_echo = [&](int range_bin, int azimuth) {
+    _range.push_back(samplerange_m * range_bin);
+    _bearing.push_back(
+        common::math::Normalizeheadingangle(azimuth_step * azimuth));
+  };
+
+  // coastline: a thick band of echoes over many spokes
+  for (std::size_t i = 0; i != num_coast_spokes; ++i) {
+    int center_bin = 300 + static_cast<int>(40 * std::sin(0.01 * i));
+    for (int bin = center_bin; bin != center_bin + 30; ++bin)
+      if (uniform(generator) < 0.7) add_echo(bin, static_cast<int>(i));
+  }
+  // targets: small blobs
+  for (std::size_t i = 0; i != num_targets; ++i) {
+    int center_bin = 50 + static_cast<int>(400 * uniform(generator));
+    int center_azimuth = static_cast<int>(2048 * uniform(generator));
+    for (int a = -3; a != 4; ++a)
+      for (int bin = -8; bin != 9; ++bin)
+        if (uniform(generator) < 0.5)
+          add_echo(center_bin + bin, center_azimuth + a);
+  }
+  // clutter
+  for (std::size_t i = 0; i != num_targets * 20; ++i)
+    add_echo(static_cast<int>(500 * uniform(generator)),
+             static_cast<int>(2048 * uniform(generator)));
+
+  for (std::size_t i = 0; i != _range.size(); ++i) {
+    _x.push_back(_range[i] * std::cos(_bearing[i]));
+    _y.push_back(_range[i] * std::sin(_bearing[i]));
+  }
+}  // generate_echoes
+
+// return true if the clusters are the same as the ones of pyclustering
+bool is_same_clusters(const perception::RadarDBSCAN &_dbscan,
+                      pyclustering::clst::cluster_sequence _clusters) {
+  if (_dbscan.num_clusters() != _clusters.size()) return false;
+  for (std::size_t i = 0; i != _clusters.size(); ++i) {
+    std::sort(_clusters[i].begin(), _clusters[i].end());
+    if (!std::equal(_clusters[i].begin(), _clusters[i].end(),
+                    _dbscan.cluster_begin(i), _dbscan.cluster_end(i)))
+      return false;
+  }
+  return true;
+}  // is_same_clusters
+
+int main() {
+  const double p_radius = 4.4;
+  const std::size_t p_minumum_neighbors = 2;
+
+  std::cout << "echoes, clusters, pyclustering(ms), grid(ms), polar(ms), "
+               "same clusters\n";
+  bool passed = true;
+  for (std::size_t num_coast_spokes : {0, 100, 300}) {
+    std::vector<double> range, bearing, x, y;
+    generate_echoes(num_coast_spokes, 30, num_coast_spokes, range, bearing, x,
+                    y);
+
+    common::timecounter _timer;
+    pyclustering::dataset p_data(x.size());
+    for (std::size_t i = 0; i != x.size(); ++i) p_data[i] = {x[i], y[i]};
+    pyclustering::clst::dbscan_data output_result;
+    pyclustering::clst::dbscan clustering_solver(p_radius,
+                                                 p_minumum_neighbors);
+    clustering_solver.process(p_data, output_result);
+    long long pyclustering_us = _timer.micro_timeelapsed();
+
+    perception::RadarDBSCAN radar_dbscan(p_radius, p_minumum_neighbors);
+    radar_dbscan.cluster(x, y);
+    long long grid_us = _timer.micro_timeelapsed();
+    bool same_grid = is_same_clusters(radar_dbscan, output_result.clusters());
+
+    _timer.micro_timeelapsed();
+    radar_dbscan.cluster_polar(range, bearing);
+    long long polar_us = _timer.micro_timeelapsed();
+    bool same_polar = is_same_clusters(radar_dbscan, output_result.clusters());
+
+    std::cout << x.size() << ", " << output_result.clusters().size() << ", "
+              << 1e-3 * pyclustering_us << ", " << 1e-3 * grid_us << ", "
+              << 1e-3 * polar_us << ", " << same_grid << " " << same_polar
+              << "\n";
+    passed &= same_grid && same_polar;
+  }
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
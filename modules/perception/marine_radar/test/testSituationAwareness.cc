@@ -0,0 +1,233 @@
+/*
+****************************************************************************
+* testSituationAwareness.cc:
+* unit test for the closed-form CPA/TCPA/DCPA of all tracked targets. The
+* results are compared with a fine search along the relative motion, and
+* the time is compared with the search of 100 time steps per target.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <iostream>
+#include <random>
+#include "../include/TargetTracking.h"
+
+using namespace ASV;
+
+// the search of 100 time steps, for the closest point of approach
+std::tuple<double, double, double> searchCPA(
+    const double boatA_position_x, const double boatA_position_y,
+    const double boatA_speed_x, const double boatA_speed_y,
+    const double boatB_position_x, const double boatB_position_y,
+    const double boatB_speed_x, const double boatB_speed_y) {
+  double initial_delta_x = boatA_position_x - boatB_position_x;
+  double initial_delta_y = boatA_position_y - boatB_position_y;
+  double delta_speed_x = boatA_speed_x - boatB_speed_x;
+  double delta_speed_y = boatA_speed_y - boatB_speed_y;
+  double initial_square_distance =
+      initial_delta_x * initial_delta_x + initial_delta_y * initial_delta_y;
+  double initial_square_rela_speed =
+      delta_speed_x * delta_speed_x + delta_speed_y * delta_speed_y;
+  double max_search_time = std::sqrt(2 * initial_square_distance /
+                                     (initial_square_rela_speed + 1));
+  int max_search_index = 100;
+  double search_time_step = max_search_time / max_search_index;
+
+  double min_distance = initial_square_distance;
+  double CPA_x = 0;
+  double CPA_y = 0;
+  double TCPA = 0;
+  for (int i = 0; i != max_search_index; ++i) {
+    double search_time = i * search_time_step;
+    double distance = std::pow(search_time * delta_speed_x + initial_delta_x,
+                               2) +
+                      std::pow(search_time * delta_speed_y + initial_delta_y,
+                               2);
+    if (distance < min_distance) {
+      min_distance = distance;
+      TCPA = search_time;
+      CPA_x = boatA_position_x + boatA_speed_x * search_time;
+      CPA_y = boatA_position_y + boatA_speed_y * search_time;
+    }
+  }
+  if (TCPA < 0.01) TCPA = -1;
+  return {CPA_x, CPA_y, TCPA};
+}  // searchCPA
+
+template <int max_num_target>
+bool test_targets(const std::size_t seed) {
+  using namespace perception;
+  const double safe_distance = 20.0;
+  const double speed_threhold = 0.5;
+  const double vessel_x = 10.0;
+  const double vessel_y = -5.0;
+  const double vessel_vx = 3.0;
+  const double vessel_vy = 1.0;
+
+  TargetTracking<max_num_target> Target_Tracking(
+      AlarmZone{10, 200, 0, M_PI, 0x90},
+      SpokeProcessdata{0.1, 0.0, 0.0},
+      TrackingTargetData{1, 400, speed_threhold, 20, 5, 600, safe_distance,
+                         1, 1, 1},
+      ClusteringData{1, 2});
+
+  // targets around the vessel, half of them idle or static
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> position(-300.0, 300.0);
+  std::uniform_real_distribution<double> speed(-6.0, 6.0);
+  std::uniform_int_distribution<int> state(0, 2);
+  TargetTrackerRTdata<max_num_target> _RTdata;
+  _RTdata.spoke_state = SPOKESTATE::OUTSIDE_ALARM_ZONE;
+  for (int i = 0; i != max_num_target; ++i) {
+    _RTdata.targets_state(i) = state(generator);
+    _RTdata.targets_intention(i) = 0;
+    _RTdata.targets_x(i) = position(generator);
+    _RTdata.targets_y(i) = position(generator);
+    _RTdata.targets_square_radius(i) = 1;
+    _RTdata.targets_vx(i) = (i % 4 == 0) ? 0.0 : speed(generator);
+    _RTdata.targets_vy(i) = (i % 4 == 0) ? 0.0 : speed(generator);
+    _RTdata.targets_CPA_x(i) = 0;
+    _RTdata.targets_CPA_y(i) = 0;
+    _RTdata.targets_TCPA(i) = 0;
+    _RTdata.targets_DCPA(i) = 0;
+    _RTdata.targets_TTSD(i) = 0;
+  }
+
+  constexpr int num_iterations = 1000;
+  common::timecounter _timer;
+  for (int k = 0; k != num_iterations; ++k)
+    Target_Tracking.SituationAwareness(vessel_x, vessel_y, vessel_vx,
+                                       vessel_vy, _RTdata);
+  long long closed_form_ns = 1000 * _timer.micro_timeelapsed() /
+                             num_iterations;
+
+  double search_TCPA_sum = 0;
+  for (int k = 0; k != num_iterations; ++k)
+    for (int i = 0; i != max_num_target; ++i)
+      if (_RTdata.targets_state(i) > 0)
+        search_TCPA_sum += std::get<2>(
+            searchCPA(vessel_x, vessel_y, vessel_vx, vessel_vy,
+                      _RTdata.targets_x(i), _RTdata.targets_y(i),
+                      _RTdata.targets_vx(i), _RTdata.targets_vy(i)));
+  long long search_ns = 1000 * _timer.micro_timeelapsed() / num_iterations;
+
+  // compare with a fine search over the relative motion
+  std::size_t num_errors = 0;
+  std::size_t num_dangerous = 0;
+  for (int i = 0; i != max_num_target; ++i) {
+    if (_RTdata.targets_state(i) == 0) {
+      if (_RTdata.targets_TCPA(i) != 0) ++num_errors;  // untouched
+      continue;
+    }
+    // beyond the horizon of the search (200s)
+    if ((_RTdata.targets_TCPA(i) > 190) || (_RTdata.targets_TTSD(i) > 190))
+      continue;
+    double dx = vessel_x - _RTdata.targets_x(i);
+    double dy = vessel_y - _RTdata.targets_y(i);
+    double wx = vessel_vx - _RTdata.targets_vx(i);
+    double wy = vessel_vy - _RTdata.targets_vy(i);
+    bool is_static = (i % 4 == 0);
+    double min_distance = std::hypot(dx, dy);
+    double min_time = 0;
+    double enter_time = (min_distance <= safe_distance) ? 0 : -1;
+    for (int j = 1; j != 200000; ++j) {
+      double t = 1e-3 * j;
+      double distance = std::hypot(dx + wx * t, dy + wy * t);
+      if (distance < min_distance) {
+        min_distance = distance;
+        min_time = t;
+      }
+      if ((enter_time < 0) && (distance <= safe_distance)) enter_time = t;
+    }
+    double TCPA = (min_time > 0) ? min_time : -1;
+    if (std::abs(_RTdata.targets_DCPA(i) - min_distance) > 1e-4) ++num_errors;
+    if (std::abs(std::max(_RTdata.targets_TCPA(i), 0.0) -
+                 std::max(TCPA, 0.0)) > 2e-3)
+      ++num_errors;
+    if (std::abs(_RTdata.targets_TTSD(i) - enter_time) > 2e-3) ++num_errors;
+    if (_RTdata.targets_intention(i) != (enter_time >= 0)) ++num_errors;
+    if (is_static && ((_RTdata.targets_CPA_x(i) != _RTdata.targets_x(i)) ||
+                      (_RTdata.targets_CPA_y(i) != _RTdata.targets_y(i))))
+      ++num_errors;
+    if (!is_static &&
+        (std::abs(_RTdata.targets_CPA_x(i) -
+                  (vessel_x + vessel_vx * std::max(TCPA, 0.0))) > 1e-2))
+      ++num_errors;
+    num_dangerous += _RTdata.targets_intention(i);
+  }
+
+  std::cout << "targets: " << max_num_target
+            << ", dangerous: " << num_dangerous
+            << ", closed form(ns): " << closed_form_ns
+            << ", search(ns): " << search_ns << ", errors: " << num_errors
+            << "\n";
+  return (num_errors == 0) && (search_TCPA_sum != 0);
+}  // test_targets
+
+// the vessel heads straight at a static target (e.g. buoy), which is
+// dangerous although the target does not move.
+bool test_static_target() {
+  using namespace perception;
+  constexpr int max_num_target = 20;
+  const double safe_distance = 20.0;
+
+  TargetTracking<max_num_target> Target_Tracking(
+      AlarmZone{10, 200, 0, M_PI, 0x90},
+      SpokeProcessdata{0.1, 0.0, 0.0},
+      TrackingTargetData{1, 400, 0.5, 20, 5, 600, safe_distance, 1, 1, 1},
+      ClusteringData{1, 2});
+
+  TargetTrackerRTdata<max_num_target> _RTdata;
+  _RTdata.spoke_state = SPOKESTATE::OUTSIDE_ALARM_ZONE;
+  _RTdata.targets_state.setZero();
+  _RTdata.targets_intention.setZero();
+  _RTdata.targets_x.setZero();
+  _RTdata.targets_y.setZero();
+  _RTdata.targets_square_radius.setOnes();
+  _RTdata.targets_vx.setZero();
+  _RTdata.targets_vy.setZero();
+  _RTdata.targets_CPA_x.setZero();
+  _RTdata.targets_CPA_y.setZero();
+  _RTdata.targets_TCPA.setZero();
+  _RTdata.targets_DCPA.setZero();
+  _RTdata.targets_TTSD.setZero();
+
+  // ahead of the vessel, 5m off its track
+  _RTdata.targets_state(0) = 2;
+  _RTdata.targets_x(0) = 100;
+  _RTdata.targets_y(0) = 5;
+  // behind the vessel
+  _RTdata.targets_state(1) = 2;
+  _RTdata.targets_x(1) = -100;
+  _RTdata.targets_y(1) = 0;
+
+  // vessel at origin, 2m/s along x
+  Target_Tracking.SituationAwareness(0.0, 0.0, 2.0, 0.0, _RTdata);
+
+  std::size_t num_errors = 0;
+  if (std::abs(_RTdata.targets_TCPA(0) - 50.0) > 1e-9) ++num_errors;
+  if (std::abs(_RTdata.targets_DCPA(0) - 5.0) > 1e-9) ++num_errors;
+  double TTSD = (100.0 - std::sqrt(std::pow(safe_distance, 2) - 25.0)) / 2.0;
+  if (std::abs(_RTdata.targets_TTSD(0) - TTSD) > 1e-9) ++num_errors;
+  if (_RTdata.targets_intention(0) != 1) ++num_errors;
+  if ((_RTdata.targets_CPA_x(0) != 100) || (_RTdata.targets_CPA_y(0) != 5))
+    ++num_errors;
+
+  if (_RTdata.targets_TCPA(1) >= 0) ++num_errors;
+  if (std::abs(_RTdata.targets_DCPA(1) - 100.0) > 1e-9) ++num_errors;
+  if (_RTdata.targets_TTSD(1) >= 0) ++num_errors;
+  if (_RTdata.targets_intention(1) != 0) ++num_errors;
+
+  std::cout << "static targets, errors: " << num_errors << "\n";
+  return num_errors == 0;
+}  // test_static_target
+
+int main() {
+  bool passed = true;
+  passed &= test_static_target();
+  passed &= test_targets<20>(0);
+  passed &= test_targets<300>(1);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,195 @@
+/*
+****************************************************************************
+* testSpokeKernel.cc:
+* unit test and micro-benchmark of the echo extraction of one spoke. The
+* SIMD thresholding is compared with the scalar one, and the extraction
+* (with lookup tables) is compared with the per-echo search and
+* trigonometric functions, over one revolution of simulated spokes.
+* usage: testSpokeKernel [num_revolutions]
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "../include/SpokeKernel.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV::perception;
+
+constexpr std::size_t num_bytes = 512;  // SAMPLES_PER_SPOKE / 2
+constexpr std::size_t num_spokes = 2048;
+
+// spokes of one revolution: sea clutter near the radar, a coastline and
+// some targets, with the random noise of the 4-bit samples
+std::vector<uint8_t> generate_spokes(const std::size_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> noise(0, 5);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<uint8_t> spokes(num_spokes * num_bytes);
+  for (std::size_t i = 0; i != num_spokes; ++i) {
+    int coast_sample = 700 + static_cast<int>(200 * std::sin(0.003 * i));
+    for (std::size_t k = 0; k != 2 * num_bytes; ++k) {
+      int nibble = noise(generator);
+      if (k < 60 && uniform(generator) < 0.5) nibble += 8;
+      if (static_cast<int>(k) >= coast_sample &&
+          static_cast<int>(k) < coast_sample + 80)
+        nibble += 10;
+      if ((i % 200 < 4) && (k % 300 < 10)) nibble += 10;
+      nibble = std::min(nibble, 15);
+      uint8_t &byte = spokes[i * num_bytes + k / 2];
+      byte |= (k % 2 == 0) ? nibble : (nibble << 4);
+    }
+  }
+  return spokes;
+}  // generate_spokes
+
+// the range of the k-th 4-bit sample
+double sample_range(const std::size_t k, const double _samplerange_m) {
+  return 8.0 + _samplerange_m * (k + 1);
+}  // sample_range
+
+int main(int argc, char *argv[]) {
+  int num_revolutions = (argc > 1) ? std::atoi(argv[1]) : 20;
+  bool passed = true;
+
+  // SIMD thresholding vs scalar, for all the thresholds and the gates which
+  // start/end at any sample (odd or even) of the vector blocks
+  auto spokes = generate_spokes(0);
+  std::vector<uint32_t> index(2 * num_bytes);
+  std::vector<uint32_t> index_scalar(2 * num_bytes);
+  std::size_t num_errors = 0;
+  for (int threshold = 0; threshold != 16; ++threshold)
+    for (std::size_t first = 0; first < 2 * num_bytes; first += 7)
+      for (std::size_t last = first; last <= 2 * num_bytes; last += 13) {
+        const uint8_t *spoke = &spokes[(first + last) % num_spokes * num_bytes];
+        std::size_t num = SpokeKernel::threshold_nibbles(
+            spoke, first, last, threshold, index.data());
+        std::size_t num_scalar = SpokeKernel::threshold_nibbles_scalar(
+            spoke, first, last, threshold, index_scalar.data());
+        if ((num != num_scalar) ||
+            !std::equal(index.begin(), index.begin() + num,
+                        index_scalar.begin()))
+          ++num_errors;
+      }
+  // the threshold of 4-bit samples, scaled to 0~255
+  for (int threshold = 0; threshold != 256; ++threshold)
+    for (int nibble = 0; nibble != 16; ++nibble)
+      if ((nibble * 0x11 >= threshold) !=
+          (nibble >= SpokeKernel::threshold_nibble(threshold)))
+        ++num_errors;
+  std::cout << "thresholding errors: " << num_errors << "\n";
+  passed &= (num_errors == 0);
+
+  // extraction vs the per-echo search, with the alarm zone of 10~200 m
+  const double start_range_m = 10.0;
+  const double end_range_m = 200.0;
+  const uint8_t sensitivity_threhold = 0x90;
+  const double samplerange_m = 0.25;
+  const double vessel_theta_rad = 0.3;
+  SpokeKernel spoke_kernel(2 * num_bytes);
+  spoke_kernel.setgate(start_range_m, end_range_m, sensitivity_threhold);
+
+  std::vector<double> bearing, range, x, y;
+  std::vector<double> bearing_ref, range_ref, x_ref, y_ref;
+  double max_error = 0.0;
+  long long reference_us = 0;
+  long long kernel_us = 0;
+  ASV::common::timecounter _timer;
+  for (int revolution = 0; revolution != num_revolutions; ++revolution) {
+    bearing_ref.clear();
+    range_ref.clear();
+    x_ref.clear();
+    y_ref.clear();
+    _timer.micro_timeelapsed();
+    for (std::size_t i = 0; i != num_spokes; ++i) {
+      const uint8_t *spoke = &spokes[i * num_bytes];
+      double azimuth_rad = 2 * M_PI * i / num_spokes;
+      std::vector<std::size_t> echoes;
+      for (std::size_t k = 0; k != 2 * num_bytes; ++k) {
+        int nibble = (k % 2 == 0) ? (spoke[k / 2] & 0x0f) : (spoke[k / 2] >> 4);
+        if (nibble * 0x11 >= sensitivity_threhold) echoes.push_back(k);
+      }
+      for (auto k : echoes) {
+        double range_m = sample_range(k, samplerange_m);
+        if ((range_m <= end_range_m) && (start_range_m <= range_m)) {
+          bearing_ref.push_back(azimuth_rad);
+          range_ref.push_back(range_m);
+        }
+      }
+    }
+    for (std::size_t j = 0; j != bearing_ref.size(); ++j) {
+      x_ref.push_back(range_ref[j] *
+                      std::cos(vessel_theta_rad + bearing_ref[j]));
+      y_ref.push_back(range_ref[j] *
+                      std::sin(vessel_theta_rad + bearing_ref[j]));
+    }
+    reference_us += _timer.micro_timeelapsed();
+
+    bearing.clear();
+    range.clear();
+    x.clear();
+    y.clear();
+    _timer.micro_timeelapsed();
+    double cvalue = std::cos(vessel_theta_rad);
+    double svalue = std::sin(vessel_theta_rad);
+    for (std::size_t i = 0; i != num_spokes; ++i) {
+      double azimuth_rad = 2 * M_PI * i / num_spokes;
+      std::size_t num = spoke_kernel.extract(&spokes[i * num_bytes],
+                                             num_bytes, samplerange_m);
+      const double *echo_range_m = spoke_kernel.echo_range_m();
+      double cvalue_bearing = 1.0;
+      double svalue_bearing = 0.0;
+      spoke_kernel.azimuth_cos_sin(azimuth_rad, cvalue_bearing,
+                                   svalue_bearing);
+      double cvalue_plus = cvalue * cvalue_bearing - svalue * svalue_bearing;
+      double svalue_plus = svalue * cvalue_bearing + cvalue * svalue_bearing;
+      bearing.insert(bearing.end(), num, azimuth_rad);
+      range.insert(range.end(), echo_range_m, echo_range_m + num);
+      std::size_t num_previous = x.size();
+      x.resize(num_previous + num);
+      y.resize(num_previous + num);
+      for (std::size_t j = 0; j != num; ++j) {
+        x[num_previous + j] = echo_range_m[j] * cvalue_plus;
+        y[num_previous + j] = echo_range_m[j] * svalue_plus;
+      }
+    }
+    kernel_us += _timer.micro_timeelapsed();
+
+    passed &= (bearing == bearing_ref) && (range == range_ref);
+    for (std::size_t j = 0; j != x.size(); ++j)
+      max_error = std::max({max_error, std::abs(x[j] - x_ref[j]),
+                            std::abs(y[j] - y_ref[j])});
+  }
+  passed &= (max_error < 1e-9);
+
+  std::cout << "echoes per revolution: " << range.size()
+            << ", max position error(m): " << max_error
+            << "\nper revolution(us): per-echo " << reference_us / num_revolutions
+            << " | kernel " << kernel_us / num_revolutions << "\n";
+
+  // thresholding only, one revolution
+  long long scalar_us = 0;
+  long long simd_us = 0;
+  std::size_t num_scalar = 0;
+  std::size_t num_simd = 0;
+  for (int revolution = 0; revolution != num_revolutions; ++revolution) {
+    _timer.micro_timeelapsed();
+    for (std::size_t i = 0; i != num_spokes; ++i)
+      num_scalar += SpokeKernel::threshold_nibbles_scalar(
+          &spokes[i * num_bytes], 0, 2 * num_bytes, 9, index_scalar.data());
+    scalar_us += _timer.micro_timeelapsed();
+    for (std::size_t i = 0; i != num_spokes; ++i)
+      num_simd += SpokeKernel::threshold_nibbles(
+          &spokes[i * num_bytes], 0, 2 * num_bytes, 9, index.data());
+    simd_us += _timer.micro_timeelapsed();
+  }
+  passed &= (num_scalar == num_simd);
+  std::cout << "thresholding per revolution(us): scalar "
+            << scalar_us / num_revolutions << " | simd "
+            << simd_us / num_revolutions << "\n";
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
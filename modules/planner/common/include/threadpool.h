@@ -0,0 +1,131 @@
+/*
+***********************************************************************
+* threadpool.h:
+* fixed-size pool of worker threads, used to run the independent
+* iterations of a loop in parallel (e.g. the samples of lattice)
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ASV::planning {
+
+class ThreadPool {
+  // one call of parallel_for
+  struct Job {
+    const std::function<void(std::size_t)> *task;
+    std::size_t num_iterations;
+    std::atomic<std::size_t> next_iteration;
+    std::atomic<std::size_t> num_finished;
+  };
+
+ public:
+  // the calling thread also runs the iterations, so (num_threads - 1)
+  // workers are created; num_threads <= 1 runs the loop serially
+  explicit ThreadPool(
+      const std::size_t num_threads = std::thread::hardware_concurrency())
+      : stop_(false), generation_(0) {
+    for (std::size_t i = 1; i < num_threads; ++i)
+      workers_.emplace_back(&ThreadPool::worker_loop, this);
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  virtual ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    job_cv_.notify_all();
+    for (auto &worker : workers_) worker.join();
+  }
+
+  // run task(i) for i in [0, num_iterations), and return once all of them
+  // are finished. Each iteration should write to its own output only, and
+  // should not throw.
+  void parallel_for(const std::size_t num_iterations,
+                    const std::function<void(std::size_t)> &task) {
+    if (workers_.empty() || (num_iterations < 2)) {
+      for (std::size_t i = 0; i != num_iterations; ++i) task(i);
+      return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->task = &task;
+    job->num_iterations = num_iterations;
+    job->next_iteration = 0;
+    job->num_finished = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      job_ = job;
+      ++generation_;
+    }
+    job_cv_.notify_all();
+
+    run_job(*job);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&job] {
+      return job->num_finished.load() == job->num_iterations;
+    });
+    job_.reset();
+  }  // parallel_for
+
+  std::size_t num_threads() const noexcept { return workers_.size() + 1; }
+
+ private:
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  bool stop_;
+  std::size_t generation_;  // # of jobs posted
+  std::shared_ptr<Job> job_;
+
+  void worker_loop() {
+    std::size_t seen_generation = 0;
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_cv_.wait(lock, [this, seen_generation] {
+          return stop_ || (generation_ != seen_generation);
+        });
+        if (stop_) return;
+        seen_generation = generation_;
+        job = job_;
+      }
+      if (job) run_job(*job);
+    }
+  }  // worker_loop
+
+  void run_job(Job &job) {
+    while (true) {
+      std::size_t i = job.next_iteration.fetch_add(1);
+      if (i >= job.num_iterations) return;
+      (*job.task)(i);
+      if (job.num_finished.fetch_add(1) + 1 == job.num_iterations) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_cv_.notify_all();
+      }
+    }
+  }  // run_job
+
+};  // end class ThreadPool
+
+}  // namespace ASV::planning
+
+#endif /* _THREADPOOL_H_ */
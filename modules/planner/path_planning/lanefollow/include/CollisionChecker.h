@@ -1,7 +1,8 @@
 /*
 ***********************************************************************
 * CollisionChecker.h:
-* Collision detection, using circle-based vessel shape
+* Collision detection, using circle-based vessel shape. The obstacles and
+* the reference line are indexed by uniform grids.
 * This header file can be read by C++ compilers
 *
 * by Hu.ZH(CrossOcean.ai)
@@ -11,37 +12,58 @@
 #ifndef _COLLISIONCHECKER_H_
 #define _COLLISIONCHECKER_H_
 
+#include <memory>
 #include "LatticePlannerdata.h"
+#include "PointGrid.h"
 #include "common/logging/include/easylogging++.h"
 #include "modules/planner/common/include/planner_util.h"
+#include "modules/planner/common/include/threadpool.h"
 
 namespace ASV::planning {
 class CollisionChecker {
  public:
   CollisionChecker(const CollisionData &_CollisionData)
-      : collisiondata(_CollisionData) {}
+      : collisiondata(_CollisionData),
+        obstacle_grid(_CollisionData.ROBOT_RADIUS),
+        reference_grid(3 * _CollisionData.ROBOT_RADIUS),
+        thread_pool(nullptr) {}
   virtual ~CollisionChecker() = default;
 
-  std::vector<Frenet_path> check_paths(
-      const std::vector<Frenet_path> &_frenet_lattice) {
-    std::vector<Frenet_path> collision_free_roi_paths;
-    std::vector<Frenet_path> sub_collision_free_roi_paths;
-
-    // compute the constraint-free path
-    // std::vector<Frenet_path> constraint_free_paths = _frenet_lattice;
-    std::vector<Frenet_path> constraint_free_paths =
-        check_constraints(_frenet_lattice);
+  // return the indices of the collision-free paths in the lattice, which
+  // are valid until the next check
+  const std::vector<std::size_t> &check_paths(
+      const Frenet_lattice &_frenet_lattice) {
+    std::size_t num_paths =
+        static_cast<std::size_t>(_frenet_lattice.num_points.size());
+    constraint_free_paths.clear();
+    collision_free_roi_paths.clear();
+    sub_collision_free_roi_paths.clear();
+
+    // check each path (in parallel if the thread pool is set):
+    // -1: constraints are violated; 0, 1, 2: results of check_collision
+    path_status.resize(num_paths);
+    auto check_path_i = [&](std::size_t i) {
+      path_status[i] = check_constraint(_frenet_lattice, i)
+                           ? check_collision(_frenet_lattice, i)
+                           : -1;
+    };
+    if (thread_pool) {
+      thread_pool->parallel_for(num_paths, check_path_i);
+    } else {
+      for (std::size_t i = 0; i != num_paths; i++) check_path_i(i);
+    }
 
-    for (std::size_t i = 0; i != constraint_free_paths.size(); i++) {
-      int results = check_collision(constraint_free_paths[i]);
-      if (results == 2) {
+    // collect the paths in the order of lattice
+    for (std::size_t i = 0; i != num_paths; i++) {
+      if (path_status[i] < 0) continue;  // constraints are violated
+      constraint_free_paths.push_back(i);
+      if (path_status[i] == 2) {
         continue;  // collision occurs
-      } else if (results == 1)
-        sub_collision_free_roi_paths.emplace_back(
-            constraint_free_paths[i]);  // emplace_back is better
+      } else if (path_status[i] == 1)
+        sub_collision_free_roi_paths.push_back(i);
       else {
-        sub_collision_free_roi_paths.emplace_back(constraint_free_paths[i]);
-        collision_free_roi_paths.emplace_back(constraint_free_paths[i]);
+        sub_collision_free_roi_paths.push_back(i);
+        collision_free_roi_paths.push_back(i);
       }
     }
     std::cout << constraint_free_paths.size() << " "
@@ -73,14 +95,20 @@ class CollisionChecker {
     return previous_obstacle_y_;
   }
 
+  // check the paths in parallel, nullptr for the serial check
+  CollisionChecker &set_thread_pool(
+      const std::shared_ptr<ThreadPool> &_thread_pool) {
+    thread_pool = _thread_pool;
+    return *this;
+  }  // set_thread_pool
+
  protected:
   // check if the surroundings will block the reference line: if true, the
-  // surroundings will be obstacles, otherwise not.
-  void IsObstacle(double surrounding_x, double surrounding_y,
-                  const Eigen::VectorXd &_ref_x,
-                  const Eigen::VectorXd &_ref_y) {
+  // surroundings will be obstacles, otherwise not. update_obstacle_index()
+  // should be called after all the surroundings are checked.
+  void IsObstacle(double surrounding_x, double surrounding_y) {
     // check the reference line
-    if (check_reference(surrounding_x, surrounding_y, _ref_x, _ref_y)) return;
+    if (check_reference(surrounding_x, surrounding_y)) return;
 
     // obstacle resolution
     double obstacle_resolution = 0.1 * std::pow(collisiondata.ROBOT_RADIUS, 2);
@@ -99,30 +127,39 @@ class CollisionChecker {
 
   }  // IsObstacle
 
-  bool check_reference(double surrounding_x, double surrounding_y,
-                       const Eigen::VectorXd &_ref_x,
-                       const Eigen::VectorXd &_ref_y) {
+  // return true if the surroundings are out of the reference line, i.e. no
+  // point of reference line is within 3 * ROBOT_RADIUS
+  bool check_reference(double surrounding_x, double surrounding_y) const {
     // check the reference line
     double max_reference_radius = 9 * std::pow(collisiondata.ROBOT_RADIUS, 2);
-    double min_dist = std::numeric_limits<double>::max();
-
-    for (unsigned i = 0; i != _ref_x.size(); ++i) {
-      double distance =
-          (_ref_x(i) - surrounding_x) * (_ref_x(i) - surrounding_x) +
-          (_ref_y(i) - surrounding_y) * (_ref_y(i) - surrounding_y);
-      if (distance < min_dist) min_dist = distance;
-    }
+    double min_dist =
+        reference_grid.min_squared_distance(surrounding_x, surrounding_y);
     if (min_dist > max_reference_radius)  // out of reference line
       return true;
     return false;
   }  // check_reference
 
+  // rebuild the index of the reference line, when it is regenerated
+  void update_reference(const Eigen::VectorXd &_ref_x,
+                        const Eigen::VectorXd &_ref_y) {
+    reference_grid.clear().add_points(_ref_x, _ref_y).build();
+  }  // update_reference
+
+  // rebuild the index of the current and previous obstacles
+  void update_obstacle_index() {
+    obstacle_grid.clear()
+        .add_points(obstacle_x_, obstacle_y_)
+        .add_points(previous_obstacle_x_, previous_obstacle_y_)
+        .build();
+  }  // update_obstacle_index
+
   void update_obstacles(const std::vector<double> &_new_obstacle_x,
                         const std::vector<double> &_new_obstacle_y) {
     previous_obstacle_x_ = obstacle_x_;
     previous_obstacle_y_ = obstacle_y_;
     obstacle_x_ = _new_obstacle_x;
     obstacle_y_ = _new_obstacle_y;
+    update_obstacle_index();
 
   }  // update_obstacles
 
@@ -133,29 +170,31 @@ class CollisionChecker {
   std::vector<double> previous_obstacle_y_;  // in the Cartesian coordinate
   std::vector<double> obstacle_x_;           // in the Cartesian coordinate
   std::vector<double> obstacle_y_;           // in the Cartesian coordinate
-
-  int check_collision(const Frenet_path &_Frenet_path) {
+  // index of all the obstacles, with the cell size of ROBOT_RADIUS
+  PointGrid obstacle_grid;
+  // index of the reference line, with the cell size of 3 * ROBOT_RADIUS
+  PointGrid reference_grid;
+  std::shared_ptr<ThreadPool> thread_pool;
+  // results of check_paths, reused among the planning steps
+  std::vector<int> path_status;
+  std::vector<std::size_t> constraint_free_paths;
+  std::vector<std::size_t> collision_free_roi_paths;
+  std::vector<std::size_t> sub_collision_free_roi_paths;
+
+  int check_collision(const Frenet_lattice &_frenet_lattice,
+                      std::size_t _index) const {
     std::size_t num_path_point =
-        static_cast<std::size_t>(_Frenet_path.x.size());
+        static_cast<std::size_t>(_frenet_lattice.num_points(_index));
 
+    // only the obstacles within ROBOT_RADIUS matter, which are found
+    // exactly by the grid
     double min_dist = std::numeric_limits<double>::max();
     double min_radius = std::pow(collisiondata.ROBOT_RADIUS, 2);
     for (std::size_t j = 0; j != num_path_point; j++) {
-      double plan_x = _Frenet_path.x(j);
-      double plan_y = _Frenet_path.y(j);
-
-      for (std::size_t i = 0; i != obstacle_x_.size(); i++) {
-        double _dis = std::pow(plan_x - obstacle_x_[i], 2) +
-                      std::pow(plan_y - obstacle_y_[i], 2);
-
-        if (_dis < min_dist) min_dist = _dis;
-      }
-      for (std::size_t i = 0; i != previous_obstacle_x_.size(); i++) {
-        double _dis = std::pow(plan_x - previous_obstacle_x_[i], 2) +
-                      std::pow(plan_y - previous_obstacle_y_[i], 2);
-
-        if (_dis < min_dist) min_dist = _dis;
-      }
+      double _dis = obstacle_grid.min_squared_distance(
+          _frenet_lattice.x(j, _index), _frenet_lattice.y(j, _index));
+      if (_dis < min_dist) min_dist = _dis;
+      if (min_dist <= 0.8 * min_radius) return 2;
     }
     if (min_dist <= 0.8 * min_radius) return 2;
     if (min_dist <= min_radius)  // collision occurs
@@ -163,48 +202,30 @@ class CollisionChecker {
     return 0;
   }  // check_collision
 
-  std::vector<Frenet_path> check_constraints(
-      const std::vector<Frenet_path> &_frenet_lattice) {
-    std::vector<Frenet_path> constraint_free_paths;
-
-    std::size_t count_max_speed = 0;
-    std::size_t count_max_accel = 0;
-    std::size_t count_max_angular_accel = 0;
-    // std::size_t count_max_curvature = 0;
-
-    for (std::size_t i = 0; i != _frenet_lattice.size(); i++) {
-      if (_frenet_lattice[i].speed.maxCoeff() > collisiondata.MAX_SPEED) {
-        count_max_speed++;
-        continue;  // max speed check
-      }
-      if ((_frenet_lattice[i].dspeed.maxCoeff() > collisiondata.MAX_ACCEL) ||
-          (_frenet_lattice[i].dspeed.minCoeff() < collisiondata.MIN_ACCEL)) {
-        count_max_accel++;
-        continue;  // Max accel check
-      }
-      if ((_frenet_lattice[i].yaw_accel.maxCoeff() >
-           collisiondata.MAX_ANG_ACCEL) ||
-          (_frenet_lattice[i].yaw_accel.minCoeff() <
-           collisiondata.MIN_ANG_ACCEL)) {
-        count_max_angular_accel++;
-        continue;  // Max heading acceleration check
-      }
-      // if ((_frenet_lattice[i].kappa.maxCoeff() > collisiondata.MAX_CURVATURE)
-      // ||
-      //     (_frenet_lattice[i].kappa.minCoeff() <
-      //      -collisiondata.MAX_CURVATURE)) {
-      //   count_max_curvature++;
-      //   continue;  // Max curvature check
-      // }
-      constraint_free_paths.emplace_back(_frenet_lattice[i]);
-    }
-
-    // std::cout << "max_speed " << count_max_speed << " max_accel "
-    //           << count_max_accel
-    //           << " MAX_ANG_ACCEL: " << count_max_angular_accel
-    //           << " MAX_CURVATURE: " << count_max_curvature << std::endl;
-    return constraint_free_paths;
-  }  // check_constraints
+  // return true if the path satisfies the speed and acceleration constraints
+  bool check_constraint(const Frenet_lattice &_frenet_lattice,
+                        std::size_t _index) const {
+    std::size_t num_path_point =
+        static_cast<std::size_t>(_frenet_lattice.num_points(_index));
+    auto speed = _frenet_lattice.speed.col(_index).head(num_path_point);
+    auto dspeed = _frenet_lattice.dspeed.col(_index).head(num_path_point);
+    auto yaw_accel =
+        _frenet_lattice.yaw_accel.col(_index).head(num_path_point);
+
+    if (speed.maxCoeff() > collisiondata.MAX_SPEED)
+      return false;  // max speed check
+    if ((dspeed.maxCoeff() > collisiondata.MAX_ACCEL) ||
+        (dspeed.minCoeff() < collisiondata.MIN_ACCEL))
+      return false;  // Max accel check
+    if ((yaw_accel.maxCoeff() > collisiondata.MAX_ANG_ACCEL) ||
+        (yaw_accel.minCoeff() < collisiondata.MIN_ANG_ACCEL))
+      return false;  // Max heading acceleration check
+    // auto kappa = _frenet_lattice.kappa.col(_index).head(num_path_point);
+    // if ((kappa.maxCoeff() > collisiondata.MAX_CURVATURE) ||
+    //     (kappa.minCoeff() < -collisiondata.MAX_CURVATURE))
+    //   return false;  // Max curvature check
+    return true;
+  }  // check_constraint
 
 };  // end class CollisionChecker
 }  // namespace ASV::planning
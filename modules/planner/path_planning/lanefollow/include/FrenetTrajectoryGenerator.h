@@ -14,10 +14,13 @@
 #ifndef _FRENETTRAJECTORYGENERATOR_H_
 #define _FRENETTRAJECTORYGENERATOR_H_
 
+#include <atomic>
 #include <limits>
+#include <memory>
 #include "LatticePlannerdata.h"
 #include "common/logging/include/easylogging++.h"
 #include "modules/planner/common/include/planner_util.h"
+#include "modules/planner/common/include/threadpool.h"
 
 namespace ASV::planning {
 
@@ -48,7 +51,9 @@ class FrenetTrajectoryGenerator {
             0,  // d_ddot
             0,  // d_prime
             0   // d_pprime
-        }) {
+        }),
+        num_extreme_situations(0),
+        thread_pool(nullptr) {
     setup_target_course();
     initialize_endcondition_FrenetLattice();
   }
@@ -93,9 +98,16 @@ class FrenetTrajectoryGenerator {
   Eigen::VectorXd getRefHeading() const noexcept { return RefHeading; }
   Eigen::VectorXd getRefKappa() const noexcept { return RefKappa; }
 
+  // generate the lattice in parallel, nullptr for the serial generation
+  FrenetTrajectoryGenerator &set_thread_pool(
+      const std::shared_ptr<ThreadPool> &_thread_pool) {
+    thread_pool = _thread_pool;
+    return *this;
+  }  // set_thread_pool
+
  protected:
-  // Frenet lattice
-  std::vector<Frenet_path> frenet_paths;
+  // Frenet lattice, reused among the planning steps
+  Frenet_lattice frenet_lattice;
 
   // setup a new targe course and re-generate it
   double regenerate_target_course(const Eigen::VectorXd &_marine_wx,
@@ -147,8 +159,20 @@ class FrenetTrajectoryGenerator {
   const double KLAT = 1;
   const double KLON = 10;
 
-  // difference h
-  const double spacing = 0.01;
+  // buffers used in the generation of lattice, one for each (di, Tj)
+  struct Frenet_buffer {
+    Eigen::VectorXd t;  // time (s)
+    // lateral motion, shared by the target speeds
+    Eigen::VectorXd d;
+    Eigen::VectorXd d_dot;
+    Eigen::VectorXd d_ddot;
+    Eigen::VectorXd d_dddot;
+  };
+  std::vector<Frenet_buffer> frenet_buffers;
+
+  // # of Frenet2Cart with 1 - kappa_r * d <= 0 in the last lattice
+  std::atomic<std::size_t> num_extreme_situations;
+  std::shared_ptr<ThreadPool> thread_pool;
 
   // assume that target_spline2d is known, we can interpolate the spline2d to
   // obtain the associated (s,x,y,theta, kappa)
@@ -207,241 +231,154 @@ class FrenetTrajectoryGenerator {
                            double _target_s_dot,        // target speed,
                            double _target_s_ddot = 0.0  //
   ) {
+    // the paths are stored in the order of (di, Tj, tvk), no matter whether
+    // they are generated in parallel
+    resize_frenet_lattice();
+    frenet_buffers.resize(n_di * n_Tj);
+    num_extreme_situations = 0;
+
+    auto calc_paths_ij = [&](std::size_t index) {
+      calc_frenet_paths(index / n_Tj, index % n_Tj, _d, _d_dot, _d_ddot, _s,
+                        _s_dot, _s_ddot, _target_s_dot, _target_s_ddot);
+    };
+    if (thread_pool) {
+      thread_pool->parallel_for(n_di * n_Tj, calc_paths_ij);
+    } else {
+      for (std::size_t index = 0; index != n_di * n_Tj; ++index)
+        calc_paths_ij(index);
+    }
+
+    if (num_extreme_situations > 0)
+      CLOG(ERROR, "Frenet") << "extreme situations";
+  }  // calc_frenet_lattice
+
+  // allocate the lattice for all the end conditions, which is a no-op
+  // unless the lattice is changed in size
+  void resize_frenet_lattice() {
+    std::size_t n_paths = n_di * n_Tj * n_tvk;
+    std::size_t max_points = static_cast<std::size_t>(
+        std::ceil(Tj.maxCoeff() / latticedata.DT + 1));
+    frenet_lattice.num_points.resize(n_paths);
+    for (auto *variable :
+         {&frenet_lattice.t, &frenet_lattice.d, &frenet_lattice.d_dot,
+          &frenet_lattice.d_ddot, &frenet_lattice.s, &frenet_lattice.s_dot,
+          &frenet_lattice.s_ddot, &frenet_lattice.d_prime,
+          &frenet_lattice.d_pprime, &frenet_lattice.x, &frenet_lattice.y,
+          &frenet_lattice.yaw, &frenet_lattice.kappa, &frenet_lattice.speed,
+          &frenet_lattice.dspeed, &frenet_lattice.yaw_rate,
+          &frenet_lattice.yaw_accel})
+      variable->resize(max_points, n_paths);
+    frenet_lattice.cd.resize(n_paths);
+    frenet_lattice.cv.resize(n_paths);
+    frenet_lattice.cf.resize(n_paths);
+  }  // resize_frenet_lattice
+
+  // generate the paths to the lateral offset di(i) at time Tj(j), with all
+  // the target speeds. The derivatives of d and s are evaluated from the
+  // coefficients of the polynomials, and those of d to s follow by the
+  // chain rule, in a single loop over t.
+  void calc_frenet_paths(std::size_t i, std::size_t j, double _d,
+                         double _d_dot, double _d_ddot, double _s,
+                         double _s_dot, double _s_ddot, double _target_s_dot,
+                         double _target_s_ddot) {
     quintic_polynomial _quintic_polynomial;
     quartic_polynomial _quartic_polynomial;
-
-    frenet_paths.clear();
-    frenet_paths.reserve(n_di * n_Tj * n_tvk);
-
-    // generate path to each offset goal
-    for (std::size_t i = 0; i != n_di; i++) {
-      // Lateral motion planning
-      for (std::size_t j = 0; j != n_Tj; j++) {
-        _quintic_polynomial.update_startendposition(_d, _d_dot, _d_ddot, di(i),
-                                                    0.0, 0.0, Tj(j));
-        std::size_t n_zero_Tj =
-            static_cast<std::size_t>(std::ceil(Tj(j) / latticedata.DT + 1));
-        Eigen::VectorXd _t = Eigen::VectorXd::LinSpaced(n_zero_Tj, 0.0, Tj(j));
-        Eigen::VectorXd t_d(n_zero_Tj);
-        Eigen::VectorXd t_d_dot(n_zero_Tj);
-        Eigen::VectorXd t_d_ddot(n_zero_Tj);
-        Eigen::VectorXd t_d_dddot(n_zero_Tj);
-
-        Eigen::VectorXd t_d_minus_h(n_zero_Tj);
-        Eigen::VectorXd t_d_dot_minus_h(n_zero_Tj);
-        Eigen::VectorXd t_d_ddot_minus_h(n_zero_Tj);
-        Eigen::VectorXd t_d_dddot_minus_h(n_zero_Tj);
-
-        Eigen::VectorXd t_d_plus_h(n_zero_Tj);
-        Eigen::VectorXd t_d_dot_plus_h(n_zero_Tj);
-        Eigen::VectorXd t_d_ddot_plus_h(n_zero_Tj);
-        Eigen::VectorXd t_d_dddot_plus_h(n_zero_Tj);
-
-        for (std::size_t ji = 0; ji != n_zero_Tj; ji++) {
-          t_d(ji) = _quintic_polynomial.compute_order_derivative<0>(_t(ji));
-          t_d_dot(ji) = _quintic_polynomial.compute_order_derivative<1>(_t(ji));
-          t_d_ddot(ji) =
-              _quintic_polynomial.compute_order_derivative<2>(_t(ji));
-          t_d_dddot(ji) =
-              _quintic_polynomial.compute_order_derivative<3>(_t(ji));
-
-          t_d_minus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<0>(_t(ji) - spacing);
-          t_d_dot_minus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<1>(_t(ji) - spacing);
-          t_d_ddot_minus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<2>(_t(ji) - spacing);
-          t_d_dddot_minus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<3>(_t(ji) - spacing);
-
-          t_d_plus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<0>(_t(ji) + spacing);
-          t_d_dot_plus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<1>(_t(ji) + spacing);
-          t_d_ddot_plus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<2>(_t(ji) + spacing);
-          t_d_dddot_plus_h(ji) =
-              _quintic_polynomial.compute_order_derivative<3>(_t(ji) + spacing);
-        }
-
-        // Longitudinal motion planning (Velocity keeping)
-        for (std::size_t k = 0; k != n_tvk; k++) {
-          _quartic_polynomial.update_startendposition(
-              _s, _s_dot, _s_ddot, tvk(k), _target_s_ddot, Tj(j));
-          Eigen::VectorXd t_s(n_zero_Tj);
-          Eigen::VectorXd t_s_dot(n_zero_Tj);
-          Eigen::VectorXd t_s_ddot(n_zero_Tj);
-          Eigen::VectorXd t_s_dddot(n_zero_Tj);
-          Eigen::VectorXd t_d_prime(n_zero_Tj);
-          Eigen::VectorXd t_d_pprime(n_zero_Tj);
-
-          Eigen::VectorXd t_s_minus_h(n_zero_Tj);
-          Eigen::VectorXd t_s_dot_minus_h(n_zero_Tj);
-          Eigen::VectorXd t_s_ddot_minus_h(n_zero_Tj);
-          Eigen::VectorXd t_s_dddot_minus_h(n_zero_Tj);
-          Eigen::VectorXd t_d_prime_minus_h(n_zero_Tj);
-          Eigen::VectorXd t_d_pprime_minus_h(n_zero_Tj);
-
-          Eigen::VectorXd t_s_plus_h(n_zero_Tj);
-          Eigen::VectorXd t_s_dot_plus_h(n_zero_Tj);
-          Eigen::VectorXd t_s_ddot_plus_h(n_zero_Tj);
-          Eigen::VectorXd t_s_dddot_plus_h(n_zero_Tj);
-          Eigen::VectorXd t_d_prime_plus_h(n_zero_Tj);
-          Eigen::VectorXd t_d_pprime_plus_h(n_zero_Tj);
-
-          for (std::size_t ki = 0; ki != n_zero_Tj; ki++) {
-            t_s(ki) = _quartic_polynomial.compute_order_derivative<0>(_t(ki));
-            t_s_dot(ki) =
-                _quartic_polynomial.compute_order_derivative<1>(_t(ki));
-            t_s_ddot(ki) =
-                _quartic_polynomial.compute_order_derivative<2>(_t(ki));
-            t_s_dddot(ki) =
-                _quartic_polynomial.compute_order_derivative<3>(_t(ki));
-            t_d_prime(ki) = t_d_dot(ki) / t_s_dot(ki);
-            t_d_pprime(ki) = (t_d_ddot(ki) - t_s_ddot(ki) * t_d_prime(ki)) /
-                             std::pow(t_s_dot(ki), 2);
-
-            t_s_minus_h(ki) = _quartic_polynomial.compute_order_derivative<0>(
-                _t(ki) - spacing);
-            t_s_dot_minus_h(ki) =
-                _quartic_polynomial.compute_order_derivative<1>(_t(ki) -
-                                                                spacing);
-            t_s_ddot_minus_h(ki) =
-                _quartic_polynomial.compute_order_derivative<2>(_t(ki) -
-                                                                spacing);
-            t_s_dddot_minus_h(ki) =
-                _quartic_polynomial.compute_order_derivative<3>(_t(ki) -
-                                                                spacing);
-            t_d_prime_minus_h(ki) = t_d_dot_minus_h(ki) / t_s_dot_minus_h(ki);
-            t_d_pprime_minus_h(ki) =
-                (t_d_ddot_minus_h(ki) -
-                 t_s_ddot_minus_h(ki) * t_d_prime_minus_h(ki)) /
-                std::pow(t_s_dot_minus_h(ki), 2);
-
-            t_s_plus_h(ki) = _quartic_polynomial.compute_order_derivative<0>(
-                _t(ki) + spacing);
-            t_s_dot_plus_h(ki) =
-                _quartic_polynomial.compute_order_derivative<1>(_t(ki) +
-                                                                spacing);
-            t_s_ddot_plus_h(ki) =
-                _quartic_polynomial.compute_order_derivative<2>(_t(ki) +
-                                                                spacing);
-            t_s_dddot_plus_h(ki) =
-                _quartic_polynomial.compute_order_derivative<3>(_t(ki) +
-                                                                spacing);
-            t_d_prime_plus_h(ki) = t_d_dot_plus_h(ki) / t_s_dot_plus_h(ki);
-            t_d_pprime_plus_h(ki) =
-                (t_d_ddot_plus_h(ki) -
-                 t_s_ddot_plus_h(ki) * t_d_prime_plus_h(ki)) /
-                std::pow(t_s_dot_plus_h(ki), 2);
-          }
-
-          double Jp = t_d_dddot.squaredNorm();  // square of jerk
-          double Js = t_s_dddot.squaredNorm();  // square of jerk
-
-          // std::cout << "Jp: " << Jp << " Js: " << Js << " Tj: " << Tj(j)
-          //           << " JD_d: " << std::pow(t_d(n_zero_Tj - 1), 2) << "
-          //           JD_s: "
-          //           << std::pow((_target_s_dot - t_s_dot(n_zero_Tj - 1)), 2)
-          //           << std::endl;
-
-          // square of diff from target speed
-          double _cd =
-              KJ * Jp + KT * Tj(j) + KD * std::pow(t_d(n_zero_Tj - 1), 2);
-          double _cv =
-              KJ * Js + KT * Tj(j) +
-              KD * std::pow((_target_s_dot - t_s_dot(n_zero_Tj - 1)), 2);
-          double _cf = KLAT * _cd + KLON * _cv;
-
-          // calc global positions;
-          Eigen::VectorXd t_x(n_zero_Tj);         // global x
-          Eigen::VectorXd t_y(n_zero_Tj);         // global y
-          Eigen::VectorXd t_yaw(n_zero_Tj);       // heading
-          Eigen::VectorXd t_kappa(n_zero_Tj);     // curvature
-          Eigen::VectorXd t_speed(n_zero_Tj);     // speed
-          Eigen::VectorXd t_dspeed(n_zero_Tj);    // dspeed
-          Eigen::VectorXd t_yawrate(n_zero_Tj);   // yaw rate
-          Eigen::VectorXd t_yawaccel(n_zero_Tj);  // yaw acceleration
-
-          for (std::size_t ki = 0; ki != n_zero_Tj; ki++) {
-            // auto _cartesianstate = Frenet2Cart(FrenetState{
-            //     t_s(ki),        // s
-            //     t_s_dot(ki),    // s_dot
-            //     t_s_ddot(ki),   // s_ddot
-            //     t_d(ki),        // d
-            //     t_d_dot(ki),    // d_dot
-            //     t_d_ddot(ki),   // d_ddot
-            //     t_d_prime(ki),  // d_prime
-            //     t_d_pprime(ki)  // d_pprime
-            // });
-            auto _cartesianstate = Frenet2Cart(
-                FrenetState{
-                    t_s_minus_h(ki),        // s
-                    t_s_dot_minus_h(ki),    // s_dot
-                    t_s_ddot_minus_h(ki),   // s_ddot
-                    t_d_minus_h(ki),        // d
-                    t_d_dot_minus_h(ki),    // d_dot
-                    t_d_ddot_minus_h(ki),   // d_ddot
-                    t_d_prime_minus_h(ki),  // d_prime
-                    t_d_pprime_minus_h(ki)  // d_pprime
-                },
-                FrenetState{
-                    t_s(ki),        // s
-                    t_s_dot(ki),    // s_dot
-                    t_s_ddot(ki),   // s_ddot
-                    t_d(ki),        // d
-                    t_d_dot(ki),    // d_dot
-                    t_d_ddot(ki),   // d_ddot
-                    t_d_prime(ki),  // d_prime
-                    t_d_pprime(ki)  // d_pprime
-                },
-                FrenetState{
-                    t_s_plus_h(ki),        // s
-                    t_s_dot_plus_h(ki),    // s_dot
-                    t_s_ddot_plus_h(ki),   // s_ddot
-                    t_d_plus_h(ki),        // d
-                    t_d_dot_plus_h(ki),    // d_dot
-                    t_d_ddot_plus_h(ki),   // d_ddot
-                    t_d_prime_plus_h(ki),  // d_prime
-                    t_d_pprime_plus_h(ki)  // d_pprime
-                });
-            t_x(ki) = _cartesianstate.x;
-            t_y(ki) = _cartesianstate.y;
-            t_yaw(ki) = _cartesianstate.theta;
-            t_kappa(ki) = _cartesianstate.kappa;
-            t_speed(ki) = _cartesianstate.speed;
-            t_dspeed(ki) = _cartesianstate.dspeed;
-            t_yawrate(ki) = _cartesianstate.yaw_rate;
-            t_yawaccel(ki) = _cartesianstate.yaw_accel;
-          }
-
-          // add to frenet_paths
-          frenet_paths.emplace_back(Frenet_path{
-              _t,          // vector of t
-              t_d,         // vector of d
-              t_d_dot,     // vector of dd/dt
-              t_d_ddot,    // vector of d(d_dot)/dt
-              t_s,         // vector of s
-              t_s_dot,     // vector of ds/dt
-              t_s_ddot,    // vector of d(s_dot)/dt
-              t_d_prime,   // vector of dd/ds
-              t_d_pprime,  // vector of d(d_prime)/ds
-              t_x,         // vector of x;
-              t_y,         // vector of y
-              t_yaw,       // vector of yaw
-              t_kappa,     // vector of kappa
-              t_speed,     // vector of speed
-              t_dspeed,    // vector of dspeed
-              t_yawrate,   // vector of yaw rate
-              t_yawaccel,  // vector of yaw acceleration
-              _cd,         // cd
-              _cv,         // cv
-              _cf          // cf
-          });
-        }
+    Frenet_buffer &_buffer = frenet_buffers[i * n_Tj + j];
+
+    std::size_t n_zero_Tj =
+        static_cast<std::size_t>(std::ceil(Tj(j) / latticedata.DT + 1));
+    _buffer.t.setLinSpaced(n_zero_Tj, 0.0, Tj(j));
+    _buffer.d.resize(n_zero_Tj);
+    _buffer.d_dot.resize(n_zero_Tj);
+    _buffer.d_ddot.resize(n_zero_Tj);
+    _buffer.d_dddot.resize(n_zero_Tj);
+
+    // Lateral motion planning
+    _quintic_polynomial.update_startendposition(_d, _d_dot, _d_ddot, di(i),
+                                                0.0, 0.0, Tj(j));
+    double Jp = 0.0;  // square of jerk
+    for (std::size_t ki = 0; ki != n_zero_Tj; ki++) {
+      double t = _buffer.t(ki);
+      _buffer.d(ki) = _quintic_polynomial.compute_order_derivative<0>(t);
+      _buffer.d_dot(ki) = _quintic_polynomial.compute_order_derivative<1>(t);
+      _buffer.d_ddot(ki) = _quintic_polynomial.compute_order_derivative<2>(t);
+      _buffer.d_dddot(ki) =
+          _quintic_polynomial.compute_order_derivative<3>(t);
+      Jp += _buffer.d_dddot(ki) * _buffer.d_dddot(ki);
+    }
+    double _cd =
+        KJ * Jp + KT * Tj(j) + KD * std::pow(_buffer.d(n_zero_Tj - 1), 2);
+
+    // Longitudinal motion planning (Velocity keeping)
+    for (std::size_t k = 0; k != n_tvk; k++) {
+      std::size_t p = (i * n_Tj + j) * n_tvk + k;  // index of path
+      _quartic_polynomial.update_startendposition(_s, _s_dot, _s_ddot, tvk(k),
+                                                  _target_s_ddot, Tj(j));
+      double Js = 0.0;  // square of jerk
+      for (std::size_t ki = 0; ki != n_zero_Tj; ki++) {
+        double t = _buffer.t(ki);
+        double s = _quartic_polynomial.compute_order_derivative<0>(t);
+        double s_dot = _quartic_polynomial.compute_order_derivative<1>(t);
+        double s_ddot = _quartic_polynomial.compute_order_derivative<2>(t);
+        double s_dddot = _quartic_polynomial.compute_order_derivative<3>(t);
+        Js += s_dddot * s_dddot;
+
+        // d_dot = d' * s_dot,
+        // d_ddot = d'' * s_dot^2 + d' * s_ddot,
+        // d_dddot = d''' * s_dot^3 + 3 * d'' * s_dot * s_ddot + d' * s_dddot
+        double d_prime = _buffer.d_dot(ki) / s_dot;
+        double d_pprime =
+            (_buffer.d_ddot(ki) - s_ddot * d_prime) / (s_dot * s_dot);
+        double d_ppprime = (_buffer.d_dddot(ki) -
+                            3 * d_pprime * s_dot * s_ddot - d_prime * s_dddot) /
+                           (s_dot * s_dot * s_dot);
+
+        frenet_lattice.t(ki, p) = t;
+        frenet_lattice.d(ki, p) = _buffer.d(ki);
+        frenet_lattice.d_dot(ki, p) = _buffer.d_dot(ki);
+        frenet_lattice.d_ddot(ki, p) = _buffer.d_ddot(ki);
+        frenet_lattice.s(ki, p) = s;
+        frenet_lattice.s_dot(ki, p) = s_dot;
+        frenet_lattice.s_ddot(ki, p) = s_ddot;
+        frenet_lattice.d_prime(ki, p) = d_prime;
+        frenet_lattice.d_pprime(ki, p) = d_pprime;
+
+        // calc global positions;
+        auto _cartesianstate = Frenet2Cart(
+            FrenetState{
+                s,                   // s
+                s_dot,               // s_dot
+                s_ddot,              // s_ddot
+                _buffer.d(ki),       // d
+                _buffer.d_dot(ki),   // d_dot
+                _buffer.d_ddot(ki),  // d_ddot
+                d_prime,             // d_prime
+                d_pprime             // d_pprime
+            },
+            d_ppprime);
+        frenet_lattice.x(ki, p) = _cartesianstate.x;
+        frenet_lattice.y(ki, p) = _cartesianstate.y;
+        frenet_lattice.yaw(ki, p) = _cartesianstate.theta;
+        frenet_lattice.kappa(ki, p) = _cartesianstate.kappa;
+        frenet_lattice.speed(ki, p) = _cartesianstate.speed;
+        frenet_lattice.dspeed(ki, p) = _cartesianstate.dspeed;
+        frenet_lattice.yaw_rate(ki, p) = _cartesianstate.yaw_rate;
+        frenet_lattice.yaw_accel(ki, p) = _cartesianstate.yaw_accel;
       }
+
+      // square of diff from target speed
+      double _cv = KJ * Js + KT * Tj(j) +
+                   KD * std::pow((_target_s_dot -
+                                  frenet_lattice.s_dot(n_zero_Tj - 1, p)),
+                                 2);
+      double _cf = KLAT * _cd + KLON * _cv;
+
+      frenet_lattice.num_points(p) = static_cast<int>(n_zero_Tj);
+      frenet_lattice.cd(p) = _cd;
+      frenet_lattice.cv(p) = _cv;
+      frenet_lattice.cf(p) = _cf;
     }
-  }  // calc_frenet_lattice
+  }  // calc_frenet_paths
 
   // find the closest point on the reference spline, given a position (x, y)
   int ClosestRefPoint(double _cart_vx, double _cart_vy,
@@ -614,15 +551,17 @@ class FrenetTrajectoryGenerator {
     return _cartstate_v;
   }  // Frenet2Cart
 
-  // Transform from Frenet s,d coordinates to Cartesian x,y
-  CartesianState Frenet2Cart(const FrenetState &_frenetstate_minus_h,
-                             const FrenetState &_frenetstate,
-                             const FrenetState &_frenetstate_plus_h) {
+  // Transform from Frenet s,d coordinates to Cartesian x,y, where the yaw
+  // rate and acceleration are given by d''' = d(d_pprime)/ds
+  CartesianState Frenet2Cart(const FrenetState &_frenetstate,
+                             double _d_ppprime) {
     CartesianState _cartstate_v;
-    // calc global positions at t0
+    // calc global positions;
     double ref_heading = target_Spline2D.compute_yaw(_frenetstate.s);
     double ref_kappa = target_Spline2D.compute_curvature(_frenetstate.s);
     double ref_kappa_prime = target_Spline2D.compute_dcurvature(_frenetstate.s);
+    double ref_kappa_pprime =
+        target_Spline2D.compute_ddcurvature(_frenetstate.s);
 
     auto _cart_position = CalculateCartesianPoint(
         ref_heading, _frenetstate.d,
@@ -630,47 +569,23 @@ class FrenetTrajectoryGenerator {
     _cartstate_v.x = _cart_position(0);
     _cartstate_v.y = _cart_position(1);
 
-    // calc global positions at t0-h
-    double ref_heading_minus_h =
-        target_Spline2D.compute_yaw(_frenetstate_minus_h.s);
-    double ref_kappa_minus_h =
-        target_Spline2D.compute_curvature(_frenetstate_minus_h.s);
-
-    // calc global positions at t0+h
-    double ref_heading_plus_h =
-        target_Spline2D.compute_yaw(_frenetstate_plus_h.s);
-    double ref_kappa_plus_h =
-        target_Spline2D.compute_curvature(_frenetstate_plus_h.s);
-
-    // one_minus_kappa_r_d at t0
+    // (logged by calc_frenet_lattice, as this may run in the worker threads)
     double one_minus_kappa_r_d = 1 - ref_kappa * _frenetstate.d;
-    if (one_minus_kappa_r_d <= 0) {
-      CLOG(ERROR, "Frenet") << "extreme situations";
-    }
+    if (one_minus_kappa_r_d <= 0) ++num_extreme_situations;
 
-    // speed at t0
+    // speed
     _cartstate_v.speed = std::hypot(_frenetstate.s_dot * one_minus_kappa_r_d,
                                     _frenetstate.d_dot);
 
-    // theta at t0
+    // theta
     const double tan_delta_theta = _frenetstate.d_prime / one_minus_kappa_r_d;
     const double delta_theta =
         std::atan2(_frenetstate.d_prime, one_minus_kappa_r_d);
     const double cos_delta_theta = std::cos(delta_theta);
     _cartstate_v.theta =
         common::math::Normalizeheadingangle(delta_theta + ref_heading);
-    // theta at t0-h
-    double theta_minus_h = common::math::Normalizeheadingangle(
-        std::atan2(_frenetstate_minus_h.d_prime,
-                   1 - ref_kappa_minus_h * _frenetstate_minus_h.d) +
-        ref_heading_minus_h);
-    // theta at t0+h
-    double theta_plus_h = common::math::Normalizeheadingangle(
-        std::atan2(_frenetstate_plus_h.d_prime,
-                   1 - ref_kappa_plus_h * _frenetstate_plus_h.d) +
-        ref_heading_plus_h);
-
-    // kappa at t0
+
+    // kappa
     const double kappa_r_d_prime =
         ref_kappa_prime * _frenetstate.d + ref_kappa * _frenetstate.d_prime;
     _cartstate_v.kappa =
@@ -678,7 +593,6 @@ class FrenetTrajectoryGenerator {
              cos_delta_theta * cos_delta_theta / one_minus_kappa_r_d +
          ref_kappa) *
         cos_delta_theta / one_minus_kappa_r_d;
-
     // a
     const double delta_theta_prime =
         _cartstate_v.kappa * one_minus_kappa_r_d / cos_delta_theta - ref_kappa;
@@ -689,16 +603,31 @@ class FrenetTrajectoryGenerator {
             (delta_theta_prime * _frenetstate.d_prime - kappa_r_d_prime) /
             cos_delta_theta;
 
-    // yaw rate
-    _cartstate_v.yaw_rate =
-        common::math::Normalizeheadingangle(theta_plus_h - theta_minus_h) /
-        (2 * spacing);
+    // d(delta_theta)/ds = N / D, where N = (1-krd) * d'' + (krd)' * d' and
+    // D = (1-krd)^2 + d'^2
+    const double kappa_r_d_pprime = ref_kappa_pprime * _frenetstate.d +
+                                    2 * ref_kappa_prime * _frenetstate.d_prime +
+                                    ref_kappa * _frenetstate.d_pprime;
+    const double N = one_minus_kappa_r_d * _frenetstate.d_pprime +
+                     kappa_r_d_prime * _frenetstate.d_prime;
+    const double N_prime = one_minus_kappa_r_d * _d_ppprime +
+                           kappa_r_d_pprime * _frenetstate.d_prime;
+    const double D = one_minus_kappa_r_d * one_minus_kappa_r_d +
+                     _frenetstate.d_prime * _frenetstate.d_prime;
+    const double D_prime =
+        2 * (_frenetstate.d_prime * _frenetstate.d_pprime -
+             one_minus_kappa_r_d * kappa_r_d_prime);
+    const double delta_theta_pprime = (N_prime * D - N * D_prime) / (D * D);
+
+    // yaw rate = d(theta)/dt, theta = ref_heading(s) + delta_theta
+    const double theta_prime = ref_kappa + delta_theta_prime;
+    _cartstate_v.yaw_rate = _frenetstate.s_dot * theta_prime;
 
     // yaw acceleration
     _cartstate_v.yaw_accel =
-        common::math::Normalizeheadingangle(theta_plus_h + theta_minus_h -
-                                            2 * _cartstate_v.theta) /
-        (spacing * spacing);
+        _frenetstate.s_ddot * theta_prime +
+        _frenetstate.s_dot * _frenetstate.s_dot *
+            (ref_kappa_prime + delta_theta_pprime);
 
     return _cartstate_v;
   }  // Frenet2Cart
@@ -35,7 +35,13 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
             0,            // dspeed
             0,            // yaw_rate
             0             // yaw_accel
-        }) {}
+        }),
+        best_path(0),
+        has_best_path(false) {
+    CollisionChecker::update_reference(
+        FrenetTrajectoryGenerator::getCartRefX(),
+        FrenetTrajectoryGenerator::getCartRefY());
+  }
 
   LatticePlanner &trajectoryonestep(double marine_x, double marine_y,
                                     double marine_theta, double marine_kappa,
@@ -47,16 +53,19 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
         _targetspeed);
 
     // constraints and collision check
-    auto t_frenet_paths =
-        CollisionChecker::check_paths(FrenetTrajectoryGenerator::frenet_paths);
+    const auto &t_frenet_paths = CollisionChecker::check_paths(
+        FrenetTrajectoryGenerator::frenet_lattice);
 
     if (t_frenet_paths.size() > 0) {
       // find minimum cost path
       best_path = findmincostpath(t_frenet_paths);
+      has_best_path = true;
       // update the planning state
       updateNextCartesianStatus();
-    } else
+    } else {
+      has_best_path = false;
       CLOG(ERROR, "Frenet_Lattice") << "No best path!";
+    }
 
     return *this;
   }  // trajectoryonestep
@@ -66,6 +75,9 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
                                 double initial_target_speed = 1) {
     double initial_theta = FrenetTrajectoryGenerator::regenerate_target_course(
         _marine_wx, _marine_wy);
+    CollisionChecker::update_reference(
+        FrenetTrajectoryGenerator::getCartRefX(),
+        FrenetTrajectoryGenerator::getCartRefY());
     next_cartesianstate.x = 0;
     next_cartesianstate.y = 0;
     next_cartesianstate.theta = initial_theta;
@@ -82,18 +94,14 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
                       const std::vector<double> &_marine_surrounding_y) {
     std::size_t size_of_surroundings = _marine_surrounding_x.size();
     if (size_of_surroundings == _marine_surrounding_y.size()) {
-      // get the reference line
-      auto _CartRefX = FrenetTrajectoryGenerator::getCartRefX();
-      auto _CartRefY = FrenetTrajectoryGenerator::getCartRefY();
-
       // check if the surroundings are obstacles
       for (std::size_t i = 0; i != size_of_surroundings; ++i) {
         // convert to cart coordinate
         auto [surrounding_x, surrounding_y] = common::math::Marine2Cart(
             _marine_surrounding_x[i], _marine_surrounding_y[i]);
-        CollisionChecker::IsObstacle(surrounding_x, surrounding_y, _CartRefX,
-                                     _CartRefY);
+        CollisionChecker::IsObstacle(surrounding_x, surrounding_y);
       }
+      CollisionChecker::update_obstacle_index();
 
     } else
       return;
@@ -105,10 +113,6 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
                       const Eigen::VectorXd &_targets_CPA_marine_x,
                       const Eigen::VectorXd &_targets_CPA_marine_y) {
     unsigned size_of_targets = _targets_state.size();
-    // get the reference line
-    auto _CartRefX = FrenetTrajectoryGenerator::getCartRefX();
-    auto _CartRefY = FrenetTrajectoryGenerator::getCartRefY();
-    //
     std::vector<double> new_surroundings_x;  // in the Cartesian coordinate
     std::vector<double> new_surroundings_y;  // in the Cartesian coordinate
 
@@ -118,8 +122,7 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
         // convert to cart coordinate
         auto [surrounding_x, surrounding_y] = common::math::Marine2Cart(
             _targets_CPA_marine_x(i), _targets_CPA_marine_y(i));
-        if (!CollisionChecker::check_reference(surrounding_x, surrounding_y,
-                                               _CartRefX, _CartRefY)) {
+        if (!CollisionChecker::check_reference(surrounding_x, surrounding_y)) {
           new_surroundings_x.emplace_back(surrounding_x);
           new_surroundings_y.emplace_back(surrounding_y);
         }
@@ -130,35 +133,63 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
     CollisionChecker::update_obstacles(new_surroundings_x, new_surroundings_y);
   }  // setup_obstacle
 
-  std::vector<Frenet_path> getallfrenetpaths() const noexcept {
-    return FrenetTrajectoryGenerator::frenet_paths;
+  // generate and check the lattice with "num_threads" threads (including the
+  // calling thread); 1 for the serial planner
+  LatticePlanner &set_num_threads(std::size_t num_threads) {
+    std::shared_ptr<ThreadPool> thread_pool =
+        (num_threads > 1) ? std::make_shared<ThreadPool>(num_threads)
+                          : nullptr;
+    FrenetTrajectoryGenerator::set_thread_pool(thread_pool);
+    CollisionChecker::set_thread_pool(thread_pool);
+    return *this;
+  }  // set_num_threads
+
+  const Frenet_lattice &getallfrenetpaths() const noexcept {
+    return FrenetTrajectoryGenerator::frenet_lattice;
   }
   CartesianState getnextcartesianstate() const noexcept {
     return next_cartesianstate;
   }
-  Eigen::VectorXd bestX() const noexcept { return best_path.x; }
-  Eigen::VectorXd bestY() const noexcept { return best_path.y; }
-  Eigen::VectorXd bestSpeed() const noexcept { return best_path.speed; }
+  // views of the best path, valid until the next planning step
+  Eigen::Ref<const Eigen::VectorXd> bestX() const noexcept {
+    return best_path_variable(FrenetTrajectoryGenerator::frenet_lattice.x);
+  }
+  Eigen::Ref<const Eigen::VectorXd> bestY() const noexcept {
+    return best_path_variable(FrenetTrajectoryGenerator::frenet_lattice.y);
+  }
+  Eigen::Ref<const Eigen::VectorXd> bestSpeed() const noexcept {
+    return best_path_variable(
+        FrenetTrajectoryGenerator::frenet_lattice.speed);
+  }
   double getsampletime() const noexcept { return sample_time; }
 
  private:
   const double sample_time;
   CartesianState next_cartesianstate;
-  Frenet_path best_path;
+  std::size_t best_path;  // index in the lattice
+  bool has_best_path;
 
-  Frenet_path findmincostpath(const std::vector<Frenet_path> &_frenetpaths) {
-    // find minimum cost path
+  // return the index of the minimum cost path
+  std::size_t findmincostpath(const std::vector<std::size_t> &_frenetpaths) {
+    const auto &_cf = FrenetTrajectoryGenerator::frenet_lattice.cf;
     double mincost = std::numeric_limits<double>::max();
-    Frenet_path _best_path = _frenetpaths[0];
+    std::size_t _best_path = _frenetpaths[0];
     for (std::size_t i = 0; i != _frenetpaths.size(); i++) {
-      if (mincost > _frenetpaths[i].cf) {
-        mincost = _frenetpaths[i].cf;
+      if (mincost > _cf(_frenetpaths[i])) {
+        mincost = _cf(_frenetpaths[i]);
         _best_path = _frenetpaths[i];
       }
     }
     return _best_path;
   }
 
+  Eigen::Ref<const Eigen::VectorXd> best_path_variable(
+      const Eigen::MatrixXd &_variable) const {
+    if (!has_best_path) return Eigen::Map<const Eigen::VectorXd>(nullptr, 0);
+    return _variable.col(best_path).head(
+        FrenetTrajectoryGenerator::frenet_lattice.num_points(best_path));
+  }  // best_path_variable
+
   void updateNextCartesianStatus() {
     // The results of Frenet generation at "DT"
     // TODO: adjust the "index", which is empirical; For simulation without
@@ -171,14 +202,15 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
     // if (index >= max_index) index = max_index;
 
     int index = 1;
-    next_cartesianstate.x = best_path.x(index);
-    next_cartesianstate.y = best_path.y(index);
-    next_cartesianstate.theta = best_path.yaw(index);
-    next_cartesianstate.kappa = best_path.kappa(index);
-    next_cartesianstate.speed = best_path.speed(index);
-    next_cartesianstate.dspeed = best_path.dspeed(index);
-    next_cartesianstate.yaw_rate = best_path.yaw_rate(index);
-    next_cartesianstate.yaw_accel = best_path.yaw_accel(index);
+    const auto &_frenet_lattice = FrenetTrajectoryGenerator::frenet_lattice;
+    next_cartesianstate.x = _frenet_lattice.x(index, best_path);
+    next_cartesianstate.y = _frenet_lattice.y(index, best_path);
+    next_cartesianstate.theta = _frenet_lattice.yaw(index, best_path);
+    next_cartesianstate.kappa = _frenet_lattice.kappa(index, best_path);
+    next_cartesianstate.speed = _frenet_lattice.speed(index, best_path);
+    next_cartesianstate.dspeed = _frenet_lattice.dspeed(index, best_path);
+    next_cartesianstate.yaw_rate = _frenet_lattice.yaw_rate(index, best_path);
+    next_cartesianstate.yaw_accel = _frenet_lattice.yaw_accel(index, best_path);
 
   }  // updateNextCartesianStatus
 
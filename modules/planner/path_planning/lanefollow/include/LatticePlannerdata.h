@@ -39,27 +39,31 @@ struct FrenetState {
   double d_pprime;  // d(d_prime)/ ds
 };
 
-struct Frenet_path {
-  Eigen::VectorXd t;  // time (s)
-  Eigen::VectorXd d;  // lateral error (m)
-  Eigen::VectorXd d_dot;
-  Eigen::VectorXd d_ddot;
-  Eigen::VectorXd s;  // longitudual error (m)
-  Eigen::VectorXd s_dot;
-  Eigen::VectorXd s_ddot;
-  Eigen::VectorXd d_prime;
-  Eigen::VectorXd d_pprime;
-  Eigen::VectorXd x;
-  Eigen::VectorXd y;
-  Eigen::VectorXd yaw;
-  Eigen::VectorXd kappa;
-  Eigen::VectorXd speed;
-  Eigen::VectorXd dspeed;
-  Eigen::VectorXd yaw_rate;   // rad/s
-  Eigen::VectorXd yaw_accel;  // rad/s^2
-  double cd;
-  double cv;
-  double cf;
+// Frenet lattice, stored as structure of arrays: each variable of all the
+// paths is in one matrix, with one column for each path. The i-th path has
+// num_points(i) time instants, and the rest of its column is not used.
+struct Frenet_lattice {
+  Eigen::VectorXi num_points;
+  Eigen::MatrixXd t;  // time (s)
+  Eigen::MatrixXd d;  // lateral error (m)
+  Eigen::MatrixXd d_dot;
+  Eigen::MatrixXd d_ddot;
+  Eigen::MatrixXd s;  // longitudual error (m)
+  Eigen::MatrixXd s_dot;
+  Eigen::MatrixXd s_ddot;
+  Eigen::MatrixXd d_prime;
+  Eigen::MatrixXd d_pprime;
+  Eigen::MatrixXd x;
+  Eigen::MatrixXd y;
+  Eigen::MatrixXd yaw;
+  Eigen::MatrixXd kappa;
+  Eigen::MatrixXd speed;
+  Eigen::MatrixXd dspeed;
+  Eigen::MatrixXd yaw_rate;   // rad/s
+  Eigen::MatrixXd yaw_accel;  // rad/s^2
+  Eigen::VectorXd cd;
+  Eigen::VectorXd cv;
+  Eigen::VectorXd cf;
 };
 
 struct LatticeData {
@@ -0,0 +1,180 @@
+/*
+***********************************************************************
+* PointGrid.h:
+* uniform grid of 2d points, used to find the points close to a given
+* position without scanning all of them. The points are sorted by cell,
+* and each cell stores the range of its points.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _POINTGRID_H_
+#define _POINTGRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <common/math/eigen/Eigen/Core>
+#include <limits>
+#include <vector>
+
+namespace ASV::planning {
+
+class PointGrid {
+ public:
+  // the squared distance within "cell_size" is exact in the query
+  explicit PointGrid(const double cell_size = 1.0,
+                     const std::size_t max_num_cells = 1 << 20)
+      : min_cell_size_(cell_size),
+        max_num_cells_(max_num_cells),
+        cell_size_(cell_size),
+        origin_x_(0.0),
+        origin_y_(0.0),
+        size_x_(0),
+        size_y_(0) {}
+  virtual ~PointGrid() = default;
+
+  // remove all the points, and the grid is empty until build()
+  PointGrid &clear() noexcept {
+    points_x_.clear();
+    points_y_.clear();
+    sorted_x_.clear();
+    sorted_y_.clear();
+    cell_start_.clear();
+    size_x_ = 0;
+    size_y_ = 0;
+    return *this;
+  }  // clear
+
+  PointGrid &add_points(const std::vector<double> &_x,
+                        const std::vector<double> &_y) {
+    points_x_.insert(points_x_.end(), _x.begin(), _x.end());
+    points_y_.insert(points_y_.end(), _y.begin(), _y.end());
+    return *this;
+  }  // add_points
+
+  PointGrid &add_points(const Eigen::VectorXd &_x, const Eigen::VectorXd &_y) {
+    points_x_.insert(points_x_.end(), _x.data(), _x.data() + _x.size());
+    points_y_.insert(points_y_.end(), _y.data(), _y.data() + _y.size());
+    return *this;
+  }  // add_points
+
+  // sort the added points by cell. The grid covers the bounding box of the
+  // points, and the cells are enlarged if there are too many of them.
+  PointGrid &build() {
+    std::size_t num_points = std::min(points_x_.size(), points_y_.size());
+    points_x_.resize(num_points);
+    points_y_.resize(num_points);
+    cell_start_.clear();
+    if (num_points == 0) {
+      size_x_ = 0;
+      size_y_ = 0;
+      return *this;
+    }
+
+    auto [min_x, max_x] =
+        std::minmax_element(points_x_.begin(), points_x_.end());
+    auto [min_y, max_y] =
+        std::minmax_element(points_y_.begin(), points_y_.end());
+    origin_x_ = *min_x;
+    origin_y_ = *min_y;
+    double range_x = *max_x - *min_x;
+    double range_y = *max_y - *min_y;
+    cell_size_ = std::fmax(
+        min_cell_size_,
+        std::sqrt((range_x + min_cell_size_) * (range_y + min_cell_size_) /
+                  max_num_cells_));
+    size_x_ = static_cast<int>(range_x / cell_size_) + 1;
+    size_y_ = static_cast<int>(range_y / cell_size_) + 1;
+
+    // counting sort of the points by cell
+    std::size_t num_cells = static_cast<std::size_t>(size_x_) * size_y_;
+    cell_start_.assign(num_cells + 1, 0);
+    cell_index_.resize(num_points);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      cell_index_[i] = cell(points_x_[i], points_y_[i]);
+      ++cell_start_[cell_index_[i] + 1];
+    }
+    for (std::size_t c = 0; c != num_cells; ++c)
+      cell_start_[c + 1] += cell_start_[c];
+
+    sorted_x_.resize(num_points);
+    sorted_y_.resize(num_points);
+    cell_fill_.assign(cell_start_.begin(), cell_start_.end() - 1);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      std::size_t position = cell_fill_[cell_index_[i]]++;
+      sorted_x_[position] = points_x_[i];
+      sorted_y_[position] = points_y_[i];
+    }
+    return *this;
+  }  // build
+
+  // minimum squared distance from (x, y) to the points in its cell and the
+  // neighboring ones. It is exact if the closest point is within the cell
+  // size, and larger than the square of cell size otherwise (max() if no
+  // point is found).
+  double min_squared_distance(const double x, const double y) const {
+    double min_dist = std::numeric_limits<double>::max();
+    if (cell_start_.empty()) return min_dist;
+
+    int ix = static_cast<int>(std::floor((x - origin_x_) / cell_size_));
+    int iy = static_cast<int>(std::floor((y - origin_y_) / cell_size_));
+    if ((ix < -1) || (ix > size_x_) || (iy < -1) || (iy > size_y_))
+      return min_dist;
+
+    int min_ix = std::max(ix - 1, 0);
+    int max_ix = std::min(ix + 1, size_x_ - 1);
+    int min_iy = std::max(iy - 1, 0);
+    int max_iy = std::min(iy + 1, size_y_ - 1);
+    for (int cx = min_ix; cx <= max_ix; ++cx) {
+      // the cells in a column are contiguous
+      std::size_t begin = cell_start_[cx * size_y_ + min_iy];
+      std::size_t end = cell_start_[cx * size_y_ + max_iy + 1];
+      for (std::size_t i = begin; i != end; ++i) {
+        double _dis = std::pow(x - sorted_x_[i], 2) +
+                      std::pow(y - sorted_y_[i], 2);
+        if (_dis < min_dist) min_dist = _dis;
+      }
+    }
+    return min_dist;
+  }  // min_squared_distance
+
+  std::size_t size() const noexcept { return sorted_x_.size(); }
+  bool empty() const noexcept { return cell_start_.empty(); }
+  double cell_size() const noexcept { return cell_size_; }
+
+ private:
+  const double min_cell_size_;
+  const std::size_t max_num_cells_;
+  double cell_size_;
+  double origin_x_;
+  double origin_y_;
+  int size_x_;
+  int size_y_;
+
+  // points added since clear()
+  std::vector<double> points_x_;
+  std::vector<double> points_y_;
+  // points sorted by cell (x-major), the points of cell c are in
+  // [cell_start_[c], cell_start_[c + 1])
+  std::vector<double> sorted_x_;
+  std::vector<double> sorted_y_;
+  std::vector<std::size_t> cell_start_;
+  // buffers of build()
+  std::vector<std::size_t> cell_index_;
+  std::vector<std::size_t> cell_fill_;
+
+  std::size_t cell(const double x, const double y) const {
+    int ix = std::min(static_cast<int>((x - origin_x_) / cell_size_),
+                      size_x_ - 1);
+    int iy = std::min(static_cast<int>((y - origin_y_) / cell_size_),
+                      size_y_ - 1);
+    return static_cast<std::size_t>(ix) * size_y_ + iy;
+  }  // cell
+
+};  // end class PointGrid
+
+}  // namespace ASV::planning
+
+#endif /* _POINTGRID_H_ */
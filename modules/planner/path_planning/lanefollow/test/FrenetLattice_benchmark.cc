@@ -0,0 +1,129 @@
+/*
+***********************************************************************
+* FrenetLattice_benchmark.cc:
+* benchmark of the generation and check of Frenet lattice, over the
+* # of samples and the # of threads. The lattices given by the thread
+* pool are compared with the serial ones.
+* usage: FrenetLattice_benchmark [max_num_threads]
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <sstream>
+#include "../include/LatticePlanner.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+// return true if the two lattices are exactly the same
+bool is_same_lattice(const planning::Frenet_lattice &_lattice_a,
+                     const planning::Frenet_lattice &_lattice_b) {
+  if (_lattice_a.num_points != _lattice_b.num_points) return false;
+  if (_lattice_a.cf != _lattice_b.cf) return false;
+  for (int i = 0; i != _lattice_a.num_points.size(); ++i) {
+    int n = _lattice_a.num_points(i);
+    if ((_lattice_a.x.col(i).head(n) != _lattice_b.x.col(i).head(n)) ||
+        (_lattice_a.y.col(i).head(n) != _lattice_b.y.col(i).head(n)) ||
+        (_lattice_a.speed.col(i).head(n) !=
+         _lattice_b.speed.col(i).head(n)) ||
+        (_lattice_a.yaw_accel.col(i).head(n) !=
+         _lattice_b.yaw_accel.col(i).head(n)))
+      return false;
+  }
+  return true;
+}  // is_same_lattice
+
+int main(int argc, char *argv[]) {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+
+  std::size_t max_num_threads = (argc > 1)
+                                    ? std::atoi(argv[1])
+                                    : std::thread::hardware_concurrency();
+  constexpr int num_runs = 20;
+
+  Eigen::VectorXd marine_WX(5);
+  Eigen::VectorXd marine_WY(5);
+  marine_WX << 0.0, 10.0, 20.5, 35.0, 70.5;
+  marine_WY << 0.0, 6.0, -5.0, -6.5, 0.0;
+  std::vector<double> marine_surrounding_x{20.0, 30.0, 30.0, 35.0, 34.0, 50.0};
+  std::vector<double> marine_surrounding_y{-10.0, -6.0, -8.0, -8.0, -8.0, -3.0};
+
+  planning::CollisionData _collisiondata{
+      4,     // MAX_SPEED
+      4.0,   // MAX_ACCEL
+      -3.0,  // MIN_ACCEL
+      2.0,   // MAX_ANG_ACCEL
+      -2.0,  // MIN_ANG_ACCEL
+      0.2,   // MAX_CURVATURE
+      3,     // HULL_LENGTH
+      1,     // HULL_WIDTH
+      1.5,   // HULL_BACK2COG
+      3.3    // ROBOT_RADIUS
+  };
+
+  // the output of check_paths is discarded
+  std::ostringstream discarded;
+
+  std::cout << "samples, threads, generation(ms), check(ms), same lattice\n";
+  for (double road_width_step : {1.0, 0.5, 0.25, 0.125}) {
+    planning::LatticeData _latticedata{
+        0.1,              // SAMPLE_TIME
+        50.0 / 3.6,       // MAX_SPEED
+        0.05,             // TARGET_COURSE_ARC_STEP
+        7.0,              // MAX_ROAD_WIDTH
+        road_width_step,  // ROAD_WIDTH_STEP
+        5.0,              // MAXT
+        4.0,              // MINT
+        0.2,              // DT
+        0.4,              // MAX_SPEED_DEVIATION
+        0.2               // TRAGET_SPEED_STEP
+    };
+
+    planning::Frenet_lattice serial_lattice;
+    std::vector<std::size_t> serial_checked_paths;
+    for (std::size_t num_threads = 1; num_threads <= max_num_threads;
+         num_threads *= 2) {
+      planning::LatticePlanner _trajectorygenerator(_latticedata,
+                                                    _collisiondata);
+      _trajectorygenerator.set_num_threads(num_threads)
+          .regenerate_target_course(marine_WX, marine_WY);
+      _trajectorygenerator.setup_obstacle(marine_surrounding_x,
+                                          marine_surrounding_y);
+
+      long long generation_us = 0;
+      long long check_us = 0;
+      std::vector<std::size_t> checked_paths;
+      for (int i = 0; i != num_runs; ++i) {
+        common::timecounter _timer;
+        _trajectorygenerator.Generate_Lattice(0, -1, -0.2 * M_PI, 0, 1, 0, 3);
+        generation_us += _timer.micro_timeelapsed();
+
+        auto *coutbuf = std::cout.rdbuf(discarded.rdbuf());
+        _timer.micro_timeelapsed();
+        checked_paths = _trajectorygenerator.check_paths(
+            _trajectorygenerator.getallfrenetpaths());
+        check_us += _timer.micro_timeelapsed();
+        std::cout.rdbuf(coutbuf);
+        discarded.str("");
+      }
+
+      const auto &all_frenet_paths = _trajectorygenerator.getallfrenetpaths();
+      bool same_lattice = true;
+      if (num_threads == 1) {
+        serial_lattice = all_frenet_paths;
+        serial_checked_paths = checked_paths;
+      } else {
+        same_lattice = is_same_lattice(serial_lattice, all_frenet_paths) &&
+                       (serial_checked_paths == checked_paths);
+      }
+
+      std::cout << all_frenet_paths.num_points.size() << ", " << num_threads
+                << ", " << 1e-3 * generation_us / num_runs << ", "
+                << 1e-3 * check_us / num_runs << ", " << same_lattice
+                << "\n";
+    }
+  }
+
+  return 0;
+}
@@ -26,7 +26,7 @@ void rtplotting_bestpath(
     const std::vector<double> &_cart_obstacle_y, const Eigen::VectorXd &_ref_x,
     const Eigen::VectorXd &_ref_y, const Eigen::VectorXd &_cart_best_x,
     const Eigen::VectorXd &_cart_best_y,
-    const std::vector<planning::Frenet_path> &_all_frenet_paths = {}) {
+    const planning::Frenet_lattice &_all_frenet_paths = {}) {
   static std::vector<double> vessel_profile_x({2.0, 1.1, -1.0, -1.0, 1.1});
   static std::vector<double> vessel_profile_y({0.0, 0.8, 0.8, -0.8, -0.8});
 
@@ -48,12 +48,11 @@ void rtplotting_bestpath(
 
   // lattice
   _gp << "plot ";
-  for (int i = 0; i != _all_frenet_paths.size(); ++i) {
+  for (int i = 0; i != _all_frenet_paths.num_points.size(); ++i) {
     xy_pts_A.clear();
-    auto one_frenet_path = _all_frenet_paths[i];
-    for (int j = 0; j != one_frenet_path.x.size(); ++j)
-      xy_pts_A.push_back(
-          std::make_pair(-one_frenet_path.y(j), one_frenet_path.x(j)));
+    for (int j = 0; j != _all_frenet_paths.num_points(i); ++j)
+      xy_pts_A.push_back(std::make_pair(-_all_frenet_paths.y(j, i),
+                                        _all_frenet_paths.x(j, i)));
     _gp << _gp.file1d(xy_pts_A)
         << "with line linetype 1 lw 0.5 lc rgb '#FDDBC7' notitle,";
   }
@@ -236,7 +235,7 @@ int main() {
                                   Plan_cartesianstate.theta,
                                   Plan_cartesianstate.kappa);
 
-    auto all_frenet_paths = _trajectorygenerator.getallfrenetpaths();
+    const auto &all_frenet_paths = _trajectorygenerator.getallfrenetpaths();
     auto cart_rx = _trajectorygenerator.getCartRefX();
     auto cart_ry = _trajectorygenerator.getCartRefY();
     auto cart_bestX = _trajectorygenerator.bestX();
@@ -0,0 +1,71 @@
+/*
+***********************************************************************
+* testPointGrid.cc:
+* Utility test for the uniform grid of points, compared with the brute
+* force search over all the points
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <iostream>
+#include <random>
+#include "../include/PointGrid.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+double brute_force_min_squared_distance(const std::vector<double> &_x,
+                                        const std::vector<double> &_y,
+                                        double x, double y) {
+  double min_dist = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i != _x.size(); ++i) {
+    double _dis = std::pow(x - _x[i], 2) + std::pow(y - _y[i], 2);
+    if (_dis < min_dist) min_dist = _dis;
+  }
+  return min_dist;
+}  // brute_force_min_squared_distance
+
+int main() {
+  const double radius = 3.3;
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> distribution(-200.0, 200.0);
+
+  for (std::size_t num_points : {0, 1, 10, 100, 1000, 10000}) {
+    std::vector<double> x(num_points);
+    std::vector<double> y(num_points);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      x[i] = distribution(generator);
+      y[i] = distribution(generator);
+    }
+    planning::PointGrid grid(radius);
+    grid.clear().add_points(x, y).build();
+
+    // the squared distance within the radius should be exact
+    const int num_queries = 20000;
+    int num_errors = 0;
+    long long grid_us = 0;
+    long long brute_force_us = 0;
+    for (int i = 0; i != num_queries; ++i) {
+      double qx = 1.2 * distribution(generator);
+      double qy = 1.2 * distribution(generator);
+      common::timecounter _timer;
+      double grid_dist = grid.min_squared_distance(qx, qy);
+      grid_us += _timer.micro_timeelapsed();
+      double exact_dist = brute_force_min_squared_distance(x, y, qx, qy);
+      brute_force_us += _timer.micro_timeelapsed();
+
+      if (exact_dist <= radius * radius) {
+        if (grid_dist != exact_dist) ++num_errors;
+      } else if (grid_dist <= radius * radius) {
+        ++num_errors;
+      }
+    }
+    std::cout << "points: " << num_points << ", errors: " << num_errors
+              << ", grid: " << grid_us << " us, brute force: "
+              << brute_force_us << " us\n";
+    if (num_errors > 0) return 1;
+  }
+  return 0;
+}
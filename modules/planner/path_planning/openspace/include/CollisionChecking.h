@@ -11,7 +11,8 @@
 #ifndef _CONSTRAINTCHECKING_H_
 #define _CONSTRAINTCHECKING_H_
 
-#include <pyclustering/container/kdtree.hpp>
+#include "KDTree2d.h"
+#include "OccupancyGrid.h"
 #include "openspacedata.h"
 
 namespace ASV::planning {
@@ -20,12 +21,19 @@ template <std::size_t max_vertex = 50, std::size_t max_ls = 50,
           std::size_t max_box = 20>
 class CollisionChecking {
  public:
-  explicit CollisionChecking(const CollisionData &_CollisionData)
+  // grid_resolution > 0 enables the rasterized obstacles (occupancy grid and
+  // distance field), which are used to skip the exact checking of the poses
+  // far away from (or deep inside) the obstacles
+  explicit CollisionChecking(const CollisionData &_CollisionData,
+                             const double grid_resolution = 0.0)
       : ego_length_(_CollisionData.HULL_LENGTH),
         ego_width_(_CollisionData.HULL_WIDTH),
         ego_back2cog_(_CollisionData.HULL_BACK2COG),
         ego_center_local_x_(0.5 * ego_length_ - ego_back2cog_),
-        ego_center_local_y_(0.0) {}
+        ego_center_local_y_(0.0),
+        ego_circumscribed_radius_(0.5 * std::hypot(ego_length_, ego_width_)),
+        ego_inscribed_radius_(0.5 * std::fmin(ego_length_, ego_width_)),
+        grid_resolution_(grid_resolution) {}
 
   virtual ~CollisionChecking() = default;
 
@@ -43,6 +51,16 @@ class CollisionChecking {
   // check collision, return true if collision occurs.
   bool InCollision(const double ego_x, const double ego_y,
                    const double ego_theta) const {
+    // conservative bounds given by the distance field: the ego box lies in
+    // its circumscribed circle, and contains its inscribed circle
+    if (grid_resolution_ > 0) {
+      constexpr double margin = 1e-3;
+      double distance = occupancy_grid_.distance(ego_x, ego_y);
+      double error = occupancy_grid_.error_bound();
+      if (distance - error > ego_circumscribed_radius_ + margin) return false;
+      if (distance + error < ego_inscribed_radius_ - margin) return true;
+    }
+
     // update the 2dbox for ego vessel
     ASV::common::math::Box2d ego_box_({ego_x, ego_y}, ego_theta,
                                       this->ego_length_, this->ego_width_);
@@ -77,26 +95,36 @@ class CollisionChecking {
   std::vector<ASV::common::math::Vec2d> FindNearestNeighbors(
       const double px, const double py,
       const double radius_search = 10.0) const {
-    pyclustering::container::kdtree_searcher searcher(
-        {px, py}, tree_.get_root(), radius_search);
-
-    // Find Nearest Neighbours
-    std::vector<double> nearest_distances;
-    std::vector<pyclustering::container::kdnode::ptr> nearest_nodes;
-    searcher.find_nearest_nodes(nearest_distances, nearest_nodes);
-
-    // generate the obstacles in the nearest neighbors
-    std::size_t total_num = nearest_nodes.size();
-    std::vector<ASV::common::math::Vec2d> nearest_obstacles(
-        total_num, ASV::common::math::Vec2d(0, 0));
+    std::vector<ASV::common::math::Vec2d> nearest_obstacles;
+    FindNearestNeighbors(px, py, radius_search, nearest_obstacles);
+    return nearest_obstacles;
+  }  // FindNearestNeighbors
 
-    for (std::size_t index = 0; index != total_num; index++) {
-      auto nearest_node = nearest_nodes[index]->get_data();
-      nearest_obstacles[index] =
-          ASV::common::math::Vec2d(nearest_node[0], nearest_node[1]);
-    }
+  // find the obstacles within the radius of (x, y). The results are
+  // written to nearest_obstacles, whose capacity is reused
+  void FindNearestNeighbors(
+      const double px, const double py, const double radius_search,
+      std::vector<ASV::common::math::Vec2d> &nearest_obstacles) const {
+    nearest_obstacles.clear();
+    tree_.radius_search(px, py, radius_search,
+                        [&nearest_obstacles](const KDTree2d::Point &_point) {
+                          nearest_obstacles.emplace_back(_point[0], _point[1]);
+                        });
+  }  // FindNearestNeighbors
 
-    return nearest_obstacles;
+  // find the obstacles within the radius of each position on a path. The
+  // buffers of the previous call are reused, so that a smoothing iteration
+  // does not allocate once the buffers are large enough
+  void FindNearestNeighbors(
+      const std::vector<ASV::common::math::Vec2d> &positions,
+      const double radius_search,
+      std::vector<std::vector<ASV::common::math::Vec2d>> &nearest_obstacles)
+      const {
+    std::size_t total_num = positions.size();
+    nearest_obstacles.resize(total_num);
+    for (std::size_t index = 0; index != total_num; index++)
+      FindNearestNeighbors(positions[index].x(), positions[index].y(),
+                           radius_search, nearest_obstacles[index]);
   }  // FindNearestNeighbors
 
   // find the nearest obstacle, given position (x, y)
@@ -129,17 +157,16 @@ class CollisionChecking {
     return nearest_obstacles;
   }  // FindNearstObstacle
 
-  // find the nearest obstacle, given position (x, y)
+  // find the nearest obstacle, given position (x, y). If there is no
+  // obstacle, the nearest one is at infinity
   ASV::common::math::Vec2d FindNearstObstacle(const double px,
                                               const double py) const {
-    // kd search
-    const static double radius_search = 10.0;  // not used
-    pyclustering::container::kdtree_searcher searcher(
-        {px, py}, tree_.get_root(), radius_search);
-    // FindNearestNode
-    pyclustering::container::kdnode::ptr nearest_node =
-        searcher.find_nearest_node();
-    auto nearest_obstacle = nearest_node->get_data();
+    std::size_t nearest_index = 0;
+    double squared_distance = 0.0;
+    if (!tree_.nearest(px, py, nearest_index, squared_distance))
+      return {std::numeric_limits<double>::infinity(),
+              std::numeric_limits<double>::infinity()};
+    auto nearest_obstacle = tree_.point(nearest_index);
     return {nearest_obstacle[0], nearest_obstacle[1]};
   }  // FindNearstObstacle
 
@@ -152,6 +179,7 @@ class CollisionChecking {
     set_Obstacles_LineSegment(Obstacles_LineSegment);
     set_Obstacles_Box2d(Obstacles_Box2d);
     updateAllCenters();
+    if (grid_resolution_ > 0) updateOccupancyGrid();
     return *this;
   }  // set_all_obstacls
 
@@ -203,6 +231,12 @@ class CollisionChecking {
   auto Obstacles_Vertex() const noexcept { return Obstacles_Vertex_; }
   auto Obstacles_LineSegment() const noexcept { return Obstacles_LineSegment_; }
   auto Obstacles_Box2d() const noexcept { return Obstacles_Box2d_; }
+  const OccupancyGrid &occupancy_grid() const noexcept {
+    return occupancy_grid_;
+  }
+  double ego_inscribed_radius() const noexcept {
+    return ego_inscribed_radius_;
+  }
 
  private:
   const double ego_length_;
@@ -210,13 +244,19 @@ class CollisionChecking {
   const double ego_back2cog_;
   const double ego_center_local_x_;
   const double ego_center_local_y_;
+  const double ego_circumscribed_radius_;
+  const double ego_inscribed_radius_;
+  const double grid_resolution_;
 
   Obstacle_Vertex<max_vertex> Obstacles_Vertex_;
   Obstacle_LineSegment<max_ls> Obstacles_LineSegment_;
   Obstacle_Box2d<max_box> Obstacles_Box2d_;
 
-  std::vector<std::vector<double>> allcenters_;
-  pyclustering::container::kdtree tree_;
+  std::vector<KDTree2d::Point> allcenters_;
+  KDTree2d tree_;
+
+  // rasterized obstacles
+  OccupancyGrid occupancy_grid_;
 
   std::tuple<double, double> local2global(const double local_x,
                                           const double local_y,
@@ -348,13 +388,43 @@ class CollisionChecking {
     }
 
     // update the kdtree
-    tree_ = pyclustering::container::kdtree();
-    for (auto &center : allcenters_) {
-      tree_.insert(center);
-    }
+    tree_.build(allcenters_);
 
   }  // updateAllCenters
 
+  void updateOccupancyGrid() {
+    occupancy_grid_ = OccupancyGrid();
+    if (allcenters_.empty()) return;
+
+    // the grid covers all obstacles, with a padding that any pose out of the
+    // grid is collision-free
+    double min_x = allcenters_[0][0];
+    double max_x = allcenters_[0][0];
+    double min_y = allcenters_[0][1];
+    double max_y = allcenters_[0][1];
+    for (const auto &center : allcenters_) {
+      min_x = std::fmin(min_x, center[0]);
+      max_x = std::fmax(max_x, center[0]);
+      min_y = std::fmin(min_y, center[1]);
+      max_y = std::fmax(max_y, center[1]);
+    }
+    double padding = ego_circumscribed_radius_ + 4 * grid_resolution_;
+    occupancy_grid_.reset(grid_resolution_, min_x - padding, min_y - padding,
+                          max_x + padding, max_y + padding);
+
+    for (std::size_t i = 0; i != max_vertex; ++i)
+      if (Obstacles_Vertex_.status[i])
+        occupancy_grid_.fill_point(Obstacles_Vertex_.vertex[i]);
+    for (std::size_t i = 0; i != max_ls; ++i)
+      if (Obstacles_LineSegment_.status[i])
+        occupancy_grid_.fill_linesegment(Obstacles_LineSegment_.linesegment[i]);
+    for (std::size_t i = 0; i != max_box; ++i)
+      if (Obstacles_Box2d_.status[i])
+        occupancy_grid_.fill_box(Obstacles_Box2d_.box2d[i]);
+
+    occupancy_grid_.update_distance_field();
+  }  // updateOccupancyGrid
+
 };  // end class CollisionChecking
 
 using CollisionChecking_Astar = CollisionChecking<50, 50, 20>;
@@ -12,6 +12,7 @@
 #define _HYBRIDASTAR_H_
 
 #include "CollisionChecking.h"
+#include "HybridAStarHeuristic.h"
 #include "common/math/Geometry/include/Reeds_Shepp.h"
 #include "hybridstlastar.h"
 #include "openspacedata.h"
@@ -108,6 +109,17 @@ class HybridState2DNode {
 
   }  // IsSameState
 
+  // heading is not considered in IsSameState
+  static constexpr int num_index_theta = 1;
+
+  // cell of the hash index, which is slightly larger than the tolerance of
+  // IsSameState
+  std::array<int, 3> IndexKey() const {
+    constexpr float resolution_xy = 0.051;
+    return {static_cast<int>(std::floor(x_ / resolution_xy)),
+            static_cast<int>(std::floor(y_ / resolution_xy)), 0};
+  }  // IndexKey
+
  private:
   // the index (x_,y_,theta_) of the node
   float x_;
@@ -125,8 +137,7 @@ class HybridState2DNode {
 class HybridState4DNode {
   using HybridAStar_Search =
       HybridAStarSearch<HybridState4DNode, SearchConfig,
-                        CollisionChecking_Astar,
-                        ASV::common::math::ReedsSheppStateSpace>;
+                        CollisionChecking_Astar, HybridAStarHeuristic>;
 
   enum MovementType {
     STRAIGHT_FORWARD = 0,
@@ -153,19 +164,21 @@ class HybridState4DNode {
 
   // Here's the heuristic function that estimates the distance from a Node
   // to the Goal.
-  float GoalDistanceEstimate(
-      const HybridState4DNode &nodeGoal,
-      const ASV::common::math::ReedsSheppStateSpace &RSCurve) {
+  float GoalDistanceEstimate(const HybridState4DNode &nodeGoal,
+                             const HybridAStarHeuristic &heuristic) {
     std::array<double, 3> _rsstart = {this->x_, this->y_, this->theta_};
     std::array<double, 3> _rsend = {nodeGoal.x(), nodeGoal.y(),
                                     nodeGoal.theta()};
 
     float rsdistance =
-        static_cast<float>(RSCurve.rs_distance(_rsstart, _rsend));
+        static_cast<float>(heuristic.rs_distance(_rsstart, _rsend));
     float l1distance = (std::fabs(this->x_ - nodeGoal.x()) +
                         std::fabs(this->y_ - nodeGoal.y()));
+    // zero if the 2d cost-to-go field is not computed
+    float holonomicdistance =
+        static_cast<float>(heuristic.holonomic_distance(this->x_, this->y_));
 
-    return std::fmax(rsdistance, l1distance);
+    return std::fmax(std::fmax(rsdistance, l1distance), holonomicdistance);
 
   }  // GoalDistanceEstimate
 
@@ -234,6 +247,22 @@ class HybridState4DNode {
 
   }  // IsSameState
 
+  // # of heading cells, floor(2 * pi / 0.01)
+  static constexpr int num_index_theta = 628;
+
+  // cell of the hash index, which is slightly larger than the tolerance of
+  // IsSameState
+  std::array<int, 3> IndexKey() const {
+    constexpr float resolution_xy = 0.051;
+    constexpr double resolution_theta = 2 * M_PI / num_index_theta;
+    int theta_index = static_cast<int>(std::floor(
+        (ASV::common::math::fNormalizeheadingangle(theta_) + M_PI) /
+        resolution_theta));
+    return {static_cast<int>(std::floor(x_ / resolution_xy)),
+            static_cast<int>(std::floor(y_ / resolution_xy)),
+            std::clamp(theta_index, 0, num_index_theta - 1)};
+  }  // IndexKey
+
  private:
   float x_;  // the (x,y) positions of the node
   float y_;
@@ -292,8 +321,7 @@ class HybridState4DNode {
 class HybridAStar {
   using HybridAStar_4dNode_Search =
       HybridAStarSearch<HybridState4DNode, SearchConfig,
-                        CollisionChecking_Astar,
-                        ASV::common::math::ReedsSheppStateSpace>;
+                        CollisionChecking_Astar, HybridAStarHeuristic>;
   using HybridAStar_2dNode_Search =
       HybridAStarSearch<HybridState2DNode, SearchConfig,
                         CollisionChecking_Astar>;
@@ -306,11 +334,17 @@ class HybridAStar {
       : startpoint_({0, 0, 0}),
         endpoint_({0, 0, 0}),
         rscurve_(1.0 / collisiondata.MAX_CURVATURE),
+        heuristic_(1.0 / collisiondata.MAX_CURVATURE),
         searchconfig_({
             0,     // move_length
             0,     // turning_angle
             {{0}}  // cost_map
         }),
+        holonomic_resolution_(0.0),
+        analytic_expansion_interval_(1),
+        analytic_expansion_distance_(0.0),
+        num_shots_attempted_(0),
+        num_shots_succeeded_(0),
         astar_4d_search_(5000),
         astar_2d_search_(3000) {
     searchconfig_ = GenerateSearchConfig(collisiondata, hybridastarconfig);
@@ -323,14 +357,35 @@ class HybridAStar {
                                const float end_y, const float end_theta) {
     startpoint_ = {start_x, start_y, start_theta};
     endpoint_ = {end_x, end_y, end_theta};
-
-    HybridState4DNode nodeStart(start_x, start_y, start_theta);
-    HybridState4DNode nodeEnd(end_x, end_y, end_theta);
-    astar_4d_search_.SetStartAndGoalStates(nodeStart, nodeEnd, rscurve_);
-
     return *this;
   }  // setup_start_end
 
+  // use the RS lookup table in the heuristic, which is cached in file
+  HybridAStar &load_rs_table(const std::string &filename) {
+    heuristic_.load_rs_table(filename);
+    return *this;
+  }  // load_rs_table
+
+  // use the 2d cost-to-go field (holonomic-with-obstacles) in the heuristic,
+  // which is computed at the start of each search. It requires the occupancy
+  // grid of the collision checker (grid_resolution > 0). resolution = 0
+  // disables it.
+  HybridAStar &enable_holonomic_heuristic(const double resolution) {
+    holonomic_resolution_ = resolution;
+    return *this;
+  }  // enable_holonomic_heuristic
+
+  // schedule of the analytic expansion (a RS shot to the goal): the shot is
+  // tried at the first expansion and every "interval" expansions after it,
+  // or once the heuristic of the current node drops below "distance".
+  // interval = 1 tries it at each expansion.
+  HybridAStar &set_analytic_expansion(const int interval,
+                                      const double distance) {
+    analytic_expansion_interval_ = std::max(interval, 1);
+    analytic_expansion_distance_ = distance;
+    return *this;
+  }  // set_analytic_expansion
+
   // update the start and ending points
   HybridAStar &setup_2d_start_end(const float start_x, const float start_y,
                                   const float start_theta, const float end_x,
@@ -343,17 +398,31 @@ class HybridAStar {
   }  // setup_2d_start_end
 
   void perform_4dnode_search(const CollisionChecking_Astar &collision_checker) {
+    std::array<double, 3> start = {startpoint_[0], startpoint_[1],
+                                   startpoint_[2]};
+    std::array<double, 3> end = {endpoint_[0], endpoint_[1], endpoint_[2]};
+    heuristic_.update_holonomic(collision_checker.occupancy_grid(),
+                                collision_checker.ego_inscribed_radius(),
+                                start, end, holonomic_resolution_);
+
+    HybridState4DNode nodeStart(startpoint_[0], startpoint_[1],
+                                startpoint_[2]);
+    HybridState4DNode nodeEnd(endpoint_[0], endpoint_[1], endpoint_[2]);
+    astar_4d_search_.SetStartAndGoalStates(nodeStart, nodeEnd, heuristic_);
+    num_shots_attempted_ = 0;
+    num_shots_succeeded_ = 0;
+
     unsigned int SearchState;
     unsigned int SearchSteps = 0;
     do {
       // perform a hybrid A* search
       SearchState = astar_4d_search_.SearchStep(searchconfig_,
-                                                collision_checker, rscurve_);
+                                                collision_checker, heuristic_);
       SearchSteps++;
 
       // get the current node
       HybridState4DNode *current_p = astar_4d_search_.GetCurrentNode();
-      if (current_p) {
+      if (current_p && IsAnalyticExpansionScheduled(SearchSteps)) {
         std::array<double, 3> closedlist_end = {current_p->x(), current_p->y(),
                                                 current_p->theta()};
 
@@ -364,9 +433,11 @@ class HybridAStar {
         // try a rs curve
         auto rscurve_generated = rscurve_.rs_state(
             closedlist_end, rscurve_end, 0.5 * searchconfig_.move_length);
+        ++num_shots_attempted_;
 
         // check the collision for the generated RS curve
-        if (!collision_checker.InCollision(rscurve_generated)) {
+        if (IsShotCollisionFree(rscurve_generated, collision_checker)) {
+          ++num_shots_succeeded_;
           vecpath closedlist_trajecotry = {
               {static_cast<double>(current_p->x()),
                static_cast<double>(current_p->y()),
@@ -442,6 +513,8 @@ class HybridAStar {
 
     // Display the number of loops the search went through
     std::cout << "SearchSteps : " << SearchSteps << "\n";
+    std::cout << "RS shots : " << num_shots_succeeded_ << "/"
+              << num_shots_attempted_ << "\n";
     // astarsearch_.FreeSolutionNodes();
     astar_4d_search_.EnsureMemoryFreed();
 
@@ -502,24 +575,16 @@ class HybridAStar {
     return hybridastar_2d_trajecotry_;
   }  // hybridastar_2dtrajecotry
 
+  // # of RS shots in the last 4d search
+  int num_shots_attempted() const noexcept { return num_shots_attempted_; }
+  int num_shots_succeeded() const noexcept { return num_shots_succeeded_; }
+
   std::array<float, 3> startpoint() const noexcept { return startpoint_; }
   std::array<float, 3> endpoint() const noexcept { return endpoint_; }
 
- private:
-  std::array<float, 3> startpoint_;
-  std::array<float, 3> endpoint_;
-
-  ASV::common::math::ReedsSheppStateSpace rscurve_;
-  SearchConfig searchconfig_;
-  HybridAStar_4dNode_Search astar_4d_search_;
-  HybridAStar_2dNode_Search astar_2d_search_;
-
-  // search results
-  vecpath hybridastar_trajecotry_;
-  std::vector<std::array<double, 3>> hybridastar_2d_trajecotry_;
-
-  // generate the config for search
-  SearchConfig GenerateSearchConfig(
+  // generate the config for search, from the vessel and the motion
+  // primitives of hybrid A*
+  static SearchConfig GenerateSearchConfig(
       const CollisionData &collisiondata,
       const HybridAStarConfig &hybridastarconfig) {
     SearchConfig searchconfig;
@@ -555,6 +620,42 @@ class HybridAStar {
     return searchconfig;
   }  // GenerateSearchConfig
 
+ private:
+  std::array<float, 3> startpoint_;
+  std::array<float, 3> endpoint_;
+
+  ASV::common::math::ReedsSheppStateSpace rscurve_;
+  HybridAStarHeuristic heuristic_;
+  SearchConfig searchconfig_;
+  double holonomic_resolution_;  // resolution of 2d cost-to-go field
+  int analytic_expansion_interval_;     // # of expansions between RS shots
+  double analytic_expansion_distance_;  // heuristic below which RS shot
+  int num_shots_attempted_;
+  int num_shots_succeeded_;
+  HybridAStar_4dNode_Search astar_4d_search_;
+  HybridAStar_2dNode_Search astar_2d_search_;
+
+  // search results
+  vecpath hybridastar_trajecotry_;
+  std::vector<std::array<double, 3>> hybridastar_2d_trajecotry_;
+
+  bool IsAnalyticExpansionScheduled(const unsigned int search_steps) const {
+    return ((search_steps - 1) % analytic_expansion_interval_ == 0) ||
+           (astar_4d_search_.GetCurrentNodeHeuristic() <
+            analytic_expansion_distance_);
+  }  // IsAnalyticExpansionScheduled
+
+  // check the samples of RS curve from the far end, where the curve meets
+  // the goal among the obstacles, and stop at the first collision
+  bool IsShotCollisionFree(
+      const std::vector<std::array<double, 3>> &rscurve_states,
+      const CollisionChecking_Astar &collision_checker) const {
+    for (auto it = rscurve_states.rbegin(); it != rscurve_states.rend(); ++it)
+      if (collision_checker.InCollision(it->at(0), it->at(1), it->at(2)))
+        return false;
+    return true;
+  }  // IsShotCollisionFree
+
   // tempo function
   float twodnode_search(const CollisionChecking_Astar &collision_checker) {
     unsigned int SearchState;
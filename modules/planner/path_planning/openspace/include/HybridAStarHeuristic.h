@@ -0,0 +1,192 @@
+/*
+*******************************************************************************
+* HybridAStarHeuristic.h:
+* heuristic (cost-to-go) of the 4d hybrid A* search, based on the Reeds
+* Shepp distance (evaluated exactly or from a lookup table), and the
+* holonomic-with-obstacles distance given by a 2d Dijkstra search
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#ifndef _HYBRIDASTARHEURISTIC_H_
+#define _HYBRIDASTARHEURISTIC_H_
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "OccupancyGrid.h"
+#include "common/math/Geometry/include/ReedsSheppTable.h"
+
+namespace ASV::planning {
+
+class HybridAStarHeuristic {
+ public:
+  explicit HybridAStarHeuristic(const double turningRadius)
+      : rho_(turningRadius),
+        rscurve_(turningRadius),
+        rstable_(turningRadius),
+        holonomic_resolution_(0.0),
+        holonomic_origin_x_(0.0),
+        holonomic_origin_y_(0.0),
+        holonomic_size_x_(0),
+        holonomic_size_y_(0) {}
+  virtual ~HybridAStarHeuristic() = default;
+
+  // load the cached RS table from file, or generate and cache it. The exact
+  // RS distance is used until the table is loaded.
+  HybridAStarHeuristic &load_rs_table(const std::string &filename) {
+    rstable_.load_or_generate(filename);
+    return *this;
+  }  // load_rs_table
+
+  // RS distance from q0 to q1, or its lower bound from the table if loaded
+  double rs_distance(const std::array<double, 3> &q0,
+                     const std::array<double, 3> &q1) const {
+    return rstable_.empty() ? rscurve_.rs_distance(q0, q1)
+                            : rstable_.rs_distance(q0, q1);
+  }  // rs_distance
+
+  // 2d cost-to-go to the goal, given by a backward Dijkstra search from the
+  // goal over an 8-connected grid. A cell is blocked if the distance field
+  // shows that any pose in it collides (the inscribed circle of the ego
+  // vessel, with radius "clearance", overlaps the obstacles). The grid
+  // covers the obstacles, start and goal, with a padding of two turning
+  // radii. Nothing is computed if the occupancy grid is empty.
+  HybridAStarHeuristic &update_holonomic(const OccupancyGrid &occupancy_grid,
+                                         const double clearance,
+                                         const std::array<double, 3> &start,
+                                         const std::array<double, 3> &goal,
+                                         const double resolution) {
+    holonomic_cost_.clear();
+    if (occupancy_grid.empty() || !(resolution > 0)) return *this;
+
+    double padding = 2 * rho_;
+    double min_x = std::fmin(occupancy_grid.origin_x(),
+                             std::fmin(start[0], goal[0]) - padding);
+    double min_y = std::fmin(occupancy_grid.origin_y(),
+                             std::fmin(start[1], goal[1]) - padding);
+    double max_x = std::fmax(occupancy_grid.origin_x() +
+                                 occupancy_grid.size_x() *
+                                     occupancy_grid.resolution(),
+                             std::fmax(start[0], goal[0]) + padding);
+    double max_y = std::fmax(occupancy_grid.origin_y() +
+                                 occupancy_grid.size_y() *
+                                     occupancy_grid.resolution(),
+                             std::fmax(start[1], goal[1]) + padding);
+    holonomic_resolution_ = resolution;
+    holonomic_origin_x_ = min_x;
+    holonomic_origin_y_ = min_y;
+    holonomic_size_x_ =
+        static_cast<int>(std::ceil((max_x - min_x) / resolution)) + 1;
+    holonomic_size_y_ =
+        static_cast<int>(std::ceil((max_y - min_y) / resolution)) + 1;
+
+    // blocked cells, using the distance at the center of each cell
+    std::size_t num_cell =
+        static_cast<std::size_t>(holonomic_size_x_) * holonomic_size_y_;
+    double margin = occupancy_grid.error_bound() + M_SQRT1_2 * resolution;
+    std::vector<std::uint8_t> blocked(num_cell, 0);
+    for (int ix = 0; ix != holonomic_size_x_; ++ix) {
+      for (int iy = 0; iy != holonomic_size_y_; ++iy) {
+        double distance = occupancy_grid.distance(
+            min_x + (ix + 0.5) * resolution, min_y + (iy + 0.5) * resolution);
+        blocked[ix * holonomic_size_y_ + iy] = (distance + margin < clearance);
+      }
+    }
+
+    // Dijkstra search from the goal
+    using QueueNode = std::pair<float, int>;  // (cost, index of cell)
+    std::priority_queue<QueueNode, std::vector<QueueNode>,
+                        std::greater<QueueNode>>
+        openlist;
+    holonomic_cost_.assign(num_cell, std::numeric_limits<float>::infinity());
+    int goal_index = holonomic_index(goal[0], goal[1]);
+    holonomic_cost_[goal_index] = 0.0f;
+    openlist.push({0.0f, goal_index});
+
+    constexpr int move_direction[8][2] = {{0, 1}, {1, 1},   {1, 0},  {1, -1},
+                                          {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+    while (!openlist.empty()) {
+      auto [cost, index] = openlist.top();
+      openlist.pop();
+      if (cost > holonomic_cost_[index]) continue;  // outdated
+
+      int ix = index / holonomic_size_y_;
+      int iy = index % holonomic_size_y_;
+      for (const auto &move : move_direction) {
+        int new_ix = ix + move[0];
+        int new_iy = iy + move[1];
+        if ((new_ix < 0) || (new_ix >= holonomic_size_x_) || (new_iy < 0) ||
+            (new_iy >= holonomic_size_y_))
+          continue;
+        int new_index = new_ix * holonomic_size_y_ + new_iy;
+        if (blocked[new_index]) continue;
+
+        float new_cost =
+            cost + static_cast<float>(((move[0] != 0) && (move[1] != 0))
+                                          ? M_SQRT2 * resolution
+                                          : resolution);
+        if (new_cost < holonomic_cost_[new_index]) {
+          holonomic_cost_[new_index] = new_cost;
+          openlist.push({new_cost, new_index});
+        }
+      }
+    }
+    return *this;
+  }  // update_holonomic
+
+  // holonomic distance from (x, y) to the goal, by subtracting the offsets
+  // between the positions and the centers of their cells from the cost;
+  // infinity if the goal is unreachable, and zero if it is not computed or
+  // (x, y) is out of the grid
+  double holonomic_distance(const double x, const double y) const {
+    if (holonomic_cost_.empty()) return 0.0;
+    int ix = static_cast<int>(
+        std::floor((x - holonomic_origin_x_) / holonomic_resolution_));
+    int iy = static_cast<int>(
+        std::floor((y - holonomic_origin_y_) / holonomic_resolution_));
+    if ((ix < 0) || (ix >= holonomic_size_x_) || (iy < 0) ||
+        (iy >= holonomic_size_y_))
+      return 0.0;
+    return std::fmax(0.0, holonomic_cost_[ix * holonomic_size_y_ + iy] -
+                              M_SQRT2 * holonomic_resolution_);
+  }  // holonomic_distance
+
+  bool use_rs_table() const noexcept { return !rstable_.empty(); }
+  bool use_holonomic() const noexcept { return !holonomic_cost_.empty(); }
+  const ASV::common::math::ReedsSheppStateSpace &rscurve() const noexcept {
+    return rscurve_;
+  }
+
+ private:
+  const double rho_;  // turning radius
+  ASV::common::math::ReedsSheppStateSpace rscurve_;
+  ASV::common::math::ReedsSheppLookupTable rstable_;
+
+  // 2d cost-to-go field, x-major
+  double holonomic_resolution_;
+  double holonomic_origin_x_;
+  double holonomic_origin_y_;
+  int holonomic_size_x_;
+  int holonomic_size_y_;
+  std::vector<float> holonomic_cost_;
+
+  int holonomic_index(const double x, const double y) const {
+    int ix = static_cast<int>(
+        std::floor((x - holonomic_origin_x_) / holonomic_resolution_));
+    int iy = static_cast<int>(
+        std::floor((y - holonomic_origin_y_) / holonomic_resolution_));
+    return ix * holonomic_size_y_ + iy;
+  }  // holonomic_index
+
+};  // end class HybridAStarHeuristic
+
+}  // namespace ASV::planning
+
+#endif /* _HYBRIDASTARHEURISTIC_H_ */
@@ -0,0 +1,152 @@
+/*
+***********************************************************************
+* KDTree2d.h:
+* static 2d k-d tree, stored in one contiguous array. The tree is
+* built once, by sorting the points in place around the median of each
+* subrange, and the nearest/radius queries do not allocate memory.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _KDTREE2D_H_
+#define _KDTREE2D_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ASV::planning {
+
+class KDTree2d {
+ public:
+  using Point = std::array<double, 2>;
+
+  KDTree2d() = default;
+  virtual ~KDTree2d() = default;
+
+  // build the tree over all points. The node of subrange [begin, end) is
+  // its median (begin + end) / 2, split along the axis of larger extent.
+  KDTree2d &build(const std::vector<Point> &_points) {
+    points_ = _points;
+    split_axis_.assign(points_.size(), 0);
+    build_subtree(0, points_.size());
+    return *this;
+  }  // build
+
+  // index of the nearest point to (x, y), and its squared distance.
+  // Return false if the tree is empty
+  bool nearest(const double x, const double y, std::size_t &_index,
+               double &_squared_distance) const {
+    if (points_.empty()) return false;
+    _index = 0;
+    _squared_distance = std::numeric_limits<double>::max();
+    nearest_subtree(0, points_.size(), {x, y}, _index, _squared_distance);
+    return true;
+  }  // nearest
+
+  // call _visitor(const Point &) for each point within the radius
+  // (squared distance <= radius^2), in the order of the array
+  template <typename Visitor>
+  void radius_search(const double x, const double y, const double radius,
+                     Visitor &&_visitor) const {
+    radius_subtree(0, points_.size(), {x, y}, radius, radius * radius,
+                   _visitor);
+  }  // radius_search
+
+  const Point &point(const std::size_t _index) const {
+    return points_[_index];
+  }
+  std::size_t size() const noexcept { return points_.size(); }
+  bool empty() const noexcept { return points_.empty(); }
+
+ private:
+  // points sorted as an implicit balanced tree
+  std::vector<Point> points_;
+  // split axis of the node at each index
+  std::vector<uint8_t> split_axis_;
+
+  static double squared_distance(const Point &_a, const Point &_b) {
+    double dx = _a[0] - _b[0];
+    double dy = _a[1] - _b[1];
+    return dx * dx + dy * dy;
+  }  // squared_distance
+
+  void build_subtree(const std::size_t begin, const std::size_t end) {
+    if (end - begin < 2) return;
+
+    auto [min_x, max_x] = std::minmax_element(
+        points_.begin() + begin, points_.begin() + end,
+        [](const Point &_a, const Point &_b) { return _a[0] < _b[0]; });
+    auto [min_y, max_y] = std::minmax_element(
+        points_.begin() + begin, points_.begin() + end,
+        [](const Point &_a, const Point &_b) { return _a[1] < _b[1]; });
+    uint8_t axis = ((*max_x)[0] - (*min_x)[0] >= (*max_y)[1] - (*min_y)[1])
+                       ? 0
+                       : 1;
+
+    std::size_t mid = begin + (end - begin) / 2;
+    std::nth_element(points_.begin() + begin, points_.begin() + mid,
+                     points_.begin() + end,
+                     [axis](const Point &_a, const Point &_b) {
+                       return _a[axis] < _b[axis];
+                     });
+    split_axis_[mid] = axis;
+    build_subtree(begin, mid);
+    build_subtree(mid + 1, end);
+  }  // build_subtree
+
+  void nearest_subtree(const std::size_t begin, const std::size_t end,
+                       const Point &_query, std::size_t &_index,
+                       double &_squared_distance) const {
+    if (begin == end) return;
+    std::size_t mid = begin + (end - begin) / 2;
+    double _dis = squared_distance(points_[mid], _query);
+    if (_dis < _squared_distance) {
+      _squared_distance = _dis;
+      _index = mid;
+    }
+    if (end - begin == 1) return;
+
+    // search the side of the query first, and the other side only if the
+    // splitting line is closer than the best point so far
+    uint8_t axis = split_axis_[mid];
+    double delta = _query[axis] - points_[mid][axis];
+    if (delta < 0) {
+      nearest_subtree(begin, mid, _query, _index, _squared_distance);
+      if (delta * delta < _squared_distance)
+        nearest_subtree(mid + 1, end, _query, _index, _squared_distance);
+    } else {
+      nearest_subtree(mid + 1, end, _query, _index, _squared_distance);
+      if (delta * delta < _squared_distance)
+        nearest_subtree(begin, mid, _query, _index, _squared_distance);
+    }
+  }  // nearest_subtree
+
+  template <typename Visitor>
+  void radius_subtree(const std::size_t begin, const std::size_t end,
+                      const Point &_query, const double radius,
+                      const double squared_radius, Visitor &_visitor) const {
+    if (begin == end) return;
+    std::size_t mid = begin + (end - begin) / 2;
+    uint8_t axis = split_axis_[mid];
+    double delta = _query[axis] - points_[mid][axis];
+
+    // the points before mid are not larger than mid along the axis, and
+    // the points after mid are not smaller
+    if (delta <= radius)
+      radius_subtree(begin, mid, _query, radius, squared_radius, _visitor);
+    if (squared_distance(points_[mid], _query) <= squared_radius)
+      _visitor(static_cast<const Point &>(points_[mid]));
+    if (delta >= -radius)
+      radius_subtree(mid + 1, end, _query, radius, squared_radius, _visitor);
+  }  // radius_subtree
+
+};  // end class KDTree2d
+
+}  // namespace ASV::planning
+
+#endif /* _KDTREE2D_H_ */
@@ -0,0 +1,231 @@
+/*
+***********************************************************************
+* OccupancyGrid.h:
+* rasterized obstacles (binary occupancy grid) and the Euclidean
+* distance transform over it, used to accelerate the collision checking
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _OCCUPANCYGRID_H_
+#define _OCCUPANCYGRID_H_
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "common/math/Geometry/include/box2d.h"
+
+namespace ASV::planning {
+
+class OccupancyGrid {
+ public:
+  OccupancyGrid()
+      : resolution_(0.0),
+        origin_x_(0.0),
+        origin_y_(0.0),
+        size_x_(0),
+        size_y_(0) {}
+  virtual ~OccupancyGrid() = default;
+
+  // allocate an empty grid which covers the rectangle [min, max]. A
+  // non-positive resolution gives a grid without cells.
+  OccupancyGrid &reset(const double resolution, const double min_x,
+                       const double min_y, const double max_x,
+                       const double max_y) {
+    if (!(resolution > 0)) return *this = OccupancyGrid();
+    resolution_ = resolution;
+    origin_x_ = min_x;
+    origin_y_ = min_y;
+    size_x_ = static_cast<int>(std::ceil((max_x - min_x) / resolution)) + 1;
+    size_y_ = static_cast<int>(std::ceil((max_y - min_y) / resolution)) + 1;
+    occupancy_.assign(size_x_ * size_y_, 0);
+    distance_.assign(size_x_ * size_y_,
+                     std::numeric_limits<float>::infinity());
+    return *this;
+  }  // reset
+
+  // mark the cell which contains the point
+  OccupancyGrid &fill_point(const ASV::common::math::Vec2d &point) {
+    if (empty()) return *this;
+    int ix = index_x(point.x());
+    int iy = index_y(point.y());
+    if (IsInGrid(ix, iy)) occupancy_[ix * size_y_ + iy] = 1;
+    return *this;
+  }  // fill_point
+
+  // mark the cells along the line segment, sampling at half resolution
+  OccupancyGrid &fill_linesegment(
+      const ASV::common::math::LineSegment2d &linesegment) {
+    if (empty()) return *this;
+    auto start = linesegment.start();
+    auto end = linesegment.end();
+    int num_sample =
+        static_cast<int>(std::ceil(linesegment.length() / sample_step())) + 1;
+    for (int i = 0; i != num_sample; ++i) {
+      double ratio = (num_sample == 1) ? 0.0 : i / (num_sample - 1.0);
+      fill_point(start + (end - start) * ratio);
+    }
+    return *this;
+  }  // fill_linesegment
+
+  // mark the cells along the edges of box, and the cells whose centers are
+  // inside the box
+  OccupancyGrid &fill_box(const ASV::common::math::Box2d &box) {
+    if (empty()) return *this;
+    auto corners = box.GetAllCorners();
+    for (std::size_t i = 0; i != corners.size(); ++i)
+      fill_linesegment(ASV::common::math::LineSegment2d(
+          corners[i], corners[(i + 1) % corners.size()]));
+
+    int min_ix = std::max(index_x(box.min_x()), 0);
+    int max_ix = std::min(index_x(box.max_x()), size_x_ - 1);
+    int min_iy = std::max(index_y(box.min_y()), 0);
+    int max_iy = std::min(index_y(box.max_y()), size_y_ - 1);
+    for (int ix = min_ix; ix <= max_ix; ++ix)
+      for (int iy = min_iy; iy <= max_iy; ++iy)
+        if (box.IsPointIn({center_x(ix), center_y(iy)}))
+          occupancy_[ix * size_y_ + iy] = 1;
+    return *this;
+  }  // fill_box
+
+  // compute the distance from the center of each cell to the center of the
+  // nearest occupied cell (Felzenszwalb & Huttenlocher, 2012)
+  OccupancyGrid &update_distance_field() {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    std::size_t max_size = std::max(size_x_, size_y_);
+    std::vector<float> f(max_size, 0.0);
+    std::vector<float> d(max_size, 0.0);
+    std::vector<float> z(max_size + 1, 0.0);
+    std::vector<int> v(max_size, 0);
+
+    // squared distance along y (in # of cells)
+    for (int ix = 0; ix != size_x_; ++ix) {
+      for (int iy = 0; iy != size_y_; ++iy)
+        f[iy] = occupancy_[ix * size_y_ + iy] ? 0.0f : inf;
+      distance_transform_1d(f, d, z, v, size_y_);
+      for (int iy = 0; iy != size_y_; ++iy)
+        distance_[ix * size_y_ + iy] = d[iy];
+    }
+    // squared distance along x
+    for (int iy = 0; iy != size_y_; ++iy) {
+      for (int ix = 0; ix != size_x_; ++ix)
+        f[ix] = distance_[ix * size_y_ + iy];
+      distance_transform_1d(f, d, z, v, size_x_);
+      for (int ix = 0; ix != size_x_; ++ix)
+        distance_[ix * size_y_ + iy] =
+            static_cast<float>(resolution_) * std::sqrt(d[ix]);
+    }
+    return *this;
+  }  // update_distance_field
+
+  // distance field at the cell which contains (x, y); infinity if outside,
+  // or if the grid has no cells (no obstacles)
+  double distance(const double x, const double y) const {
+    if (empty()) return std::numeric_limits<double>::infinity();
+    int ix = index_x(x);
+    int iy = index_y(y);
+    if (!IsInGrid(ix, iy)) return std::numeric_limits<double>::infinity();
+    return distance_[ix * size_y_ + iy];
+  }  // distance
+
+  bool IsOccupied(const int ix, const int iy) const {
+    return IsInGrid(ix, iy) && (occupancy_[ix * size_y_ + iy] != 0);
+  }  // IsOccupied
+
+  bool IsInGrid(const int ix, const int iy) const noexcept {
+    return (ix >= 0) && (ix < size_x_) && (iy >= 0) && (iy < size_y_);
+  }  // IsInGrid
+
+  // conservative bound of |D(p) - distance(p)|, where D(p) is the exact
+  // distance from p to the rasterized obstacles. It comes from the offsets
+  // between p, the obstacle points and the centers of their cells (half
+  // diagonal each), and the gap between samples along the edges.
+  double error_bound() const noexcept {
+    return 1.5 * std::sqrt(2.0) * resolution_ + 0.5 * sample_step();
+  }  // error_bound
+
+  int index_x(const double x) const {
+    return static_cast<int>(std::floor((x - origin_x_) / resolution_));
+  }
+  int index_y(const double y) const {
+    return static_cast<int>(std::floor((y - origin_y_) / resolution_));
+  }
+  double center_x(const int ix) const {
+    return origin_x_ + (ix + 0.5) * resolution_;
+  }
+  double center_y(const int iy) const {
+    return origin_y_ + (iy + 0.5) * resolution_;
+  }
+
+  bool empty() const noexcept { return occupancy_.empty(); }
+  double resolution() const noexcept { return resolution_; }
+  double origin_x() const noexcept { return origin_x_; }
+  double origin_y() const noexcept { return origin_y_; }
+  int size_x() const noexcept { return size_x_; }
+  int size_y() const noexcept { return size_y_; }
+
+ private:
+  double resolution_;  // size of each cell (m)
+  double origin_x_;    // x-coordinate of the lower-left corner (m)
+  double origin_y_;    // y-coordinate of the lower-left corner (m)
+  int size_x_;         // # of cells along x
+  int size_y_;         // # of cells along y
+
+  std::vector<std::uint8_t> occupancy_;  // x-major, index = ix * size_y + iy
+  std::vector<float> distance_;          // distance field (m)
+
+  double sample_step() const noexcept { return 0.5 * resolution_; }
+
+  // 1d squared distance transform of the sampled function f
+  void distance_transform_1d(const std::vector<float> &f, std::vector<float> &d,
+                             std::vector<float> &z, std::vector<int> &v,
+                             const int n) const {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+
+    // find the first finite sample
+    int first = 0;
+    while (first < n && std::isinf(f[first])) ++first;
+    if (first == n) {
+      std::fill(d.begin(), d.begin() + n, inf);
+      return;
+    }
+
+    int k = 0;
+    v[0] = first;
+    z[0] = -inf;
+    z[1] = inf;
+    for (int q = first + 1; q < n; ++q) {
+      if (std::isinf(f[q])) continue;  // no parabola at unoccupied cells
+      float s = intersection(f, q, v[k]);
+      while (s <= z[k]) {
+        --k;
+        s = intersection(f, q, v[k]);
+      }
+      ++k;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = inf;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+      while (z[k + 1] < q) ++k;
+      float dq = static_cast<float>(q - v[k]);
+      d[q] = dq * dq + f[v[k]];
+    }
+  }  // distance_transform_1d
+
+  // intersection of the parabolas rooted at q and p
+  float intersection(const std::vector<float> &f, const int q,
+                     const int p) const {
+    return ((f[q] + q * q) - (f[p] + p * p)) / (2.0f * (q - p));
+  }  // intersection
+
+};  // end class OccupancyGrid
+
+}  // namespace ASV::planning
+
+#endif /* _OCCUPANCYGRID_H_ */
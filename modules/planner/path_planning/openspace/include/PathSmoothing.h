@@ -78,6 +78,9 @@ class PathSmoothing {
   mutable std::vector<std::vector<vec2d>> smooth_path_;
   mutable std::vector<std::array<double, 3>> fine_path_;
 
+  // nearest neighbors of each vertex, reused over the iterations
+  mutable std::vector<std::vector<vec2d>> nearest_obstacles_;
+
   // perform path smoothing on one segment
   std::vector<vec2d> OneSegmentSmoothing(
       const CollisionChecking_Astar &collision_checker,
@@ -86,7 +89,7 @@ class PathSmoothing {
     if (coarse_path.size() >= 3) {  // ensure the size
       auto smooth_path_ing = coarse_path;
       for (int i = 0; i != 1; ++i) {
-        std::vector<std::vector<vec2d>> _nearest_obstacles =
+        const std::vector<std::vector<vec2d>> &_nearest_obstacles =
             GenerateNearestNeighbors(collision_checker, smooth_path_ing, dmax);
 
         // compute the gradient of cost function
@@ -123,21 +126,14 @@ class PathSmoothing {
 
   }  // OneSegmentSmoothing
 
-  // compute the nearest neighbors of each vertex on one segment
-  std::vector<std::vector<vec2d>> GenerateNearestNeighbors(
+  // compute the nearest neighbors of each vertex on one segment, in one
+  // batched query. The neighbors of start/end are not used, since their
+  // gradients are all zero
+  const std::vector<std::vector<vec2d>> &GenerateNearestNeighbors(
       const CollisionChecking_Astar &collision_checker,
       const std::vector<vec2d> &path, const double dmax) const {
-    std::size_t size_coarse_path = path.size();
-    std::vector<std::vector<vec2d>> _nearest_obstacles(size_coarse_path,
-                                                       {{0, 0}});
-    // gradient at start/end and fixed node are all zero
-    for (std::size_t index = 1; index != (size_coarse_path - 1); ++index) {
-      // find the nearest neighbors around the current node
-      auto i_nearest_obstacles = collision_checker.FindNearestNeighbors(
-          path[index].x(), path[index].y(), dmax);
-      _nearest_obstacles[index] = i_nearest_obstacles;
-    }
-    return _nearest_obstacles;
+    collision_checker.FindNearestNeighbors(path, dmax, nearest_obstacles_);
+    return nearest_obstacles_;
   }  // GenerateNearestNeighbors
 
   // compute the gradient of each vertex on one segment
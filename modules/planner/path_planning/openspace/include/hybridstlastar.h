@@ -10,8 +10,17 @@
 #ifndef STLHYBRIDASTAR_H
 #define STLHYBRIDASTAR_H
 
+#include <array>
+#include <cmath>
+#include <unordered_map>
 #include "modules/planner/common/include/stlastar.h"
 
+// Hash index of the open/closed lists can be disabled to compare performance
+// Uses linear search over the lists instead if you turn it off
+#ifndef USE_HASH_INDEX
+#define USE_HASH_INDEX 1
+#endif
+
 namespace ASV::planning {
 
 // The AStar search class. UserState is the users state space type
@@ -43,7 +52,10 @@ class HybridAStarSearch {
     float h;  // heuristic estimate of distance to goal
     float f;  // sum of cumulative cost of predecessors and self and heuristic
 
-    Node() : parent(0), child(0), g(0.0f), h(0.0f), f(0.0f) {}
+    int list_index;  // position in the open heap or in the closed list
+
+    Node()
+        : parent(0), child(0), g(0.0f), h(0.0f), f(0.0f), list_index(-1) {}
 
     UserState m_UserState;
   };
@@ -56,6 +68,23 @@ class HybridAStarSearch {
     bool operator()(const Node *x, const Node *y) const { return x->f > y->f; }
   };
 
+  // discretized (x, y, theta) cell of a state, provided by UserState::IndexKey
+  using IndexKey = std::array<int, 3>;
+
+  class IndexKeyHash {
+   public:
+    std::size_t operator()(const IndexKey &key) const {
+      std::size_t seed = 0;
+      for (const auto &value : key)
+        seed ^=
+            std::hash<int>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      return seed;
+    }
+  };
+
+  using NodeIndex =
+      std::unordered_map<IndexKey, std::vector<Node *>, IndexKeyHash>;
+
  public:  // methods
   // constructor just initialises private data
   HybridAStarSearch()
@@ -108,11 +137,7 @@ class HybridAStarSearch {
     m_Start->parent = 0;
 
     // Push the start node on the Open list
-
-    m_OpenList.push_back(m_Start);  // heap now unsorted
-
-    // Sort back element into heap
-    std::push_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+    PushOpenList(m_Start);
 
     // Initialise counter for search steps
     m_Steps = 0;
@@ -148,9 +173,7 @@ class HybridAStarSearch {
     m_Steps++;
 
     // Pop the best node (the one with the lowest f)
-    Node *n = m_OpenList.front();  // get pointer to the node
-    std::pop_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
-    m_OpenList.pop_back();
+    Node *n = PopOpenList();
 
     m_CurrentNode = n;
 
@@ -231,22 +254,12 @@ class HybridAStarSearch {
         // If it is but the node that is already on them is better (lower g)
         // then we can forget about this successor
 
-        // First linear search of open list to find node
-
-        typename std::vector<Node *>::iterator openlist_result;
-
-        for (openlist_result = m_OpenList.begin();
-             openlist_result != m_OpenList.end(); openlist_result++) {
-          if ((*openlist_result)
-                  ->m_UserState.IsSameState((*successor)->m_UserState)) {
-            break;
-          }
-        }
+        Node *openlist_result = FindOnOpenList((*successor)->m_UserState);
 
-        if (openlist_result != m_OpenList.end()) {
+        if (openlist_result) {
           // we found this state on open
 
-          if ((*openlist_result)->g <= newg) {
+          if (openlist_result->g <= newg) {
             FreeNode((*successor));
 
             // the one on Open is cheaper than this one
@@ -254,20 +267,12 @@ class HybridAStarSearch {
           }
         }
 
-        typename std::vector<Node *>::iterator closedlist_result;
+        Node *closedlist_result = FindOnClosedList((*successor)->m_UserState);
 
-        for (closedlist_result = m_ClosedList.begin();
-             closedlist_result != m_ClosedList.end(); closedlist_result++) {
-          if ((*closedlist_result)
-                  ->m_UserState.IsSameState((*successor)->m_UserState)) {
-            break;
-          }
-        }
-
-        if (closedlist_result != m_ClosedList.end()) {
+        if (closedlist_result) {
           // we found this state on closed
 
-          if ((*closedlist_result)->g <= newg) {
+          if (closedlist_result->g <= newg) {
             // the one on Closed is cheaper than this one
             FreeNode((*successor));
 
@@ -290,25 +295,21 @@ class HybridAStarSearch {
         // 2 - Move it from closed to open list
         // 3 - Sort heap again in open list
 
-        if (closedlist_result != m_ClosedList.end()) {
+        if (closedlist_result) {
           // Update closed node with successor node AStar data
-          //*(*closedlist_result) = *(*successor);
-          (*closedlist_result)->parent = (*successor)->parent;
-          (*closedlist_result)->g = (*successor)->g;
-          (*closedlist_result)->h = (*successor)->h;
-          (*closedlist_result)->f = (*successor)->f;
+          closedlist_result->parent = (*successor)->parent;
+          closedlist_result->g = (*successor)->g;
+          closedlist_result->h = (*successor)->h;
+          closedlist_result->f = (*successor)->f;
 
           // Free successor node
           FreeNode((*successor));
 
-          // Push closed node into open list
-          m_OpenList.push_back((*closedlist_result));
-
           // Remove closed node from closed list
-          m_ClosedList.erase(closedlist_result);
+          RemoveFromClosedList(closedlist_result);
 
-          // Sort back element into heap
-          std::push_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+          // Push closed node into open list
+          PushOpenList(closedlist_result);
 
           // Fix thanks to ...
           // Greg Douglas <gregdouglasmail@gmail.com>
@@ -321,22 +322,18 @@ class HybridAStarSearch {
         // 1 - Update old version of this node in open list
         // 2 - sort heap again in open list
 
-        else if (openlist_result != m_OpenList.end()) {
+        else if (openlist_result) {
           // Update open node with successor node AStar data
-          //*(*openlist_result) = *(*successor);
-          (*openlist_result)->parent = (*successor)->parent;
-          (*openlist_result)->g = (*successor)->g;
-          (*openlist_result)->h = (*successor)->h;
-          (*openlist_result)->f = (*successor)->f;
+          openlist_result->parent = (*successor)->parent;
+          openlist_result->g = (*successor)->g;
+          openlist_result->h = (*successor)->h;
+          openlist_result->f = (*successor)->f;
 
           // Free successor node
           FreeNode((*successor));
 
-          // re-make the heap
-          // make_heap rather than sort_heap is an essential bug fix
-          // thanks to Mike Ryynanen for pointing this out and then explaining
-          // it in detail. sort_heap called on an invalid heap does not work
-          std::make_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+          // re-sort the heap
+          UpdateOpenList(openlist_result);
         }
 
         // New successor
@@ -345,16 +342,12 @@ class HybridAStarSearch {
 
         else {
           // Push successor node into open list
-          m_OpenList.push_back((*successor));
-
-          // Sort back element into heap
-          std::push_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+          PushOpenList((*successor));
         }
       }
 
       // push n onto Closed, as we have expanded it now
-
-      m_ClosedList.push_back(n);
+      PushClosedList(n);
 
     }  // end else (not goal so expand)
 
@@ -478,6 +471,11 @@ class HybridAStarSearch {
     return NULL;
   }  // GetCurrentNodePrev
 
+  // heuristic of the current node; FLT_MAX if there is no current node
+  float GetCurrentNodeHeuristic() const {
+    return m_CurrentNode ? m_CurrentNode->h : FLT_MAX;
+  }
+
   // Get final cost of solution
   // Returns FLT_MAX if goal is not defined or there is no solution
   float GetSolutionCost() {
@@ -598,6 +596,7 @@ class HybridAStarSearch {
     }
 
     m_ClosedList.clear();
+    ClearIndex();
 
     // delete the goal
 
@@ -639,8 +638,181 @@ class HybridAStarSearch {
     }
 
     m_ClosedList.clear();
+    ClearIndex();
+  }
+
+  // Open/closed list management
+  // With USE_HASH_INDEX, the open list is an indexed binary heap (each node
+  // knows its position, so that decrease-key is O(log N)), and both lists are
+  // indexed by the discretized (x, y, theta) cell of the user state. As the
+  // cell size is not smaller than the tolerance of IsSameState, a state which
+  // is the same as the query can only lie in one of the adjacent cells.
+
+  Node *FindOnOpenList(UserState &State) {
+#if USE_HASH_INDEX
+    return FindInIndex(m_OpenIndex, State);
+#else
+    for (auto &node : m_OpenList) {
+      if (node->m_UserState.IsSameState(State)) return node;
+    }
+    return NULL;
+#endif
+  }
+
+  Node *FindOnClosedList(UserState &State) {
+#if USE_HASH_INDEX
+    return FindInIndex(m_ClosedIndex, State);
+#else
+    for (auto &node : m_ClosedList) {
+      if (node->m_UserState.IsSameState(State)) return node;
+    }
+    return NULL;
+#endif
+  }
+
+  void PushOpenList(Node *node) {
+    m_OpenList.push_back(node);
+#if USE_HASH_INDEX
+    node->list_index = static_cast<int>(m_OpenList.size()) - 1;
+    HeapSiftUp(node->list_index);
+    InsertIndex(m_OpenIndex, node);
+#else
+    std::push_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+#endif
   }
 
+  Node *PopOpenList() {
+    Node *node = m_OpenList.front();
+#if USE_HASH_INDEX
+    HeapSwap(0, m_OpenList.size() - 1);
+    m_OpenList.pop_back();
+    if (!m_OpenList.empty()) HeapSiftDown(0);
+    EraseIndex(m_OpenIndex, node);
+    node->list_index = -1;
+#else
+    std::pop_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+    m_OpenList.pop_back();
+#endif
+    return node;
+  }
+
+  // re-sort the heap after the f value of node (on open) has been changed
+  void UpdateOpenList(Node *node) {
+#if USE_HASH_INDEX
+    HeapSiftDown(HeapSiftUp(node->list_index));
+#else
+    // make_heap rather than sort_heap is an essential bug fix
+    // thanks to Mike Ryynanen for pointing this out and then explaining
+    // it in detail. sort_heap called on an invalid heap does not work
+    (void)node;
+    std::make_heap(m_OpenList.begin(), m_OpenList.end(), HeapCompare_f());
+#endif
+  }
+
+  void PushClosedList(Node *node) {
+    m_ClosedList.push_back(node);
+#if USE_HASH_INDEX
+    node->list_index = static_cast<int>(m_ClosedList.size()) - 1;
+    InsertIndex(m_ClosedIndex, node);
+#endif
+  }
+
+  void RemoveFromClosedList(Node *node) {
+#if USE_HASH_INDEX
+    // swap with the last one, the order of closed list is not relevant
+    std::size_t index = node->list_index;
+    m_ClosedList[index] = m_ClosedList.back();
+    m_ClosedList[index]->list_index = static_cast<int>(index);
+    m_ClosedList.pop_back();
+    EraseIndex(m_ClosedIndex, node);
+    node->list_index = -1;
+#else
+    m_ClosedList.erase(
+        std::find(m_ClosedList.begin(), m_ClosedList.end(), node));
+#endif
+  }
+
+  void ClearIndex() {
+#if USE_HASH_INDEX
+    m_OpenIndex.clear();
+    m_ClosedIndex.clear();
+#endif
+  }
+
+#if USE_HASH_INDEX
+  Node *FindInIndex(NodeIndex &index, UserState &State) {
+    // heading is periodic, its cells wrap around
+    constexpr int num_theta = UserState::num_index_theta;
+    constexpr int theta_range = (num_theta > 2) ? 1 : 0;
+
+    IndexKey key = State.IndexKey();
+    for (int i = -1; i != 2; ++i) {
+      for (int j = -1; j != 2; ++j) {
+        for (int k = -theta_range; k != theta_range + 1; ++k) {
+          auto cell = index.find({key[0] + i, key[1] + j,
+                                  ((key[2] + k) % num_theta + num_theta) %
+                                      num_theta});
+          if (cell == index.end()) continue;
+          for (auto &node : cell->second) {
+            if (node->m_UserState.IsSameState(State)) return node;
+          }
+        }
+      }
+    }
+    return NULL;
+  }
+
+  void InsertIndex(NodeIndex &index, Node *node) {
+    index[node->m_UserState.IndexKey()].push_back(node);
+  }
+
+  void EraseIndex(NodeIndex &index, Node *node) {
+    auto cell = index.find(node->m_UserState.IndexKey());
+    if (cell == index.end()) return;
+    auto &nodes = cell->second;
+    auto it = std::find(nodes.begin(), nodes.end(), node);
+    if (it != nodes.end()) {
+      *it = nodes.back();
+      nodes.pop_back();
+    }
+    if (nodes.empty()) index.erase(cell);
+  }
+
+  void HeapSwap(std::size_t i, std::size_t j) {
+    std::swap(m_OpenList[i], m_OpenList[j]);
+    m_OpenList[i]->list_index = static_cast<int>(i);
+    m_OpenList[j]->list_index = static_cast<int>(j);
+  }
+
+  // the node with lowest f is at the front
+  std::size_t HeapSiftUp(std::size_t index) {
+    while (index > 0) {
+      std::size_t parent = (index - 1) / 2;
+      if (!(m_OpenList[index]->f < m_OpenList[parent]->f)) break;
+      HeapSwap(index, parent);
+      index = parent;
+    }
+    return index;
+  }
+
+  std::size_t HeapSiftDown(std::size_t index) {
+    std::size_t num = m_OpenList.size();
+    while (true) {
+      std::size_t smallest = index;
+      std::size_t left = 2 * index + 1;
+      std::size_t right = left + 1;
+      if (left < num && m_OpenList[left]->f < m_OpenList[smallest]->f)
+        smallest = left;
+      if (right < num && m_OpenList[right]->f < m_OpenList[smallest]->f)
+        smallest = right;
+      if (smallest == index) break;
+      HeapSwap(index, smallest);
+      index = smallest;
+    }
+    return index;
+  }
+#endif
+
   // Node memory management
   Node *AllocateNode() {
 #if !USE_FSA_MEMORY
@@ -678,6 +850,12 @@ class HybridAStarSearch {
   // Closed list is a vector.
   std::vector<Node *> m_ClosedList;
 
+#if USE_HASH_INDEX
+  // Hash index of the open and closed lists
+  NodeIndex m_OpenIndex;
+  NodeIndex m_ClosedIndex;
+#endif
+
   // Successors is a vector filled out by the user each type successors to a
   // node are generated
   std::vector<Node *> m_Successors;
@@ -738,6 +916,12 @@ class HybridAStarState {
 
   // Returns true if this node is the same as the rhs node
   virtual bool IsSameState(const UserState &rhs) = 0;
+
+  // Returns the discretized (x, y, theta) cell of this node, used by the hash
+  // index of the open/closed lists. The cell size must not be smaller than
+  // the tolerance of IsSameState. UserState should also define
+  // "static constexpr int num_index_theta", the number of heading cells
+  virtual std::array<int, 3> IndexKey() const = 0;
 };
 
 }  // namespace ASV::planning
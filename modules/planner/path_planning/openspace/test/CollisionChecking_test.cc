@@ -103,4 +103,47 @@ int main() {
 
   for (const auto &nn_result : nn_results)
     std::cout << nn_result.x() << " " << nn_result.y() << std::endl;
+
+  // compare with the collision checking using the distance field
+  planning::CollisionChecking<> _CollisionChecking_grid(_collisiondata, 0.1);
+  _CollisionChecking_grid.set_all_obstacls(Obstacles_Vertex, Obstacles_lS,
+                                           Obstacles_Box);
+  et = _timer.timeelapsed();
+  std::cout << "elapsed time of distance field: " << et << std::endl;
+
+  std::vector<std::array<double, 3>> poses;
+  for (double px = -15; px < 20; px += 0.13)
+    for (double py = -5; py < 20; py += 0.13)
+      for (double ptheta = -M_PI; ptheta < M_PI; ptheta += 0.7)
+        poses.push_back({px, py, ptheta});
+
+  std::vector<bool> exact_results(poses.size(), false);
+  _timer.timeelapsed();
+  for (std::size_t i = 0; i != poses.size(); ++i)
+    exact_results[i] = _CollisionChecking.InCollision(
+        poses[i].at(0), poses[i].at(1), poses[i].at(2));
+  et = _timer.timeelapsed();
+  std::cout << "elapsed time of " << poses.size()
+            << " exact collision checking: " << et << std::endl;
+
+  std::size_t num_mismatch = 0;
+  for (std::size_t i = 0; i != poses.size(); ++i)
+    if (_CollisionChecking_grid.InCollision(poses[i].at(0), poses[i].at(1),
+                                            poses[i].at(2)) != exact_results[i])
+      ++num_mismatch;
+  et = _timer.timeelapsed();
+  std::cout << "elapsed time of " << poses.size()
+            << " collision checking with distance field: " << et << std::endl;
+  std::cout << "# of mismatch: " << num_mismatch << std::endl;
+
+  // the distance field without any obstacle
+  planning::CollisionChecking<> _CollisionChecking_empty(_collisiondata, 0.1);
+  _CollisionChecking_empty.set_all_obstacls({}, {}, {});
+  std::size_t num_collision_empty = 0;
+  for (const auto &pose : poses)
+    if (_CollisionChecking_empty.InCollision(pose.at(0), pose.at(1),
+                                             pose.at(2)))
+      ++num_collision_empty;
+  std::cout << "# of collision without obstacles: " << num_collision_empty
+            << std::endl;
 }
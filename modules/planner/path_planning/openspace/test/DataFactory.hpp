@@ -1020,6 +1020,34 @@ void generate_obstacle_map(
       // end point
       end_point = {18, 5, 0.0 * M_PI};
 
+      break;
+    case 11:
+      // dead-end pocket: U-shaped pier opening towards the start point, and
+      // the end point is behind the pier
+      Obstacles_LS.push_back({
+          10,  // start_x
+          -6,  // start_y
+          20,  // end_x
+          -6   // end_y
+      });
+      Obstacles_LS.push_back({
+          20,  // start_x
+          -6,  // start_y
+          20,  // end_x
+          6    // end_y
+      });
+      Obstacles_LS.push_back({
+          20,  // start_x
+          6,   // start_y
+          10,  // end_x
+          6    // end_y
+      });
+      // start point
+      start_point = {0, 0, 0.0 * M_PI};
+
+      // end point
+      end_point = {28, 0, 0.0 * M_PI};
+
       break;
     default:
       break;
@@ -0,0 +1,166 @@
+/*
+*******************************************************************************
+* HybridAstar_benchmark.cc:
+* benchmark of the node expansion in hybrid A* search, using the scenarios
+* in DataFactory.hpp. Build with USE_HASH_INDEX=0 to compare with the linear
+* search over the open/closed lists.
+* usage: HybridAstar_benchmark [rs_table_file|-] [holonomic_resolution]
+*                              [shot_interval] [shot_distance] [max_steps]
+*   rs_table_file: use (and cache) the lookup table of RS distance
+*   holonomic_resolution: use the 2d cost-to-go field in the heuristic
+*   shot_interval, shot_distance: schedule of the RS shots in
+*     HybridAStar::perform_4dnode_search
+*   max_steps: step budget of the node expansion, 4000 by default (the
+*     whole 4d search is limited by the node pool of HybridAStar)
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include "../include/HybridAStar.h"
+#include "DataFactory.hpp"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+int main(int argc, char *argv[]) {
+  using HybridAStar_4dNode_Search =
+      planning::HybridAStarSearch<planning::HybridState4DNode,
+                                  planning::SearchConfig,
+                                  planning::CollisionChecking_Astar,
+                                  planning::HybridAStarHeuristic>;
+
+  int max_steps = (argc > 5) ? std::atoi(argv[5]) : 4000;
+  int max_nodes = 8 * max_steps;  // each expansion adds up to 6 nodes
+
+  planning::HybridAStarConfig _HybridAStarConfig{
+      1.05,  // move_length
+      1.3,   // penalty_turning
+      1.5,   // penalty_reverse
+      2      // penalty_switch
+  };
+
+  planning::SearchConfig searchconfig =
+      planning::HybridAStar::GenerateSearchConfig(planning::_collisiondata,
+                                                  _HybridAStarConfig);
+
+  planning::HybridAStarHeuristic heuristic(
+      1.0 / planning::_collisiondata.MAX_CURVATURE);
+  if ((argc > 1) && (std::string(argv[1]) != "-")) {
+    common::timecounter _timer;
+    heuristic.load_rs_table(argv[1]);
+    std::cout << "load RS table: " << _timer.timeelapsed() << " ms\n";
+  }
+  // the 2d cost-to-go field requires the occupancy grid
+  double holonomic_resolution = (argc > 2) ? std::atof(argv[2]) : 0.0;
+  double grid_resolution = (holonomic_resolution > 0) ? 0.1 : 0.0;
+
+  std::cout << "USE_HASH_INDEX: " << USE_HASH_INDEX << "\n";
+  std::cout << "RS table: " << heuristic.use_rs_table() << "\n";
+  std::cout << "holonomic resolution: " << holonomic_resolution << "\n";
+  std::cout << "max steps: " << max_steps << "\n";
+  std::cout << "scenario, steps, state, time(ms), expansions/s\n";
+
+  long long total_time = 0;
+  long long total_steps = 0;
+  for (int scenario = -1; scenario != 12; ++scenario) {
+    std::vector<planning::Obstacle_Vertex_Config> Obstacles_Vertex;
+    std::vector<planning::Obstacle_LineSegment_Config> Obstacles_LS;
+    std::vector<planning::Obstacle_Box2d_Config> Obstacles_Box;
+    std::array<double, 3> start_point;
+    std::array<double, 3> end_point;
+    planning::generate_obstacle_map(Obstacles_Vertex, Obstacles_LS,
+                                    Obstacles_Box, start_point, end_point,
+                                    scenario);
+
+    planning::CollisionChecking_Astar collision_checker(
+        planning::_collisiondata, grid_resolution);
+    collision_checker.set_all_obstacls(Obstacles_Vertex, Obstacles_LS,
+                                       Obstacles_Box);
+
+    HybridAStar_4dNode_Search astar_4d_search(max_nodes);
+    planning::HybridState4DNode nodeStart(start_point[0], start_point[1],
+                                          start_point[2]);
+    planning::HybridState4DNode nodeEnd(end_point[0], end_point[1],
+                                        end_point[2]);
+
+    common::timecounter _timer;
+    heuristic.update_holonomic(collision_checker.occupancy_grid(),
+                               collision_checker.ego_inscribed_radius(),
+                               start_point, end_point, holonomic_resolution);
+    astar_4d_search.SetStartAndGoalStates(nodeStart, nodeEnd, heuristic);
+    unsigned int SearchState;
+    do {
+      SearchState = astar_4d_search.SearchStep(searchconfig,
+                                               collision_checker, heuristic);
+    } while ((SearchState ==
+              HybridAStar_4dNode_Search::SEARCH_STATE_SEARCHING) &&
+             (astar_4d_search.GetStepCount() < max_steps));
+    long long elapsed_us = _timer.micro_timeelapsed();
+
+    // release the nodes
+    if (SearchState == HybridAStar_4dNode_Search::SEARCH_STATE_SUCCEEDED) {
+      astar_4d_search.FreeSolutionNodes();
+    } else if (SearchState ==
+               HybridAStar_4dNode_Search::SEARCH_STATE_SEARCHING) {
+      astar_4d_search.CancelSearch();
+      astar_4d_search.SearchStep(searchconfig, collision_checker, heuristic);
+    }
+
+    int steps = astar_4d_search.GetStepCount();
+    total_time += elapsed_us;
+    total_steps += steps;
+    std::cout << scenario << ", " << steps << ", " << SearchState << ", "
+              << 1e-3 * elapsed_us << ", "
+              << 1e6 * steps / std::max(elapsed_us, 1LL) << "\n";
+  }
+
+  std::cout << "total, " << total_steps << ", -, " << 1e-3 * total_time
+            << ", " << 1e6 * total_steps / std::max(total_time, 1LL) << "\n";
+
+  // the whole 4d search with the RS shots
+  int shot_interval = (argc > 3) ? std::atoi(argv[3]) : 1;
+  double shot_distance = (argc > 4) ? std::atof(argv[4]) : 0.0;
+  std::vector<std::string> shot_results;
+  for (int scenario = -1; scenario != 12; ++scenario) {
+    std::vector<planning::Obstacle_Vertex_Config> Obstacles_Vertex;
+    std::vector<planning::Obstacle_LineSegment_Config> Obstacles_LS;
+    std::vector<planning::Obstacle_Box2d_Config> Obstacles_Box;
+    std::array<double, 3> start_point;
+    std::array<double, 3> end_point;
+    planning::generate_obstacle_map(Obstacles_Vertex, Obstacles_LS,
+                                    Obstacles_Box, start_point, end_point,
+                                    scenario);
+
+    planning::CollisionChecking_Astar collision_checker(
+        planning::_collisiondata, grid_resolution);
+    collision_checker.set_all_obstacls(Obstacles_Vertex, Obstacles_LS,
+                                       Obstacles_Box);
+
+    planning::HybridAStar hybridastar(planning::_collisiondata,
+                                      _HybridAStarConfig);
+    if ((argc > 1) && (std::string(argv[1]) != "-"))
+      hybridastar.load_rs_table(argv[1]);
+    hybridastar.enable_holonomic_heuristic(holonomic_resolution)
+        .set_analytic_expansion(shot_interval, shot_distance)
+        .setup_start_end(start_point[0], start_point[1], start_point[2],
+                         end_point[0], end_point[1], end_point[2]);
+
+    common::timecounter _timer;
+    hybridastar.perform_4dnode_search(collision_checker);
+    long long elapsed_us = _timer.micro_timeelapsed();
+
+    shot_results.push_back(std::to_string(scenario) + ", " +
+                           std::to_string(hybridastar.num_shots_attempted()) +
+                           ", " +
+                           std::to_string(hybridastar.num_shots_succeeded()) +
+                           ", " + std::to_string(1e-3 * elapsed_us));
+  }
+
+  std::cout << "shot interval: " << shot_interval
+            << ", shot distance: " << shot_distance << "\n";
+  std::cout << "scenario, shots attempted, shots succeeded, time(ms)\n";
+  for (const auto &result : shot_results) std::cout << result << "\n";
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/*
+*******************************************************************************
+* KDTree_benchmark.cc:
+* benchmark of the static 2d k-d tree used in collision checking, compared
+* with the kdtree of pyclustering (a new searcher for each query). The
+* nearest and radius queries of the two trees are checked to be the same.
+* usage: KDTree_benchmark [num_iterations]
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <pyclustering/container/kdtree.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "../include/KDTree2d.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+int main(int argc, char *argv[]) {
+  int num_iterations = (argc > 1) ? std::atoi(argv[1]) : 20;
+  constexpr std::size_t num_vertex = 200;  // # of vertex on a path
+  constexpr double radius_search = 5.0;    // dmax in path smoothing
+  constexpr double nearest_radius = 10.0;  // used by FindNearstObstacle
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+
+  std::cout << "obstacles, build(us): pyclustering | flat, radius query(us): "
+               "pyclustering | flat | flat batched, nearest query(us): "
+               "pyclustering | flat, errors\n";
+  for (std::size_t num_points : {100, 1000, 10000}) {
+    std::vector<std::vector<double>> points_pyclustering(num_points);
+    std::vector<planning::KDTree2d::Point> points(num_points);
+    for (std::size_t i = 0; i != num_points; ++i) {
+      double x = distribution(generator);
+      double y = distribution(generator);
+      points_pyclustering[i] = {x, y};
+      points[i] = {x, y};
+    }
+    std::vector<planning::KDTree2d::Point> path(num_vertex);
+    for (std::size_t i = 0; i != num_vertex; ++i)
+      path[i] = {-100.0 + i, 0.5 * distribution(generator)};
+
+    // build
+    common::timecounter _timer;
+    pyclustering::container::kdtree tree_pyclustering;
+    for (auto &point : points_pyclustering) tree_pyclustering.insert(point);
+    long long build_pyclustering_us = _timer.micro_timeelapsed();
+    planning::KDTree2d tree;
+    tree.build(points);
+    long long build_us = _timer.micro_timeelapsed();
+
+    // radius query of each vertex
+    long long radius_pyclustering_us = 0;
+    long long radius_us = 0;
+    long long radius_batched_us = 0;
+    std::size_t num_errors = 0;
+    std::vector<std::vector<planning::KDTree2d::Point>> neighbors(num_vertex);
+    for (int iteration = 0; iteration != num_iterations; ++iteration) {
+      std::vector<std::vector<planning::KDTree2d::Point>>
+          neighbors_pyclustering(num_vertex);
+      _timer.micro_timeelapsed();
+      for (std::size_t i = 0; i != num_vertex; ++i) {
+        pyclustering::container::kdtree_searcher searcher(
+            {path[i][0], path[i][1]}, tree_pyclustering.get_root(),
+            radius_search);
+        std::vector<double> nearest_distances;
+        std::vector<pyclustering::container::kdnode::ptr> nearest_nodes;
+        searcher.find_nearest_nodes(nearest_distances, nearest_nodes);
+        for (const auto &node : nearest_nodes)
+          neighbors_pyclustering[i].push_back(
+              {node->get_data()[0], node->get_data()[1]});
+      }
+      radius_pyclustering_us += _timer.micro_timeelapsed();
+
+      for (std::size_t i = 0; i != num_vertex; ++i) {
+        std::vector<planning::KDTree2d::Point> neighbors_one;
+        tree.radius_search(path[i][0], path[i][1], radius_search,
+                           [&neighbors_one](const auto &_point) {
+                             neighbors_one.push_back(_point);
+                           });
+      }
+      radius_us += _timer.micro_timeelapsed();
+
+      // reuse the buffers, as CollisionChecking::FindNearestNeighbors
+      for (std::size_t i = 0; i != num_vertex; ++i) {
+        neighbors[i].clear();
+        tree.radius_search(path[i][0], path[i][1], radius_search,
+                           [&neighbors, i](const auto &_point) {
+                             neighbors[i].push_back(_point);
+                           });
+      }
+      radius_batched_us += _timer.micro_timeelapsed();
+
+      for (std::size_t i = 0; i != num_vertex; ++i) {
+        std::sort(neighbors_pyclustering[i].begin(),
+                  neighbors_pyclustering[i].end());
+        auto sorted_neighbors = neighbors[i];
+        std::sort(sorted_neighbors.begin(), sorted_neighbors.end());
+        if (sorted_neighbors != neighbors_pyclustering[i]) ++num_errors;
+      }
+    }
+
+    // nearest query of each vertex
+    long long nearest_pyclustering_us = 0;
+    long long nearest_us = 0;
+    for (int iteration = 0; iteration != num_iterations; ++iteration) {
+      std::vector<double> distance_pyclustering(num_vertex);
+      std::vector<double> distance(num_vertex);
+      _timer.micro_timeelapsed();
+      for (std::size_t i = 0; i != num_vertex; ++i) {
+        pyclustering::container::kdtree_searcher searcher(
+            {path[i][0], path[i][1]}, tree_pyclustering.get_root(),
+            nearest_radius);
+        auto nearest_point = searcher.find_nearest_node()->get_data();
+        distance_pyclustering[i] = std::pow(path[i][0] - nearest_point[0], 2) +
+                                   std::pow(path[i][1] - nearest_point[1], 2);
+      }
+      nearest_pyclustering_us += _timer.micro_timeelapsed();
+
+      for (std::size_t i = 0; i != num_vertex; ++i) {
+        std::size_t index = 0;
+        tree.nearest(path[i][0], path[i][1], index, distance[i]);
+      }
+      nearest_us += _timer.micro_timeelapsed();
+
+      // the search of pyclustering is exact within its radius only; the
+      // squared distances are summed in a different order, so they are
+      // compared with a relative tolerance
+      for (std::size_t i = 0; i != num_vertex; ++i)
+        if ((distance_pyclustering[i] <= nearest_radius * nearest_radius) &&
+            (std::fabs(distance_pyclustering[i] - distance[i]) >
+             1e-9 * std::max(distance_pyclustering[i], distance[i])))
+          ++num_errors;
+    }
+
+    std::cout << num_points << ", " << build_pyclustering_us << " | "
+              << build_us << ", " << radius_pyclustering_us / num_iterations
+              << " | " << radius_us / num_iterations << " | "
+              << radius_batched_us / num_iterations << ", "
+              << nearest_pyclustering_us / num_iterations << " | "
+              << nearest_us / num_iterations << ", " << num_errors << "\n";
+    if (num_errors > 0) return 1;
+  }
+
+  return 0;
+}
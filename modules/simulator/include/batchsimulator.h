@@ -0,0 +1,222 @@
+/*
+***********************************************************************
+* batchsimulator.h:
+* 3DoF motion simulator for many USVs at once, used to tune controller
+* and planner over Monte-Carlo scenarios. The states are stored as
+* structure of arrays, and the vessels in a chunk are advanced by one
+* RK4 step in loops which the compiler can vectorize. Each thread runs
+* its own chunk of vessels through the whole scenario.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _BATCHSIMULATOR_H_
+#define _BATCHSIMULATOR_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "common/math/miscellaneous/include/math_utils.h"
+#include "simulatordata.h"
+
+namespace ASV::simulation {
+
+// command of one vessel at one step, given by the closed-loop policy
+struct scenariocommand {
+  double desired_heading;    // rad, the same as simulator_onestep
+  Eigen::Vector3d thrust;    // body-fixed thrust (N, N, N*m)
+  Eigen::Vector3d seaload;   // body-fixed disturbance
+  Eigen::Vector3d setpoint;  // desired x, y, heading for the metrics
+};
+
+// aggregate metrics of one scenario
+struct scenariometrics {
+  double rms_position_error;  // m
+  double max_position_error;  // m
+  double rms_heading_error;   // rad
+  double energy;              // J, integral of |thrust * velocity|
+};
+
+class batchsimulator {
+  using state_type = Eigen::Matrix<double, 6, 1>;
+
+ public:
+  batchsimulator(double _sample_time, const common::vessel &_vessel,
+                 std::size_t _num_vessels)
+      : sample_time(_sample_time),
+        num_vessels(_num_vessels),
+        M_inv((_vessel.AddedMass + _vessel.Mass).inverse()),
+        K(-M_inv * _vessel.LinearDamping),
+        desired_heading(_num_vessels, 0.0) {
+    for (auto &_x : X) _x.assign(_num_vessels, 0.0);
+    for (auto &_f : force) _f.assign(_num_vessels, 0.0);
+    cos_theta.assign(_num_vessels, 1.0);
+    sin_theta.assign(_num_vessels, 0.0);
+  }
+  virtual ~batchsimulator() = default;
+
+  // assign the input of vessel i for the next step
+  void setinput(std::size_t i, double _desired_heading,
+                const Eigen::Vector3d &_thrust,
+                const Eigen::Vector3d &_seaload = Eigen::Vector3d::Zero()) {
+    desired_heading[i] = _desired_heading;
+    Eigen::Vector3d f = M_inv * (_thrust + _seaload);
+    for (int j = 0; j != 3; ++j) force[j][i] = f(j);
+  }  // setinput
+
+  // advance the vessels in [_begin, _end) by one sample time
+  void onestep(std::size_t _begin, std::size_t _end) {
+    updaterotation(_begin, _end);
+
+    const double h = sample_time;
+    const double k00 = K(0, 0), k01 = K(0, 1), k02 = K(0, 2);
+    const double k10 = K(1, 0), k11 = K(1, 1), k12 = K(1, 2);
+    const double k20 = K(2, 0), k21 = K(2, 1), k22 = K(2, 2);
+    double *x = X[0].data(), *y = X[1].data(), *psi = X[2].data();
+    double *u = X[3].data(), *v = X[4].data(), *r = X[5].data();
+    const double *fu = force[0].data(), *fv = force[1].data();
+    const double *fr = force[2].data();
+    const double *c = cos_theta.data(), *s = sin_theta.data();
+
+    // RK4 of the linear system with the rotation fixed in one step
+    for (std::size_t i = _begin; i < _end; ++i) {
+      double u0 = u[i], v0 = v[i], r0 = r[i];
+      double du1 = k00 * u0 + k01 * v0 + k02 * r0 + fu[i];
+      double dv1 = k10 * u0 + k11 * v0 + k12 * r0 + fv[i];
+      double dr1 = k20 * u0 + k21 * v0 + k22 * r0 + fr[i];
+      double u1 = u0 + 0.5 * h * du1;
+      double v1 = v0 + 0.5 * h * dv1;
+      double r1 = r0 + 0.5 * h * dr1;
+      double du2 = k00 * u1 + k01 * v1 + k02 * r1 + fu[i];
+      double dv2 = k10 * u1 + k11 * v1 + k12 * r1 + fv[i];
+      double dr2 = k20 * u1 + k21 * v1 + k22 * r1 + fr[i];
+      double u2 = u0 + 0.5 * h * du2;
+      double v2 = v0 + 0.5 * h * dv2;
+      double r2 = r0 + 0.5 * h * dr2;
+      double du3 = k00 * u2 + k01 * v2 + k02 * r2 + fu[i];
+      double dv3 = k10 * u2 + k11 * v2 + k12 * r2 + fv[i];
+      double dr3 = k20 * u2 + k21 * v2 + k22 * r2 + fr[i];
+      double u3 = u0 + h * du3;
+      double v3 = v0 + h * dv3;
+      double r3 = r0 + h * dr3;
+      double du4 = k00 * u3 + k01 * v3 + k02 * r3 + fu[i];
+      double dv4 = k10 * u3 + k11 * v3 + k12 * r3 + fv[i];
+      double dr4 = k20 * u3 + k21 * v3 + k22 * r3 + fr[i];
+
+      // weighted velocity in body-fixed frame
+      double su = u0 + 2 * u1 + 2 * u2 + u3;
+      double sv = v0 + 2 * v1 + 2 * v2 + v3;
+      double sr = r0 + 2 * r1 + 2 * r2 + r3;
+      x[i] += h / 6 * (c[i] * su - s[i] * sv);
+      y[i] += h / 6 * (s[i] * su + c[i] * sv);
+      psi[i] += h / 6 * sr;
+      u[i] = u0 + h / 6 * (du1 + 2 * du2 + 2 * du3 + du4);
+      v[i] = v0 + h / 6 * (dv1 + 2 * dv2 + 2 * dv3 + dv4);
+      r[i] = r0 + h / 6 * (dr1 + 2 * dr2 + 2 * dr3 + dr4);
+    }
+  }  // onestep
+
+  // advance all the vessels by one sample time
+  void onestep() { onestep(0, num_vessels); }
+
+  // run a closed-loop scenario of _num_steps for each vessel, where
+  // _policy(std::size_t vessel, std::size_t step, const state_type &x)
+  // returns the scenariocommand. The vessels are split into chunks of
+  // _num_threads threads, so _policy is called concurrently for
+  // different vessels.
+  template <typename Policy>
+  std::vector<scenariometrics> runscenarios(
+      std::size_t _num_steps, const Policy &_policy,
+      std::size_t _num_threads = std::thread::hardware_concurrency()) {
+    std::vector<scenariometrics> metrics(num_vessels,
+                                         scenariometrics{0, 0, 0, 0});
+    _num_threads = std::max<std::size_t>(
+        1, std::min(_num_threads, num_vessels));
+    std::size_t chunk = (num_vessels + _num_threads - 1) / _num_threads;
+
+    auto runchunk = [&](std::size_t _begin, std::size_t _end) {
+      for (std::size_t k = 0; k != _num_steps; ++k) {
+        for (std::size_t i = _begin; i != _end; ++i) {
+          state_type x = getX(i);
+          scenariocommand command = _policy(i, k, x);
+          setinput(i, command.desired_heading, command.thrust,
+                   command.seaload);
+          accumulatemetrics(metrics[i], x, command);
+        }
+        onestep(_begin, _end);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < _num_threads; ++t) {
+      std::size_t begin = std::min(t * chunk, num_vessels);
+      std::size_t end = std::min(begin + chunk, num_vessels);
+      workers.emplace_back(runchunk, begin, end);
+    }
+    runchunk(0, std::min(chunk, num_vessels));
+    for (auto &_worker : workers) _worker.join();
+
+    for (auto &_metrics : metrics) {
+      _metrics.rms_position_error =
+          std::sqrt(_metrics.rms_position_error / _num_steps);
+      _metrics.rms_heading_error =
+          std::sqrt(_metrics.rms_heading_error / _num_steps);
+    }
+    return metrics;
+  }  // runscenarios
+
+  void setX(std::size_t i, const state_type &_x) {
+    for (int j = 0; j != 6; ++j) X[j][i] = _x(j);
+  }
+  state_type getX(std::size_t i) const {
+    state_type _x;
+    for (int j = 0; j != 6; ++j) _x(j) = X[j][i];
+    return _x;
+  }
+  std::size_t size() const noexcept { return num_vessels; }
+  double getsampletime() const noexcept { return sample_time; }
+
+ private:
+  const double sample_time;  // second
+  const std::size_t num_vessels;
+  const Eigen::Matrix3d M_inv;
+  const Eigen::Matrix3d K;  // -M^(-1) * D
+
+  std::array<std::vector<double>, 6> X;      // x, y, theta, u, v, r
+  std::array<std::vector<double>, 3> force;  // M^(-1) * (thrust + seaload)
+  std::vector<double> desired_heading;
+  std::vector<double> cos_theta;
+  std::vector<double> sin_theta;
+
+  // the same orientation in the transformation as simulator_onestep
+  void updaterotation(std::size_t _begin, std::size_t _end) {
+    for (std::size_t i = _begin; i < _end; ++i) {
+      double theta = X[2][i];
+      if (std::abs(common::math::Normalizeheadingangle(
+              theta - desired_heading[i])) < M_PI / 36)
+        theta = desired_heading[i];
+      cos_theta[i] = std::cos(theta);
+      sin_theta[i] = std::sin(theta);
+    }
+  }  // updaterotation
+
+  void accumulatemetrics(scenariometrics &_metrics, const state_type &_x,
+                         const scenariocommand &_command) const {
+    double position_error = (_x.head(2) - _command.setpoint.head(2)).norm();
+    double heading_error =
+        common::math::Normalizeheadingangle(_x(2) - _command.setpoint(2));
+    _metrics.rms_position_error += position_error * position_error;
+    _metrics.max_position_error =
+        std::max(_metrics.max_position_error, position_error);
+    _metrics.rms_heading_error += heading_error * heading_error;
+    _metrics.energy +=
+        std::abs(_command.thrust.dot(_x.tail(3))) * sample_time;
+  }  // accumulatemetrics
+};  // end class batchsimulator
+
+}  // namespace ASV::simulation
+
+#endif /* _BATCHSIMULATOR_H_ */
@@ -11,9 +11,10 @@
 #ifndef _SIMULATOR_H_
 #define _SIMULATOR_H_
 
+#include <boost/numeric/odeint.hpp>
 #include <cmath>
+#include <common/math/eigen/unsupported/Eigen/MatrixFunctions>
 #include "common/math/miscellaneous/include/math_utils.h"
-#include "common/math/solvers/ode/include/odesolver.h"
 #include "simulatordata.h"
 
 namespace ASV::simulation {
@@ -26,7 +27,10 @@ struct vessel_simulator {
         D(_vessel.LinearDamping),
         A(Eigen::Matrix<double, 6, 6>::Zero()),
         B(Eigen::Matrix<double, 6, 3>::Zero()),
-        u(Eigen::Vector3d::Zero()) {
+        u(Eigen::Vector3d::Zero()),
+        expKh(Eigen::Matrix3d::Identity()),
+        Phi1(Eigen::Matrix3d::Zero()),
+        Phi2(Eigen::Matrix3d::Zero()) {
     initializeAB();
   }
 
@@ -61,11 +65,43 @@ struct vessel_simulator {
     B.block(3, 0, 3, 3) = M_inv;
   }
 
+  // With the rotation R fixed in one step and K = -M^(-1)*D, the zero-order
+  // hold of the input f = M^(-1)*u gives
+  //    nu(h) = exp(K*h) * nu + Phi1 * f,
+  //    eta(h) = eta + R * (Phi1 * nu + Phi2 * f),
+  // where Phi1 = int_0^h exp(K*t)dt and Phi2 = int_0^h int_0^t exp(K*s)dsdt.
+  // They are given by the exponential of an augmented matrix, only once.
+  void discretize(double _sample_time) {
+    Eigen::Matrix<double, 9, 9> augmented = Eigen::Matrix<double, 9, 9>::Zero();
+    augmented.block(0, 0, 3, 3) = A.block(3, 3, 3, 3);
+    augmented.block(0, 3, 3, 3) = Eigen::Matrix3d::Identity();
+    augmented.block(3, 6, 3, 3) = Eigen::Matrix3d::Identity();
+    Eigen::Matrix<double, 9, 9> exp_augmented =
+        (augmented * _sample_time).exp();
+    expKh = exp_augmented.block(0, 0, 3, 3);
+    Phi1 = exp_augmented.block(0, 3, 3, 3);
+    Phi2 = exp_augmented.block(0, 6, 3, 3);
+  }  // discretize
+
+  // exact state at next sample time, using the A and u updated
+  template <typename State>
+  void exactstep(State& x) const {
+    Eigen::Vector3d f = B.block(3, 0, 3, 3) * u;
+    Eigen::Vector3d nu = x.template tail<3>();
+    x.template head<3>() +=
+        A.block(0, 3, 3, 3) * (Phi1 * nu + Phi2 * f);
+    x.template tail<3>() = expKh * nu + Phi1 * f;
+  }  // exactstep
+
   Eigen::Matrix3d M;
   Eigen::Matrix3d D;
   Eigen::Matrix<double, 6, 6> A;
   Eigen::Matrix<double, 6, 3> B;
   Eigen::Vector3d u;  // input defined in the body-fixed coordinate frame
+  // zero-order hold
+  Eigen::Matrix3d expKh;
+  Eigen::Matrix3d Phi1;
+  Eigen::Matrix3d Phi2;
 };
 
 class simulator {
@@ -73,10 +109,14 @@ class simulator {
 
  public:
   simulator(double _sample_time, const common::vessel& _vessel,
-            const state_type& _x = state_type::Zero())
+            const state_type& _x = state_type::Zero(),
+            DISCRETIZATION _discretization = DISCRETIZATION::RK4)
       : sample_time(_sample_time),
+        discretization(_discretization),
         sys(_vessel),
-        simulator_rtdata({common::STATETOGGLE::READY, _x}) {}
+        simulator_rtdata({common::STATETOGGLE::READY, _x}) {
+    if (discretization == DISCRETIZATION::ZOH) sys.discretize(sample_time);
+  }
   virtual ~simulator() = default;
 
   simulator& simulator_onestep(
@@ -94,7 +134,10 @@ class simulator {
 
     sys.updateA(_theta);              // update the transform matrix and A
     sys.updateu(_thrust + _seaload);  // update the input
-    rk4.do_step(sys, simulator_rtdata.X, 0.0, sample_time);
+    if (discretization == DISCRETIZATION::ZOH)
+      sys.exactstep(simulator_rtdata.X);
+    else
+      rk4.do_step(sys, simulator_rtdata.X, 0.0, sample_time);
     return *this;
   }
 
@@ -104,6 +147,7 @@ class simulator {
 
  private:
   double sample_time;  // second
+  DISCRETIZATION discretization;
   vessel_simulator sys;
   simulatorRTdata simulator_rtdata;
 
@@ -15,6 +15,12 @@
 
 namespace ASV::simulation {
 
+// method to compute the state at next sample time
+enum class DISCRETIZATION {
+  RK4 = 0,  // 4-order Runge-Kutta
+  ZOH       // exact discretization with zero-order hold input
+};
+
 struct simulatorRTdata {
   // state toggle
   common::STATETOGGLE state_toggle;
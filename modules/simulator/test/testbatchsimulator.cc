@@ -0,0 +1,144 @@
+/*
+***********************************************************************
+* testbatchsimulator.cc:
+* compare the batched simulator with simulator for the same closed-loop
+* scenarios, sweep the gains of a P controller, and report the vessel
+* steps per second of both.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "../include/batchsimulator.h"
+#include "../include/simulator.h"
+
+using namespace ASV;
+using state_type = Eigen::Matrix<double, 6, 1>;
+using steady = std::chrono::steady_clock;
+
+const common::vessel _vessel{
+    (Eigen::Matrix3d() << 100, 0, 1, 0, 100, 0, 1, 0, 1000)
+        .finished(),          // Mass
+    Eigen::Matrix3d::Zero(),  // AddedMass
+    (Eigen::Matrix3d() << 100, 0, 0, 0, 200, 0, 0, 0, 300)
+        .finished(),          // LinearDamping
+    Eigen::Matrix3d::Zero(),  // QuadraticDamping
+    Eigen::Vector3d::Zero(),  // cog
+    Eigen::Vector2d::Zero(),  // x_thrust
+    Eigen::Vector2d::Zero(),  // y_thrust
+    Eigen::Vector2d::Zero(),  // mz_thrust
+    Eigen::Vector2d::Zero(),  // surge_v
+    Eigen::Vector2d::Zero(),  // sway_v
+    Eigen::Vector2d::Zero(),  // yaw_v
+    Eigen::Vector2d::Zero(),  // roll_v
+    0,                        // L
+    0                         // B
+};
+
+constexpr double sample_time = 0.1;
+
+// P controller in the earth-fixed frame, whose gain and constant
+// current depend on the vessel
+simulation::scenariocommand policy(std::size_t _vessel_index, std::size_t,
+                                   const state_type &_x) {
+  double gain = 5.0 + 5.0 * (_vessel_index % 8);
+  Eigen::Vector3d setpoint(10, -5, 0.5);
+  Eigen::Vector3d error = setpoint - _x.head(3);
+  error(2) = common::math::Normalizeheadingangle(error(2));
+  double c = std::cos(_x(2)), s = std::sin(_x(2));
+  Eigen::Vector3d thrust(gain * (c * error(0) + s * error(1)),
+                         gain * (-s * error(0) + c * error(1)),
+                         10 * gain * error(2));
+  thrust -= 20 * _x.tail(3);
+  Eigen::Vector3d seaload(5.0 * std::sin(0.1 * _vessel_index), 2.0, 0);
+  return {setpoint(2), thrust, seaload, setpoint};
+}  // policy
+
+state_type initialstate(std::size_t _vessel_index) {
+  return (state_type() << 0.1 * _vessel_index, 1, 0.1, 0, 0, 0).finished();
+}
+
+// same scenarios with simulator, one vessel after another
+std::vector<state_type> runsimulator(std::size_t _num_vessels,
+                                     std::size_t _num_steps) {
+  std::vector<state_type> final_x;
+  for (std::size_t i = 0; i != _num_vessels; ++i) {
+    simulation::simulator _simulator(sample_time, _vessel, initialstate(i));
+    for (std::size_t k = 0; k != _num_steps; ++k) {
+      auto command = policy(i, k, _simulator.getX());
+      _simulator.simulator_onestep(command.desired_heading, command.thrust,
+                                   command.seaload);
+    }
+    final_x.push_back(_simulator.getX());
+  }
+  return final_x;
+}  // runsimulator
+
+int main() {
+  constexpr std::size_t num_steps = 2000;
+  bool passed = true;
+
+  // accuracy
+  {
+    constexpr std::size_t num_vessels = 64;
+    simulation::batchsimulator batch(sample_time, _vessel, num_vessels);
+    for (std::size_t i = 0; i != num_vessels; ++i)
+      batch.setX(i, initialstate(i));
+    auto metrics = batch.runscenarios(num_steps, policy, 4);
+    auto final_x = runsimulator(num_vessels, num_steps);
+    double max_difference = 0;
+    for (std::size_t i = 0; i != num_vessels; ++i)
+      max_difference = std::max(
+          max_difference, (batch.getX(i) - final_x[i]).cwiseAbs().maxCoeff());
+    passed &= (max_difference < 1e-8);
+    std::cout << "max difference to simulator: " << max_difference << "\n";
+
+    // the sweep of gains
+    for (std::size_t i = 0; i != 8; ++i)
+      std::cout << "gain " << 5.0 + 5.0 * i << ": rms position error "
+                << metrics[i].rms_position_error << " m, max "
+                << metrics[i].max_position_error << " m, rms heading error "
+                << metrics[i].rms_heading_error << " rad, energy "
+                << metrics[i].energy << " J\n";
+    passed &= (metrics[7].rms_position_error < metrics[0].rms_position_error);
+  }
+
+  // throughput
+  {
+    constexpr std::size_t num_vessels = 4096;
+    constexpr std::size_t num_bench_steps = 500;
+    auto t0 = steady::now();
+    runsimulator(num_vessels / 16, num_bench_steps);
+    double simulator_rate =
+        num_vessels / 16 * num_bench_steps /
+        std::chrono::duration<double>(steady::now() - t0).count();
+
+    simulation::batchsimulator batch(sample_time, _vessel, num_vessels);
+    for (std::size_t i = 0; i != num_vessels; ++i)
+      batch.setX(i, initialstate(i));
+    t0 = steady::now();
+    for (std::size_t k = 0; k != num_bench_steps; ++k) batch.onestep();
+    double step_rate =
+        num_vessels * num_bench_steps /
+        std::chrono::duration<double>(steady::now() - t0).count();
+
+    std::cout << "vessel steps per second: simulator with policy "
+              << simulator_rate << ", batch step only " << step_rate;
+    for (std::size_t num_threads : {std::size_t(1),
+                                    std::size_t(
+                                        std::thread::hardware_concurrency())}) {
+      t0 = steady::now();
+      batch.runscenarios(num_bench_steps, policy, num_threads);
+      double rate = num_vessels * num_bench_steps /
+                    std::chrono::duration<double>(steady::now() - t0).count();
+      std::cout << ", batch with policy (" << num_threads << " threads) "
+                << rate;
+    }
+    std::cout << std::endl;
+  }
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
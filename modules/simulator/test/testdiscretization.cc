@@ -0,0 +1,115 @@
+/*
+***********************************************************************
+* testdiscretization.cc:
+* compare the exact discretization (zero-order hold) of simulator with
+* RK4, in accuracy of one step and of a long mission, and in speed.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "../include/simulator.h"
+
+using namespace ASV;
+using state_type = Eigen::Matrix<double, 6, 1>;
+using steady = std::chrono::steady_clock;
+
+const common::vessel _vessel{
+    (Eigen::Matrix3d() << 100, 0, 1, 0, 100, 0, 1, 0, 1000)
+        .finished(),          // Mass
+    Eigen::Matrix3d::Zero(),  // AddedMass
+    (Eigen::Matrix3d() << 100, 0, 0, 0, 200, 0, 0, 0, 300)
+        .finished(),          // LinearDamping
+    Eigen::Matrix3d::Zero(),  // QuadraticDamping
+    Eigen::Vector3d::Zero(),  // cog
+    Eigen::Vector2d::Zero(),  // x_thrust
+    Eigen::Vector2d::Zero(),  // y_thrust
+    Eigen::Vector2d::Zero(),  // mz_thrust
+    Eigen::Vector2d::Zero(),  // surge_v
+    Eigen::Vector2d::Zero(),  // sway_v
+    Eigen::Vector2d::Zero(),  // yaw_v
+    Eigen::Vector2d::Zero(),  // roll_v
+    0,                        // L
+    0                         // B
+};
+
+// error of one step with the rotation fixed, where the reference is RK4
+// with 1000 sub-steps
+double onesteperror(double _sample_time, simulation::DISCRETIZATION _method) {
+  constexpr int num_substeps = 1000;
+  double max_error = 0;
+  std::srand(1);
+  for (int k = 0; k != 100; ++k) {
+    state_type x = state_type::Random();
+    x(2) *= M_PI;
+    Eigen::Vector3d thrust = 100 * Eigen::Vector3d::Random();
+
+    simulation::simulator _simulator(_sample_time, _vessel, x, _method);
+    _simulator.simulator_onestep(x(2), thrust);
+
+    simulation::vessel_simulator sys(_vessel);
+    sys.updateA(x(2));
+    sys.updateu(thrust);
+    boost::numeric::odeint::runge_kutta4<
+        state_type, double, state_type, double,
+        boost::numeric::odeint::vector_space_algebra>
+        rk4;
+    state_type reference = x;
+    for (int i = 0; i != num_substeps; ++i)
+      rk4.do_step(sys, reference, 0.0, _sample_time / num_substeps);
+
+    max_error = std::max(
+        max_error, (_simulator.getX() - reference).cwiseAbs().maxCoeff());
+  }
+  return max_error;
+}  // onesteperror
+
+// a long mission of P controller, return the final state
+state_type mission(double _sample_time, int _num_steps,
+                   simulation::DISCRETIZATION _method, double &_elapsed_ms) {
+  state_type x = (state_type() << 0, 1, 0.1, 0, 0, 0).finished();
+  Eigen::Matrix3d P =
+      (Eigen::Matrix3d() << 10, 0, 0, 0, 10, 0, 0, 0, 100).finished();
+  simulation::simulator _simulator(_sample_time, _vessel, x, _method);
+
+  auto t0 = steady::now();
+  for (int i = 0; i != _num_steps; ++i) {
+    Eigen::Vector3d setpoint(100 * std::sin(1e-4 * i), 50, 0.2);
+    Eigen::Vector3d u = P * (setpoint - x.head(3));
+    x = _simulator.simulator_onestep(setpoint(2), u).getX();
+  }
+  _elapsed_ms =
+      std::chrono::duration<double, std::milli>(steady::now() - t0).count();
+  return x;
+}  // mission
+
+int main() {
+  bool passed = true;
+  for (double sample_time : {0.01, 0.1, 1.0}) {
+    double rk4_error =
+        onesteperror(sample_time, simulation::DISCRETIZATION::RK4);
+    double zoh_error =
+        onesteperror(sample_time, simulation::DISCRETIZATION::ZOH);
+    passed &= (zoh_error < 1e-9);
+    std::cout << "one step of " << sample_time << " s, error of RK4 "
+              << rk4_error << ", error of ZOH " << zoh_error << "\n";
+  }
+
+  constexpr int num_steps = 1000000;  // 1e5 s mission
+  double rk4_ms = 0, zoh_ms = 0;
+  state_type x_rk4 =
+      mission(0.1, num_steps, simulation::DISCRETIZATION::RK4, rk4_ms);
+  state_type x_zoh =
+      mission(0.1, num_steps, simulation::DISCRETIZATION::ZOH, zoh_ms);
+  double difference = (x_rk4 - x_zoh).cwiseAbs().maxCoeff();
+  passed &= (difference < 1e-3);
+  std::cout << "mission of " << num_steps << " steps: RK4 " << rk4_ms
+            << " ms, ZOH " << zoh_ms << " ms, difference of final state "
+            << difference << std::endl;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}